@@ -17,4 +17,70 @@
 
 #include <dmsdk/dlib/atomic.h>
 
+/*
+ * Atomic load of an int32_atomic_t. It is sequentially consistent with the other atomic functions.
+ * With GCC and Clang it is a load instruction that doesn't write to the memory, unlike dmAtomicGet32,
+ * which makes it a lot cheaper when polled, or when other threads are writing to the same cache line.
+ * With MSVC it is a compare-and-swap of 0 with 0. It never changes the value, but it is a locked
+ * read-modify-write, with the same cost as dmAtomicGet32.
+ * @return value Current value
+ */
+inline int32_t dmAtomicLoad32(int32_atomic_t* ptr)
+{
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange((volatile long*) ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Pointer versions of the atomic functions. The stores are full memory barriers, like the 32 bit versions.
+
+/*
+ * Atomic load of a pointer, see dmAtomicLoad32
+ * @return value Current value
+ */
+template <typename T>
+inline T* dmAtomicGetPtr(T* volatile* ptr)
+{
+#if defined(_MSC_VER)
+    return (T*) InterlockedCompareExchangePointer((PVOID volatile*) ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/*
+ * Atomic exchange of a pointer
+ * @return prev Previous value
+ */
+template <typename T>
+inline T* dmAtomicStorePtr(T* volatile* ptr, T* value)
+{
+#if defined(_MSC_VER)
+    return (T*) InterlockedExchangePointer((PVOID volatile*) ptr, (PVOID) value);
+#else
+    T* prev;
+    do
+    {
+        prev = dmAtomicGetPtr(ptr);
+    } while (!__sync_bool_compare_and_swap(ptr, prev, value));
+    return prev;
+#endif
+}
+
+/*
+ * Atomic compare and store of a pointer. Stores value if the current value equals comparand.
+ * @return prev Previous value
+ */
+template <typename T>
+inline T* dmAtomicCompareStorePtr(T* volatile* ptr, T* value, T* comparand)
+{
+#if defined(_MSC_VER)
+    return (T*) InterlockedCompareExchangePointer((PVOID volatile*) ptr, (PVOID) value, (PVOID) comparand);
+#else
+    return __sync_val_compare_and_swap(ptr, comparand, value);
+#endif
+}
+
 #endif //DM_ATOMIC_H
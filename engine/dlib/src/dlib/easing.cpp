@@ -17,6 +17,11 @@
 #include <dlib/math.h>
 #include "easing.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_EASING_SSE2
+#endif
+
 namespace dmEasing
 {
     #include "easing_lookup.h"
@@ -61,5 +66,47 @@ namespace dmEasing
         float diff = (t - index1 * (1.0f / (sample_count-1))) * (sample_count-1);
         return val1 * (1.0f - diff) + val2 * diff;
     }
+
+    void GetValues(Type type, const float* t, float* out, uint32_t count)
+    {
+        assert(type < TYPE_FLOAT_VECTOR);
+        const float* lookup = EASING_LOOKUP + type * (EASING_SAMPLES + 1);
+        const float scale = (float) (EASING_SAMPLES - 1);
+        const float recip_scale = 1.0f / (EASING_SAMPLES - 1);
+
+        // Same as GetValue(). Since the last sample is duplicated, index+1 is always within the curve.
+        uint32_t i = 0;
+#if defined(DM_EASING_SSE2)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale4 = _mm_set1_ps(scale);
+        const __m128 recip_scale4 = _mm_set1_ps(recip_scale);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 ti = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(t + i), zero), one);
+            __m128i index = _mm_cvttps_epi32(_mm_mul_ps(ti, scale4));
+            __m128 diff = _mm_mul_ps(_mm_sub_ps(ti, _mm_mul_ps(_mm_cvtepi32_ps(index), recip_scale4)), scale4);
+
+            int32_t indices[4];
+            _mm_storeu_si128((__m128i*) indices, index);
+            const float* l0 = lookup + indices[0];
+            const float* l1 = lookup + indices[1];
+            const float* l2 = lookup + indices[2];
+            const float* l3 = lookup + indices[3];
+            __m128 val1 = _mm_setr_ps(l0[0], l1[0], l2[0], l3[0]);
+            __m128 val2 = _mm_setr_ps(l0[1], l1[1], l2[1], l3[1]);
+
+            __m128 result = _mm_add_ps(_mm_mul_ps(val1, _mm_sub_ps(one, diff)), _mm_mul_ps(val2, diff));
+            _mm_storeu_ps(out + i, result);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            float ti = dmMath::Clamp(t[i], 0.0f, 1.0f);
+            int index = (int) (ti * scale);
+            float diff = (ti - index * recip_scale) * scale;
+            out[i] = lookup[index] * (1.0f - diff) + lookup[index + 1] * diff;
+        }
+    }
 }
 
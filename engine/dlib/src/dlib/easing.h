@@ -105,6 +105,15 @@ namespace dmEasing
      */
     float GetValue(Type type, float t);
     float GetValue(Curve curve, float t);
+
+    /**
+     * Easing-curve evaluation of many values at once. Gives the same result as GetValue for each value.
+     * @param type curve type, any built in type (i.e. not TYPE_FLOAT_VECTOR)
+     * @param t times in the range [0,1]
+     * @param out curve values, may be the same array as t
+     * @param count number of values
+     */
+    void GetValues(Type type, const float* t, float* out, uint32_t count);
 }
 
 #endif // DM_EASING
@@ -14,14 +14,16 @@
 
 
 #include <stdio.h> // printf
-
-#include <dmsdk/dlib/array.h>
+#include <stdint.h>
+#include <string.h> // memset
 
 #include <dmsdk/dlib/array.h>
 #include <dmsdk/dlib/atomic.h>
 #include <dmsdk/dlib/profile.h>
 #include <dmsdk/dlib/log.h>
+#include <dmsdk/dlib/spinlock.h>
 #include <dlib/thread.h>
+#include <dlib/time.h>
 #include <dlib/math.h>
 #include <dlib/dstrings.h>
 
@@ -30,120 +32,404 @@
     #include <dmsdk/dlib/mutex.h>
 #endif
 
-#include "jc/ringbuffer.h"
 #include "job_thread.h"
 
+/*
+ * Work stealing job scheduler
+ *
+ * Each worker thread owns a job queue, and all other threads (e.g. the main thread) share queue 0.
+ * A thread pushes and pops at the back of its own queue (LIFO, good for cache locality), and steals
+ * from the front of the other queues (FIFO) when its own queue is empty.
+ * Without worker threads, Update() also runs the jobs of queue 0 from the front, in the order they were pushed.
+ * Each queue has one lane per priority, and the lanes are always checked in priority order.
+ *
+ * The jobs are stored in a fixed size pool, so no allocations (or reallocations) are made while the workers are running.
+ * A job handle is the pool index plus a generation, which is bumped when the job finishes.
+ */
+
 namespace dmJobThread
 {
 
+static const uint32_t JOB_INDEX_MASK = 0xFFFF;
+static const uint32_t JOB_GENERATION_SHIFT = 16;
+// Number of times WaitJob() polls the queues without finding work, before it starts yielding the thread
+static const uint32_t WAIT_JOB_SPIN_COUNT = 64;
+
 struct JobItem
 {
     void*       m_Context;
     void*       m_Data;
-    FProcess    m_Process;
     FCallback   m_Callback;
     int         m_Result;
 };
 
-struct JobThreadContext
+struct Job
 {
-    jc::RingBuffer<JobItem>                 m_Work;
-    jc::RingBuffer<JobItem>                 m_Done;
+    FProcess        m_Process;
+    FRangeProcess   m_RangeProcess;
+    FCallback       m_Callback;     // If set, it's called from Update() on the main thread
+    void*           m_Context;
+    void*           m_Data;
+    uint32_t        m_RangeStart;
+    uint32_t        m_RangeEnd;
+    HJob            m_Parent;
+    int32_atomic_t  m_Unfinished;   // 1 (the job itself) + number of unfinished children
+    int32_atomic_t  m_Generation;
+    int             m_Result;
+    uint8_t         m_Priority;
+};
+
+// Bounded deque of job indices. It can never overflow since the capacity is >= the job pool size
+struct JobLane
+{
+    uint16_t*           m_Items;
+    volatile uint32_t   m_Front;
+    volatile uint32_t   m_Back;
+};
+
+struct JobQueue
+{
+    dmSpinlock::Spinlock    m_Lock;
+    JobLane                 m_Lanes[MAX_JOB_PRIORITY];
+};
+
+struct WorkerArgs
+{
+    struct JobContext*  m_Context;
+    uint32_t            m_QueueIndex;
+};
+
+struct JobContext
+{
+    Job*                        m_Jobs;
+    uint32_t                    m_MaxJobCount;
+    uint32_t                    m_QueueMask;
+
+    dmSpinlock::Spinlock        m_FreeLock;
+    dmArray<uint16_t>           m_FreeIndices;
+
+    // Queue 0 is shared by all non worker threads. Queue i+1 is owned by worker i
+    dmArray<JobQueue*>          m_Queues;
+
+    // Finished jobs with a callback, waiting for Update().
+    // Update() swaps the arrays, so that the jobs can keep finishing while it does the callbacks
+    dmSpinlock::Spinlock        m_DoneLock;
+    dmArray<JobItem>            m_Done[2];
+    uint32_t                    m_DoneIndex;
+
+    dmArray<WorkerArgs>         m_WorkerArgs;
+    dmArray<dmThread::Thread>   m_Threads;
 
 #if defined(DM_HAS_THREADS)
+    dmThread::TlsKey                        m_WorkerTls;
     dmMutex::HMutex                         m_Mutex;
     dmConditionVariable::HConditionVariable m_WakeupCond;
-    bool                                    m_Run;
+    int32_atomic_t                          m_Pending;  // Number of queued jobs
+    int32_atomic_t                          m_Sleeping; // Number of workers waiting for jobs
+    int32_atomic_t                          m_Run;
 #endif
 };
 
-struct JobContext
+JobThreadCreationParams::JobThreadCreationParams()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+static inline uint32_t GetQueueIndex(JobContext* ctx)
 {
 #if defined(DM_HAS_THREADS)
-    dmArray<dmThread::Thread> m_Threads;
+    return (uint32_t)(uintptr_t)dmThread::GetTlsValue(ctx->m_WorkerTls);
+#else
+    return 0;
 #endif
-    JobThreadContext    m_ThreadContext;
-};
+}
+
+static inline Job* GetJob(JobContext* ctx, HJob job)
+{
+    return &ctx->m_Jobs[job & JOB_INDEX_MASK];
+}
 
-static void PutWork(JobThreadContext* ctx, const JobItem* item)
+static inline HJob MakeHandle(JobContext* ctx, uint32_t index)
 {
+    uint32_t generation = (uint32_t)dmAtomicGet32(&ctx->m_Jobs[index].m_Generation);
+    return (generation << JOB_GENERATION_SHIFT) | index;
+}
+
+static void PushLane(JobContext* ctx, JobLane* lane, uint16_t index)
+{
+    lane->m_Items[lane->m_Back & ctx->m_QueueMask] = index;
+    lane->m_Back = lane->m_Back + 1;
+}
+
+static void PushQueue(JobContext* ctx, uint32_t queue_index, uint32_t priority, uint16_t index)
+{
+#if defined(DM_HAS_THREADS)
+    // Count it before it's visible to the workers, so that the counter never goes below zero
+    dmAtomicIncrement32(&ctx->m_Pending);
+#endif
+
+    JobQueue* queue = ctx->m_Queues[queue_index];
+    {
+        DM_SPINLOCK_SCOPED_LOCK(queue->m_Lock);
+        PushLane(ctx, &queue->m_Lanes[priority], index);
+    }
+
 #if defined(DM_HAS_THREADS)
-    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+    if (dmAtomicGet32(&ctx->m_Sleeping) > 0)
+    {
+        DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+        dmConditionVariable::Signal(ctx->m_WakeupCond);
+    }
 #endif
-    if (ctx->m_Work.Full())
-        ctx->m_Work.SetCapacity(ctx->m_Work.Capacity() + 8);
-    ctx->m_Work.Push(*item);
 }
 
-static void PutDone(JobThreadContext* ctx, JobItem* item)
+// Pop from the back (own queue) or steal from the front (other queues)
+static bool PopLane(JobContext* ctx, JobQueue* queue, uint32_t priority, bool back, uint16_t* out)
 {
+    JobLane* lane = &queue->m_Lanes[priority];
+    if (lane->m_Front == lane->m_Back) // Early out without taking the lock
+        return false;
+
+    DM_SPINLOCK_SCOPED_LOCK(queue->m_Lock);
+    if (lane->m_Front == lane->m_Back)
+        return false;
+
+    if (back)
+    {
+        lane->m_Back = lane->m_Back - 1;
+        *out = lane->m_Items[lane->m_Back & ctx->m_QueueMask];
+    }
+    else
+    {
+        *out = lane->m_Items[lane->m_Front & ctx->m_QueueMask];
+        lane->m_Front = lane->m_Front + 1;
+    }
+    return true;
+}
+
+// With oldest_first, the own queue is also popped from the front, i.e. in the order the jobs were pushed
+static bool PopJob(JobContext* ctx, uint32_t queue_index, uint32_t max_priority, bool oldest_first, uint16_t* out)
+{
+    uint32_t queue_count = ctx->m_Queues.Size();
+    for (uint32_t p = 0; p <= max_priority; ++p)
+    {
+        if (PopLane(ctx, ctx->m_Queues[queue_index], p, !oldest_first, out))
+            goto found;
+
+        for (uint32_t i = 1; i < queue_count; ++i)
+        {
+            uint32_t victim = (queue_index + i) % queue_count;
+            if (PopLane(ctx, ctx->m_Queues[victim], p, false, out))
+                goto found;
+        }
+    }
+    return false;
+
+found:
 #if defined(DM_HAS_THREADS)
-    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+    dmAtomicDecrement32(&ctx->m_Pending);
 #endif
-    if (ctx->m_Done.Full())
-        ctx->m_Done.SetCapacity(ctx->m_Done.Capacity() + 8);
-    ctx->m_Done.Push(*item);
+    return true;
 }
 
-#if defined(DM_HAS_THREADS)
-static void JobThread(void* _ctx)
+static HJob AllocJob(JobContext* ctx, HJob parent)
+{
+    uint16_t index;
+    {
+        DM_SPINLOCK_SCOPED_LOCK(ctx->m_FreeLock);
+        if (ctx->m_FreeIndices.Empty())
+            return INVALID_JOB;
+        index = ctx->m_FreeIndices.Back();
+        ctx->m_FreeIndices.Pop();
+    }
+
+    Job* job = &ctx->m_Jobs[index];
+    job->m_Process      = 0;
+    job->m_RangeProcess = 0;
+    job->m_Callback     = 0;
+    job->m_Context      = 0;
+    job->m_Data         = 0;
+    job->m_RangeStart   = 0;
+    job->m_RangeEnd     = 0;
+    job->m_Parent       = parent;
+    job->m_Result       = 0;
+    job->m_Priority     = JOB_PRIORITY_NORMAL;
+    dmAtomicStore32(&job->m_Unfinished, 1);
+
+    if (parent != INVALID_JOB)
+        dmAtomicIncrement32(&GetJob(ctx, parent)->m_Unfinished);
+
+    return MakeHandle(ctx, index);
+}
+
+static void FreeJob(JobContext* ctx, uint32_t index)
+{
+    Job* job = &ctx->m_Jobs[index];
+
+    // Only one thread can finish a job, so there is no need for a compare-and-swap here
+    uint32_t generation = (uint32_t)dmAtomicGet32(&job->m_Generation) + 1;
+    if ((generation & JOB_INDEX_MASK) == 0)
+        generation = 1;
+    dmAtomicStore32(&job->m_Generation, (int32_t)generation);
+
+    DM_SPINLOCK_SCOPED_LOCK(ctx->m_FreeLock);
+    ctx->m_FreeIndices.Push((uint16_t)index);
+}
+
+static void PutDone(JobContext* ctx, const JobItem& item)
+{
+    DM_SPINLOCK_SCOPED_LOCK(ctx->m_DoneLock);
+    dmArray<JobItem>& done = ctx->m_Done[ctx->m_DoneIndex];
+    if (done.Full())
+        done.OffsetCapacity(64);
+    done.Push(item);
+}
+
+static void FinishJob(JobContext* ctx, uint32_t index)
 {
-    JobThreadContext* ctx = (JobThreadContext*)_ctx;
     while (true)
     {
-        JobItem item = {};
+        Job* job = &ctx->m_Jobs[index];
+        if (dmAtomicDecrement32(&job->m_Unfinished) != 1)
+            return; // There are still unfinished children
+
+        if (job->m_Callback)
         {
-            DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
-
-            if (!ctx->m_Run)
-                break;
-
-            while(ctx->m_Work.Empty())
-            {
-                dmConditionVariable::Wait(ctx->m_WakeupCond, ctx->m_Mutex);
-                if (!ctx->m_Run)
-                    return;
-            }
-            item = ctx->m_Work.Pop();
+            JobItem item;
+            item.m_Context  = job->m_Context;
+            item.m_Data     = job->m_Data;
+            item.m_Callback = job->m_Callback;
+            item.m_Result   = job->m_Result;
+            PutDone(ctx, item);
         }
 
+        HJob parent = job->m_Parent;
+        FreeJob(ctx, index);
+
+        if (parent == INVALID_JOB)
+            return;
+        index = parent & JOB_INDEX_MASK;
+    }
+}
+
+static void ExecuteJob(JobContext* ctx, uint32_t index)
+{
+    Job* job = &ctx->m_Jobs[index];
+    if (job->m_RangeProcess)
+        job->m_RangeProcess(job->m_Context, job->m_Data, job->m_RangeStart, job->m_RangeEnd);
+    else if (job->m_Process)
+        job->m_Result = job->m_Process(job->m_Context, job->m_Data);
+    FinishJob(ctx, index);
+}
+
+#if defined(DM_HAS_THREADS)
+static void JobThread(void* _args)
+{
+    WorkerArgs* args = (WorkerArgs*)_args;
+    JobContext* ctx = args->m_Context;
+    uint32_t queue_index = args->m_QueueIndex;
+
+    dmThread::SetTlsValue(ctx->m_WorkerTls, (void*)(uintptr_t)queue_index);
+
+    while (dmAtomicGet32(&ctx->m_Run))
+    {
+        uint16_t index;
+        if (PopJob(ctx, queue_index, MAX_JOB_PRIORITY - 1, false, &index))
         {
             DM_PROFILE("JobThread");
-            item.m_Result = item.m_Process(item.m_Context, item.m_Data);
-            PutDone(ctx, &item);
+            ExecuteJob(ctx, index);
+            continue;
         }
+
+        DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+        dmAtomicIncrement32(&ctx->m_Sleeping);
+        while (dmAtomicGet32(&ctx->m_Pending) == 0 && dmAtomicGet32(&ctx->m_Run))
+        {
+            dmConditionVariable::Wait(ctx->m_WakeupCond, ctx->m_Mutex);
+        }
+        dmAtomicDecrement32(&ctx->m_Sleeping);
     }
 }
-#else
-static void UpdateSingleThread(JobThreadContext* ctx)
-{
-    if (ctx->m_Work.Empty())
-        return;
-    // TODO: Perhaps time scope a number of items!
-    JobItem item = ctx->m_Work.Pop();
+#endif
 
-    item.m_Result = item.m_Process(item.m_Context, item.m_Data);
-    PutDone(ctx, &item);
+// Without workers, nothing steals from the front of queue 0, so we do it here.
+// The jobs then run in the order they were pushed, same as when the workers pick them up
+static void UpdateSingleThread(JobContext* ctx)
+{
+    uint16_t index;
+    if (PopJob(ctx, 0, MAX_JOB_PRIORITY - 1, true, &index))
+        ExecuteJob(ctx, index);
 }
-#endif
 
 HContext Create(const JobThreadCreationParams& create_params)
 {
     JobContext* context = new JobContext;
+
+    uint32_t max_job_count = create_params.m_MaxJobCount ? create_params.m_MaxJobCount : DM_DEFAULT_MAX_JOB_COUNT;
+    max_job_count = dmMath::Min(max_job_count, DM_MAX_JOB_COUNT);
+
+    context->m_MaxJobCount = max_job_count;
+    context->m_Jobs = new Job[max_job_count];
+    memset(context->m_Jobs, 0, sizeof(Job) * max_job_count);
+
+    context->m_FreeIndices.SetCapacity(max_job_count);
+    for (uint32_t i = 0; i < max_job_count; ++i)
+    {
+        context->m_Jobs[i].m_Generation = 1;
+        // Reversed, so that the first jobs get the lowest indices
+        context->m_FreeIndices.Push((uint16_t)(max_job_count - 1 - i));
+    }
+    dmSpinlock::Create(&context->m_FreeLock);
+    dmSpinlock::Create(&context->m_DoneLock);
+    context->m_DoneIndex = 0;
+
+    uint32_t thread_count = 0;
 #if defined(DM_HAS_THREADS)
-    context->m_ThreadContext.m_Mutex = dmMutex::New();
-    context->m_ThreadContext.m_WakeupCond = dmConditionVariable::New();
-    context->m_ThreadContext.m_Run = true;
+    thread_count = dmMath::Min(create_params.m_ThreadCount, DM_MAX_JOB_THREAD_COUNT);
+#endif
 
-    uint32_t thread_count = dmMath::Min(create_params.m_ThreadCount, DM_MAX_JOB_THREAD_COUNT);
+    uint32_t queue_capacity = 1;
+    while (queue_capacity < max_job_count)
+        queue_capacity <<= 1;
+    context->m_QueueMask = queue_capacity - 1;
+
+    uint32_t queue_count = thread_count + 1;
+    context->m_Queues.SetCapacity(queue_count);
+    for (uint32_t i = 0; i < queue_count; ++i)
+    {
+        JobQueue* queue = new JobQueue;
+        dmSpinlock::Create(&queue->m_Lock);
+        for (uint32_t p = 0; p < MAX_JOB_PRIORITY; ++p)
+        {
+            queue->m_Lanes[p].m_Items = new uint16_t[queue_capacity];
+            queue->m_Lanes[p].m_Front = 0;
+            queue->m_Lanes[p].m_Back = 0;
+        }
+        context->m_Queues.Push(queue);
+    }
+
+#if defined(DM_HAS_THREADS)
+    context->m_WorkerTls = dmThread::AllocTls();
+    context->m_Mutex = dmMutex::New();
+    context->m_WakeupCond = dmConditionVariable::New();
+    context->m_Pending = 0;
+    context->m_Sleeping = 0;
+    context->m_Run = 1;
+
+    context->m_WorkerArgs.SetCapacity(thread_count);
+    context->m_WorkerArgs.SetSize(thread_count);
     context->m_Threads.SetCapacity(thread_count);
     context->m_Threads.SetSize(thread_count);
 
-    for (int i = 0; i < thread_count; ++i)
+    for (uint32_t i = 0; i < thread_count; ++i)
     {
+        const char* name = create_params.m_ThreadNames[i] ? create_params.m_ThreadNames[i] : create_params.m_ThreadNames[0];
         char name_buf[128];
-        dmSnPrintf(name_buf, sizeof(name_buf), "%s_%d", create_params.m_ThreadNames[i], i);
-        context->m_Threads[i] = dmThread::New(JobThread, 0x80000, (void*)&context->m_ThreadContext, name_buf);
+        dmSnPrintf(name_buf, sizeof(name_buf), "%s_%d", name ? name : "JobThread", i);
+
+        context->m_WorkerArgs[i].m_Context = context;
+        context->m_WorkerArgs[i].m_QueueIndex = i + 1;
+        context->m_Threads[i] = dmThread::New(JobThread, 0x80000, (void*)&context->m_WorkerArgs[i], name_buf);
     }
 #endif
     return context;
@@ -156,79 +442,190 @@ void Destroy(HContext context)
 
 #if defined(DM_HAS_THREADS)
     {
-        DM_MUTEX_SCOPED_LOCK(context->m_ThreadContext.m_Mutex);
+        DM_MUTEX_SCOPED_LOCK(context->m_Mutex);
 
-        context->m_ThreadContext.m_Run = false;;
+        dmAtomicStore32(&context->m_Run, 0);
 
-        dmConditionVariable::Broadcast(context->m_ThreadContext.m_WakeupCond);
+        dmConditionVariable::Broadcast(context->m_WakeupCond);
     }
 
-    for (int i = 0; i < context->m_Threads.Size(); ++i)
+    for (uint32_t i = 0; i < context->m_Threads.Size(); ++i)
     {
         dmThread::Join(context->m_Threads[i]);
     }
-    dmConditionVariable::Delete(context->m_ThreadContext.m_WakeupCond);
-    dmMutex::Delete(context->m_ThreadContext.m_Mutex);
+    dmConditionVariable::Delete(context->m_WakeupCond);
+    dmMutex::Delete(context->m_Mutex);
+    dmThread::FreeTls(context->m_WorkerTls);
 #endif // DM_HAS_THREADS
 
+    for (uint32_t i = 0; i < context->m_Queues.Size(); ++i)
+    {
+        JobQueue* queue = context->m_Queues[i];
+        for (uint32_t p = 0; p < MAX_JOB_PRIORITY; ++p)
+            delete[] queue->m_Lanes[p].m_Items;
+        dmSpinlock::Destroy(&queue->m_Lock);
+        delete queue;
+    }
+
+    dmSpinlock::Destroy(&context->m_FreeLock);
+    dmSpinlock::Destroy(&context->m_DoneLock);
+    delete[] context->m_Jobs;
     delete context;
 }
 
+HJob CreateJob(HContext context, FProcess process, void* user_context, void* data, HJob parent, JobPriority priority)
+{
+    HJob hjob = AllocJob(context, parent);
+    if (hjob == INVALID_JOB)
+        return INVALID_JOB;
+
+    Job* job = GetJob(context, hjob);
+    job->m_Process = process;
+    job->m_Context = user_context;
+    job->m_Data     = data;
+    job->m_Priority = (uint8_t)priority;
+    return hjob;
+}
+
+void RunJob(HContext context, HJob job)
+{
+    PushQueue(context, GetQueueIndex(context), GetJob(context, job)->m_Priority, (uint16_t)(job & JOB_INDEX_MASK));
+}
+
+bool IsJobFinished(HContext context, HJob job)
+{
+    if (job == INVALID_JOB)
+        return true;
+    uint32_t generation = (uint32_t)dmAtomicGet32(&GetJob(context, job)->m_Generation);
+    return generation != (job >> JOB_GENERATION_SHIFT);
+}
+
+void WaitJob(HContext context, HJob job)
+{
+    DM_PROFILE("WaitJob");
+
+    uint32_t queue_index = GetQueueIndex(context);
+    // The low priority lane is meant for long running background work, which we don't want to
+    // block a waiting thread with. It's only processed here if there are no workers to do it.
+    uint32_t max_priority = context->m_Threads.Empty() ? MAX_JOB_PRIORITY - 1 : JOB_PRIORITY_NORMAL;
+    uint32_t spin_count = 0;
+    while (!IsJobFinished(context, job))
+    {
+        uint16_t index;
+        if (PopJob(context, queue_index, max_priority, false, &index))
+        {
+            ExecuteJob(context, index);
+            spin_count = 0;
+        }
+        else if (++spin_count > WAIT_JOB_SPIN_COUNT)
+        {
+            // The remaining jobs are running on other threads, so let them have the core
+            dmTime::Sleep(0);
+        }
+    }
+}
+
 void PushJob(HContext context, FProcess process, FCallback callback, void* user_context, void* data)
 {
-    JobItem item;
-    item.m_Context = user_context;
-    item.m_Data = data;
-    item.m_Process = process;
-    item.m_Callback = callback;
-    item.m_Result = 0;
+    HJob hjob = AllocJob(context, INVALID_JOB);
+    if (hjob == INVALID_JOB)
+    {
+        // The pool is exhausted, so we do the work on this thread instead
+        JobItem item;
+        item.m_Context  = user_context;
+        item.m_Data     = data;
+        item.m_Callback = callback;
+        item.m_Result   = process(user_context, data);
+        PutDone(context, item);
+        return;
+    }
 
-    PutWork(&context->m_ThreadContext, &item);
-#if defined(DM_HAS_THREADS)
-    dmConditionVariable::Signal(context->m_ThreadContext.m_WakeupCond);
-#endif
+    Job* job = GetJob(context, hjob);
+    job->m_Process  = process;
+    job->m_Callback = callback;
+    job->m_Priority = JOB_PRIORITY_LOW;
+    job->m_Context  = user_context;
+    job->m_Data     = data;
+    PushQueue(context, GetQueueIndex(context), job->m_Priority, (uint16_t)(hjob & JOB_INDEX_MASK));
+}
+
+void ParallelFor(HContext context, FRangeProcess process, void* user_context, void* data, uint32_t count, uint32_t grain)
+{
+    if (count == 0)
+        return;
+    if (grain == 0)
+        grain = 1;
+
+    if (!context || context->m_Threads.Empty() || count <= grain)
+    {
+        process(user_context, data, 0, count);
+        return;
+    }
+
+    DM_PROFILE("ParallelFor");
+
+    HJob root = AllocJob(context, INVALID_JOB);
+    if (root == INVALID_JOB)
+    {
+        process(user_context, data, 0, count);
+        return;
+    }
+
+    uint32_t queue_index = GetQueueIndex(context);
+    for (uint32_t start = 0; start < count; start += grain)
+    {
+        uint32_t end = dmMath::Min(start + grain, count);
+        HJob hjob = AllocJob(context, root);
+        if (hjob == INVALID_JOB)
+        {
+            process(user_context, data, start, end);
+            continue;
+        }
+
+        Job* job = GetJob(context, hjob);
+        job->m_RangeProcess = process;
+        job->m_Context      = user_context;
+        job->m_Data         = data;
+        job->m_RangeStart   = start;
+        job->m_RangeEnd     = end;
+        job->m_Priority     = JOB_PRIORITY_HIGH;
+        PushQueue(context, queue_index, job->m_Priority, (uint16_t)(hjob & JOB_INDEX_MASK));
+    }
+
+    // The root has no work of its own
+    FinishJob(context, root & JOB_INDEX_MASK);
+    WaitJob(context, root);
 }
 
 uint32_t GetWorkerCount(HContext context)
 {
-#if defined(DM_HAS_THREADS)
     return context->m_Threads.Size();
-#else
-    return 0;
-#endif
 }
 
 void Update(HContext context)
 {
     DM_PROFILE("Update");
 
-#if !defined(DM_HAS_THREADS)
-    UpdateSingleThread(&context->m_ThreadContext);
-#endif
-
-    // Lock for as little as possible, by copying the items to an array owned by this thread
-    uint32_t size;
-    dmArray<JobItem> items;
+    if (context->m_Threads.Empty())
+        UpdateSingleThread(context);
 
+    // Lock for as little as possible, by letting the jobs finish into the other array
+    uint32_t done_index;
     {
-#if defined(DM_HAS_THREADS)
-        DM_MUTEX_SCOPED_LOCK(context->m_ThreadContext.m_Mutex);
-#endif
-        size = context->m_ThreadContext.m_Done.Size();
-        items.SetCapacity(size);
-
-        for(uint32_t i = 0; i < size; ++i)
-            items.Push(context->m_ThreadContext.m_Done[i]);
-        context->m_ThreadContext.m_Done.Clear();
+        DM_SPINLOCK_SCOPED_LOCK(context->m_DoneLock);
+        done_index = context->m_DoneIndex;
+        context->m_DoneIndex = 1 - done_index;
     }
+    dmArray<JobItem>& items = context->m_Done[done_index];
 
     // Now do the callbacks
-    for(uint32_t i = 0; i < size; ++i)
+    for(uint32_t i = 0; i < items.Size(); ++i)
     {
         JobItem& item = items[i];
         if (item.m_Callback)
             item.m_Callback(item.m_Context, item.m_Data, item.m_Result);
     }
+    items.SetSize(0);
 }
 
 } // namespace dmJobThread
@@ -22,13 +22,36 @@ namespace dmJobThread
     typedef struct JobContext* HContext;
     typedef int (*FProcess)(void* context, void* data);
     typedef void (*FCallback)(void* context, void* data, int result);
+    // Processes the half open range [start, end)
+    typedef void (*FRangeProcess)(void* context, void* data, uint32_t start, uint32_t end);
 
-    static const uint8_t DM_MAX_JOB_THREAD_COUNT = 8;
+    /*
+     * Handle to a scheduled job. The handle is versioned, so a handle to a job
+     * that has finished (and whose slot was reused) is reported as finished.
+     */
+    typedef uint32_t HJob;
+    static const HJob INVALID_JOB = 0;
+
+    static const uint8_t  DM_MAX_JOB_THREAD_COUNT = 16;
+    static const uint32_t DM_DEFAULT_MAX_JOB_COUNT = 4096;
+    static const uint32_t DM_MAX_JOB_COUNT = 0xFFFF;
+
+    enum JobPriority
+    {
+        JOB_PRIORITY_HIGH   = 0,
+        JOB_PRIORITY_NORMAL = 1,
+        JOB_PRIORITY_LOW    = 2,
+        MAX_JOB_PRIORITY    = 3,
+    };
 
     struct JobThreadCreationParams
     {
+        JobThreadCreationParams();
+
         const char* m_ThreadNames[DM_MAX_JOB_THREAD_COUNT];
         uint8_t     m_ThreadCount;
+        // Max number of jobs that can be in flight at the same time. 0 means DM_DEFAULT_MAX_JOB_COUNT.
+        uint32_t    m_MaxJobCount;
     };
 
     HContext Create(const JobThreadCreationParams& create_params);
@@ -37,6 +60,31 @@ namespace dmJobThread
     void     PushJob(HContext context, FProcess process, FCallback callback, void* user_context, void* data);
     uint32_t GetWorkerCount(HContext context);
     bool     PlatformHasThreadSupport();
+
+    /*
+     * Creates a job, but doesn't schedule it. Call RunJob() to schedule it.
+     * If a parent is given, the parent isn't considered finished until all its children have finished.
+     * Children must be created before the parent has finished (e.g. before RunJob(parent), or from within the parent's process function).
+     * The process function is called on a worker thread (or on a thread calling WaitJob()).
+     * Returns INVALID_JOB if the job pool is exhausted.
+     */
+    HJob     CreateJob(HContext context, FProcess process, void* user_context, void* data, HJob parent, JobPriority priority);
+
+    // Schedules a job created with CreateJob()
+    void     RunJob(HContext context, HJob job);
+
+    // Returns true if the job and all its children have finished
+    bool     IsJobFinished(HContext context, HJob job);
+
+    // Waits for the job and its children to finish. The calling thread helps out by processing pending jobs while waiting.
+    void     WaitJob(HContext context, HJob job);
+
+    /*
+     * Splits [0, count) into ranges of at most grain items, processes them on all workers (and the calling thread),
+     * and returns when all ranges are processed. Each range is processed by exactly one thread.
+     * Falls back to processing the range on the calling thread if there are no workers.
+     */
+    void     ParallelFor(HContext context, FRangeProcess process, void* user_context, void* data, uint32_t count, uint32_t grain);
 }
 
 #endif // DM_JOB_THREAD_H
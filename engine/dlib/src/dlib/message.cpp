@@ -13,11 +13,11 @@
 // specific language governing permissions and limitations under the License.
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include "message.h"
 #include "atomic.h"
 #include "hash.h"
-#include "hashtable.h"
 #include "array.h"
 #include "condition_variable.h"
 #include "dstrings.h"
@@ -34,24 +34,23 @@ namespace dmMessage
     // Alignment of allocations
     const uint32_t DM_MESSAGE_ALIGNMENT = 16U;
 
+    // Posting is lock-free: Post() allocates the message from the current page of the socket by atomically bumping
+    // the page offset, and pushes it onto the message list with a compare-and-swap. The socket mutex is only taken
+    // when the current page is full and a new page is needed, and by Dispatch() when it takes the list and reclaims pages.
+
     struct MemoryPage
     {
-        uint8_t     m_Memory[DM_MESSAGE_PAGE_SIZE];
-        uint32_t    m_Current;
-        MemoryPage* m_NextPage;
+        uint8_t        m_Memory[DM_MESSAGE_PAGE_SIZE];
+        int32_atomic_t m_Current;   // Bumped past DM_MESSAGE_PAGE_SIZE when the page is full
+        MemoryPage*    m_NextPage;
     };
 
     struct MemoryAllocator
     {
-        MemoryAllocator()
-        {
-            m_CurrentPage = 0;
-            m_FreePages = 0;
-            m_FullPages = 0;
-        }
-        MemoryPage* m_CurrentPage;
-        MemoryPage* m_FreePages;
-        MemoryPage* m_FullPages;
+        MemoryPage* volatile m_CurrentPage;
+        MemoryPage*          m_FreePages;
+        MemoryPage*          m_FullPages;
+        MemoryPage*          m_PendingPages;    // Dispatched, but a Post() may still be writing to them
     };
 
     struct GlobalInit
@@ -63,88 +62,39 @@ namespace dmMessage
 
     } g_MessageInit;
 
-    static Result GetSocketNoLock(dmhash_t name_hash, HSocket* out_socket);
-
-    static void AllocateNewPage(MemoryAllocator* allocator)
-    {
-        if (allocator->m_CurrentPage)
-        {
-            // Link current page to full pages
-            allocator->m_CurrentPage->m_NextPage = allocator->m_FullPages;
-            allocator->m_FullPages = allocator->m_CurrentPage;
-        }
-
-        MemoryPage* new_page = 0;
-
-        if (allocator->m_FreePages)
-        {
-            // Free page to use
-            new_page = allocator->m_FreePages;
-            allocator->m_FreePages = new_page->m_NextPage;
-        }
-        else
-        {
-            // Allocate new page
-            new_page = new MemoryPage;
-        }
-
-        new_page->m_Current = 0;
-        new_page->m_NextPage = 0;
-
-        allocator->m_CurrentPage = new_page;
-    }
-
-    static void* AllocateMessage(MemoryAllocator* allocator, uint32_t size)
-    {
-        // At least ALIGNMENT bytes alignment of size in order to ensure that the next allocation is aligned
-        size += DM_MESSAGE_ALIGNMENT-1;
-        size &= ~(DM_MESSAGE_ALIGNMENT-1);
-        assert(size <= DM_MESSAGE_PAGE_SIZE);
-
-        if (allocator->m_CurrentPage == 0 || (DM_MESSAGE_PAGE_SIZE-allocator->m_CurrentPage->m_Current) < size)
-        {
-            // No current page or allocation didn't fit.
-            AllocateNewPage(allocator);
-        }
-
-        MemoryPage* page = allocator->m_CurrentPage;
-        void* ret = (void*) ((uintptr_t) &page->m_Memory[0] + page->m_Current);
-        page->m_Current += size;
-        return ret;
-    }
+    // Set in the reference count while the socket exists, i.e. until DeleteSocket()
+    const int32_t SOCKET_ALIVE = 0x40000000;
 
     struct MessageSocket
     {
-        uint32_t        m_RefCount; // Is protected by "g_MessageSpinlock"
-        dmhash_t        m_NameHash;
-        Message*        m_Header;
-        Message*        m_Tail;
-        const char*     m_Name;
-        dmMutex::HMutex m_Mutex;
+        int32_atomic_t    m_RefCount;       // SOCKET_ALIVE, plus one per AcquireSocket()
+        int32_atomic_t    m_InUse;          // Slot is taken, until the socket is disposed
+        int32_atomic_t    m_Used;           // Slot is on the probe sequence of a socket. Lookups probe past it
+        int32_atomic_t    m_NameKey;        // Upper bits of m_NameHash, for the lookup
+        int32_atomic_t    m_Waiting;        // Number of threads in DispatchBlocking() waiting for messages
+        dmhash_t          m_NameHash;       // Stable while a reference is held
+        const char*       m_Name;
+        Message* volatile m_Head;           // Posted messages, latest first
+        dmMutex::HMutex   m_Mutex;          // Protects the page lists, except m_CurrentPage
         dmConditionVariable::HConditionVariable m_Condition;
-        MemoryAllocator m_Allocator;
+        MemoryAllocator   m_Allocator;
     };
 
-    const uint32_t MAX_SOCKETS = 256;
+    const uint32_t MAX_SOCKETS = 256; // Must be a power of two
 
+    // Open addressing table of the sockets, indexed by the name hash
+    // Static, so that it is zero initialized and can be read without locks
     struct MessageContext
     {
-        dmHashTable64<MessageSocket> m_Sockets;
+        MessageSocket m_Sockets[MAX_SOCKETS];
     };
 
-    MessageContext* g_MessageContext = 0;
+    static MessageContext g_MessageContext;
+    // Serializes NewSocket()
     dmSpinlock::Spinlock g_MessageSpinlock;
 
-    static MessageContext* Create(uint32_t max_sockets)
-    {
-        MessageContext* ctx = new MessageContext;
-        ctx->m_Sockets.SetCapacity(max_sockets, max_sockets);
-
-        return ctx;
-    }
-
     // Until the Create/Destroy functions are exposed:
-    // The context is created on demand, and we also need to destroy it automatically
+    // Stops the sockets from being used after the static destructors have run
     struct ContextDestroyer
     {
         ContextDestroyer()
@@ -156,69 +106,139 @@ namespace dmMessage
         ~ContextDestroyer()
         {
             dmAtomicStore32(&m_Deleted, 1);
-            {
-                DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-                if (g_MessageContext)
-                {
-                    delete g_MessageContext;
-                    g_MessageContext = 0;
-                }
-            }
             dmSpinlock::Destroy(&g_MessageSpinlock);
         }
         int32_atomic_t m_Deleted;
     } g_ContextDestroyer;
 
-    Result NewSocket(const char* name, HSocket* socket)
+    static inline int32_t GetNameKey(dmhash_t name_hash)
+    {
+        return (int32_t)(name_hash >> 32);
+    }
+
+    static inline uint32_t GetSlot(dmhash_t name_hash, uint32_t probe)
+    {
+        return ((uint32_t)name_hash + probe) & (MAX_SOCKETS - 1);
+    }
+
+    // Clears m_Used of the released slots that no longer are on the probe sequence of a socket,
+    // so that lookups of unknown names can stop there.
+    // Assumes g_MessageSpinlock is held, so that no socket is added meanwhile
+    static void ClearUnusedSlots()
     {
-        if (dmAtomicGet32(&g_ContextDestroyer.m_Deleted))
+        bool on_probe_sequence[MAX_SOCKETS] = {};
+        for (uint32_t i = 0; i < MAX_SOCKETS; ++i)
         {
-            return RESULT_SOCKET_OUT_OF_RESOURCES;
+            MessageSocket* s = &g_MessageContext.m_Sockets[i];
+            if (!dmAtomicLoad32(&s->m_InUse))
+            {
+                continue;
+            }
+            // The name hash is only changed by NewSocket()
+            uint32_t probe_count = (i - (uint32_t)s->m_NameHash) & (MAX_SOCKETS - 1);
+            for (uint32_t probe = 0; probe <= probe_count; ++probe)
+            {
+                on_probe_sequence[GetSlot(s->m_NameHash, probe)] = true;
+            }
         }
 
-        if (name == 0x0 || *name == 0 || strchr(name, '#') != 0x0 || strchr(name, ':') != 0x0)
+        for (uint32_t i = 0; i < MAX_SOCKETS; ++i)
         {
-            return RESULT_INVALID_SOCKET_NAME;
+            MessageSocket* s = &g_MessageContext.m_Sockets[i];
+            if (!on_probe_sequence[i] && !dmAtomicLoad32(&s->m_InUse) && dmAtomicLoad32(&s->m_Used))
+            {
+                dmAtomicStore32(&s->m_Used, 0);
+            }
         }
+    }
 
-        dmhash_t name_hash = dmHashString64(name);
+    // Assumes the socket mutex is held
+    static void AllocateNewPage(MemoryAllocator* allocator, MemoryPage* current_page)
+    {
+        if (current_page)
+        {
+            // Link current page to full pages
+            current_page->m_NextPage = allocator->m_FullPages;
+            allocator->m_FullPages = current_page;
+        }
 
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
+        MemoryPage* new_page = 0;
 
-        if (g_MessageContext == 0)
+        if (allocator->m_FreePages)
         {
-            g_MessageContext = Create(MAX_SOCKETS);
+            // Free page to use
+            new_page = allocator->m_FreePages;
+            allocator->m_FreePages = new_page->m_NextPage;
         }
-
-        if (g_MessageContext->m_Sockets.Full())
+        else
         {
-            return RESULT_SOCKET_OUT_OF_RESOURCES;
+            // Allocate new page
+            new_page = new MemoryPage;
         }
 
-        HSocket tmp;
-        if (GetSocketNoLock(name_hash, &tmp) == RESULT_OK)
+        dmAtomicStore32(&new_page->m_Current, 0);
+        new_page->m_NextPage = 0;
+
+        dmAtomicStorePtr(&allocator->m_CurrentPage, new_page);
+    }
+
+    // Assumes the caller holds a reference to the socket, so that the page isn't reclaimed before the message is posted
+    static void* AllocateMessage(MessageSocket* s, uint32_t size)
+    {
+        // At least ALIGNMENT bytes alignment of size in order to ensure that the next allocation is aligned
+        size += DM_MESSAGE_ALIGNMENT-1;
+        size &= ~(DM_MESSAGE_ALIGNMENT-1);
+        assert(size <= DM_MESSAGE_PAGE_SIZE);
+
+        MemoryAllocator* allocator = &s->m_Allocator;
+        while (true)
         {
-            return RESULT_SOCKET_EXISTS;
-        }
+            MemoryPage* page = dmAtomicGetPtr(&allocator->m_CurrentPage);
+            if (page)
+            {
+                uint32_t offset = (uint32_t)dmAtomicAdd32(&page->m_Current, (int32_t)size);
+                if (offset + size <= DM_MESSAGE_PAGE_SIZE)
+                {
+                    return (void*) ((uintptr_t) &page->m_Memory[0] + offset);
+                }
+            }
 
-        MessageSocket s;
-        s.m_RefCount = 1;
-        s.m_Header = 0;
-        s.m_Tail = 0;
-        s.m_NameHash = name_hash;
-        s.m_Name = strdup(name);
-        s.m_Mutex = dmMutex::New();
-        s.m_Condition = dmConditionVariable::New();
+            // No current page or allocation didn't fit.
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+            if (dmAtomicGetPtr(&allocator->m_CurrentPage) == page)
+            {
+                AllocateNewPage(allocator, page);
+            }
+        }
+    }
 
-        g_MessageContext->m_Sockets.Put(name_hash, s);
-        *socket = name_hash;
+    static void FreePages(MemoryPage* p)
+    {
+        while (p)
+        {
+            MemoryPage* next = p->m_NextPage;
+            delete p;
+            p = next;
+        }
+    }
 
-        return RESULT_OK;
+    // Reverses the list of messages, which are pushed latest first
+    static Message* ReverseMessages(Message* message_object)
+    {
+        Message* reversed = 0;
+        while (message_object)
+        {
+            Message* next = message_object->m_Next;
+            message_object->m_Next = reversed;
+            reversed = message_object;
+            message_object = next;
+        }
+        return reversed;
     }
 
     static void DisposeSocket(MessageSocket* s)
     {
-        Message *message_object = s->m_Header;
+        Message *message_object = ReverseMessages(dmAtomicStorePtr(&s->m_Head, (Message*)0));
         while (message_object)
         {
             if (message_object->m_DestroyCallback)
@@ -230,20 +250,9 @@ namespace dmMessage
 
         free((void*) s->m_Name);
 
-        MemoryPage* p = s->m_Allocator.m_FreePages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        p = s->m_Allocator.m_FullPages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
+        FreePages(s->m_Allocator.m_FreePages);
+        FreePages(s->m_Allocator.m_FullPages);
+        FreePages(s->m_Allocator.m_PendingPages);
         if (s->m_Allocator.m_CurrentPage)
         {
             delete s->m_Allocator.m_CurrentPage;
@@ -253,79 +262,160 @@ namespace dmMessage
 
         dmMutex::Delete(s->m_Mutex);
 
-        memset(s, 0, sizeof(*s));
+        s->m_Name = 0;
+        s->m_Mutex = 0;
+        s->m_Condition = 0;
+        memset(&s->m_Allocator, 0, sizeof(s->m_Allocator));
+
+        // The slot may now be reused by NewSocket()
+        dmAtomicStore32(&s->m_InUse, 0);
     }
 
     static void ReleaseSocket(MessageSocket* s)
     {
+        if (dmAtomicDecrement32(&s->m_RefCount) == 1)
         {
-            DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-            --s->m_RefCount;
+            DisposeSocket(s);
+        }
+    }
 
-            if (s->m_RefCount > 0)
+    // Adds a reference, unless the socket has been deleted
+    static bool TryRetainSocket(MessageSocket* s)
+    {
+        int32_t ref_count = dmAtomicLoad32(&s->m_RefCount);
+        while (ref_count & SOCKET_ALIVE)
+        {
+            int32_t prev = dmAtomicCompareStore32(&s->m_RefCount, ref_count + 1, ref_count);
+            if (prev == ref_count)
             {
-                return;
+                return true;
             }
+            ref_count = prev;
         }
-        DisposeSocket(s);
+        return false;
     }
 
     static MessageSocket* AcquireSocket(HSocket socket)
     {
-        if (dmAtomicGet32(&g_ContextDestroyer.m_Deleted))
+        if (dmAtomicLoad32(&g_ContextDestroyer.m_Deleted))
         {
             return 0; // The system has already been shut down
         }
 
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
+        int32_t name_key = GetNameKey(socket);
+        for (uint32_t i = 0; i < MAX_SOCKETS; ++i)
+        {
+            MessageSocket* s = &g_MessageContext.m_Sockets[GetSlot(socket, i)];
+            if (!dmAtomicLoad32(&s->m_Used))
+            {
+                return 0x0;
+            }
 
-        MessageSocket* s = g_MessageContext->m_Sockets.Get(socket);
+            if (dmAtomicLoad32(&s->m_NameKey) != name_key || !TryRetainSocket(s))
+            {
+                continue;
+            }
 
-        if (s == 0x0)
+            // The slot can't be reused while we hold the reference
+            if (s->m_NameHash == socket)
+            {
+                return s;
+            }
+            ReleaseSocket(s);
+        }
+        return 0x0;
+    }
+
+    Result NewSocket(const char* name, HSocket* socket)
+    {
+        if (dmAtomicLoad32(&g_ContextDestroyer.m_Deleted))
         {
-            return 0x0;
+            return RESULT_SOCKET_OUT_OF_RESOURCES;
         }
 
-        assert(s->m_RefCount >= 1);
+        if (name == 0x0 || *name == 0 || strchr(name, '#') != 0x0 || strchr(name, ':') != 0x0)
+        {
+            return RESULT_INVALID_SOCKET_NAME;
+        }
 
-        ++s->m_RefCount;
+        dmhash_t name_hash = dmHashString64(name);
 
-        return s;
-    }
+        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
+
+        ClearUnusedSlots();
 
-    Result DeleteSocket(HSocket socket)
-    {
         MessageSocket* s = 0x0;
+        for (uint32_t i = 0; i < MAX_SOCKETS; ++i)
         {
-            DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-            s = g_MessageContext->m_Sockets.Get(socket);
-            if (s == 0x0)
+            MessageSocket* slot = &g_MessageContext.m_Sockets[GetSlot(name_hash, i)];
+            if (!dmAtomicLoad32(&slot->m_InUse))
             {
-                return RESULT_SOCKET_NOT_FOUND;
+                s = slot;
+                break;
             }
+        }
 
-            g_MessageContext->m_Sockets.Erase(s->m_NameHash);
-            --s->m_RefCount;
+        if (s == 0x0)
+        {
+            return RESULT_SOCKET_OUT_OF_RESOURCES;
+        }
 
-            if(s->m_RefCount > 0)
-            {
-                // Defer deletion
-                return RESULT_OK;
-            }
+        MessageSocket* existing = AcquireSocket(name_hash);
+        if (existing)
+        {
+            ReleaseSocket(existing);
+            return RESULT_SOCKET_EXISTS;
         }
-        DisposeSocket(s);
+
+        s->m_NameHash = name_hash;
+        s->m_Name = strdup(name);
+        s->m_Head = 0;
+        s->m_Mutex = dmMutex::New();
+        s->m_Condition = dmConditionVariable::New();
+        memset(&s->m_Allocator, 0, sizeof(s->m_Allocator));
+        dmAtomicStore32(&s->m_Waiting, 0);
+        dmAtomicStore32(&s->m_NameKey, GetNameKey(name_hash));
+        dmAtomicStore32(&s->m_InUse, 1);
+        dmAtomicStore32(&s->m_Used, 1);
+        // Publish the socket to the lookups
+        dmAtomicStore32(&s->m_RefCount, SOCKET_ALIVE);
+
+        *socket = name_hash;
+
         return RESULT_OK;
     }
 
-    static Result GetSocketNoLock(dmhash_t name_hash, HSocket* out_socket)
+    Result DeleteSocket(HSocket socket)
     {
-        *out_socket = name_hash; // to silence an existing test
+        MessageSocket* s = AcquireSocket(socket);
+        if (s == 0x0)
+        {
+            return RESULT_SOCKET_NOT_FOUND;
+        }
 
-        MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(name_hash);
-        if (!message_socket)
+        // Remove the socket from the lookups
+        int32_t ref_count = dmAtomicLoad32(&s->m_RefCount);
+        while (true)
         {
-            return RESULT_NAME_OK_SOCKET_NOT_FOUND;
+            if (!(ref_count & SOCKET_ALIVE))
+            {
+                // Deleted by another thread
+                ReleaseSocket(s);
+                return RESULT_SOCKET_NOT_FOUND;
+            }
+            int32_t prev = dmAtomicCompareStore32(&s->m_RefCount, ref_count & ~SOCKET_ALIVE, ref_count);
+            if (prev == ref_count)
+            {
+                break;
+            }
+            ref_count = prev;
         }
+
+        // Deletion is deferred if other references are held
+        ReleaseSocket(s);
+
+        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
+        ClearUnusedSlots();
         return RESULT_OK;
     }
 
@@ -339,20 +429,25 @@ namespace dmMessage
         }
 
         dmhash_t name_hash = dmHashString64(name);
+        *out_socket = name_hash; // to silence an existing test
 
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-
-        return GetSocketNoLock(name_hash, out_socket);
+        MessageSocket* message_socket = AcquireSocket(name_hash);
+        if (!message_socket)
+        {
+            return RESULT_NAME_OK_SOCKET_NOT_FOUND;
+        }
+        ReleaseSocket(message_socket);
+        return RESULT_OK;
     }
 
     const char* GetSocketName(HSocket socket)
     {
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-
-        MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(socket);
+        MessageSocket* message_socket = AcquireSocket(socket);
         if (message_socket != 0x0)
         {
-            return message_socket->m_Name;
+            const char* name = message_socket->m_Name;
+            ReleaseSocket(message_socket);
+            return name;
         }
         else
         {
@@ -362,12 +457,12 @@ namespace dmMessage
 
     dmhash_t GetSocketNameHash(HSocket socket)
     {
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-
-        MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(socket);
+        MessageSocket* message_socket = AcquireSocket(socket);
         if (message_socket != 0x0)
         {
-            return message_socket->m_NameHash;
+            dmhash_t name_hash = message_socket->m_NameHash;
+            ReleaseSocket(message_socket);
+            return name_hash;
         }
         else
         {
@@ -379,9 +474,12 @@ namespace dmMessage
     {
         if (socket != 0)
         {
-            DM_SPINLOCK_SCOPED_LOCK(g_MessageSpinlock);
-            MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(socket);
-            return message_socket != 0;
+            MessageSocket* message_socket = AcquireSocket(socket);
+            if (message_socket != 0x0)
+            {
+                ReleaseSocket(message_socket);
+                return true;
+            }
         }
         return false;
     }
@@ -394,11 +492,7 @@ namespace dmMessage
         MessageSocket* s = AcquireSocket(socket);
         if (s != 0)
         {
-            bool has_messages;
-            {
-                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
-                has_messages = s->m_Header != 0;
-            }
+            bool has_messages = dmAtomicGetPtr(&s->m_Head) != 0;
             ReleaseSocket(s);
             return has_messages;
         }
@@ -462,11 +556,8 @@ namespace dmMessage
             return RESULT_SOCKET_NOT_FOUND;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
         uint32_t data_size = sizeof(Message) + message_data_size;
-        Message *new_message = (Message *) AllocateMessage(allocator, data_size);
+        Message *new_message = (Message *) AllocateMessage(s, data_size);
         if (sender != 0x0)
         {
             new_message->m_Sender = *sender;
@@ -481,28 +572,27 @@ namespace dmMessage
         new_message->m_UserData2 = user_data2;
         new_message->m_Descriptor = descriptor;
         new_message->m_DataSize = message_data_size;
-        new_message->m_Next = 0;
         new_message->m_DestroyCallback = destroy_callback;
         memcpy(&new_message->m_Data[0], message_data, message_data_size);
 
-        bool is_first_message = !s->m_Header;
-
-        if (!s->m_Header)
+        Message* head = dmAtomicGetPtr(&s->m_Head);
+        while (true)
         {
-            s->m_Header = new_message;
-            s->m_Tail = new_message;
-        }
-        else
-        {
-            s->m_Tail->m_Next = new_message;
-            s->m_Tail = new_message;
+            new_message->m_Next = head;
+            Message* prev = dmAtomicCompareStorePtr(&s->m_Head, new_message, head);
+            if (prev == head)
+            {
+                break;
+            }
+            head = prev;
         }
 
-        if (is_first_message)
+        bool is_first_message = head == 0;
+        if (is_first_message && dmAtomicLoad32(&s->m_Waiting) > 0)
         {
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
             dmConditionVariable::Signal(s->m_Condition);
         }
-        dmMutex::Unlock(s->m_Mutex);
 
         ReleaseSocket(s);
 
@@ -550,56 +640,76 @@ namespace dmMessage
             return 0;
         }
 
-        dmMutex::Lock(s->m_Mutex);
+        if (!dmAtomicGetPtr(&s->m_Head) && !blocking)
+        {
+            ReleaseSocket(s);
+            return 0;
+        }
 
         MemoryAllocator* allocator = &s->m_Allocator;
 
-        if (!s->m_Header)
+        dmMutex::Lock(s->m_Mutex);
+
+        if (!dmAtomicGetPtr(&s->m_Head))
         {
-            if (blocking) {
+            // Posting threads only signal when someone is waiting
+            dmAtomicIncrement32(&s->m_Waiting);
+            if (!dmAtomicGetPtr(&s->m_Head))
+            {
                 dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
-            } else {
-                dmMutex::Unlock(s->m_Mutex);
-                ReleaseSocket(s);
-                return 0;
             }
+            dmAtomicDecrement32(&s->m_Waiting);
         }
 
-
         char buffer[128];
         const char* profiler_string = GetProfilerString(s->m_Name, buffer, sizeof(buffer));
         DM_PROFILE_DYN(profiler_string, 0);
 
         uint32_t dispatch_count = 0;
 
-        Message *message_object = s->m_Header;
-        s->m_Header = 0;
-        s->m_Tail = 0;
-
-        // Unlink full pages
+        // Unlink full pages, and the pages left from the previous dispatch
         MemoryPage* full_pages = allocator->m_FullPages;
         allocator->m_FullPages = 0;
+        if (allocator->m_PendingPages)
+        {
+            MemoryPage* last = allocator->m_PendingPages;
+            while (last->m_NextPage)
+                last = last->m_NextPage;
+            last->m_NextPage = full_pages;
+            full_pages = allocator->m_PendingPages;
+            allocator->m_PendingPages = 0;
+        }
+
+        // A full page can only be reused once all messages in it are dispatched. If a Post() is in flight, its
+        // message might be in one of the pages without being linked yet, so the pages are kept until the next dispatch.
+        // Posting holds a reference to the socket, so if ours is the only one, there is no Post() in flight.
+        bool reclaim_pages = dmAtomicLoad32(&s->m_RefCount) == (SOCKET_ALIVE | 1);
+
+        Message *message_object = ReverseMessages(dmAtomicStorePtr(&s->m_Head, (Message*)0));
 
         dmMutex::Unlock(s->m_Mutex);
 
         while (message_object)
         {
+            // The callback may post messages to this socket, which only touches the list head
+            Message* next = message_object->m_Next;
             dispatch_callback(message_object, user_ptr);
             if (message_object->m_DestroyCallback) {
                 message_object->m_DestroyCallback(message_object);
             }
-            message_object = message_object->m_Next;
+            message_object = next;
             dispatch_count++;
         }
 
         // Reclaim all full pages active when dispatch started
         dmMutex::Lock(s->m_Mutex);
+        MemoryPage** reclaimed_pages = reclaim_pages ? &allocator->m_FreePages : &allocator->m_PendingPages;
         MemoryPage* p = full_pages;
         while (p)
         {
             MemoryPage* next = p->m_NextPage;
-            p->m_NextPage = allocator->m_FreePages;
-            allocator->m_FreePages = p;
+            p->m_NextPage = *reclaimed_pages;
+            *reclaimed_pages = p;
             p = next;
         }
         dmMutex::Unlock(s->m_Mutex);
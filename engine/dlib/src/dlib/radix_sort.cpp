@@ -0,0 +1,100 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+#include "radix_sort.h"
+
+namespace dmRadixSort
+{
+    static const uint32_t RADIX_BITS = 8;
+    static const uint32_t RADIX_SIZE = 1 << RADIX_BITS;
+    static const uint32_t RADIX_MASK = RADIX_SIZE - 1;
+
+    template <typename KeyType>
+    static void Sort(KeyType* keys, uint32_t* values, KeyType* key_scratch, uint32_t* value_scratch, uint32_t count)
+    {
+        const uint32_t pass_count = sizeof(KeyType);
+
+        if (count < 2)
+            return;
+
+        // Build the histograms for all passes in one go
+        uint32_t histograms[pass_count][RADIX_SIZE];
+        memset(histograms, 0, sizeof(histograms));
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            KeyType key = keys[i];
+            for (uint32_t p = 0; p < pass_count; ++p)
+            {
+                histograms[p][(key >> (p * RADIX_BITS)) & RADIX_MASK]++;
+            }
+        }
+
+        KeyType* src_keys = keys;
+        uint32_t* src_values = values;
+        KeyType* dst_keys = key_scratch;
+        uint32_t* dst_values = value_scratch;
+
+        for (uint32_t p = 0; p < pass_count; ++p)
+        {
+            uint32_t* histogram = histograms[p];
+            uint32_t shift = p * RADIX_BITS;
+
+            // If all keys have the same digit, this pass wouldn't change the order
+            if (histogram[(src_keys[0] >> shift) & RADIX_MASK] == count)
+                continue;
+
+            // Convert the counts to offsets
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < RADIX_SIZE; ++i)
+            {
+                uint32_t c = histogram[i];
+                histogram[i] = offset;
+                offset += c;
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                KeyType key = src_keys[i];
+                uint32_t dst = histogram[(key >> shift) & RADIX_MASK]++;
+                dst_keys[dst] = key;
+                dst_values[dst] = src_values[i];
+            }
+
+            KeyType* tmp_keys = src_keys;
+            src_keys = dst_keys;
+            dst_keys = tmp_keys;
+            uint32_t* tmp_values = src_values;
+            src_values = dst_values;
+            dst_values = tmp_values;
+        }
+
+        // An odd number of passes leaves the result in the scratch buffers
+        if (src_keys != keys)
+        {
+            memcpy(keys, src_keys, sizeof(KeyType) * count);
+            memcpy(values, src_values, sizeof(uint32_t) * count);
+        }
+    }
+
+    void Sort64(uint64_t* keys, uint32_t* values, uint64_t* key_scratch, uint32_t* value_scratch, uint32_t count)
+    {
+        Sort<uint64_t>(keys, values, key_scratch, value_scratch, count);
+    }
+
+    void Sort32(uint32_t* keys, uint32_t* values, uint32_t* key_scratch, uint32_t* value_scratch, uint32_t count)
+    {
+        Sort<uint32_t>(keys, values, key_scratch, value_scratch, count);
+    }
+}
@@ -0,0 +1,35 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_RADIX_SORT_H
+#define DM_RADIX_SORT_H
+
+#include <stdint.h>
+
+namespace dmRadixSort
+{
+    /*
+     * Stable LSD radix sort of count (key, value) pairs, in ascending key order.
+     * The sorted result is written back to keys and values.
+     * key_scratch and value_scratch must each have room for count items.
+     * Passes over bytes that are the same for all keys are skipped, so keys
+     * with few significant bits are cheap to sort.
+     */
+    void Sort64(uint64_t* keys, uint32_t* values, uint64_t* key_scratch, uint32_t* value_scratch, uint32_t count);
+
+    // Same as Sort64(), but for 32 bit keys
+    void Sort32(uint32_t* keys, uint32_t* values, uint32_t* key_scratch, uint32_t* value_scratch, uint32_t count);
+}
+
+#endif // DM_RADIX_SORT_H
@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include "../dlib/easing.h"
@@ -43,6 +44,31 @@ TEST(dmEasing, Linear)
     }
 }
 
+TEST(dmEasing, GetValues)
+{
+    // Not a multiple of the SIMD width, and outside of [0,1] at both ends
+    const uint32_t count = 103;
+    float t[count];
+    float values[count];
+    for (uint32_t i = 0; i < count; ++i) {
+        t[i] = -0.1f + i * (1.2f / (count - 1));
+    }
+
+    for (int type = 0; type < dmEasing::TYPE_FLOAT_VECTOR; ++type) {
+        dmEasing::GetValues((dmEasing::Type) type, t, values, count);
+        for (uint32_t i = 0; i < count; ++i) {
+            ASSERT_EQ(dmEasing::GetValue((dmEasing::Type) type, t[i]), values[i]);
+        }
+    }
+
+    // In place
+    memcpy(values, t, sizeof(t));
+    dmEasing::GetValues(dmEasing::TYPE_INQUAD, values, values, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_EQ(dmEasing::GetValue(dmEasing::TYPE_INQUAD, t[i]), values[i]);
+    }
+}
+
 TEST(dmEasing, CurstomCurve)
 {
     dmVMath::FloatVector vector_empty(0);
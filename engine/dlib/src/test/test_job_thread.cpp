@@ -12,8 +12,10 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <string.h> // memset
 #include "dlib/job_thread.h"
 #include "dlib/array.h"
+#include "dlib/atomic.h"
 #include "dlib/time.h"
 
 #define JC_TEST_IMPLEMENTATION
@@ -82,6 +84,164 @@ TEST(dmJobThread, PushJobsMultipleThreads)
     ASSERT_TRUE(tests_done);
 }
 
+static int ProcessOrder(void* context, void* data)
+{
+    dmArray<uint32_t>* order = (dmArray<uint32_t>*)context;
+    order->Push((uint32_t)(uintptr_t)data);
+    return 1;
+}
+
+static void CallbackNop(void* context, void* data, int result)
+{
+}
+
+// Without workers, the jobs are run by Update(), in the order they were pushed
+TEST(dmJobThread, PushJobsNoWorkersOrder)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadCount = 0;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+
+    const uint32_t job_count = 8;
+    dmArray<uint32_t> order;
+    order.SetCapacity(job_count);
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        dmJobThread::PushJob(ctx, ProcessOrder, CallbackNop, (void*)&order, (void*)(uintptr_t)i);
+    }
+
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        dmJobThread::Update(ctx);
+    }
+
+    ASSERT_EQ(job_count, order.Size());
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        ASSERT_EQ(i, order[i]);
+    }
+
+    dmJobThread::Destroy(ctx);
+}
+
+static int ProcessCount(void* context, void* data)
+{
+    dmAtomicIncrement32((int32_atomic_t*)data);
+    return 0;
+}
+
+TEST(dmJobThread, ParentChild)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = 4;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+
+    int32_atomic_t count = 0;
+    dmJobThread::HJob parent = dmJobThread::CreateJob(ctx, ProcessCount, 0, (void*)&count, dmJobThread::INVALID_JOB, dmJobThread::JOB_PRIORITY_NORMAL);
+    ASSERT_NE(dmJobThread::INVALID_JOB, parent);
+
+    const int child_count = 1000;
+    for (int i = 0; i < child_count; ++i)
+    {
+        dmJobThread::HJob child = dmJobThread::CreateJob(ctx, ProcessCount, 0, (void*)&count, parent, dmJobThread::JOB_PRIORITY_HIGH);
+        ASSERT_NE(dmJobThread::INVALID_JOB, child);
+        dmJobThread::RunJob(ctx, child);
+    }
+
+    ASSERT_FALSE(dmJobThread::IsJobFinished(ctx, parent));
+    dmJobThread::RunJob(ctx, parent);
+    dmJobThread::WaitJob(ctx, parent);
+
+    ASSERT_TRUE(dmJobThread::IsJobFinished(ctx, parent));
+    ASSERT_EQ(child_count + 1, dmAtomicGet32(&count));
+
+    dmJobThread::Destroy(ctx);
+}
+
+TEST(dmJobThread, JobPoolExhausted)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = 1;
+    job_thread_create_params.m_MaxJobCount    = 2;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+
+    int32_atomic_t count = 0;
+    dmJobThread::HJob job1 = dmJobThread::CreateJob(ctx, ProcessCount, 0, (void*)&count, dmJobThread::INVALID_JOB, dmJobThread::JOB_PRIORITY_NORMAL);
+    dmJobThread::HJob job2 = dmJobThread::CreateJob(ctx, ProcessCount, 0, (void*)&count, dmJobThread::INVALID_JOB, dmJobThread::JOB_PRIORITY_NORMAL);
+    dmJobThread::HJob job3 = dmJobThread::CreateJob(ctx, ProcessCount, 0, (void*)&count, dmJobThread::INVALID_JOB, dmJobThread::JOB_PRIORITY_NORMAL);
+    ASSERT_NE(dmJobThread::INVALID_JOB, job1);
+    ASSERT_NE(dmJobThread::INVALID_JOB, job2);
+    ASSERT_EQ(dmJobThread::INVALID_JOB, job3);
+
+    dmJobThread::RunJob(ctx, job1);
+    dmJobThread::RunJob(ctx, job2);
+    dmJobThread::WaitJob(ctx, job1);
+    dmJobThread::WaitJob(ctx, job2);
+    ASSERT_EQ(2, dmAtomicGet32(&count));
+
+    // The slot is reused, but the old handle is still reported as finished
+    job3 = dmJobThread::CreateJob(ctx, ProcessCount, 0, (void*)&count, dmJobThread::INVALID_JOB, dmJobThread::JOB_PRIORITY_NORMAL);
+    ASSERT_NE(dmJobThread::INVALID_JOB, job3);
+    ASSERT_NE(job1, job3);
+    ASSERT_NE(job2, job3);
+    ASSERT_TRUE(dmJobThread::IsJobFinished(ctx, job1));
+    ASSERT_TRUE(dmJobThread::IsJobFinished(ctx, job2));
+    ASSERT_FALSE(dmJobThread::IsJobFinished(ctx, job3));
+
+    dmJobThread::RunJob(ctx, job3);
+    dmJobThread::WaitJob(ctx, job3);
+    ASSERT_EQ(3, dmAtomicGet32(&count));
+
+    dmJobThread::Destroy(ctx);
+}
+
+static void ProcessRange(void* context, void* data, uint32_t start, uint32_t end)
+{
+    uint32_t* values = (uint32_t*)data;
+    for (uint32_t i = start; i < end; ++i)
+        values[i] += i;
+}
+
+static void TestParallelFor(uint8_t thread_count)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = thread_count;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+
+    dmArray<uint32_t> values;
+    values.SetCapacity(100000);
+    values.SetSize(values.Capacity());
+    memset(values.Begin(), 0, values.Size() * sizeof(uint32_t));
+
+    const uint32_t iterations = 10;
+    for (uint32_t i = 0; i < iterations; ++i)
+        dmJobThread::ParallelFor(ctx, ProcessRange, 0, values.Begin(), values.Size(), 97);
+
+    for (uint32_t i = 0; i < values.Size(); ++i)
+    {
+        ASSERT_EQ(i * iterations, values[i]);
+    }
+
+    dmJobThread::Destroy(ctx);
+}
+
+TEST(dmJobThread, ParallelForNoWorkers)
+{
+    TestParallelFor(0);
+}
+
+TEST(dmJobThread, ParallelFor)
+{
+    TestParallelFor(4);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -0,0 +1,249 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdio.h>
+#include "dlib/job_thread.h"
+#include "dlib/array.h"
+#include "dlib/atomic.h"
+#include "dlib/condition_variable.h"
+#include "dlib/mutex.h"
+#include "dlib/thread.h"
+#include "dlib/time.h"
+#include "jc/ringbuffer.h"
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+// The previous implementation (one queue, guarded by one mutex), kept here as a reference
+namespace LegacyJobThread
+{
+    struct JobItem
+    {
+        void*                   m_Context;
+        void*                   m_Data;
+        dmJobThread::FProcess   m_Process;
+        dmJobThread::FCallback  m_Callback;
+        int                     m_Result;
+    };
+
+    struct Context
+    {
+        jc::RingBuffer<JobItem>                 m_Work;
+        jc::RingBuffer<JobItem>                 m_Done;
+        dmMutex::HMutex                         m_Mutex;
+        dmConditionVariable::HConditionVariable m_WakeupCond;
+        bool                                    m_Run;
+        dmArray<dmThread::Thread>               m_Threads;
+    };
+
+    static void JobThread(void* _ctx)
+    {
+        Context* ctx = (Context*)_ctx;
+        while (true)
+        {
+            JobItem item = {};
+            {
+                DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+                if (!ctx->m_Run)
+                    break;
+                while(ctx->m_Work.Empty())
+                {
+                    dmConditionVariable::Wait(ctx->m_WakeupCond, ctx->m_Mutex);
+                    if (!ctx->m_Run)
+                        return;
+                }
+                item = ctx->m_Work.Pop();
+            }
+
+            item.m_Result = item.m_Process(item.m_Context, item.m_Data);
+
+            DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+            if (ctx->m_Done.Full())
+                ctx->m_Done.SetCapacity(ctx->m_Done.Capacity() + 8);
+            ctx->m_Done.Push(item);
+        }
+    }
+
+    static Context* Create(uint32_t thread_count)
+    {
+        Context* ctx = new Context;
+        ctx->m_Mutex = dmMutex::New();
+        ctx->m_WakeupCond = dmConditionVariable::New();
+        ctx->m_Run = true;
+        ctx->m_Threads.SetCapacity(thread_count);
+        for (uint32_t i = 0; i < thread_count; ++i)
+            ctx->m_Threads.Push(dmThread::New(JobThread, 0x80000, ctx, "LegacyJobThread"));
+        return ctx;
+    }
+
+    static void Destroy(Context* ctx)
+    {
+        {
+            DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+            ctx->m_Run = false;
+            dmConditionVariable::Broadcast(ctx->m_WakeupCond);
+        }
+        for (uint32_t i = 0; i < ctx->m_Threads.Size(); ++i)
+            dmThread::Join(ctx->m_Threads[i]);
+        dmConditionVariable::Delete(ctx->m_WakeupCond);
+        dmMutex::Delete(ctx->m_Mutex);
+        delete ctx;
+    }
+
+    static void PushJob(Context* ctx, dmJobThread::FProcess process, dmJobThread::FCallback callback, void* user_context, void* data)
+    {
+        JobItem item = { user_context, data, process, callback, 0 };
+        {
+            DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+            if (ctx->m_Work.Full())
+                ctx->m_Work.SetCapacity(ctx->m_Work.Capacity() + 8);
+            ctx->m_Work.Push(item);
+        }
+        dmConditionVariable::Signal(ctx->m_WakeupCond);
+    }
+
+    static void Update(Context* ctx)
+    {
+        dmArray<JobItem> items;
+        {
+            DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+            uint32_t size = ctx->m_Done.Size();
+            items.SetCapacity(size);
+            for(uint32_t i = 0; i < size; ++i)
+                items.Push(ctx->m_Done[i]);
+            ctx->m_Done.Clear();
+        }
+        for(uint32_t i = 0; i < items.Size(); ++i)
+            items[i].m_Callback(items[i].m_Context, items[i].m_Data, items[i].m_Result);
+    }
+}
+
+static const uint32_t JOB_COUNT = 32768;
+static const uint32_t JOB_WORK  = 200; // Iterations of "work" per job, to make the jobs non trivial
+
+static int ProcessJob(void* context, void* data)
+{
+    uint32_t v = (uint32_t)(uintptr_t)data;
+    for (uint32_t i = 0; i < JOB_WORK; ++i)
+        v = v * 1664525 + 1013904223;
+    return (int)v;
+}
+
+static void JobDone(void* context, void* data, int result)
+{
+    (*(uint32_t*)context)++;
+}
+
+static void ProcessRange(void* context, void* data, uint32_t start, uint32_t end)
+{
+    int* results = (int*)data;
+    for (uint32_t i = start; i < end; ++i)
+        results[i] = ProcessJob(0, (void*)(uintptr_t)i);
+}
+
+static float MeasureLegacy(uint32_t thread_count)
+{
+    LegacyJobThread::Context* ctx = LegacyJobThread::Create(thread_count);
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    uint32_t done = 0;
+    for (uint32_t i = 0; i < JOB_COUNT; ++i)
+        LegacyJobThread::PushJob(ctx, ProcessJob, JobDone, &done, (void*)(uintptr_t)i);
+    while (done < JOB_COUNT)
+        LegacyJobThread::Update(ctx);
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    LegacyJobThread::Destroy(ctx);
+    return (end - start) / 1000.0f;
+}
+
+static dmJobThread::HContext CreateContext(uint32_t thread_count)
+{
+    dmJobThread::JobThreadCreationParams params;
+    params.m_ThreadNames[0] = "PerfJobThread";
+    params.m_ThreadCount    = thread_count;
+    params.m_MaxJobCount    = dmJobThread::DM_MAX_JOB_COUNT;
+    return dmJobThread::Create(params);
+}
+
+static float MeasurePushJob(uint32_t thread_count)
+{
+    dmJobThread::HContext ctx = CreateContext(thread_count);
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    uint32_t done = 0;
+    for (uint32_t i = 0; i < JOB_COUNT; ++i)
+        dmJobThread::PushJob(ctx, ProcessJob, JobDone, &done, (void*)(uintptr_t)i);
+    while (done < JOB_COUNT)
+        dmJobThread::Update(ctx);
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    dmJobThread::Destroy(ctx);
+    return (end - start) / 1000.0f;
+}
+
+static float MeasureRunJob(uint32_t thread_count)
+{
+    dmJobThread::HContext ctx = CreateContext(thread_count);
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    dmJobThread::HJob root = dmJobThread::CreateJob(ctx, 0, 0, 0, dmJobThread::INVALID_JOB, dmJobThread::JOB_PRIORITY_NORMAL);
+    for (uint32_t i = 0; i < JOB_COUNT; ++i)
+    {
+        dmJobThread::HJob job = dmJobThread::CreateJob(ctx, ProcessJob, 0, (void*)(uintptr_t)i, root, dmJobThread::JOB_PRIORITY_NORMAL);
+        dmJobThread::RunJob(ctx, job);
+    }
+    dmJobThread::RunJob(ctx, root);
+    dmJobThread::WaitJob(ctx, root);
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    dmJobThread::Destroy(ctx);
+    return (end - start) / 1000.0f;
+}
+
+static float MeasureParallelFor(uint32_t thread_count)
+{
+    dmJobThread::HContext ctx = CreateContext(thread_count);
+
+    dmArray<int> results;
+    results.SetCapacity(JOB_COUNT);
+    results.SetSize(JOB_COUNT);
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    dmJobThread::ParallelFor(ctx, ProcessRange, 0, results.Begin(), JOB_COUNT, 64);
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    dmJobThread::Destroy(ctx);
+    return (end - start) / 1000.0f;
+}
+
+TEST(dmJobThreadPerf, Throughput)
+{
+    printf("%u jobs, times in ms\n", JOB_COUNT);
+    printf("%8s %10s %10s %10s %12s\n", "threads", "legacy", "PushJob", "RunJob", "ParallelFor");
+    for (uint32_t thread_count = 1; thread_count <= dmJobThread::DM_MAX_JOB_THREAD_COUNT; thread_count *= 2)
+    {
+        float legacy       = MeasureLegacy(thread_count);
+        float push_job     = MeasurePushJob(thread_count);
+        float run_job      = MeasureRunJob(thread_count);
+        float parallel_for = MeasureParallelFor(thread_count);
+        printf("%8u %10.3f %10.3f %10.3f %12.3f\n", thread_count, legacy, push_job, run_job, parallel_for);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
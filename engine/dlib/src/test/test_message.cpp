@@ -14,9 +14,11 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <vector>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
+#include "../../src/dlib/atomic.h"
 #include "../../src/dlib/hash.h"
 #include "../../src/dlib/message.h"
 #include "../../src/dlib/dstrings.h"
@@ -230,6 +232,43 @@ TEST(dmMessage, OutofResources)
 
 }
 
+// Many sockets created and deleted over time, while some of them stay alive
+TEST(dmMessage, ReuseSlots)
+{
+    std::vector<dmMessage::HSocket> alive;
+    std::vector<dmMessage::HSocket> deleted;
+    char name[32];
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        dmSnPrintf(name, sizeof(name), "my_socket_%d", i);
+        dmMessage::HSocket socket;
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket(name, &socket));
+        if (i % 20 == 0 && alive.size() < 64)
+        {
+            alive.push_back(socket);
+        }
+        else
+        {
+            ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(socket));
+            deleted.push_back(socket);
+        }
+    }
+
+    for (uint32_t i = 0; i < alive.size(); ++i)
+    {
+        ASSERT_TRUE(dmMessage::IsSocketValid(alive[i]));
+    }
+    for (uint32_t i = 0; i < deleted.size(); ++i)
+    {
+        ASSERT_FALSE(dmMessage::IsSocketValid(deleted[i]));
+    }
+    for (uint32_t i = 0; i < alive.size(); ++i)
+    {
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(alive[i]));
+    }
+}
+
 void HandleMessagePostDuring(dmMessage::Message *message_object, void *user_ptr)
 {
     dmMessage::URL* receiver = (dmMessage::URL*) user_ptr;
@@ -365,6 +404,162 @@ TEST(dmMessage, ThreadTest2)
 
     ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
 }
+
+struct StressMessage
+{
+    uint32_t m_Producer;
+    uint32_t m_Sequence;
+    uint8_t  m_Padding[200];
+};
+
+struct StressProducer
+{
+    dmMessage::URL m_Receiver;
+    uint32_t       m_Producer;
+    uint32_t       m_Count;
+};
+
+struct StressConsumer
+{
+    uint32_t m_NextSequence[8];
+    uint32_t m_Errors;
+};
+
+static void StressPostThread(void* arg)
+{
+    StressProducer* producer = (StressProducer*) arg;
+    StressMessage message;
+    for (uint32_t i = 0; i < producer->m_Count; ++i)
+    {
+        message.m_Producer = producer->m_Producer;
+        message.m_Sequence = i;
+        // Varying sizes so that the producers fill up the pages at different times
+        uint32_t size = sizeof(uint32_t) * 2 + (i * 37 + producer->m_Producer * 11) % sizeof(message.m_Padding);
+        memset(message.m_Padding, (int)(i & 0xff), size - sizeof(uint32_t) * 2);
+        dmMessage::Result result = dmMessage::Post(0x0, &producer->m_Receiver, m_HashMessage1, i, 0x0, &message, size, 0);
+        T_ASSERT_EQ(dmMessage::RESULT_OK, result);
+    }
+}
+
+static void HandleStressMessage(dmMessage::Message *message_object, void *user_ptr)
+{
+    StressConsumer* consumer = (StressConsumer*) user_ptr;
+    StressMessage* message = (StressMessage*) message_object->m_Data;
+    uint32_t padding_size = message_object->m_DataSize - sizeof(uint32_t) * 2;
+    bool ok = message->m_Producer < 8 && message->m_Sequence == (uint32_t)message_object->m_UserData1;
+    // Messages from one producer are dispatched in the order they were posted
+    ok = ok && consumer->m_NextSequence[message->m_Producer] == message->m_Sequence;
+    for (uint32_t i = 0; ok && i < padding_size; ++i)
+    {
+        ok = message->m_Padding[i] == (uint8_t)(message->m_Sequence & 0xff);
+    }
+    if (ok)
+        consumer->m_NextSequence[message->m_Producer]++;
+    else
+        consumer->m_Errors++;
+}
+
+// Many producers, and a consumer dispatching at the same time
+TEST(dmMessage, ThreadStress)
+{
+    const uint32_t producer_count = 8;
+    const uint32_t message_count = 20000;
+
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    StressProducer producers[producer_count];
+    dmThread::Thread threads[producer_count];
+    for (uint32_t i = 0; i < producer_count; ++i)
+    {
+        producers[i].m_Receiver = receiver;
+        producers[i].m_Producer = i;
+        producers[i].m_Count = message_count;
+        threads[i] = dmThread::New(&StressPostThread, 0x80000, (void*) &producers[i], "stress_post");
+    }
+
+    StressConsumer consumer;
+    memset(&consumer, 0, sizeof(consumer));
+    uint32_t count = 0;
+    while (count < producer_count * message_count)
+    {
+        count += dmMessage::Dispatch(receiver.m_Socket, HandleStressMessage, &consumer);
+    }
+
+    for (uint32_t i = 0; i < producer_count; ++i)
+    {
+        dmThread::Join(threads[i]);
+        ASSERT_EQ(message_count, consumer.m_NextSequence[i]);
+    }
+    ASSERT_EQ(0u, consumer.m_Errors);
+    ASSERT_EQ(0u, dmMessage::Dispatch(receiver.m_Socket, HandleStressMessage, &consumer));
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
+struct ChurnContext
+{
+    dmMessage::URL m_Receiver;
+    int32_atomic_t m_Done;
+};
+
+static void SocketChurnThread(void* arg)
+{
+    ChurnContext* ctx = (ChurnContext*) arg;
+    char name[32];
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        dmSnPrintf(name, sizeof(name), "churn_socket_%u", i % 64);
+        dmMessage::URL url;
+        dmMessage::ResetURL(&url);
+        dmMessage::Result result = dmMessage::NewSocket(name, &url.m_Socket);
+        T_ASSERT_EQ(dmMessage::RESULT_OK, result);
+        result = dmMessage::Post(0x0, &url, m_HashMessage1, 0, 0x0, &i, sizeof(i), 0);
+        T_ASSERT_EQ(dmMessage::RESULT_OK, result);
+        result = dmMessage::DeleteSocket(url.m_Socket);
+        T_ASSERT_EQ(dmMessage::RESULT_OK, result);
+    }
+    dmAtomicStore32(&ctx->m_Done, 1);
+}
+
+static void ChurnPostThread(void* arg)
+{
+    ChurnContext* ctx = (ChurnContext*) arg;
+    uint32_t i = 0;
+    while (!dmAtomicGet32(&ctx->m_Done))
+    {
+        dmMessage::Result result = dmMessage::Post(0x0, &ctx->m_Receiver, m_HashMessage1, 0, 0x0, &i, sizeof(i), 0);
+        T_ASSERT_EQ(dmMessage::RESULT_OK, result);
+        ++i;
+    }
+}
+
+// Sockets being created and deleted while other sockets are looked up
+TEST(dmMessage, SocketChurn)
+{
+    ChurnContext ctx;
+    dmMessage::ResetURL(&ctx.m_Receiver);
+    dmAtomicStore32(&ctx.m_Done, 0);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &ctx.m_Receiver.m_Socket));
+
+    dmThread::Thread churn = dmThread::New(&SocketChurnThread, 0x80000, (void*) &ctx, "churn");
+    dmThread::Thread post = dmThread::New(&ChurnPostThread, 0x80000, (void*) &ctx, "churn_post");
+
+    while (!dmAtomicGet32(&ctx.m_Done))
+    {
+        dmMessage::Dispatch(ctx.m_Receiver.m_Socket, HandleMessage, 0);
+        ASSERT_TRUE(dmMessage::IsSocketValid(ctx.m_Receiver.m_Socket));
+    }
+
+    dmThread::Join(churn);
+    dmThread::Join(post);
+    dmMessage::Dispatch(ctx.m_Receiver.m_Socket, HandleMessage, 0);
+
+    dmMessage::HSocket socket;
+    ASSERT_EQ(dmMessage::RESULT_NAME_OK_SOCKET_NOT_FOUND, dmMessage::GetSocket("churn_socket_0", &socket));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(ctx.m_Receiver.m_Socket));
+}
 #endif // DM_NO_THREAD_SUPPORT
 
 void HandleIntegrityMessage(dmMessage::Message *message_object, void *user_ptr)
@@ -0,0 +1,319 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "dlib/atomic.h"
+#include "dlib/hash.h"
+#include "dlib/hashtable.h"
+#include "dlib/message.h"
+#include "dlib/mutex.h"
+#include "dlib/spinlock.h"
+#include "dlib/thread.h"
+#include "dlib/time.h"
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+// Benchmarks for posting messages from one or more threads.
+// Not run as part of the test suite, run build/src/test/test_message_perf manually.
+
+static const uint32_t MESSAGE_COUNT     = 256 * 1024; // Total number of messages per run
+static const uint32_t MAX_PRODUCERS     = 8;
+static const uint32_t MESSAGE_DATA_SIZE = 32;
+
+// The previous implementation (a spinlock for the socket lookup, and a mutex per socket), kept here as a reference
+namespace LegacyMessage
+{
+    struct Page
+    {
+        uint8_t  m_Memory[dmMessage::DM_MESSAGE_PAGE_SIZE];
+        uint32_t m_Current;
+        Page*    m_Next;
+    };
+
+    struct Socket
+    {
+        uint32_t            m_RefCount;
+        dmMessage::Message* m_Header;
+        dmMessage::Message* m_Tail;
+        dmMutex::HMutex     m_Mutex;
+        Page*               m_CurrentPage;
+        Page*               m_FullPages;
+        Page*               m_FreePages;
+    };
+
+    static dmHashTable64<Socket> g_Sockets;
+    static dmSpinlock::Spinlock  g_Spinlock;
+
+    static Socket* Acquire(dmhash_t socket)
+    {
+        DM_SPINLOCK_SCOPED_LOCK(g_Spinlock);
+        Socket* s = g_Sockets.Get(socket);
+        if (s)
+            ++s->m_RefCount;
+        return s;
+    }
+
+    static void Release(Socket* s)
+    {
+        DM_SPINLOCK_SCOPED_LOCK(g_Spinlock);
+        --s->m_RefCount;
+    }
+
+    static void* Allocate(Socket* s, uint32_t size)
+    {
+        size = (size + 15) & ~15;
+        if (s->m_CurrentPage == 0 || dmMessage::DM_MESSAGE_PAGE_SIZE - s->m_CurrentPage->m_Current < size)
+        {
+            if (s->m_CurrentPage)
+            {
+                s->m_CurrentPage->m_Next = s->m_FullPages;
+                s->m_FullPages = s->m_CurrentPage;
+            }
+            Page* page = s->m_FreePages;
+            if (page)
+                s->m_FreePages = page->m_Next;
+            else
+                page = new Page;
+            page->m_Current = 0;
+            page->m_Next = 0;
+            s->m_CurrentPage = page;
+        }
+        void* ret = &s->m_CurrentPage->m_Memory[s->m_CurrentPage->m_Current];
+        s->m_CurrentPage->m_Current += size;
+        return ret;
+    }
+
+    static void NewSocket(dmhash_t name_hash)
+    {
+        dmSpinlock::Create(&g_Spinlock);
+        g_Sockets.SetCapacity(16, 16);
+        Socket s;
+        memset(&s, 0, sizeof(s));
+        s.m_RefCount = 1;
+        s.m_Mutex = dmMutex::New();
+        g_Sockets.Put(name_hash, s);
+    }
+
+    static void DeleteSocket(dmhash_t name_hash)
+    {
+        Socket* s = g_Sockets.Get(name_hash);
+        dmMutex::Delete(s->m_Mutex);
+        Page* pages[] = {s->m_CurrentPage, s->m_FullPages, s->m_FreePages};
+        for (uint32_t i = 0; i < sizeof(pages) / sizeof(pages[0]); ++i)
+        {
+            Page* p = pages[i];
+            while (p)
+            {
+                Page* next = p->m_Next;
+                delete p;
+                p = next;
+            }
+        }
+        g_Sockets.Erase(name_hash);
+        dmSpinlock::Destroy(&g_Spinlock);
+    }
+
+    static void Post(const dmMessage::URL* receiver, dmhash_t message_id, const void* data, uint32_t data_size)
+    {
+        Socket* s = Acquire(receiver->m_Socket);
+        DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+        dmMessage::Message* m = (dmMessage::Message*) Allocate(s, sizeof(dmMessage::Message) + data_size);
+        dmMessage::ResetURL(&m->m_Sender);
+        m->m_Receiver = *receiver;
+        m->m_Id = message_id;
+        m->m_DataSize = data_size;
+        m->m_Next = 0;
+        m->m_DestroyCallback = 0;
+        memcpy(m->m_Data, data, data_size);
+        if (!s->m_Header)
+            s->m_Header = m;
+        else
+            s->m_Tail->m_Next = m;
+        s->m_Tail = m;
+        Release(s);
+    }
+
+    static uint32_t Dispatch(dmhash_t socket)
+    {
+        Socket* s = Acquire(socket);
+        dmMessage::Message* m;
+        Page* full_pages;
+        {
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+            m = s->m_Header;
+            s->m_Header = s->m_Tail = 0;
+            full_pages = s->m_FullPages;
+            s->m_FullPages = 0;
+        }
+        uint32_t count = 0;
+        for (; m; m = m->m_Next)
+            ++count;
+        {
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+            while (full_pages)
+            {
+                Page* next = full_pages->m_Next;
+                full_pages->m_Next = s->m_FreePages;
+                s->m_FreePages = full_pages;
+                full_pages = next;
+            }
+        }
+        Release(s);
+        return count;
+    }
+}
+
+struct ProducerContext
+{
+    dmMessage::URL  m_Receiver;
+    uint32_t        m_Count;
+    bool            m_Legacy;
+    int32_atomic_t* m_Start;
+};
+
+static void ProducerThread(void* arg)
+{
+    ProducerContext* ctx = (ProducerContext*) arg;
+    uint8_t data[MESSAGE_DATA_SIZE] = {};
+    while (!dmAtomicGet32(ctx->m_Start))
+    {
+    }
+    for (uint32_t i = 0; i < ctx->m_Count; ++i)
+    {
+        if (ctx->m_Legacy)
+            LegacyMessage::Post(&ctx->m_Receiver, 1, data, sizeof(data));
+        else
+            dmMessage::Post(0x0, &ctx->m_Receiver, 1, 0, 0x0, data, sizeof(data), 0);
+    }
+}
+
+static void NullDispatch(dmMessage::Message*, void*)
+{
+}
+
+// Posts MESSAGE_COUNT messages from producer_count threads while the calling thread dispatches them.
+// Returns the time in ms
+static float Measure(uint32_t producer_count, bool legacy)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    if (legacy)
+    {
+        receiver.m_Socket = dmHashString64("perf_socket");
+        LegacyMessage::NewSocket(receiver.m_Socket);
+    }
+    else
+    {
+        dmMessage::NewSocket("perf_socket", &receiver.m_Socket);
+    }
+
+    int32_atomic_t start_flag = 0;
+    ProducerContext contexts[MAX_PRODUCERS];
+    dmThread::Thread threads[MAX_PRODUCERS];
+    for (uint32_t i = 0; i < producer_count; ++i)
+    {
+        contexts[i].m_Receiver = receiver;
+        contexts[i].m_Count = MESSAGE_COUNT / producer_count;
+        contexts[i].m_Legacy = legacy;
+        contexts[i].m_Start = &start_flag;
+        threads[i] = dmThread::New(&ProducerThread, 0x80000, &contexts[i], "producer");
+    }
+
+    uint32_t total = (MESSAGE_COUNT / producer_count) * producer_count;
+    uint32_t count = 0;
+    uint64_t start = dmTime::GetMonotonicTime();
+    dmAtomicStore32(&start_flag, 1);
+    while (count < total)
+    {
+        if (legacy)
+            count += LegacyMessage::Dispatch(receiver.m_Socket);
+        else
+            count += dmMessage::Dispatch(receiver.m_Socket, NullDispatch, 0);
+    }
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    for (uint32_t i = 0; i < producer_count; ++i)
+    {
+        dmThread::Join(threads[i]);
+    }
+
+    if (legacy)
+        LegacyMessage::DeleteSocket(receiver.m_Socket);
+    else
+        dmMessage::DeleteSocket(receiver.m_Socket);
+    return (end - start) / 1000.0f;
+}
+
+// Post and dispatch on the same thread, which is the common case in a game
+static float MeasureSingleThread(bool legacy)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    if (legacy)
+    {
+        receiver.m_Socket = dmHashString64("perf_socket");
+        LegacyMessage::NewSocket(receiver.m_Socket);
+    }
+    else
+    {
+        dmMessage::NewSocket("perf_socket", &receiver.m_Socket);
+    }
+
+    uint8_t data[MESSAGE_DATA_SIZE] = {};
+    const uint32_t batch = 1024; // messages per "frame"
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t i = 0; i < MESSAGE_COUNT; i += batch)
+    {
+        for (uint32_t j = 0; j < batch; ++j)
+        {
+            if (legacy)
+                LegacyMessage::Post(&receiver, 1, data, sizeof(data));
+            else
+                dmMessage::Post(0x0, &receiver, 1, 0, 0x0, data, sizeof(data), 0);
+        }
+        if (legacy)
+            LegacyMessage::Dispatch(receiver.m_Socket);
+        else
+            dmMessage::Dispatch(receiver.m_Socket, NullDispatch, 0);
+    }
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    if (legacy)
+        LegacyMessage::DeleteSocket(receiver.m_Socket);
+    else
+        dmMessage::DeleteSocket(receiver.m_Socket);
+    return (end - start) / 1000.0f;
+}
+
+TEST(dmMessagePerf, Throughput)
+{
+    printf("%u messages of %u bytes, times in ms\n", MESSAGE_COUNT, MESSAGE_DATA_SIZE);
+    printf("%10s %10s %10s\n", "producers", "legacy", "Post");
+    printf("%10s %10.3f %10.3f\n", "same", MeasureSingleThread(true), MeasureSingleThread(false));
+    for (uint32_t producer_count = 1; producer_count <= MAX_PRODUCERS; producer_count *= 2)
+    {
+        float legacy = Measure(producer_count, true);
+        float post   = Measure(producer_count, false);
+        printf("%10u %10.3f %10.3f\n", producer_count, legacy, post);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -0,0 +1,141 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "dlib/radix_sort.h"
+#include "dlib/array.h"
+
+#include <stdint.h>
+#include <stdlib.h> // rand
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+#include <algorithm> // std::stable_sort
+
+template <typename KeyType>
+struct KeySorter
+{
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return m_Keys[a] < m_Keys[b];
+    }
+    const KeyType* m_Keys;
+};
+
+static uint64_t RandomKey64(uint32_t significant_bits)
+{
+    uint64_t key = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+    return significant_bits < 64 ? key & ((1ULL << significant_bits) - 1) : key;
+}
+
+// Sorts count random keys and compares the order with std::stable_sort
+static void TestSort64(uint32_t count, uint32_t significant_bits)
+{
+    dmArray<uint64_t> original;
+    dmArray<uint64_t> keys;
+    dmArray<uint64_t> key_scratch;
+    dmArray<uint32_t> values;
+    dmArray<uint32_t> value_scratch;
+    dmArray<uint32_t> expected;
+    original.SetCapacity(count);
+    keys.SetCapacity(count);
+    key_scratch.SetCapacity(count);
+    key_scratch.SetSize(count);
+    values.SetCapacity(count);
+    value_scratch.SetCapacity(count);
+    value_scratch.SetSize(count);
+    expected.SetCapacity(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint64_t key = RandomKey64(significant_bits);
+        original.Push(key);
+        keys.Push(key);
+        values.Push(i);
+        expected.Push(i);
+    }
+
+    KeySorter<uint64_t> sorter;
+    sorter.m_Keys = original.Begin();
+    std::stable_sort(expected.Begin(), expected.End(), sorter);
+
+    dmRadixSort::Sort64(keys.Begin(), values.Begin(), key_scratch.Begin(), value_scratch.Begin(), count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(expected[i], values[i]);
+        ASSERT_EQ(original[expected[i]], keys[i]);
+    }
+}
+
+TEST(dmRadixSort, Empty)
+{
+    dmRadixSort::Sort64(0, 0, 0, 0, 0);
+    dmRadixSort::Sort32(0, 0, 0, 0, 0);
+}
+
+TEST(dmRadixSort, Sort64)
+{
+    TestSort64(1, 64);
+    TestSort64(2, 64);
+    TestSort64(1000, 64);
+    TestSort64(10000, 64);
+}
+
+// Few significant bits means many equal keys, which tests the stability
+// and that the passes over the constant bytes are skipped correctly
+TEST(dmRadixSort, Sort64Stable)
+{
+    TestSort64(1000, 4);
+    TestSort64(1000, 8);
+    TestSort64(1000, 12);
+    TestSort64(1000, 24);
+}
+
+TEST(dmRadixSort, Sort32)
+{
+    const uint32_t count = 5000;
+    dmArray<uint32_t> keys;
+    dmArray<uint32_t> key_scratch;
+    dmArray<uint32_t> values;
+    dmArray<uint32_t> value_scratch;
+    keys.SetCapacity(count);
+    key_scratch.SetCapacity(count);
+    key_scratch.SetSize(count);
+    values.SetCapacity(count);
+    value_scratch.SetCapacity(count);
+    value_scratch.SetSize(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        keys.Push((uint32_t)rand() % 100);
+        values.Push(i);
+    }
+
+    dmRadixSort::Sort32(keys.Begin(), values.Begin(), key_scratch.Begin(), value_scratch.Begin(), count);
+
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        ASSERT_LE(keys[i-1], keys[i]);
+        if (keys[i-1] == keys[i])
+        {
+            ASSERT_LT(values[i-1], values[i]);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
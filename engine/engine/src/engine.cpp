@@ -935,6 +935,7 @@ namespace dmEngine
         job_thread_create_param.m_ThreadNames[0] = "DefoldJobThread1";
         job_thread_create_param.m_ThreadCount    = 1;
         engine->m_JobThreadContext               = dmJobThread::Create(job_thread_create_param);
+        dmGameObject::SetJobThreadContext(engine->m_Register, engine->m_JobThreadContext);
 
         dmGraphics::ContextParams graphics_context_params;
         graphics_context_params.m_DefaultTextureMinFilter = ConvertMinTextureFilter(dmConfigFile::GetString(engine->m_Config, "graphics.default_texture_min_filter", "linear"));
@@ -950,6 +951,19 @@ namespace dmEngine
         graphics_context_params.m_JobThread               = engine->m_JobThreadContext;
         graphics_context_params.m_SwapInterval            = swap_interval;
 
+        // Compiled pipelines are kept between runs, so that they don't need to be compiled again on the next launch
+        char pipeline_cache_path[DMPATH_MAX_PATH];
+        if (dmGraphics::GetInstalledAdapterFamily() == dmGraphics::ADAPTER_FAMILY_VULKAN && dmConfigFile::GetInt(engine->m_Config, "graphics.pipeline_cache", 1))
+        {
+            char save_path[DMPATH_MAX_PATH];
+            const char* save_dir = dmConfigFile::GetString(engine->m_Config, "project.title_as_file_name", "defold");
+            if (dmSys::GetApplicationSavePath(save_dir, save_path, sizeof(save_path)) == dmSys::RESULT_OK)
+            {
+                dmPath::Concat(save_path, "vulkan_pipeline_cache", pipeline_cache_path, sizeof(pipeline_cache_path));
+                graphics_context_params.m_PipelineCachePath = pipeline_cache_path;
+            }
+        }
+
         engine->m_GraphicsContext = dmGraphics::NewContext(graphics_context_params);
         if (engine->m_GraphicsContext == 0x0)
         {
@@ -979,6 +993,7 @@ namespace dmEngine
         const uint32_t max_resources = dmConfigFile::GetInt(engine->m_Config, dmResource::MAX_RESOURCES_KEY, 1024);
         dmResource::NewFactoryParams params;
         params.m_MaxResources = max_resources;
+        params.m_LoadThreadCount = dmConfigFile::GetInt(engine->m_Config, "resource.load_threads", 2);
         params.m_Flags = 0;
 
         if (dLib::IsDebugMode())
@@ -1070,6 +1085,7 @@ namespace dmEngine
             return false;
         }
         dmGameObject::SetInputStackDefaultCapacity(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY, dmGameObject::DEFAULT_MAX_INPUT_STACK_CAPACITY));
+        dmGameObject::SetMessageBatching(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_BATCH_MESSAGES_KEY, 0) != 0);
 
         dmRender::RenderContextParams render_params;
         render_params.m_MaxRenderTypes = 16;
@@ -1078,6 +1094,7 @@ namespace dmEngine
         render_params.m_MaxCharacters = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "graphics.max_characters", 2048 * 4);
         render_params.m_CommandBufferSize = 1024;
         render_params.m_ScriptContext = engine->m_RenderScriptContext;
+        render_params.m_JobThread = engine->m_JobThreadContext;
 #if !defined(DM_RELEASE)
         render_params.m_VertexShaderDesc = ::DEBUG_VPC;
         render_params.m_VertexShaderDescSize = ::DEBUG_VPC_SIZE;
@@ -1213,6 +1230,7 @@ namespace dmEngine
 #endif
 
         engine->m_SpriteContext.m_RenderContext = engine->m_RenderContext;
+        engine->m_SpriteContext.m_Factory = engine->m_Factory;
         engine->m_SpriteContext.m_MaxSpriteCount = dmConfigFile::GetInt(engine->m_Config, "sprite.max_count", 128);
         engine->m_SpriteContext.m_Subpixels = dmConfigFile::GetInt(engine->m_Config, "sprite.subpixels", 1);
 
@@ -393,6 +393,37 @@ namespace dmGameObject
      */
     typedef UpdateResult (*ComponentOnMessage)(const ComponentOnMessageParams& params);
 
+    /*#
+     * Parameters to ComponentOnMessageBatch callback.
+     * @struct
+     * @name ComponentOnMessageBatchParams
+     * @member m_Instance [type: HInstance] Instance handle
+     * @member m_World [type: void*] World
+     * @member m_Context [type: void*] User context
+     * @member m_UserData [type: uintptr_t*] User data storage pointer
+     * @member m_Messages [type: dmMessage::Message**] Messages, in the order they were posted
+     * @member m_MessageCount [type: uint32_t] Number of messages
+     */
+    struct ComponentOnMessageBatchParams
+    {
+        HInstance m_Instance;
+        void* m_World;
+        void* m_Context;
+        uintptr_t* m_UserData;
+        dmMessage::Message** m_Messages;
+        uint32_t m_MessageCount;
+    };
+
+    /*#
+     * Component on-message-batch function. Called with all messages sent to this component during a dispatch pass,
+     * when message batching is enabled for the collection.
+     * @typedef
+     * @name ComponentOnMessageBatch
+     * @param params [type: const dmGameObject::ComponentOnMessageBatchParams&] Update parameters
+     * @return result [type: UpdateResult] UPDATE_RESULT_OK on success
+     */
+    typedef UpdateResult (*ComponentOnMessageBatch)(const ComponentOnMessageBatchParams& params);
+
     /*#
      * Parameters to ComponentOnInput callback.
      * @struct
@@ -656,6 +687,17 @@ namespace dmGameObject
      */
     void ComponentTypeSetOnMessageFn(HComponentType type, ComponentOnMessage fn);
 
+    /*# set the component on-message-batch callback
+     * Set the component on-message-batch callback. Optional. When message batching is enabled, messages sent to the
+     * same component instance during a dispatch pass are grouped, and passed to this function instead of the on-message callback.
+     * The messages of a component are always passed in the order they were posted, but messages to different components
+     * might be handled in another order than they were posted.
+     * @name ComponentTypeSetOnMessageBatchFn
+     * @param type [type: HComponentType] the type
+     * @param fn [type: ComponentOnMessageBatch] callback
+     */
+    void ComponentTypeSetOnMessageBatchFn(HComponentType type, ComponentOnMessageBatch fn);
+
     /*# set the component on-input callback
      * Set the component on-input callback. Called once per frame, before the Update function.
      * @name ComponentTypeSetOnInputFn
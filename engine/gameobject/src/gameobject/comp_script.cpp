@@ -244,8 +244,7 @@ namespace dmGameObject
             }
         }
 
-        // TODO: Find out if the scripts actually sent any transform events
-        update_result.m_TransformsUpdated = true;
+        // Transforms written by the scripts are tracked by the setters (see MarkTransformDirty), so m_TransformsUpdated is left untouched
 
         assert(top == lua_gettop(L));
         return result;
@@ -266,25 +265,63 @@ namespace dmGameObject
         return CompScriptUpdateInternal(params, SCRIPT_FUNCTION_FIXED_UPDATE, update_result);
     }
 
+    // The script instance must be set as the current instance when calling the message handlers below
+    static void SetCurrentInstance(lua_State* L, ScriptInstance* script_instance)
+    {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, script_instance->m_InstanceReference);
+        dmScript::SetInstance(L);
+    }
+
+    static void ClearCurrentInstance(lua_State* L)
+    {
+        lua_pushnil(L);
+        dmScript::SetInstance(L);
+    }
+
     static UpdateResult HandleUnrefMessage(void* context, ScriptInstance* script_instance, int reference)
     {
         lua_State* L = GetLuaState(context);
         DM_LUA_STACK_CHECK(L, 0);
 
-        lua_rawgeti(L, LUA_REGISTRYINDEX, script_instance->m_InstanceReference);
-        dmScript::SetInstance(L);
-
         dmScript::ResolveInInstance(L, reference);
         dmScript::UnrefInInstance(L, reference);
 
         lua_pop(L, 1);
 
-        lua_pushnil(L);
-        dmScript::SetInstance(L);
-
         return UPDATE_RESULT_OK;
     }
 
+    // Pushes the message_id, message and sender arguments of on_message, and returns the message name for profiling
+    static const char* PushMessage(lua_State* L, dmMessage::Message* message)
+    {
+        dmScript::PushHash(L, message->m_Id);
+
+        const char* message_name = 0;
+        if (message->m_Descriptor != 0)
+        {
+            // TODO: setjmp/longjmp here... how to handle?!!! We are not running "from lua" here
+            // lua_cpcall?
+            message_name = ((const dmDDF::Descriptor*)message->m_Descriptor)->m_Name;
+            dmScript::PushDDF(L, (const dmDDF::Descriptor*)message->m_Descriptor, (const char*) message->m_Data, true);
+        }
+        else
+        {
+            if (dmProfile::IsInitialized())
+            {
+                // Try to find the message name via id and reverse hash
+                message_name = (const char*)dmHashReverse64(message->m_Id, 0);
+            }
+            if (message->m_DataSize > 0)
+                dmScript::PushTable(L, (const char*)message->m_Data, message->m_DataSize);
+            else
+                lua_newtable(L);
+        }
+
+        dmScript::PushURL(L, message->m_Sender);
+
+        return message_name;
+    }
+
     static UpdateResult HandleMessage(void* context, ScriptInstance* script_instance, dmMessage::Message* message, int function_ref, bool is_callback, bool deref_function_ref)
     {
         UpdateResult result = UPDATE_RESULT_OK;
@@ -293,9 +330,6 @@ namespace dmGameObject
         int top = lua_gettop(L);
         (void) top;
 
-        lua_rawgeti(L, LUA_REGISTRYINDEX, script_instance->m_InstanceReference);
-        dmScript::SetInstance(L);
-
         if (is_callback)
         {
             dmScript::ResolveInInstance(L, function_ref);
@@ -303,8 +337,6 @@ namespace dmGameObject
             {
                 // If the script instance is dead we just ignore the callback
                 lua_pop(L, 1);
-                lua_pushnil(L);
-                dmScript::SetInstance(L);
                 dmLogWarning("Failed to call message response callback function, has it been deleted?");
                 return result;
             }
@@ -325,30 +357,7 @@ namespace dmGameObject
 
         lua_rawgeti(L, LUA_REGISTRYINDEX, script_instance->m_InstanceReference);
 
-        dmScript::PushHash(L, message->m_Id);
-
-        const char* message_name = 0;
-        if (message->m_Descriptor != 0)
-        {
-            // TODO: setjmp/longjmp here... how to handle?!!! We are not running "from lua" here
-            // lua_cpcall?
-            message_name = ((const dmDDF::Descriptor*)message->m_Descriptor)->m_Name;
-            dmScript::PushDDF(L, (const dmDDF::Descriptor*)message->m_Descriptor, (const char*) message->m_Data, true);
-        }
-        else
-        {
-            if (dmProfile::IsInitialized())
-            {
-                // Try to find the message name via id and reverse hash
-                message_name = (const char*)dmHashReverse64(message->m_Id, 0);
-            }
-            if (message->m_DataSize > 0)
-                dmScript::PushTable(L, (const char*)message->m_Data, message->m_DataSize);
-            else
-                lua_newtable(L);
-        }
-
-        dmScript::PushURL(L, message->m_Sender);
+        const char* message_name = PushMessage(L, message);
 
         // An on_message function shouldn't return anything.
         {
@@ -362,20 +371,14 @@ namespace dmGameObject
             }
         }
 
-        lua_pushnil(L);
-        dmScript::SetInstance(L);
-
         assert(top == lua_gettop(L));
         return result;
     }
 
-    UpdateResult CompScriptOnMessage(const ComponentOnMessageParams& params)
+    static UpdateResult OnMessage(void* context, ScriptInstance* script_instance, dmMessage::Message* posted_message)
     {
-        DM_PROFILE("RunScript");
         UpdateResult result = UPDATE_RESULT_OK;
 
-        ScriptInstance* script_instance = (ScriptInstance*)*params.m_UserData;
-
         int function_ref;
         bool is_callback = false;
         bool deref_function_ref = true;
@@ -383,11 +386,11 @@ namespace dmGameObject
         dmMessage::Message* message = 0;
         void*               payload_message = 0;
 
-        if (params.m_Message->m_Descriptor != 0)
+        if (posted_message->m_Descriptor != 0)
         {
-            if (params.m_Message->m_Id == dmGameObjectDDF::ScriptMessage::m_DDFDescriptor->m_NameHash)
+            if (posted_message->m_Id == dmGameObjectDDF::ScriptMessage::m_DDFDescriptor->m_NameHash)
             {
-                dmGameObjectDDF::ScriptMessage* script_message = (dmGameObjectDDF::ScriptMessage*)params.m_Message->m_Data;
+                dmGameObjectDDF::ScriptMessage* script_message = (dmGameObjectDDF::ScriptMessage*)posted_message->m_Data;
                 uint32_t payload_message_size = 0;
 
                 const dmDDF::Descriptor* descriptor = dmDDF::GetDescriptorFromHash(script_message->m_DescriptorHash);
@@ -397,7 +400,7 @@ namespace dmGameObject
                     return UPDATE_RESULT_OK;
                 }
 
-                const uint8_t* packed_payload = ((uint8_t*)params.m_Message->m_Data) + sizeof(dmGameObjectDDF::ScriptMessage);
+                const uint8_t* packed_payload = ((uint8_t*)posted_message->m_Data) + sizeof(dmGameObjectDDF::ScriptMessage);
 
                 dmDDF::Result ddf_result = dmDDF::LoadMessage(packed_payload, script_message->m_PayloadSize, descriptor, &payload_message, 0, &payload_message_size);
                 if (ddf_result != dmDDF::RESULT_OK)
@@ -409,8 +412,8 @@ namespace dmGameObject
                 uint32_t new_message_size = sizeof(dmMessage::Message) + payload_message_size;
                 message = (dmMessage::Message*)malloc(new_message_size);
 
-                message->m_Sender       = params.m_Message->m_Sender;
-                message->m_Receiver     = params.m_Message->m_Receiver;
+                message->m_Sender       = posted_message->m_Sender;
+                message->m_Receiver     = posted_message->m_Receiver;
                 message->m_Id           = descriptor->m_NameHash;
                 message->m_DataSize     = payload_message_size;
                 message->m_Descriptor   = (uintptr_t)descriptor;
@@ -433,23 +436,23 @@ namespace dmGameObject
                     function_ref = script_instance->m_Script->m_FunctionReferences[SCRIPT_FUNCTION_ONMESSAGE];
                 }
             }
-            else if (params.m_Message->m_Id == dmGameObjectDDF::ScriptUnrefMessage::m_DDFDescriptor->m_NameHash)
+            else if (posted_message->m_Id == dmGameObjectDDF::ScriptUnrefMessage::m_DDFDescriptor->m_NameHash)
             {
-                dmGameObjectDDF::ScriptUnrefMessage* unref_message = (dmGameObjectDDF::ScriptUnrefMessage*) params.m_Message->m_Data;
-                return HandleUnrefMessage(params.m_Context, script_instance, unref_message->m_Reference + LUA_NOREF);
+                dmGameObjectDDF::ScriptUnrefMessage* unref_message = (dmGameObjectDDF::ScriptUnrefMessage*) posted_message->m_Data;
+                return HandleUnrefMessage(context, script_instance, unref_message->m_Reference + LUA_NOREF);
             }
         }
 
         // Is it using the old code path?
         if (!payload_message)
         {
-            message = params.m_Message;
+            message = posted_message;
 
             // We added m_UserData2 just to make it easier to specify, and to keep Lua away from the dmMessage::URL struct
             // We should move towards the dmGameObjectDDF::ScriptMessage as it's type safe
-            if (params.m_Message->m_UserData2) // Deprecated. Use dmGameObject::PostDDF() instead
+            if (posted_message->m_UserData2) // Deprecated. Use dmGameObject::PostDDF() instead
             {
-                function_ref = params.m_Message->m_UserData2 + LUA_NOREF;
+                function_ref = posted_message->m_UserData2 + LUA_NOREF;
                 is_callback = true;
             } else {
                 function_ref = script_instance->m_Script->m_FunctionReferences[SCRIPT_FUNCTION_ONMESSAGE];
@@ -458,7 +461,7 @@ namespace dmGameObject
 
         if (function_ref != LUA_NOREF)
         {
-            result = HandleMessage(params.m_Context, script_instance, message, function_ref, is_callback, deref_function_ref);
+            result = HandleMessage(context, script_instance, message, function_ref, is_callback, deref_function_ref);
         }
 
         if (payload_message)
@@ -470,6 +473,131 @@ namespace dmGameObject
         return result;
     }
 
+    UpdateResult CompScriptOnMessage(const ComponentOnMessageParams& params)
+    {
+        DM_PROFILE("RunScript");
+        ScriptInstance* script_instance = (ScriptInstance*)*params.m_UserData;
+        lua_State* L = GetLuaState(params.m_Context);
+
+        SetCurrentInstance(L, script_instance);
+        UpdateResult result = OnMessage(params.m_Context, script_instance, params.m_Message);
+        ClearCurrentInstance(L);
+        return result;
+    }
+
+    // Messages that are passed as they are to the on_message function of the script, i.e. that are not
+    // callbacks, script messages with a payload or unref messages. See OnMessage()
+    static bool IsOnMessageOnly(dmMessage::Message* message)
+    {
+        if (message->m_UserData2)
+        {
+            return false;
+        }
+        if (message->m_Descriptor != 0)
+        {
+            return message->m_Id != dmGameObjectDDF::ScriptMessage::m_DDFDescriptor->m_NameHash
+                && message->m_Id != dmGameObjectDDF::ScriptUnrefMessage::m_DDFDescriptor->m_NameHash;
+        }
+        return true;
+    }
+
+    struct OnMessageSpan
+    {
+        ScriptInstance*      m_Instance;
+        dmMessage::Message** m_Messages;
+        uint32_t             m_Count;
+        uint32_t             m_Next; // The next message to pass to on_message, kept when a call fails
+    };
+
+    // Calls on_message for each message in the span, from within a single protected call
+    static int CallOnMessageSpan(lua_State* L)
+    {
+        OnMessageSpan* span = (OnMessageSpan*) lua_touserdata(L, 1);
+        ScriptInstance* script_instance = span->m_Instance;
+        while (span->m_Next < span->m_Count)
+        {
+            dmMessage::Message* message = span->m_Messages[span->m_Next++];
+            int function_ref = script_instance->m_Script->m_FunctionReferences[SCRIPT_FUNCTION_ONMESSAGE];
+            if (function_ref == LUA_NOREF)
+            {
+                continue;
+            }
+            lua_rawgeti(L, LUA_REGISTRYINDEX, function_ref);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, script_instance->m_InstanceReference);
+            PushMessage(L, message);
+            lua_call(L, 4, 0);
+        }
+        return 0;
+    }
+
+    static UpdateResult HandleMessageSpan(void* context, ScriptInstance* script_instance, dmMessage::Message** messages, uint32_t message_count)
+    {
+        UpdateResult result = UPDATE_RESULT_OK;
+
+        lua_State* L = GetLuaState(context);
+        DM_LUA_STACK_CHECK(L, 0);
+
+        OnMessageSpan span;
+        span.m_Instance = script_instance;
+        span.m_Messages = messages;
+        span.m_Count = message_count;
+        span.m_Next = 0;
+
+        char buffer[128];
+        const char* profiler_string = dmScript::GetProfilerString(L, 0, script_instance->m_Script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[SCRIPT_FUNCTION_ONMESSAGE], 0, buffer, sizeof(buffer));
+        DM_PROFILE_DYN(profiler_string, 0);
+
+        // An error only stops the message that raised it, the call is made again for the rest
+        while (span.m_Next < span.m_Count)
+        {
+            lua_pushcfunction(L, CallOnMessageSpan);
+            lua_pushlightuserdata(L, &span);
+            if (dmScript::PCall(L, 1, 0) != 0)
+            {
+                result = UPDATE_RESULT_UNKNOWN_ERROR;
+            }
+        }
+        return result;
+    }
+
+    UpdateResult CompScriptOnMessageBatch(const ComponentOnMessageBatchParams& params)
+    {
+        DM_PROFILE("RunScript");
+        ScriptInstance* script_instance = (ScriptInstance*)*params.m_UserData;
+        lua_State* L = GetLuaState(params.m_Context);
+
+        // Consecutive messages to on_message are passed with one call into Lua. The other messages need
+        // the per message handling in OnMessage().
+        UpdateResult result = UPDATE_RESULT_OK;
+        SetCurrentInstance(L, script_instance);
+        uint32_t i = 0;
+        while (i < params.m_MessageCount)
+        {
+            UpdateResult message_result;
+            uint32_t end = i;
+            while (end < params.m_MessageCount && IsOnMessageOnly(params.m_Messages[end]))
+            {
+                ++end;
+            }
+            if (end > i)
+            {
+                message_result = HandleMessageSpan(params.m_Context, script_instance, params.m_Messages + i, end - i);
+                i = end;
+            }
+            else
+            {
+                message_result = OnMessage(params.m_Context, script_instance, params.m_Messages[i]);
+                ++i;
+            }
+            if (message_result != UPDATE_RESULT_OK)
+            {
+                result = UPDATE_RESULT_UNKNOWN_ERROR;
+            }
+        }
+        ClearCurrentInstance(L);
+        return result;
+    }
+
     InputResult CompScriptOnInput(const ComponentOnInputParams& params)
     {
         DM_PROFILE("RunScript");
@@ -51,6 +51,7 @@ namespace dmGameObject
 {
     const char* COLLECTION_MAX_INSTANCES_KEY = "collection.max_instances";
     const char* COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY = "collection.max_input_stack_entries";
+    const char* COLLECTION_BATCH_MESSAGES_KEY = "collection.batch_messages";
     const dmhash_t UNNAMED_IDENTIFIER = dmHashBuffer64("__unnamed__", strlen("__unnamed__"));
     const dmhash_t GAME_OBJECT_EXT = dmHashString64("goc");
     const char* ID_SEPARATOR = "/";
@@ -88,6 +89,7 @@ namespace dmGameObject
 
     static Collection* AllocCollection(const char* name, HRegister regist, uint32_t max_instances, dmGameObjectDDF::CollectionDesc* collection_desc);
     static void DeallocCollection(Collection* collection);
+    static void DeleteFreeInstances(Collection* collection);
     static bool InitCollection(Collection* collection);
     static bool FinalCollection(Collection* collection);
 
@@ -184,6 +186,8 @@ namespace dmGameObject
         m_ComponentTypeCount = 0;
         m_DefaultCollectionCapacity = DEFAULT_MAX_COLLECTION_CAPACITY;
         m_DefaultInputStackCapacity = DEFAULT_MAX_INPUT_STACK_CAPACITY;
+        m_JobThread = 0;
+        m_BatchMessages = false;
         m_Mutex = dmMutex::New();
     }
 
@@ -215,8 +219,23 @@ namespace dmGameObject
         m_Instances.SetCapacity(max_instances);
         m_Instances.SetSize(max_instances);
         m_InstanceIndices.SetCapacity(max_instances);
+        m_Positions.SetCapacity(max_instances);
+        m_Positions.SetSize(max_instances);
+        m_Rotations.SetCapacity(max_instances);
+        m_Rotations.SetSize(max_instances);
+        m_Scales.SetCapacity(max_instances);
+        m_Scales.SetSize(max_instances);
+        m_EulerRotations.SetCapacity(max_instances);
+        m_EulerRotations.SetSize(max_instances);
+        m_PrevEulerRotations.SetCapacity(max_instances);
+        m_PrevEulerRotations.SetSize(max_instances);
         m_WorldTransforms.SetCapacity(max_instances);
         m_WorldTransforms.SetSize(max_instances);
+        m_PrevLocalTransforms.SetCapacity(max_instances);
+        m_PrevLocalTransforms.SetSize(max_instances);
+        m_TransformFlags.SetCapacity(max_instances);
+        m_TransformFlags.SetSize(max_instances);
+        m_DirtyTransformIndices.SetCapacity(max_instances);
         m_IDToInstance.SetCapacity(dmMath::Max(1U, max_instances/3), max_instances);
         m_InputFocusStack.SetCapacity(max_input_stack_entries);
         m_NameHash = 0;
@@ -235,6 +254,7 @@ namespace dmGameObject
         m_Initialized = 0;
         m_FixedAccumTime = 0.0f;
         m_FirstUpdate = 1;
+        m_FreeInstanceCount = 0;
 
         m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
         m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
@@ -244,6 +264,7 @@ namespace dmGameObject
 
         memset(&m_Instances[0], 0, sizeof(Instance*) * max_instances);
         memset(&m_WorldTransforms[0], 0xcc, sizeof(dmTransform::Transform) * max_instances);
+        memset(&m_TransformFlags[0], TRANSFORM_FLAG_FORCE_UPDATE, sizeof(uint8_t) * max_instances);
         memset(&m_LevelIndices[0], 0, sizeof(m_LevelIndices));
     }
 
@@ -256,6 +277,18 @@ namespace dmGameObject
         return RESULT_OK;
     }
 
+    void SetJobThreadContext(HRegister regist, dmJobThread::HContext job_thread)
+    {
+        assert(regist != 0x0);
+        regist->m_JobThread = job_thread;
+    }
+
+    void SetMessageBatching(HRegister regist, bool enabled)
+    {
+        assert(regist != 0x0);
+        regist->m_BatchMessages = enabled;
+    }
+
     uint32_t GetCollectionDefaultCapacity(HRegister regist)
     {
         assert(regist != 0x0);
@@ -410,6 +443,7 @@ namespace dmGameObject
             if (regist->m_ComponentTypes[i].m_DeleteWorldFunction)
                 regist->m_ComponentTypes[i].m_DeleteWorldFunction(params);
         }
+        DeleteFreeInstances(collection);
         dmMutex::Delete(collection->m_Mutex);
         delete collection;
     }
@@ -698,12 +732,12 @@ namespace dmGameObject
          * Remove instance from m_LevelIndices using an erase-swap operation
          */
 
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<InstanceIndex>& level = collection->m_LevelIndices[instance->m_Depth];
         assert(level.Size() > 0);
         assert(instance->m_LevelIndex < level.Size());
 
-        uint16_t level_index = instance->m_LevelIndex;
-        uint16_t swap_in_index = level.EraseSwap(level_index);
+        InstanceIndex level_index = instance->m_LevelIndex;
+        InstanceIndex swap_in_index = level.EraseSwap(level_index);
         HInstance swap_in_instance = collection->m_Instances[swap_in_index];
         assert(swap_in_instance->m_Index == swap_in_index);
         swap_in_instance->m_LevelIndex = level_index;
@@ -715,7 +749,7 @@ namespace dmGameObject
      * ** 10 elements as min
      * ** Up to max_instances as max
      */
-    static void ExpandLevel(dmArray<uint16_t>& level, uint32_t max_instances)
+    static void ExpandLevel(dmArray<InstanceIndex>& level, uint32_t max_instances)
     {
         const uint32_t min_offset = 10;
         const uint32_t max_offset = max_instances - level.Capacity();
@@ -728,18 +762,38 @@ namespace dmGameObject
         /*
          * Insert instance in m_LevelIndices at level set in instance->m_Depth
          */
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<InstanceIndex>& level = collection->m_LevelIndices[instance->m_Depth];
         if (level.Full())
             ExpandLevel(level, collection->m_MaxInstances);
         assert(!level.Full());
 
-        uint16_t level_index = (uint16_t)level.Size();
+        InstanceIndex level_index = (InstanceIndex)level.Size();
         level.SetSize(level_index + 1);
         level[level_index] = instance->m_Index;
         instance->m_LevelIndex = level_index;
+
+        // New parent, or a new instance altogether
+        collection->m_TransformFlags[instance->m_Index] = TRANSFORM_FLAG_FORCE_UPDATE;
+        MarkTransformDirty(collection, instance->m_Index);
     }
 
-    static HInstance AllocInstance(Prototype* proto, const char* prototype_name) {
+    // Releases recycled instance memory until at most max_count blocks are left
+    static void TrimFreeInstances(Collection* collection, uint32_t max_count) {
+        dmArray<void*>& free_instances = collection->m_FreeInstances;
+        for (uint32_t i = free_instances.Size(); i > 0 && collection->m_FreeInstanceCount > max_count; --i)
+        {
+            void*& head = free_instances[i - 1];
+            while (head && collection->m_FreeInstanceCount > max_count)
+            {
+                void* next = *(void**)head;
+                operator delete (head);
+                head = next;
+                collection->m_FreeInstanceCount--;
+            }
+        }
+    }
+
+    static HInstance AllocInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
         // Count number of component userdata fields required
         uint32_t component_instance_userdata_count = 0;
         for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
@@ -755,23 +809,84 @@ namespace dmGameObject
                 component_instance_userdata_count++;
         }
 
-        uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
-        // NOTE: Allocate actual Instance with *all* component instance user-data accounted
-        void* instance_memory = ::operator new (sizeof(Instance) + component_instance_userdata_count * component_userdata_size);
+        // Reuse the memory of a deleted instance of the same size, to avoid hitting the allocator when spawning
+        // and deleting many instances from the same prototypes
+        void* instance_memory = 0;
+        dmArray<void*>& free_instances = collection->m_FreeInstances;
+        if (component_instance_userdata_count < free_instances.Size() && free_instances[component_instance_userdata_count] != 0)
+        {
+            instance_memory = free_instances[component_instance_userdata_count];
+            free_instances[component_instance_userdata_count] = *(void**)instance_memory;
+            collection->m_FreeInstanceCount--;
+        }
+        else
+        {
+            // Keep the live and the recycled instances within the size of the collection, see FreeInstanceMemory()
+            uint32_t remaining = collection->m_InstanceIndices.Remaining();
+            TrimFreeInstances(collection, remaining > 0 ? remaining - 1 : 0);
+
+            uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
+            // NOTE: Allocate actual Instance with *all* component instance user-data accounted
+            instance_memory = ::operator new (sizeof(Instance) + component_instance_userdata_count * component_userdata_size);
+        }
         Instance* instance = new(instance_memory) Instance(proto);
         instance->m_ComponentInstanceUserDataCount = component_instance_userdata_count;
         return instance;
     }
 
-    static void DeallocInstance(HInstance instance) {
+    static void FreeInstanceMemory(Collection* collection, HInstance instance) {
+        uint32_t component_instance_userdata_count = instance->m_ComponentInstanceUserDataCount;
+        void* instance_memory = (void*) instance;
+
+        // Bound the recycled memory so that the live and the recycled instances together never take more memory
+        // than a full collection. Otherwise spawning many instances of one prototype and then of another would
+        // keep the memory of both until the collection is deleted. See also AllocInstance().
+        if (collection->m_FreeInstanceCount >= collection->m_InstanceIndices.Remaining())
+        {
+            operator delete (instance_memory);
+            return;
+        }
+
+        dmArray<void*>& free_instances = collection->m_FreeInstances;
+        if (component_instance_userdata_count >= free_instances.Size())
+        {
+            uint32_t old_size = free_instances.Size();
+            free_instances.SetCapacity(component_instance_userdata_count + 1);
+            free_instances.SetSize(component_instance_userdata_count + 1);
+            memset(&free_instances[old_size], 0, (free_instances.Size() - old_size) * sizeof(void*));
+        }
+        *(void**)instance_memory = free_instances[component_instance_userdata_count];
+        free_instances[component_instance_userdata_count] = instance_memory;
+        collection->m_FreeInstanceCount++;
+    }
+
+    static void DeallocInstance(Collection* collection, HInstance instance) {
         instance->~Instance();
         void* instance_memory = (void*) instance;
+        uint32_t component_instance_userdata_count = instance->m_ComponentInstanceUserDataCount;
 
         // This is required for failing test
         // TODO: #ifdef on something...?
         // Clear all memory excluding ComponentInstanceUserData
         memset(instance_memory, 0xcc, sizeof(Instance));
-        operator delete (instance_memory);
+        ((Instance*)instance_memory)->m_ComponentInstanceUserDataCount = component_instance_userdata_count;
+        FreeInstanceMemory(collection, (Instance*)instance_memory);
+    }
+
+    static void DeleteFreeInstances(Collection* collection) {
+        dmArray<void*>& free_instances = collection->m_FreeInstances;
+        for (uint32_t i = 0; i < free_instances.Size(); ++i)
+        {
+            void* instance_memory = free_instances[i];
+            while (instance_memory)
+            {
+                void* next = *(void**)instance_memory;
+                operator delete (instance_memory);
+                instance_memory = next;
+            }
+        }
+        free_instances.SetSize(0);
+        collection->m_FreeInstanceCount = 0;
     }
 
     HInstance NewInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
@@ -780,13 +895,14 @@ namespace dmGameObject
             dmLogError("The game object instance could not be created since the buffer is full (%d). Increase the capacity with collection.max_instances", collection->m_InstanceIndices.Capacity());
             return 0;
         }
-        HInstance instance = AllocInstance(proto, prototype_name);
+        HInstance instance = AllocInstance(collection, proto, prototype_name);
         instance->m_Collection = collection;
         instance->m_ScaleAlongZ = collection->m_ScaleAlongZ;
-        uint16_t instance_index = collection->m_InstanceIndices.Pop();
+        InstanceIndex instance_index = collection->m_InstanceIndices.Pop();
         instance->m_Index = instance_index;
         assert(collection->m_Instances[instance_index] == 0);
         collection->m_Instances[instance_index] = instance;
+        ResetLocalTransform(collection, instance_index);
 
         InsertInstanceInLevelIndex(collection, instance);
 
@@ -808,8 +924,8 @@ namespace dmGameObject
             Unlink(collection, instance);
         }
 
-        uint16_t instance_index = instance->m_Index;
-        operator delete ((void*)instance);
+        InstanceIndex instance_index = instance->m_Index;
+        FreeInstanceMemory(collection, instance);
         collection->m_Instances[instance_index] = 0x0;
         collection->m_InstanceIndices.Push(instance_index);
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
@@ -819,6 +935,32 @@ namespace dmGameObject
         UndoNewInstance(hcollection->m_Collection, instance);
     }
 
+    // Destroys the first component_count components of an instance that could not be fully created
+    static void DestroyCreatedComponents(Collection* collection, HInstance instance, uint32_t component_count) {
+        Prototype* proto = instance->m_Prototype;
+        uint32_t next_component_instance_data = 0;
+        for (uint32_t i = 0; i < component_count; ++i)
+        {
+            Prototype::Component* component = &proto->m_Components[i];
+            ComponentType* component_type = component->m_Type;
+            assert(component_type);
+            uintptr_t* component_instance_data = 0;
+            if (component_type->m_InstanceHasUserData)
+            {
+                component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data++];
+            }
+            assert(next_component_instance_data <= instance->m_ComponentInstanceUserDataCount);
+
+            ComponentDestroyParams params;
+            params.m_Collection = collection->m_HCollection;
+            params.m_Instance = instance;
+            params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+            params.m_Context = component_type->m_Context;
+            params.m_UserData = component_instance_data;
+            component_type->m_DestroyFunction(params);
+        }
+    }
+
     bool CreateComponents(Collection* collection, HInstance instance) {
         DM_PROFILE("CreateComponents");
 
@@ -871,27 +1013,7 @@ namespace dmGameObject
 
         if (!ok)
         {
-            uint32_t next_component_instance_data = 0;
-            for (uint32_t i = 0; i < components_created; ++i)
-            {
-                Prototype::Component* component = &proto->m_Components[i];
-                ComponentType* component_type = component->m_Type;
-                assert(component_type);
-                uintptr_t* component_instance_data = 0;
-                if (component_type->m_InstanceHasUserData)
-                {
-                    component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data++];
-                }
-                assert(next_component_instance_data <= instance->m_ComponentInstanceUserDataCount);
-
-                ComponentDestroyParams params;
-                params.m_Collection = collection->m_HCollection;
-                params.m_Instance = instance;
-                params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
-                params.m_Context = component_type->m_Context;
-                params.m_UserData = component_instance_data;
-                component_type->m_DestroyFunction(params);
-            }
+            DestroyCreatedComponents(collection, instance, components_created);
         }
 
         return ok;
@@ -999,6 +1121,15 @@ namespace dmGameObject
         ReleaseInstanceIndex(index, hcollection->m_Collection);
     }
 
+    uint32_t GetRemainingInstanceCount(HCollection hcollection)
+    {
+        Collection* collection = hcollection->m_Collection;
+        dmMutex::Lock(collection->m_Mutex);
+        uint32_t remaining = dmMath::Min((uint32_t) collection->m_InstanceIdPool.Remaining(), (uint32_t) collection->m_InstanceIndices.Remaining());
+        dmMutex::Unlock(collection->m_Mutex);
+        return remaining;
+    }
+
     void AssignInstanceIndex(uint32_t index, HInstance instance)
     {
         if (instance != 0x0)
@@ -1055,8 +1186,8 @@ namespace dmGameObject
             return;
         }
         instance->m_ToBeAdded = 1;
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToAddTail;
+        InstanceIndex index = instance->m_Index;
+        InstanceIndex tail = collection->m_InstancesToAddTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToAdd = index;
@@ -1116,7 +1247,7 @@ namespace dmGameObject
             dmLogError("Instances can not be added to update during the update.");
             return false;
         }
-        uint16_t index = collection->m_InstancesToAddHead;
+        InstanceIndex index = collection->m_InstancesToAddHead;
         bool result = true;
         while (index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[index];
@@ -1187,7 +1318,7 @@ namespace dmGameObject
         SetPosition(instance, position);
         SetRotation(instance, rotation);
         SetScale(instance, scale);
-        collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(instance->m_Transform);
+        collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(GetLocalTransform(instance));
 
         dmHashInit64(&instance->m_CollectionPathHashState, true);
         dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, ID_SEPARATOR, strlen(ID_SEPARATOR));
@@ -1375,7 +1506,7 @@ namespace dmGameObject
             if (scale.getX() == 0 && scale.getY() == 0 && scale.getZ() == 0)
                     scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
 
-            instance->m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+            SetLocalTransform(instance, dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale));
             dmHashClone64(&instance->m_CollectionPathHashState, &prefixHashState, true);
 
             const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
@@ -1465,11 +1596,11 @@ namespace dmGameObject
         {
             if (!GetParent(new_instances[i]))
             {
-                new_instances[i]->m_Transform = dmTransform::Mul(transform, new_instances[i]->m_Transform);
+                SetLocalTransform(new_instances[i], dmTransform::Mul(transform, GetLocalTransform(new_instances[i])));
             }
 
             // world transforms need to be up to date in time for the script init calls
-            collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(new_instances[i]->m_Transform);
+            collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(GetLocalTransform(new_instances[i]));
         }
 
         // Create components and set properties
@@ -1663,6 +1794,216 @@ namespace dmGameObject
         return instance;
     }
 
+    uint32_t SpawnBatch(HCollection hcollection, HPrototype proto, const char* prototype_name, uint32_t count, HPropertyContainer property_container,
+                        const Point3* positions, const Quat* rotations, const Vector3* scales, HInstance* out_instances)
+    {
+        DM_PROFILE("SpawnBatch");
+
+        if (proto == 0x0) {
+            dmLogError("No prototype to spawn from.");
+            return 0;
+        }
+
+        Collection* collection = hcollection->m_Collection;
+        if (collection->m_ToBeDeleted) {
+            dmLogWarning("Spawning is not allowed when the collection is being deleted.");
+            return 0;
+        }
+
+        if (proto->m_ComponentCount > 0xFFFF) {
+            dmLogWarning("Too many components in game object: %u (max is 65536)", proto->m_ComponentCount);
+            return 0;
+        }
+
+        // Check the capacity once, rather than failing for each instance
+        uint32_t remaining = collection->m_InstanceIndices.Remaining();
+        if (count > remaining)
+        {
+            dmLogError("Only %u of %u instances of prototype %s could be spawned since the buffer is full (%d). Increase the capacity with collection.max_instances", remaining, count, prototype_name, collection->m_InstanceIndices.Capacity());
+            count = remaining;
+        }
+
+        // Acquire all the instance ids with a single lock
+        dmArray<uint32_t> id_indices;
+        id_indices.SetCapacity(count);
+        dmMutex::Lock(collection->m_Mutex);
+        while (id_indices.Size() < count && collection->m_InstanceIdPool.Remaining() > 0)
+        {
+            id_indices.Push(collection->m_InstanceIdPool.Pop());
+        }
+        dmMutex::Unlock(collection->m_Mutex);
+
+        count = id_indices.Size();
+
+        // The spawning is done in phases over the whole batch, so that the per component setup is done once per
+        // component rather than once per instance, and each component world handles all of its creates in one go.
+        // out_instances[i] is set to 0 for instances that fail to spawn, and the list is compacted at the end.
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out_instances[i] = 0;
+            HInstance instance = NewInstance(collection, proto, prototype_name);
+            if (instance == 0) {
+                continue;
+            }
+
+            dmResource::IncRef(collection->m_Factory, proto);
+
+            SetPosition(instance, positions[i]);
+            SetRotation(instance, rotations[i]);
+            SetScale(instance, scales[i]);
+            collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(GetLocalTransform(instance));
+
+            dmHashInit64(&instance->m_CollectionPathHashState, true);
+            dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, ID_SEPARATOR, strlen(ID_SEPARATOR));
+
+            dmhash_t id = ConstructInstanceId(id_indices[i]);
+            if (SetIdentifier(collection, instance, id) == RESULT_IDENTIFIER_IN_USE)
+            {
+                dmLogError("The identifier '%s' is already in use.", dmHashReverseSafe64(id));
+                UndoNewInstance(collection, instance);
+                continue;
+            }
+            out_instances[i] = instance;
+        }
+
+        uint32_t component_count = proto->m_ComponentCount;
+        uint32_t next_component_instance_data = 0;
+        for (uint32_t c = 0; c < component_count; ++c)
+        {
+            Prototype::Component* component = &proto->m_Components[c];
+            ComponentType* component_type = component->m_Type;
+            assert(component_type);
+
+            DM_PROFILE_DYN(component_type->m_Name, 0);
+
+            // The component user-data has the same slot in all instances of the prototype
+            int32_t user_data_slot = component_type->m_InstanceHasUserData ? (int32_t) next_component_instance_data++ : -1;
+
+            ComponentCreateParams params;
+            params.m_Position = component->m_Position;
+            params.m_Rotation = component->m_Rotation;
+            params.m_Scale = component->m_Scale;
+            params.m_ComponentIndex = c;
+            params.m_Resource = component->m_Resource;
+            params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+            params.m_Context = component_type->m_Context;
+            params.m_PropertySet = component->m_PropertySet;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                HInstance instance = out_instances[i];
+                if (instance == 0) {
+                    continue;
+                }
+
+                uintptr_t* component_instance_data = 0;
+                if (user_data_slot >= 0)
+                {
+                    component_instance_data = &instance->m_ComponentInstanceUserData[user_data_slot];
+                    *component_instance_data = 0;
+                }
+                params.m_Instance = instance;
+                params.m_UserData = component_instance_data;
+                if (component_type->m_CreateFunction(params) != CREATE_RESULT_OK)
+                {
+                    DestroyCreatedComponents(collection, instance, c);
+                    ReleaseIdentifier(collection, instance);
+                    UndoNewInstance(collection, instance);
+                    out_instances[i] = 0;
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            HInstance instance = out_instances[i];
+            if (instance == 0) {
+                continue;
+            }
+            if (!SetScriptPropertiesFromBuffer(instance, prototype_name, property_container))
+            {
+                Delete(collection, instance, false);
+                out_instances[i] = 0;
+                continue;
+            }
+            // The world transforms are already up to date, since the instances have no parents
+            instance->m_Initialized = 1;
+        }
+
+        // Instances that fail to initialize still have all their components initialized, as in InitComponents()
+        dmArray<uint8_t> init_failed;
+        init_failed.SetCapacity(count);
+        init_failed.SetSize(count);
+        memset(init_failed.Begin(), 0, count);
+        next_component_instance_data = 0;
+        for (uint32_t c = 0; c < component_count; ++c)
+        {
+            Prototype::Component* component = &proto->m_Components[c];
+            ComponentType* component_type = component->m_Type;
+            int32_t user_data_slot = component_type->m_InstanceHasUserData ? (int32_t) next_component_instance_data++ : -1;
+            if (!component_type->m_InitFunction)
+            {
+                continue;
+            }
+
+            ComponentInitParams params;
+            params.m_Collection = collection->m_HCollection;
+            params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+            params.m_Context = component_type->m_Context;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                HInstance instance = out_instances[i];
+                if (instance == 0) {
+                    continue;
+                }
+                params.m_Instance = instance;
+                params.m_UserData = user_data_slot >= 0 ? &instance->m_ComponentInstanceUserData[user_data_slot] : 0;
+                if (component_type->m_InitFunction(params) != CREATE_RESULT_OK)
+                {
+                    init_failed[i] = 1;
+                }
+            }
+        }
+
+        uint32_t spawned = 0;
+        uint32_t unused = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            HInstance instance = out_instances[i];
+            if (instance != 0 && init_failed[i])
+            {
+                dmLogError("Could not initialize when spawning %s.", prototype_name);
+                Delete(collection, instance, false);
+                instance = 0;
+            }
+            if (instance == 0)
+            {
+                // Keep the ids that weren't used at the start of id_indices, to return them to the pool
+                id_indices[unused++] = id_indices[i];
+                continue;
+            }
+            AddToUpdate(collection, instance);
+            instance->m_IdentifierIndex = id_indices[i];
+            out_instances[spawned++] = instance;
+        }
+
+        if (spawned < count)
+        {
+            dmLogError("Could not spawn %u of %u instances of prototype %s.", count - spawned, count, prototype_name);
+        }
+
+        // Return the ids that weren't used
+        if (unused > 0)
+        {
+            dmMutex::Lock(collection->m_Mutex);
+            for (uint32_t i = 0; i < unused; ++i)
+            {
+                collection->m_InstanceIdPool.Push(id_indices[i]);
+            }
+            dmMutex::Unlock(collection->m_Mutex);
+        }
+        return spawned;
+    }
+
     static void MoveDown(Collection* collection, Instance* instance)
     {
         /*
@@ -1749,18 +2090,18 @@ namespace dmGameObject
             Matrix4* trans = &collection->m_WorldTransforms[instance->m_Index];
             if (instance->m_Parent == INVALID_INSTANCE_INDEX)
             {
-                *trans = dmTransform::ToMatrix4(instance->m_Transform);
+                *trans = dmTransform::ToMatrix4(GetLocalTransform(instance));
             }
             else
             {
                 const Matrix4* parent_trans = &collection->m_WorldTransforms[instance->m_Parent];
                 if (instance->m_ScaleAlongZ)
                 {
-                    *trans = (*parent_trans) * dmTransform::ToMatrix4(instance->m_Transform);
+                    *trans = (*parent_trans) * dmTransform::ToMatrix4(GetLocalTransform(instance));
                 }
                 else
                 {
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(instance->m_Transform));
+                    *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(GetLocalTransform(instance)));
                 }
             }
             return InitComponents(collection, instance);
@@ -1919,8 +2260,8 @@ namespace dmGameObject
         // Delete instance
         instance->m_ToBeDeleted = 1;
 
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToDeleteTail;
+        InstanceIndex index = instance->m_Index;
+        InstanceIndex tail = collection->m_InstancesToDeleteTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToDelete = index;
@@ -1937,10 +2278,10 @@ namespace dmGameObject
 
     static void RemoveFromAddToUpdate(Collection* collection, HInstance instance)
     {
-        uint16_t index = instance->m_Index;
+        InstanceIndex index = instance->m_Index;
         assert(collection->m_InstancesToAddTail == index || instance->m_NextToAdd != INVALID_INSTANCE_INDEX);
-        uint16_t* prev_index_ptr = &collection->m_InstancesToAddHead;
-        uint16_t prev_index = *prev_index_ptr;
+        InstanceIndex* prev_index_ptr = &collection->m_InstancesToAddHead;
+        InstanceIndex prev_index = *prev_index_ptr;
         while (prev_index != index) {
             prev_index_ptr = &collection->m_Instances[prev_index]->m_NextToAdd;
             if (collection->m_InstancesToAddTail == *prev_index_ptr) {
@@ -2017,7 +2358,7 @@ namespace dmGameObject
             collection->m_InputFocusStack.Pop();
         }
 
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
 
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
     }
@@ -2182,11 +2523,11 @@ namespace dmGameObject
         return instance->m_Bone;
     }
 
-    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, uint16_t first_index, dmTransform::Transform* transforms, uint32_t transform_count)
+    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, InstanceIndex first_index, dmTransform::Transform* transforms, uint32_t transform_count)
     {
         if (transform_count == 0)
             return 0;
-        uint16_t current_index = first_index;
+        InstanceIndex current_index = first_index;
         uint32_t count = 0;
         Collection* collection = hcollection->m_Collection;
         while (current_index != INVALID_INSTANCE_INDEX)
@@ -2194,10 +2535,11 @@ namespace dmGameObject
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone)
             {
-                instance->m_Transform = transforms[count++];
+                dmTransform::Transform transform = transforms[count++];
                 if (component_transform && count == 1) {
-                    instance->m_Transform = dmTransform::Mul(*component_transform, instance->m_Transform);
+                    transform = dmTransform::Mul(*component_transform, transform);
                 }
+                SetLocalTransform(instance, transform);
                 if (count < transform_count)
                 {
                     count += DoSetBoneTransforms(hcollection, 0x0, instance->m_FirstChildIndex, &transforms[count], transform_count - count);
@@ -2217,8 +2559,8 @@ namespace dmGameObject
         return DoSetBoneTransforms(instance->m_Collection->m_HCollection, &component_transform, instance->m_Index, transforms, transform_count);
     }
 
-    static void DeleteBones(Collection* collection, uint16_t first_index) {
-        uint16_t current_index = first_index;
+    static void DeleteBones(Collection* collection, InstanceIndex first_index) {
+        InstanceIndex current_index = first_index;
         while (current_index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone && instance->m_ToBeDeleted == 0) {
@@ -2240,9 +2582,114 @@ namespace dmGameObject
         bool m_Success;
     };
 
-    void DispatchMessagesFunction(dmMessage::Message* message, void* user_ptr)
+    static void CallOnMessageBatch(DispatchMessagesContext* context, Instance* instance, Prototype::Component* component, uintptr_t* component_instance_data, dmMessage::Message** messages, uint32_t message_count)
+    {
+        ComponentType* component_type = component->m_Type;
+        ComponentOnMessageBatchParams params;
+        params.m_Instance = instance;
+        params.m_World = context->m_Collection->m_ComponentWorlds[component->m_TypeIndex];
+        params.m_Context = component_type->m_Context;
+        params.m_UserData = component_instance_data;
+        params.m_Messages = messages;
+        params.m_MessageCount = message_count;
+        UpdateResult res = component_type->m_OnMessageBatchFunction(params);
+        if (res != UPDATE_RESULT_OK)
+            context->m_Success = false;
+    }
+
+    // Defers the message until FlushMessageBatches(), grouped with the other messages to the same component
+    static void AddToMessageBatch(Collection* collection, Instance* instance, uint16_t component_index, uintptr_t* component_instance_data, dmMessage::Message* message)
+    {
+        dmArray<MessageBatch>& batches = collection->m_MessageBatches;
+        dmHashTable64<uint32_t>& lookup = collection->m_MessageBatchLookup;
+
+        // Instances are never deleted while dispatching, so the index is unique
+        dmhash_t key = ((dmhash_t)instance->m_Index << 16) | component_index;
+        uint32_t* batch_index = lookup.Get(key);
+        if (batch_index == 0x0)
+        {
+            if (lookup.Full())
+            {
+                uint32_t capacity = lookup.Capacity() + 64;
+                lookup.SetCapacity(dmMath::Max(1U, capacity/3), capacity);
+            }
+            if (batches.Full())
+            {
+                batches.OffsetCapacity(64);
+            }
+            MessageBatch batch;
+            batch.m_Instance = instance;
+            batch.m_UserData = component_instance_data;
+            batch.m_First = 0;
+            batch.m_Count = 0;
+            batch.m_ComponentIndex = component_index;
+            batches.Push(batch);
+            lookup.Put(key, batches.Size() - 1);
+            batch_index = lookup.Get(key);
+        }
+        batches[*batch_index].m_Count++;
+
+        if (collection->m_BatchedMessages.Full())
+        {
+            collection->m_BatchedMessages.OffsetCapacity(256);
+            collection->m_BatchedMessageBatch.OffsetCapacity(256);
+        }
+        collection->m_BatchedMessages.Push(message);
+        collection->m_BatchedMessageBatch.Push(*batch_index);
+    }
+
+    // Passes the deferred messages to the OnMessageBatch functions, with one call per component.
+    // Must be called before a message is handled directly, to keep the order relative to e.g. set_parent,
+    // and before dmMessage::Dispatch() returns, since the message memory is reused after that.
+    static void FlushMessageBatches(DispatchMessagesContext* context)
+    {
+        Collection* collection = context->m_Collection;
+        uint32_t message_count = collection->m_BatchedMessages.Size();
+        if (message_count == 0)
+        {
+            return;
+        }
+
+        DM_PROFILE("OnMessageBatchFunction");
+
+        // Counting sort on the batch index. Batches are in the order of their first message,
+        // and the messages within a batch are in the order they were posted.
+        dmArray<MessageBatch>& batches = collection->m_MessageBatches;
+        uint32_t batch_count = batches.Size();
+        uint32_t first = 0;
+        for (uint32_t i = 0; i < batch_count; ++i)
+        {
+            batches[i].m_First = first;
+            first += batches[i].m_Count;
+            batches[i].m_Count = 0;
+        }
+
+        dmArray<dmMessage::Message*>& spans = collection->m_MessageBatchSpans;
+        if (spans.Capacity() < message_count)
+        {
+            spans.SetCapacity(message_count);
+        }
+        spans.SetSize(message_count);
+        for (uint32_t i = 0; i < message_count; ++i)
+        {
+            MessageBatch& batch = batches[collection->m_BatchedMessageBatch[i]];
+            spans[batch.m_First + batch.m_Count++] = collection->m_BatchedMessages[i];
+        }
+        collection->m_BatchedMessages.SetSize(0);
+        collection->m_BatchedMessageBatch.SetSize(0);
+        collection->m_MessageBatchLookup.Clear();
+
+        for (uint32_t i = 0; i < batch_count; ++i)
+        {
+            MessageBatch& batch = batches[i];
+            Prototype::Component* component = &batch.m_Instance->m_Prototype->m_Components[batch.m_ComponentIndex];
+            CallOnMessageBatch(context, batch.m_Instance, component, batch.m_UserData, &spans[batch.m_First], batch.m_Count);
+        }
+        batches.SetSize(0);
+    }
+
+    static void DispatchMessage(DispatchMessagesContext* context, dmMessage::Message* message)
     {
-        DispatchMessagesContext* context = (DispatchMessagesContext*) user_ptr;
         Collection* collection = context->m_Collection;
 
         Instance* instance = GetInstanceFromIdentifier(collection, message->m_Receiver.m_Path);
@@ -2267,16 +2714,19 @@ namespace dmGameObject
             dmDDF::Descriptor* descriptor = (dmDDF::Descriptor*)message->m_Descriptor;
             if (descriptor == dmGameObjectDDF::AcquireInputFocus::m_DDFDescriptor)
             {
+                FlushMessageBatches(context);
                 dmGameObject::AcquireInputFocus(collection, instance);
                 return;
             }
             else if (descriptor == dmGameObjectDDF::ReleaseInputFocus::m_DDFDescriptor)
             {
+                FlushMessageBatches(context);
                 dmGameObject::ReleaseInputFocus(collection, instance);
                 return;
             }
             else if (descriptor == dmGameObjectDDF::SetParent::m_DDFDescriptor)
             {
+                FlushMessageBatches(context);
                 dmGameObjectDDF::SetParent* sp = (dmGameObjectDDF::SetParent*)message->m_Data;
                 dmGameObject::HInstance parent = 0;
                 if (sp->m_ParentId != 0)
@@ -2298,23 +2748,23 @@ namespace dmGameObject
                     Matrix4& world = collection->m_WorldTransforms[instance->m_Index];
                     if (instance->m_ScaleAlongZ)
                     {
-                        world = parent_t * dmTransform::ToMatrix4(instance->m_Transform);
+                        world = parent_t * dmTransform::ToMatrix4(GetLocalTransform(instance));
                     }
                     else
                     {
-                        world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(instance->m_Transform));
+                        world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(GetLocalTransform(instance)));
                     }
                 }
                 else
                 {
                     if (instance->m_ScaleAlongZ)
                     {
-                        instance->m_Transform = dmTransform::ToTransform(inverse(parent_t) * collection->m_WorldTransforms[instance->m_Index]);
+                        SetLocalTransform(instance, dmTransform::ToTransform(inverse(parent_t) * collection->m_WorldTransforms[instance->m_Index]));
                     }
                     else
                     {
                         Matrix4 tmp = dmTransform::MulNoScaleZ(inverse(parent_t), collection->m_WorldTransforms[instance->m_Index]);
-                        instance->m_Transform = dmTransform::ToTransform(tmp);
+                        SetLocalTransform(instance, dmTransform::ToTransform(tmp));
                     }
                 }
 
@@ -2354,7 +2804,7 @@ namespace dmGameObject
             ComponentType* component_type = component->m_Type;
             assert(component_type);
 
-            if (component_type->m_OnMessageFunction)
+            if (component_type->m_OnMessageFunction || component_type->m_OnMessageBatchFunction)
             {
                 // TODO: Not optimal way to find index of component instance data
                 uint32_t next_component_instance_data = 0;
@@ -2373,6 +2823,20 @@ namespace dmGameObject
                 {
                     component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data];
                 }
+
+                // The destroy callback is called as soon as we return, so those messages can't be deferred
+                if (component_type->m_OnMessageBatchFunction && collection->m_Register->m_BatchMessages && message->m_DestroyCallback == 0)
+                {
+                    AddToMessageBatch(collection, instance, component_index, component_instance_data, message);
+                    return;
+                }
+
+                FlushMessageBatches(context);
+                if (!component_type->m_OnMessageFunction)
+                {
+                    CallOnMessageBatch(context, instance, component, component_instance_data, &message, 1);
+                }
+                else
                 {
                     DM_PROFILE("OnMessageFunction");
                     ComponentOnMessageParams params;
@@ -2394,6 +2858,8 @@ namespace dmGameObject
         }
         else // broadcast
         {
+            FlushMessageBatches(context);
+
             uint32_t next_component_instance_data = 0;
             for (uint32_t i = 0; i < prototype->m_ComponentCount; ++i)
             {
@@ -2401,13 +2867,18 @@ namespace dmGameObject
                 ComponentType* component_type = component->m_Type;
                 assert(component_type);
 
-                if (component_type->m_OnMessageFunction)
+                if (component_type->m_OnMessageFunction || component_type->m_OnMessageBatchFunction)
                 {
                     uintptr_t* component_instance_data = 0;
                     if (component_type->m_InstanceHasUserData)
                     {
                         component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data++];
                     }
+                    if (!component_type->m_OnMessageFunction)
+                    {
+                        CallOnMessageBatch(context, instance, component, component_instance_data, &message, 1);
+                    }
+                    else
                     {
                         DM_PROFILE("OnMessageFunction");
                         ComponentOnMessageParams params;
@@ -2432,6 +2903,17 @@ namespace dmGameObject
         }
     }
 
+    void DispatchMessagesFunction(dmMessage::Message* message, void* user_ptr)
+    {
+        DispatchMessagesContext* context = (DispatchMessagesContext*) user_ptr;
+        DispatchMessage(context, message);
+        if (message->m_Next == 0)
+        {
+            // Last message of this dmMessage::Dispatch()
+            FlushMessageBatches(context);
+        }
+    }
+
     static bool DispatchMessages(Collection* collection, dmMessage::HSocket* sockets, uint32_t socket_count)
     {
         DM_PROFILE("DispatchMessages");
@@ -2451,14 +2933,13 @@ namespace dmGameObject
                     continue; // no need to try to update or send anything
                 }
                 // Make sure the transforms are updated if we are about to dispatch messages
-                if (collection->m_DirtyTransforms)
+                if (HasDirtyTransforms(collection))
                 {
                     UpdateTransforms(collection);
                 }
                 uint32_t message_count = dmMessage::Dispatch(sockets[i], &DispatchMessagesFunction, (void*) &ctx);
                 if (message_count)
                 {
-                    collection->m_DirtyTransforms = true;
                     iterate = true;
                 }
             }
@@ -2473,89 +2954,202 @@ namespace dmGameObject
         return DispatchMessages(hcollection->m_Collection, sockets, socket_count);
     }
 
-    static void UpdateEulerToRotation(HInstance instance);
-
     static inline bool Vec3Equals(const uint32_t* a, const uint32_t* b)
     {
         return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
     }
 
+    static inline void UpdateEulerToRotation(Collection* collection, InstanceIndex index)
+    {
+        collection->m_PrevEulerRotations[index] = collection->m_EulerRotations[index];
+        collection->m_Rotations[index] = dmVMath::EulerToQuat(collection->m_EulerRotations[index]);
+    }
+
+    static void UpdateEulerToRotation(HInstance instance)
+    {
+        UpdateEulerToRotation(instance->m_Collection, instance->m_Index);
+    }
+
+
+    static inline bool HasEulerChanged(const Collection* collection, InstanceIndex index)
+    {
+        const Vector3& euler = collection->m_EulerRotations[index];
+        const Vector3& prev_euler = collection->m_PrevEulerRotations[index];
+        return !Vec3Equals((const uint32_t*)(&euler), (const uint32_t*)(&prev_euler));
+    }
+
     static bool HasEulerChanged(Instance* instance)
     {
-        Vector3& euler = instance->m_EulerRotation;
-        Vector3& prev_euler = instance->m_PrevEulerRotation;
-        return !Vec3Equals((uint32_t*)(&euler), (uint32_t*)(&prev_euler));
+        return HasEulerChanged(instance->m_Collection, instance->m_Index);
     }
 
-    static void CheckEuler(Instance* instance)
+    static inline void CheckEuler(Collection* collection, InstanceIndex index)
     {
-        if (HasEulerChanged(instance))
+        if (HasEulerChanged(collection, index))
         {
-            UpdateEulerToRotation(instance);
+            UpdateEulerToRotation(collection, index);
         }
     }
 
-    void UpdateTransforms(Collection* collection)
+    static inline bool TransformEquals(const dmTransform::Transform& a, const dmTransform::Transform& b)
     {
-        DM_PROFILE("UpdateTransforms");
+        const uint32_t* ta = (const uint32_t*)a.GetPositionPtr();
+        const uint32_t* tb = (const uint32_t*)b.GetPositionPtr();
+        const uint32_t* ra = (const uint32_t*)a.GetRotationPtr();
+        const uint32_t* rb = (const uint32_t*)b.GetRotationPtr();
+        const uint32_t* sa = (const uint32_t*)a.GetScalePtr();
+        const uint32_t* sb = (const uint32_t*)b.GetScalePtr();
+        return Vec3Equals(ta, tb) && Vec3Equals(sa, sb) && ra[0] == rb[0] && ra[1] == rb[1] && ra[2] == rb[2] && ra[3] == rb[3];
+    }
+
+    // Levels smaller than this are updated on the calling thread
+    static const uint32_t TRANSFORM_PARALLEL_MIN_LEVEL_SIZE = 1024;
+    static const uint32_t TRANSFORM_PARALLEL_GRAIN = 256;
+
+    struct UpdateTransformsLevelContext
+    {
+        Collection*     m_Collection;
+        const InstanceIndex* m_Indices;
+        bool            m_Root;
+    };
+
+    // Updates the world transforms of the instances in a level, in the range [start, end)
+    // Only the world transform and state of the instance itself is written, and the parents
+    // are in the previous level, so disjoint ranges of a level can be updated in parallel.
+    static void UpdateTransformsLevelRange(void* _context, void* data, uint32_t start, uint32_t end)
+    {
+        UpdateTransformsLevelContext* context = (UpdateTransformsLevelContext*)_context;
+        Collection* collection = context->m_Collection;
+        const InstanceIndex* indices = context->m_Indices;
+        Instance** instances = collection->m_Instances.Begin();
+        const Vector3* positions = collection->m_Positions.Begin();
+        const Quat* rotations = collection->m_Rotations.Begin();
+        const Vector3* scales = collection->m_Scales.Begin();
+        Matrix4* world_transforms = collection->m_WorldTransforms.Begin();
+        dmTransform::Transform* prev_local_transforms = collection->m_PrevLocalTransforms.Begin();
+        uint8_t* flags = collection->m_TransformFlags.Begin();
+        bool scale_along_z = collection->m_ScaleAlongZ;
+
+        for (uint32_t i = start; i < end; ++i)
+        {
+            InstanceIndex index = indices[i];
+            CheckEuler(collection, index);
+
+            InstanceIndex parent_index = instances[index]->m_Parent;
+            bool changed = (flags[index] & TRANSFORM_FLAG_FORCE_UPDATE) != 0;
+            if (!context->m_Root)
+            {
+                assert(parent_index != INVALID_INSTANCE_INDEX);
+                changed |= (flags[parent_index] & TRANSFORM_FLAG_CHANGED) != 0;
+            }
+            else
+            {
+                assert(parent_index == INVALID_INSTANCE_INDEX);
+            }
+            dmTransform::Transform local(positions[index], rotations[index], scales[index]);
+            changed |= !TransformEquals(local, prev_local_transforms[index]);
+
+            if (!changed)
+            {
+                flags[index] = 0;
+                continue;
+            }
+
+            flags[index] = TRANSFORM_FLAG_CHANGED;
+            prev_local_transforms[index] = local;
+
+            Matrix4 own = dmTransform::ToMatrix4(local);
+            if (context->m_Root)
+                world_transforms[index] = own;
+            else if (scale_along_z)
+                world_transforms[index] = world_transforms[parent_index] * own;
+            else
+                world_transforms[index] = dmTransform::MulNoScaleZ(world_transforms[parent_index], own);
+        }
+    }
+
+    // Updates the world transform of an instance, and all of its children.
+    // Clears the dirty flags, so that the children are skipped if they are also in the dirty list.
+    static void UpdateTransformSubtree(Collection* collection, InstanceIndex index, const Matrix4* parent_world)
+    {
+        CheckEuler(collection, index);
+
+        dmTransform::Transform local(collection->m_Positions[index], collection->m_Rotations[index], collection->m_Scales[index]);
+        collection->m_PrevLocalTransforms[index] = local;
+        collection->m_TransformFlags[index] = 0;
+
+        Matrix4& world = collection->m_WorldTransforms[index];
+        Matrix4 own = dmTransform::ToMatrix4(local);
+        if (parent_world == 0x0)
+            world = own;
+        else if (collection->m_ScaleAlongZ)
+            world = *parent_world * own;
+        else
+            world = dmTransform::MulNoScaleZ(*parent_world, own);
 
-        // Calculate world transforms
-        // First root-level instances
-        dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
-        uint32_t root_count = root_level.Size();
-        for (uint32_t i = 0; i < root_count; ++i)
+        InstanceIndex child_index = collection->m_Instances[index]->m_FirstChildIndex;
+        while (child_index != INVALID_INSTANCE_INDEX)
+        {
+            UpdateTransformSubtree(collection, child_index, &world);
+            child_index = collection->m_Instances[child_index]->m_SiblingIndex;
+        }
+    }
+
+    // Only updates the subtrees of the instances that were written to
+    static void UpdateDirtyTransforms(Collection* collection)
+    {
+        dmArray<InstanceIndex>& dirty = collection->m_DirtyTransformIndices;
+        uint32_t dirty_count = dirty.Size();
+        for (uint32_t i = 0; i < dirty_count; ++i)
         {
-            uint16_t index = root_level[i];
+            InstanceIndex index = dirty[i];
             Instance* instance = collection->m_Instances[index];
-            CheckEuler(instance);
-            collection->m_WorldTransforms[index] = dmTransform::ToMatrix4(instance->m_Transform);
-            uint16_t parent_index = instance->m_Parent;
-            assert(parent_index == INVALID_INSTANCE_INDEX);
+            // Skip instances deleted since, or already updated as part of a parent
+            if (instance == 0x0 || (collection->m_TransformFlags[index] & TRANSFORM_FLAG_DIRTY) == 0)
+                continue;
+
+            const Matrix4* parent_world = 0x0;
+            if (instance->m_Parent != INVALID_INSTANCE_INDEX)
+                parent_world = &collection->m_WorldTransforms[instance->m_Parent];
+            UpdateTransformSubtree(collection, index, parent_world);
         }
+        dirty.SetSize(0);
+    }
 
+    void UpdateTransforms(Collection* collection)
+    {
+        DM_PROFILE("UpdateTransforms");
 
-        if (collection->m_ScaleAlongZ) {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
-            {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+        // Walking the dirty subtrees is cheaper than checking every instance, unless a large part of the collection was written to
+        if (!collection->m_DirtyTransforms && collection->m_DirtyTransformIndices.Size() * 4 < collection->m_InstanceIndices.Size())
+        {
+            UpdateDirtyTransforms(collection);
+            return;
+        }
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+        dmJobThread::HContext job_thread = collection->m_Register->m_JobThread;
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = *parent_trans * own;
-                }
-            }
-        } else {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
-            {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+        // Calculate world transforms, level by level, starting with the root-level instances
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            dmArray<InstanceIndex>& level = collection->m_LevelIndices[level_i];
+            uint32_t instance_count = level.Size();
+            if (instance_count == 0)
+                continue;
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+            UpdateTransformsLevelContext context;
+            context.m_Collection = collection;
+            context.m_Indices    = level.Begin();
+            context.m_Root       = level_i == 0;
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, own);
-                }
-            }
+            if (job_thread && instance_count >= TRANSFORM_PARALLEL_MIN_LEVEL_SIZE)
+                dmJobThread::ParallelFor(job_thread, UpdateTransformsLevelRange, &context, 0, instance_count, TRANSFORM_PARALLEL_GRAIN);
+            else
+                UpdateTransformsLevelRange(&context, 0, 0, instance_count);
         }
 
+        // All the dirty flags were cleared above
+        collection->m_DirtyTransformIndices.SetSize(0);
         collection->m_DirtyTransforms = false;
     }
 
@@ -2599,7 +3193,7 @@ namespace dmGameObject
             ComponentType* component_type = &collection->m_Register->m_ComponentTypes[update_index];
 
             // Avoid to call UpdateTransforms for each/all component types.
-            if (component_type->m_ReadsTransforms && collection->m_DirtyTransforms) {
+            if (component_type->m_ReadsTransforms && HasDirtyTransforms(collection)) {
                 UpdateTransforms(collection);
             }
 
@@ -2659,7 +3253,7 @@ namespace dmGameObject
                         ComponentType* component_type = &collection->m_Register->m_ComponentTypes[update_index];
 
                         // Avoid to call UpdateTransforms for each/all component types.
-                        if (component_type->m_ReadsTransforms && collection->m_DirtyTransforms) {
+                        if (component_type->m_ReadsTransforms && HasDirtyTransforms(collection)) {
                             UpdateTransforms(collection);
                         }
 
@@ -2694,7 +3288,7 @@ namespace dmGameObject
         }
 
         collection->m_InUpdate = 0;
-        if (collection->m_DirtyTransforms) {
+        if (HasDirtyTransforms(collection)) {
             UpdateTransforms(collection);
         }
 
@@ -2785,11 +3379,11 @@ namespace dmGameObject
             while (collection->m_InstancesToDeleteHead != INVALID_INSTANCE_INDEX && pass_count < max_pass_count) {
                 ++pass_count;
                 // Save the list and clear the head and tail
-                uint16_t head = collection->m_InstancesToDeleteHead;
+                InstanceIndex head = collection->m_InstancesToDeleteHead;
                 collection->m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
                 collection->m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
 
-                uint16_t index = head;
+                InstanceIndex index = head;
                 while (index != INVALID_INSTANCE_INDEX) {
                     Instance* instance = collection->m_Instances[index];
 
@@ -3031,42 +3625,46 @@ namespace dmGameObject
 
     void SetPosition(HInstance instance, Point3 position)
     {
-        instance->m_Transform.SetTranslation(Vector3(position));
+        instance->m_Collection->m_Positions[instance->m_Index] = Vector3(position);
+        MarkTransformDirty(instance);
     }
 
     Point3 GetPosition(HInstance instance)
     {
-        return Point3(instance->m_Transform.GetTranslation());
+        return Point3(instance->m_Collection->m_Positions[instance->m_Index]);
     }
 
     void SetRotation(HInstance instance, Quat rotation)
     {
-        instance->m_Transform.SetRotation(rotation);
+        instance->m_Collection->m_Rotations[instance->m_Index] = rotation;
+        MarkTransformDirty(instance);
     }
 
     Quat GetRotation(HInstance instance)
     {
-        return instance->m_Transform.GetRotation();
+        return instance->m_Collection->m_Rotations[instance->m_Index];
     }
 
     void SetScale(HInstance instance, float scale)
     {
-        instance->m_Transform.SetUniformScale(scale);
+        instance->m_Collection->m_Scales[instance->m_Index] = Vector3(scale);
+        MarkTransformDirty(instance);
     }
 
     void SetScale(HInstance instance, Vector3 scale)
     {
-        instance->m_Transform.SetScale(scale);
+        instance->m_Collection->m_Scales[instance->m_Index] = scale;
+        MarkTransformDirty(instance);
     }
 
     float GetUniformScale(HInstance instance)
     {
-        return instance->m_Transform.GetUniformScale();
+        return minElem(instance->m_Collection->m_Scales[instance->m_Index]);
     }
 
     Vector3 GetScale(HInstance instance)
     {
-        return instance->m_Transform.GetScale();
+        return instance->m_Collection->m_Scales[instance->m_Index];
     }
 
     Point3 GetWorldPosition(HInstance instance)
@@ -3248,15 +3846,11 @@ namespace dmGameObject
 
     static void UpdateRotationToEuler(HInstance instance)
     {
-        Quat q = instance->m_Transform.GetRotation();
-        instance->m_EulerRotation = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
-        instance->m_PrevEulerRotation = instance->m_EulerRotation;
-    }
-
-    static void UpdateEulerToRotation(HInstance instance)
-    {
-        instance->m_PrevEulerRotation = instance->m_EulerRotation;
-        instance->m_Transform.SetRotation(dmVMath::EulerToQuat(instance->m_EulerRotation));
+        Collection* collection = instance->m_Collection;
+        InstanceIndex index = instance->m_Index;
+        Quat q = collection->m_Rotations[index];
+        collection->m_EulerRotations[index] = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
+        collection->m_PrevEulerRotations[index] = collection->m_EulerRotations[index];
     }
 
     PropertyResult GetProperty(HInstance instance, dmhash_t component_id, dmhash_t property_id, PropertyOptions options, PropertyDesc& out_value)
@@ -3274,55 +3868,55 @@ namespace dmGameObject
             // Scale used to be a uniform scalar, but is now a non-uniform 3-component scale
             if (property_id == PROP_SCALE)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = (float*)&instance->m_Collection->m_Scales[instance->m_Index];
                 out_value.m_ValuePtr = scale;
                 out_value.m_ElementIds[0] = PROP_SCALE_X;
                 out_value.m_ElementIds[1] = PROP_SCALE_Y;
                 out_value.m_ElementIds[2] = PROP_SCALE_Z;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetScale());
+                out_value.m_Variant = PropertyVar(GetScale(instance));
             }
             else if (property_id == PROP_SCALE_X)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = (float*)&instance->m_Collection->m_Scales[instance->m_Index];
                 out_value.m_ValuePtr = scale;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_SCALE_Y)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = (float*)&instance->m_Collection->m_Scales[instance->m_Index];
                 out_value.m_ValuePtr = scale + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_SCALE_Z)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = (float*)&instance->m_Collection->m_Scales[instance->m_Index];
                 out_value.m_ValuePtr = scale + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_POSITION)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = (float*)&instance->m_Collection->m_Positions[instance->m_Index];
                 out_value.m_ValuePtr = position;
                 out_value.m_ElementIds[0] = PROP_POSITION_X;
                 out_value.m_ElementIds[1] = PROP_POSITION_Y;
                 out_value.m_ElementIds[2] = PROP_POSITION_Z;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetTranslation());
+                out_value.m_Variant = PropertyVar(instance->m_Collection->m_Positions[instance->m_Index]);
             }
             else if (property_id == PROP_POSITION_X)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = (float*)&instance->m_Collection->m_Positions[instance->m_Index];
                 out_value.m_ValuePtr = position;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_POSITION_Y)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = (float*)&instance->m_Collection->m_Positions[instance->m_Index];
                 out_value.m_ValuePtr = position + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_POSITION_Z)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = (float*)&instance->m_Collection->m_Positions[instance->m_Index];
                 out_value.m_ValuePtr = position + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
@@ -3332,13 +3926,13 @@ namespace dmGameObject
                 {
                     UpdateEulerToRotation(instance);
                 }
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = (float*)&instance->m_Collection->m_Rotations[instance->m_Index];
                 out_value.m_ValuePtr = rotation;
                 out_value.m_ElementIds[0] = PROP_ROTATION_X;
                 out_value.m_ElementIds[1] = PROP_ROTATION_Y;
                 out_value.m_ElementIds[2] = PROP_ROTATION_Z;
                 out_value.m_ElementIds[3] = PROP_ROTATION_W;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetRotation());
+                out_value.m_Variant = PropertyVar(GetRotation(instance));
             }
             else if (property_id == PROP_ROTATION_X)
             {
@@ -3346,7 +3940,7 @@ namespace dmGameObject
                 {
                     UpdateEulerToRotation(instance);
                 }
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = (float*)&instance->m_Collection->m_Rotations[instance->m_Index];
                 out_value.m_ValuePtr = rotation;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
@@ -3356,7 +3950,7 @@ namespace dmGameObject
                 {
                     UpdateEulerToRotation(instance);
                 }
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = (float*)&instance->m_Collection->m_Rotations[instance->m_Index];
                 out_value.m_ValuePtr = rotation + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
@@ -3366,7 +3960,7 @@ namespace dmGameObject
                 {
                     UpdateEulerToRotation(instance);
                 }
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = (float*)&instance->m_Collection->m_Rotations[instance->m_Index];
                 out_value.m_ValuePtr = rotation + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
@@ -3376,7 +3970,7 @@ namespace dmGameObject
                 {
                     UpdateEulerToRotation(instance);
                 }
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = (float*)&instance->m_Collection->m_Rotations[instance->m_Index];
                 out_value.m_ValuePtr = rotation + 3;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
@@ -3386,11 +3980,11 @@ namespace dmGameObject
                 {
                     UpdateRotationToEuler(instance);
                 }
-                out_value.m_ValuePtr = (float*)&instance->m_EulerRotation;
+                out_value.m_ValuePtr = (float*)&instance->m_Collection->m_EulerRotations[instance->m_Index];
                 out_value.m_ElementIds[0] = PROP_EULER_X;
                 out_value.m_ElementIds[1] = PROP_EULER_Y;
                 out_value.m_ElementIds[2] = PROP_EULER_Z;
-                out_value.m_Variant = PropertyVar(instance->m_EulerRotation);
+                out_value.m_Variant = PropertyVar(instance->m_Collection->m_EulerRotations[instance->m_Index]);
             }
             else if (property_id == PROP_EULER_X)
             {
@@ -3398,7 +3992,7 @@ namespace dmGameObject
                 {
                     UpdateRotationToEuler(instance);
                 }
-               out_value.m_ValuePtr = ((float*)&instance->m_EulerRotation);
+               out_value.m_ValuePtr = ((float*)&instance->m_Collection->m_EulerRotations[instance->m_Index]);
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_EULER_Y)
@@ -3407,7 +4001,7 @@ namespace dmGameObject
                 {
                     UpdateRotationToEuler(instance);
                 }
-                out_value.m_ValuePtr = ((float*)&instance->m_EulerRotation) + 1;
+                out_value.m_ValuePtr = ((float*)&instance->m_Collection->m_EulerRotations[instance->m_Index]) + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_EULER_Z)
@@ -3416,7 +4010,7 @@ namespace dmGameObject
                 {
                     UpdateRotationToEuler(instance);
                 }
-                out_value.m_ValuePtr = ((float*)&instance->m_EulerRotation) + 2;
+                out_value.m_ValuePtr = ((float*)&instance->m_Collection->m_EulerRotations[instance->m_Index]) + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             if (out_value.m_ValuePtr != 0x0)
@@ -3482,9 +4076,10 @@ namespace dmGameObject
             return PROPERTY_RESULT_INVALID_INSTANCE;
         if (component_id == 0)
         {
-            float* position = instance->m_Transform.GetPositionPtr();
-            float* rotation = instance->m_Transform.GetRotationPtr();
-            float* scale = instance->m_Transform.GetScalePtr();
+            float* position = (float*)&instance->m_Collection->m_Positions[instance->m_Index];
+            float* rotation = (float*)&instance->m_Collection->m_Rotations[instance->m_Index];
+            float* scale = (float*)&instance->m_Collection->m_Scales[instance->m_Index];
+            MarkTransformDirty(instance);
             if (property_id == PROP_POSITION)
             {
                 if (value.m_Type != PROPERTY_TYPE_VECTOR3)
@@ -3596,7 +4191,7 @@ namespace dmGameObject
             {
                 if (value.m_Type != PROPERTY_TYPE_VECTOR3)
                     return PROPERTY_RESULT_TYPE_MISMATCH;
-                instance->m_EulerRotation = Vector3(value.m_V4[0], value.m_V4[1], value.m_V4[2]);
+                instance->m_Collection->m_EulerRotations[instance->m_Index] = Vector3(value.m_V4[0], value.m_V4[1], value.m_V4[2]);
                 UpdateEulerToRotation(instance);
                 return PROPERTY_RESULT_OK;
             }
@@ -3604,7 +4199,7 @@ namespace dmGameObject
             {
                 if (value.m_Type != PROPERTY_TYPE_NUMBER)
                     return PROPERTY_RESULT_TYPE_MISMATCH;
-                instance->m_EulerRotation.setX((float)value.m_Number);
+                instance->m_Collection->m_EulerRotations[instance->m_Index].setX((float)value.m_Number);
                 UpdateEulerToRotation(instance);
                 return PROPERTY_RESULT_OK;
             }
@@ -3612,7 +4207,7 @@ namespace dmGameObject
             {
                 if (value.m_Type != PROPERTY_TYPE_NUMBER)
                     return PROPERTY_RESULT_TYPE_MISMATCH;
-                instance->m_EulerRotation.setY((float)value.m_Number);
+                instance->m_Collection->m_EulerRotations[instance->m_Index].setY((float)value.m_Number);
                 UpdateEulerToRotation(instance);
                 return PROPERTY_RESULT_OK;
             }
@@ -3620,7 +4215,7 @@ namespace dmGameObject
             {
                 if (value.m_Type != PROPERTY_TYPE_NUMBER)
                     return PROPERTY_RESULT_TYPE_MISMATCH;
-                instance->m_EulerRotation.setZ((float)value.m_Number);
+                instance->m_Collection->m_EulerRotations[instance->m_Index].setZ((float)value.m_Number);
                 UpdateEulerToRotation(instance);
                 return PROPERTY_RESULT_OK;
             }
@@ -3679,12 +4274,12 @@ namespace dmGameObject
     //  - patch data structures for identification and input stack
     //  - copy the rest of the fields
     // The old instance is destroyed.
-    static void RecreateInstance(Collection* collection, uint16_t index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
+    static void RecreateInstance(Collection* collection, InstanceIndex index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
         HInstance instance = collection->m_Instances[index];
         // We don't support recreating instances that are 'transitioning'
         assert(instance->m_ToBeAdded == 0);
         assert(instance->m_ToBeDeleted == 0);
-        HInstance new_instance = AllocInstance(new_proto, new_proto_name);
+        HInstance new_instance = AllocInstance(collection, new_proto, new_proto_name);
         if (!new_instance) {
             return;
         }
@@ -3697,10 +4292,7 @@ namespace dmGameObject
         new_instance->m_Parent = instance->m_Parent;
         new_instance->m_FirstChildIndex = instance->m_FirstChildIndex;
         new_instance->m_SiblingIndex = instance->m_SiblingIndex;
-        // transform-related
-        new_instance->m_Transform = instance->m_Transform;
-        new_instance->m_EulerRotation = instance->m_EulerRotation;
-        new_instance->m_PrevEulerRotation = instance->m_PrevEulerRotation;
+        // transform-related (the local transform is stored in the collection at m_Index, which is kept)
         new_instance->m_ScaleAlongZ = instance->m_ScaleAlongZ;
         // id-related
         new_instance->m_Identifier = instance->m_Identifier;
@@ -3711,7 +4303,7 @@ namespace dmGameObject
         bool res = CreateComponents(hcollection, new_instance);
         if (!res) {
             dmHashRelease64(&new_instance->m_CollectionPathHashState);
-            DeallocInstance(new_instance);
+            DeallocInstance(collection, new_instance);
             return;
         }
         if (instance->m_Initialized) {
@@ -3737,7 +4329,7 @@ namespace dmGameObject
                 break;
             }
         }
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
         DoAddToUpdate(collection, new_instance);
     }
 
@@ -3746,11 +4338,11 @@ namespace dmGameObject
         Collection* collection = (Collection*) params->m_UserData;
         for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
         {
-            dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+            dmArray<InstanceIndex>& level = collection->m_LevelIndices[level_i];
             uint32_t instance_count = level.Size();
             for (uint32_t i = 0; i < instance_count; ++i)
             {
-                uint16_t index = level[i];
+                InstanceIndex index = level[i];
                 Instance* instance = collection->m_Instances[index];
                 Prototype* prototype = (Prototype*)ResourceDescriptorGetResource(params->m_Resource);
                 if (instance->m_Prototype == prototype) {
@@ -3795,7 +4387,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToAddHead;
+        InstanceIndex index = collection->m_InstancesToAddHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToAdd;
             ++count;
@@ -3807,7 +4399,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToDeleteHead;
+        InstanceIndex index = collection->m_InstancesToDeleteHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToDelete;
             ++count;
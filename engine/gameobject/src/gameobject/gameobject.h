@@ -21,6 +21,7 @@
 
 #include <dlib/easing.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_thread.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -46,6 +47,9 @@ namespace dmGameObject
     /// Config key to use for tweaking the maximum capacity of the input stack
     extern const char* COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY;
 
+    /// Config key to use for enabling batched message dispatch, see SetMessageBatching()
+    extern const char* COLLECTION_BATCH_MESSAGES_KEY;
+
     extern const dmhash_t UNNAMED_IDENTIFIER;
 
     typedef struct PropertyContainer* HPropertyContainer;
@@ -78,7 +82,7 @@ namespace dmGameObject
     /**
      * Set default capacity of collections in this register. This does not affect existing collections.
      * @param regist Register
-     * @param capacity Default capacity of collections in this register (0-32766).
+     * @param capacity Default capacity of collections in this register (0-32766, or larger when built with DM_GAMEOBJECT_LARGE_COLLECTIONS).
      * @return RESULT_OK on success or RESULT_INVALID_OPERATION if max_count is not within range
      */
     Result SetCollectionDefaultCapacity(HRegister regist, uint32_t capacity);
@@ -97,6 +101,22 @@ namespace dmGameObject
      */
     void SetInputStackDefaultCapacity(HRegister regist, uint32_t capacity);
 
+    /**
+     * Set the job thread context used to spread work (e.g. transform updates) over several threads.
+     * @param regist Register
+     * @param job_thread Job thread context. If 0, all work is done on the calling thread.
+     */
+    void SetJobThreadContext(HRegister regist, dmJobThread::HContext job_thread);
+
+    /**
+     * Enable grouping of the messages to the same component during a dispatch pass. The messages are passed
+     * to the OnMessageBatch function of the component type, if it has one. The order of the messages to a component
+     * is preserved, but messages to different components may be handled in another order than they were posted.
+     * @param regist Register
+     * @param enabled true to enable batching. Disabled by default.
+     */
+    void SetMessageBatching(HRegister regist, bool enabled);
+
     /**
      * Creates a new gameobject collection
      * @param name Collection name, which must be unique and follow the same naming as for sockets
@@ -121,6 +141,33 @@ namespace dmGameObject
      */
     void ReleaseInstanceIndex(uint32_t index, HCollection collection);
 
+    /**
+     * Get the number of instances that can still be spawned in the collection, i.e. the smaller of the
+     * number of free instance ids and the number of free instance slots.
+     * @param collection Collection
+     * @return The number of instances that can be spawned
+     */
+    uint32_t GetRemainingInstanceCount(HCollection collection);
+
+    /**
+     * Spawns several instances of the same prototype. Equivalent to calling Spawn() count times with ids from
+     * AcquireInstanceIndex(), but the capacity checks and the id allocation are only done once for the batch.
+     * The components are created and initialized one component at a time for all of the instances. Within an
+     * instance the components are still created and initialized in order.
+     * @param collection Gameobject collection
+     * @param prototype Prototype
+     * @param prototype_name Prototype file name (.goc)
+     * @param count Number of instances to spawn
+     * @param properties Container with override properties, shared by all instances. May be 0
+     * @param positions Array of count positions
+     * @param rotations Array of count rotations
+     * @param scales Array of count scales
+     * @param out_instances Array of at least count entries that receives the spawned instances
+     * @return The number of spawned instances. Instances that fail to spawn are left out of out_instances
+     */
+    uint32_t SpawnBatch(HCollection collection, HPrototype prototype, const char* prototype_name, uint32_t count, HPropertyContainer properties,
+                        const dmVMath::Point3* positions, const dmVMath::Quat* rotations, const dmVMath::Vector3* scales, HInstance* out_instances);
+
     /**
      * Used for mapping instance ids from a collection definition to newly spawned instances
      */
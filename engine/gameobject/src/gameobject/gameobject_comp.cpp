@@ -37,6 +37,7 @@ namespace dmGameObject
         ComponentTypeSetUpdateFn(type, CompScriptUpdate);
         ComponentTypeSetFixedUpdateFn(type, CompScriptFixedUpdate);
         ComponentTypeSetOnMessageFn(type, CompScriptOnMessage);
+        ComponentTypeSetOnMessageBatchFn(type, CompScriptOnMessageBatch);
         ComponentTypeSetOnInputFn(type, CompScriptOnInput);
         ComponentTypeSetOnReloadFn(type, CompScriptOnReload);
         ComponentTypeSetSetPropertiesFn(type, CompScriptSetProperties);
@@ -85,8 +85,24 @@ namespace dmGameObject
         dmArray<void*> m_PropertyResources;
     };
 
+    // Index to Collection::m_Instances. 16 bit by default, which limits a collection to 32766 instances.
+    // Build with DM_GAMEOBJECT_LARGE_COLLECTIONS (waf --with-large-collections) for 32 bit indices. On 64 bit platforms
+    // this grows Instance from 88 to 104 bytes, and each index array in the collection uses 4 instead of 2 bytes per slot
+#if defined(DM_GAMEOBJECT_LARGE_COLLECTIONS)
+    typedef uint32_t      InstanceIndex;
+    typedef dmIndexPool32 InstanceIndexPool;
+    // Number of bits used for instance indices stored in bit fields
+    const uint32_t INSTANCE_INDEX_BITS = 31;
+    // Invalid instance index. Implies that maximum number of instances is 0x7fffffff - 1
+    const uint32_t INVALID_INSTANCE_INDEX = 0x7fffffff;
+#else
+    typedef uint16_t      InstanceIndex;
+    typedef dmIndexPool16 InstanceIndexPool;
+    // Number of bits used for instance indices stored in bit fields
+    const uint32_t INSTANCE_INDEX_BITS = 15;
     // Invalid instance index. Implies that maximum number of instances is 32766 (ie 0x7fff - 1)
     const uint32_t INVALID_INSTANCE_INDEX = 0x7fff;
+#endif
 
     // NOTE: Actual size of Instance is sizeof(Instance) + sizeof(uintptr_t) * m_UserDataCount
     struct Instance
@@ -94,9 +110,6 @@ namespace dmGameObject
         Instance(Prototype* prototype)
         {
             m_Collection = 0;
-            m_Transform.SetIdentity();
-            m_EulerRotation = Vector3(0.0f, 0.0f, 0.0f);
-            m_PrevEulerRotation = Vector3(0.0f, 0.0f, 0.0f);
             m_Prototype = prototype;
             m_IdentifierIndex = INVALID_INSTANCE_POOL_INDEX;
             m_Identifier = UNNAMED_IDENTIFIER;
@@ -121,12 +134,7 @@ namespace dmGameObject
         {
         }
 
-        dmTransform::Transform m_Transform;
-
-        // Shadowed rotation expressed in euler coordinates
-        Vector3 m_EulerRotation;
-        // Previous euler rotation, used to detect if the euler rotation has changed and should overwrite the real rotation (needed by animation)
-        Vector3 m_PrevEulerRotation;
+        // NOTE: The local transform of the instance is stored in the collection, see Collection::m_Positions
         // Collection this instances belongs to. Added for GetWorldPosition.
         // We should consider to remove this (memory footprint)
         struct Collection* m_Collection;
@@ -153,32 +161,32 @@ namespace dmGameObject
         uint16_t        m_Pad : 4;
 
         // Index to parent
-        uint16_t        m_Parent : 16;
+        InstanceIndex   m_Parent;
 
         // Index to Collection::m_Instances
-        uint16_t        m_Index : 15;
+        InstanceIndex   m_Index : INSTANCE_INDEX_BITS;
         // Used for deferred deletion
-        uint16_t        m_ToBeDeleted : 1;
+        InstanceIndex   m_ToBeDeleted : 1;
 
         // Index to Collection::m_LevelIndex. Index is relative to current level (m_Depth), eg first object in level L always has level-index 0
         // Level-index is used to reorder Collection::m_LevelIndex entries in O(1). Given an instance we need to find where the
         // instance index is located in Collection::m_LevelIndex
-        uint16_t        m_LevelIndex : 15;
-        uint16_t        m_Pad2 : 1;
+        InstanceIndex   m_LevelIndex : INSTANCE_INDEX_BITS;
+        InstanceIndex   m_Pad2 : 1;
 
         // Index to next instance to delete or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToDelete : 16;
+        InstanceIndex   m_NextToDelete;
 
         // Index to next instance to add-to-update or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToAdd;
+        InstanceIndex   m_NextToAdd;
 
         // Next sibling index. Index to Collection::m_Instances
-        uint16_t        m_SiblingIndex : 15;
-        uint16_t        m_ToBeAdded : 1;
+        InstanceIndex   m_SiblingIndex : INSTANCE_INDEX_BITS;
+        InstanceIndex   m_ToBeAdded : 1;
 
         // First child index. Index to Collection::m_Instances
-        uint16_t        m_FirstChildIndex : 15;
-        uint16_t        m_Pad4 : 1;
+        InstanceIndex   m_FirstChildIndex : INSTANCE_INDEX_BITS;
+        InstanceIndex   m_Pad4 : 1;
 
         uint32_t        m_ComponentInstanceUserDataCount;
         uintptr_t       m_ComponentInstanceUserData[0];
@@ -201,11 +209,36 @@ namespace dmGameObject
         // Default capacity of collections
         uint32_t                    m_DefaultCollectionCapacity;
         uint32_t                    m_DefaultInputStackCapacity;
+        // Used for spreading work over several threads. May be 0
+        dmJobThread::HContext       m_JobThread;
+        // If messages to components with an OnMessageBatch function should be grouped, see DispatchMessages()
+        bool                        m_BatchMessages;
 
         Register();
         ~Register();
     };
 
+    enum TransformFlags
+    {
+        // The world transform must be recalculated, e.g. since the instance changed parent or was just created
+        TRANSFORM_FLAG_FORCE_UPDATE = 1,
+        // The world transform was recalculated in the last UpdateTransforms(), so the children must be recalculated as well
+        TRANSFORM_FLAG_CHANGED      = 2,
+        // The local transform was written, and the instance is in Collection::m_DirtyTransformIndices
+        TRANSFORM_FLAG_DIRTY        = 4,
+    };
+
+    // Messages to a component, deferred until the end of the dispatch pass
+    struct MessageBatch
+    {
+        Instance*   m_Instance;
+        uintptr_t*  m_UserData;
+        // Range in Collection::m_MessageBatchSpans
+        uint32_t    m_First;
+        uint32_t    m_Count;
+        uint16_t    m_ComponentIndex;
+    };
+
     // Max hierarchical depth
     // depth is interpreted as up to <depth> levels of child nodes including root-nodes
     // Must be greater than zero
@@ -235,21 +268,45 @@ namespace dmGameObject
         dmArray<Instance*>       m_Instances;
 
         // Index pool for mapping Instance::m_Index to m_Instances
-        dmIndexPool16            m_InstanceIndices;
+        InstanceIndexPool        m_InstanceIndices;
 
         // Resources referenced through property overrides inside the collection
         dmArray<void*>           m_PropertyResources;
 
+        // Recycled instance memory, see AllocInstance(). One free list for each number of component user-data slots,
+        // the link to the next free block is stored in the first word of the block
+        dmArray<void*>           m_FreeInstances;
+        // Total number of blocks in m_FreeInstances. Never more than the number of free instance slots
+        uint32_t                 m_FreeInstanceCount;
+
         // Array of dynamically allocated index arrays, one for each level
         // Used for calculating transforms in scene-graph
         // Two dimensional table of indices with stride "max_instances"
         // Level 0 contains root-nodes in [0..m_LevelIndices[0].Size()-1]
         // Level 1 contains level 1 indices in [0..m_LevelIndices[1].Size()-1]
-        dmArray<uint16_t>        m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
+        dmArray<InstanceIndex>   m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
+
+        // Local transforms, stored as separate streams indexed by Instance::m_Index
+        // so that UpdateTransforms() only touches the data it needs
+        dmArray<Vector3>         m_Positions;
+        dmArray<Quat>            m_Rotations;
+        dmArray<Vector3>         m_Scales;
+        // Shadowed rotations expressed in euler coordinates
+        dmArray<Vector3>         m_EulerRotations;
+        // Previous euler rotations, used to detect if the euler rotation has changed and should overwrite the real rotation (needed by animation)
+        dmArray<Vector3>         m_PrevEulerRotations;
 
         // Array of world transforms. Calculated using m_LevelIndices above
         dmArray<Matrix4>         m_WorldTransforms;
 
+        // The local transforms that the world transforms were last calculated from.
+        // Used to skip instances (and subtrees) that haven't moved since the last UpdateTransforms()
+        dmArray<dmTransform::Transform> m_PrevLocalTransforms;
+        // Per instance TransformFlags
+        dmArray<uint8_t>         m_TransformFlags;
+        // Instances whose local transforms were written since the last UpdateTransforms(), see MarkTransformDirty()
+        dmArray<InstanceIndex>   m_DirtyTransformIndices;
+
         // Identifier to Instance mapping
         dmHashTable64<Instance*> m_IDToInstance;
 
@@ -267,6 +324,15 @@ namespace dmGameObject
         // Socket for sending to instances, dispatched once each update
         dmMessage::HSocket       m_FrameSocket;
 
+        // Deferred messages in the order they were posted, and the index into m_MessageBatches for each of them
+        dmArray<dmMessage::Message*> m_BatchedMessages;
+        dmArray<uint32_t>        m_BatchedMessageBatch;
+        dmArray<MessageBatch>    m_MessageBatches;
+        // Maps instance index and component index to m_MessageBatches
+        dmHashTable64<uint32_t>  m_MessageBatchLookup;
+        // The deferred messages sorted per batch, passed to the OnMessageBatch functions
+        dmArray<dmMessage::Message*> m_MessageBatchSpans;
+
         dmMutex::HMutex          m_Mutex;
 
         // Counter for generating instance ids, protected by m_Mutex
@@ -275,14 +341,14 @@ namespace dmGameObject
         dmIndexPool32            m_InstanceIdPool;
 
         // Head of linked list of instances scheduled for deferred deletion
-        uint16_t                 m_InstancesToDeleteHead;
+        InstanceIndex            m_InstancesToDeleteHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToDeleteTail;
+        InstanceIndex            m_InstancesToDeleteTail;
 
         // Head of linked list of instances scheduled to be added to update
-        uint16_t                 m_InstancesToAddHead;
+        InstanceIndex            m_InstancesToAddHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToAddTail;
+        InstanceIndex            m_InstancesToAddTail;
 
         float                    m_FixedAccumTime;  // Accumulated time between fixed updates. Scaled time.
 
@@ -292,11 +358,66 @@ namespace dmGameObject
         uint32_t                 m_ToBeDeleted : 1;
         // If the game object dynamically created in this collection should have the Z component of the position affected by scale
         uint32_t                 m_ScaleAlongZ : 1;
+        // All world transforms must be checked, e.g. since an animation wrote to the local transforms directly.
+        // Writes through the transform setters are tracked per instance instead, see MarkTransformDirty()
         uint32_t                 m_DirtyTransforms : 1;
         uint32_t                 m_Initialized : 1;
         uint32_t                 m_FirstUpdate : 1;
     };
 
+    // Must be called when the local transform of an instance is written, so that the world transforms of it
+    // and its children are updated by the next UpdateTransforms()
+    static inline void MarkTransformDirty(Collection* collection, InstanceIndex index)
+    {
+        uint8_t& flags = collection->m_TransformFlags[index];
+        if ((flags & TRANSFORM_FLAG_DIRTY) == 0)
+        {
+            flags |= TRANSFORM_FLAG_DIRTY;
+            // A reused instance index may be in the list twice, so it can fill up
+            if (collection->m_DirtyTransformIndices.Full())
+                collection->m_DirtyTransforms = 1;
+            else
+                collection->m_DirtyTransformIndices.Push(index);
+        }
+    }
+
+    static inline void MarkTransformDirty(Instance* instance)
+    {
+        MarkTransformDirty(instance->m_Collection, instance->m_Index);
+    }
+
+    static inline bool HasDirtyTransforms(const Collection* collection)
+    {
+        return collection->m_DirtyTransforms || !collection->m_DirtyTransformIndices.Empty();
+    }
+
+    static inline dmTransform::Transform GetLocalTransform(const Instance* instance)
+    {
+        const Collection* collection = instance->m_Collection;
+        InstanceIndex index = instance->m_Index;
+        return dmTransform::Transform(collection->m_Positions[index], collection->m_Rotations[index], collection->m_Scales[index]);
+    }
+
+    static inline void SetLocalTransform(Instance* instance, const dmTransform::Transform& transform)
+    {
+        Collection* collection = instance->m_Collection;
+        InstanceIndex index = instance->m_Index;
+        collection->m_Positions[index] = transform.GetTranslation();
+        collection->m_Rotations[index] = transform.GetRotation();
+        collection->m_Scales[index] = transform.GetScale();
+        MarkTransformDirty(collection, index);
+    }
+
+    // Resets the local transform of a newly allocated instance index
+    static inline void ResetLocalTransform(Collection* collection, InstanceIndex index)
+    {
+        collection->m_Positions[index] = Vector3(0.0f, 0.0f, 0.0f);
+        collection->m_Rotations[index] = Quat::identity();
+        collection->m_Scales[index] = Vector3(1.0f, 1.0f, 1.0f);
+        collection->m_EulerRotations[index] = Vector3(0.0f, 0.0f, 0.0f);
+        collection->m_PrevEulerRotations[index] = Vector3(0.0f, 0.0f, 0.0f);
+    }
+
     struct CollectionHandle
     {
         Collection* m_Collection;
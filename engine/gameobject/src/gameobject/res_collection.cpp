@@ -76,7 +76,7 @@ namespace dmGameObject
                     scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
                 }
 
-                instance->m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+                SetLocalTransform(instance, dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale));
 
                 dmHashInit64(&instance->m_CollectionPathHashState, true);
                 const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
@@ -244,8 +244,15 @@ bail:
     static size_t CalcSize(Collection* collection)
     {
         size_t size = sizeof(Collection) + sizeof(CollectionHandle);
-        size += collection->m_InstanceIndices.Capacity()*sizeof(uint16_t);
+        size += collection->m_InstanceIndices.Capacity()*sizeof(InstanceIndex);
+        size += collection->m_Positions.Capacity()*sizeof(Vector3);
+        size += collection->m_Rotations.Capacity()*sizeof(Quat);
+        size += collection->m_Scales.Capacity()*sizeof(Vector3);
+        size += collection->m_EulerRotations.Capacity()*sizeof(Vector3);
+        size += collection->m_PrevEulerRotations.Capacity()*sizeof(Vector3);
         size += collection->m_WorldTransforms.Capacity()*sizeof(Matrix4);
+        size += collection->m_PrevLocalTransforms.Capacity()*sizeof(dmTransform::Transform);
+        size += collection->m_TransformFlags.Capacity()*sizeof(uint8_t);
         size += collection->m_IDToInstance.Capacity()*(sizeof(Instance*)+sizeof(dmhash_t));
         size += collection->m_InputFocusStack.Capacity()*sizeof(Instance*);
         size += collection->m_Instances.Capacity()*sizeof(Instance*);
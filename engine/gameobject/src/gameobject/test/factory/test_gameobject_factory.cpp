@@ -285,3 +285,64 @@ TEST_F(FactoryTest, FactoryCreateCallback)
     dmGameObject::HInstance instance = Spawn(m_Factory, m_Collection, "/test_create.goc", id, 0, Point3(2.0f, 0.0f, 0.0f), Quat(), Vector3(2, 2, 2));
     ASSERT_NE((void*)0, instance);
 }
+
+TEST_F(FactoryTest, FactoryBatch)
+{
+    const uint32_t count = 8;
+    Point3 positions[count];
+    Quat rotations[count];
+    Vector3 scales[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        positions[i] = Point3((float)i, 0.0f, 0.0f);
+        rotations[i] = Quat::identity();
+        scales[i] = Vector3(1, 1, 1);
+    }
+
+    dmGameObject::HPrototype prototype = 0x0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/test.goc", (void**)&prototype));
+
+    dmGameObject::HInstance instances[count];
+    uint32_t spawned = dmGameObject::SpawnBatch(m_Collection, prototype, "/test.goc", count, 0, positions, rotations, scales, instances);
+    ASSERT_EQ(count, spawned);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ((float)i, dmGameObject::GetPosition(instances[i]).getX());
+        dmhash_t id = dmGameObject::GetIdentifier(instances[i]);
+        ASSERT_EQ(instances[i], dmGameObject::GetInstanceFromIdentifier(m_Collection, id));
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            ASSERT_NE(dmGameObject::GetIdentifier(instances[j]), id);
+        }
+    }
+
+    // The memory of deleted instances is reused
+    dmGameObject::HInstance last = instances[count - 1];
+    dmGameObject::Delete(m_Collection, last, false);
+    dmGameObject::PostUpdate(m_Collection);
+    spawned = dmGameObject::SpawnBatch(m_Collection, prototype, "/test.goc", 1, 0, positions, rotations, scales, instances);
+    ASSERT_EQ(1u, spawned);
+    ASSERT_EQ(last, instances[0]);
+
+    // The recycled memory is bounded by the size of the collection
+    dmGameObject::HCollection small_collection = dmGameObject::NewCollection("small_collection", m_Factory, m_Register, count, 0x0);
+    spawned = dmGameObject::SpawnBatch(small_collection, prototype, "/test.goc", count, 0, positions, rotations, scales, instances);
+    ASSERT_EQ(count, spawned);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmGameObject::Delete(small_collection, instances[i], false);
+    }
+    dmGameObject::PostUpdate(small_collection);
+    ASSERT_EQ(count, small_collection->m_Collection->m_FreeInstanceCount);
+
+    // Instances without components can't reuse that memory, so it is released as they are spawned
+    dmGameObject::HPrototype empty_prototype = 0x0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/test_create.goc", (void**)&empty_prototype));
+    spawned = dmGameObject::SpawnBatch(small_collection, empty_prototype, "/test_create.goc", count, 0, positions, rotations, scales, instances);
+    ASSERT_EQ(count, spawned);
+    ASSERT_EQ(0u, small_collection->m_Collection->m_FreeInstanceCount);
+    dmGameObject::DeleteCollection(small_collection);
+
+    dmResource::Release(m_Factory, empty_prototype);
+    dmResource::Release(m_Factory, prototype);
+}
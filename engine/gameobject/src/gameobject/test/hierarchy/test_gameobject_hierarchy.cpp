@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <map>
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <dlib/message.h>
 #include <dlib/dstrings.h>
 #include <dlib/time.h>
@@ -1053,4 +1054,127 @@ TEST_F(HierarchyTest, TestIterateHierarchy)
 
 }
 
+TEST_F(HierarchyTest, TestUpdateTransformsParallel)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "TestJobThread";
+    job_thread_create_params.m_ThreadCount    = 4;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_params);
+    dmGameObject::SetJobThreadContext(m_Register, job_thread);
+
+    // Large enough for the levels to be split over the job threads
+    const uint32_t root_count = 2048;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("parallel", m_Factory, m_Register, root_count * 3, 0x0);
+
+    dmArray<dmGameObject::HInstance> roots;
+    dmArray<dmGameObject::HInstance> children;
+    dmArray<dmGameObject::HInstance> grand_children;
+    roots.SetCapacity(root_count);
+    children.SetCapacity(root_count);
+    grand_children.SetCapacity(root_count);
+    for (uint32_t i = 0; i < root_count; ++i)
+    {
+        dmGameObject::HInstance root = dmGameObject::New(collection, "/go.goc");
+        dmGameObject::HInstance child = dmGameObject::New(collection, "/go.goc");
+        dmGameObject::HInstance grand_child = dmGameObject::New(collection, "/go.goc");
+        ASSERT_NE((void*)0, root);
+        ASSERT_NE((void*)0, child);
+        ASSERT_NE((void*)0, grand_child);
+        dmGameObject::SetPosition(root, Point3((float)i, 0, 0));
+        dmGameObject::SetPosition(child, Point3(0, 1, 0));
+        dmGameObject::SetPosition(grand_child, Point3(0, 0, 1));
+        ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, root));
+        ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(grand_child, child));
+        roots.Push(root);
+        children.Push(child);
+        grand_children.Push(grand_child);
+    }
+
+    dmGameObject::UpdateTransforms(collection);
+
+    for (uint32_t i = 0; i < root_count; ++i)
+    {
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(children[i]) - Point3((float)i, 1, 0)), EPSILON);
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_children[i]) - Point3((float)i, 1, 1)), EPSILON);
+    }
+
+    // Only move every other root, the subtrees of the other roots are left untouched
+    for (uint32_t i = 0; i < root_count; i += 2)
+    {
+        dmGameObject::SetPosition(roots[i], Point3((float)i, 2, 0));
+    }
+    // Move a child without moving its parent
+    dmGameObject::SetPosition(children[1], Point3(0, 5, 0));
+
+    dmGameObject::UpdateTransforms(collection);
+
+    for (uint32_t i = 0; i < root_count; ++i)
+    {
+        float y = (i % 2) == 0 ? 3.0f : 1.0f;
+        if (i == 1)
+            y = 5.0f;
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(children[i]) - Point3((float)i, y, 0)), EPSILON);
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_children[i]) - Point3((float)i, y, 1)), EPSILON);
+    }
+
+    // Reparenting must update the subtree, even if no local transform changed
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(children[3], roots[4]));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_children[3]) - Point3(4, 3, 1)), EPSILON);
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+
+    dmGameObject::SetJobThreadContext(m_Register, 0);
+    dmJobThread::Destroy(job_thread);
+}
+
+TEST_F(HierarchyTest, TestUpdateDirtyTransforms)
+{
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+
+    // Some static instances, to make the written ones few enough for the incremental update
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        ASSERT_NE((void*)0, dmGameObject::New(m_Collection, "/go.goc"));
+    }
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child_child = dmGameObject::New(m_Collection, "/go.goc");
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, parent));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child_child, child));
+    dmGameObject::SetPosition(child, Point3(0, 1, 0));
+    dmGameObject::SetPosition(child_child, Point3(0, 0, 1));
+
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_FALSE(dmGameObject::HasDirtyTransforms(collection));
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child_child) - Point3(0, 1, 1)), EPSILON);
+
+    // A frame without any transform writes doesn't need an update
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_FALSE(dmGameObject::HasDirtyTransforms(collection));
+
+    // Writing a child and its parent updates the subtree once
+    dmGameObject::SetPosition(child, Point3(0, 2, 0));
+    dmGameObject::SetPosition(parent, Point3(3, 0, 0));
+    ASSERT_TRUE(dmGameObject::HasDirtyTransforms(collection));
+    ASSERT_EQ(2U, collection->m_DirtyTransformIndices.Size());
+    // Writing twice doesn't add it twice
+    dmGameObject::SetPosition(parent, Point3(4, 0, 0));
+    ASSERT_EQ(2U, collection->m_DirtyTransformIndices.Size());
+
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_FALSE(dmGameObject::HasDirtyTransforms(collection));
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(4, 2, 0)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child_child) - Point3(4, 2, 1)), EPSILON);
+
+    // Property writes are tracked as well
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(child_child, 0, dmHashString64("position.x"), dmGameObject::PropertyOptions(), dmGameObject::PropertyVar(1.0f)));
+    ASSERT_TRUE(dmGameObject::HasDirtyTransforms(collection));
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child_child) - Point3(5, 2, 1)), EPSILON);
+
+    dmGameObject::Delete(m_Collection, parent, true);
+}
+
 #undef EPSILON
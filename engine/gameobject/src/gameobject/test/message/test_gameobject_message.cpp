@@ -66,6 +66,8 @@ protected:
         assert(dmMessage::NewSocket("@system", &m_Socket) == dmMessage::RESULT_OK);
 
         m_MessageTargetCounter = 0;
+        m_MessageBatchCount = 0;
+        m_MaxMessageBatchSize = 0;
 
         dmResource::Result e = dmResource::RegisterType(m_Factory, "mt", this, 0, ResMessageTargetCreate, 0, ResMessageTargetDestroy, 0);
         ASSERT_EQ(dmResource::RESULT_OK, e);
@@ -110,6 +112,7 @@ protected:
     static dmGameObject::CreateResult CompMessageTargetCreate(const dmGameObject::ComponentCreateParams& params);
     static dmGameObject::CreateResult CompMessageTargetDestroy(const dmGameObject::ComponentDestroyParams& params);
     static dmGameObject::UpdateResult CompMessageTargetOnMessage(const dmGameObject::ComponentOnMessageParams& params);
+    static dmGameObject::UpdateResult CompMessageTargetOnMessageBatch(const dmGameObject::ComponentOnMessageBatchParams& params);
 
 public:
     dmGameObject::UpdateContext m_UpdateContext;
@@ -122,6 +125,8 @@ public:
     std::map<uint32_t, uint32_t> m_MessageMap;
 
     uint32_t m_MessageTargetCounter;
+    uint32_t m_MessageBatchCount;
+    uint32_t m_MaxMessageBatchSize;
     dmGameObject::ModuleContext m_ModuleContext;
     dmHashTable64<void*> m_Contexts;
 };
@@ -202,6 +207,29 @@ dmGameObject::UpdateResult MessageTest::CompMessageTargetOnMessage(const dmGameO
     return dmGameObject::UPDATE_RESULT_OK;
 }
 
+dmGameObject::UpdateResult MessageTest::CompMessageTargetOnMessageBatch(const dmGameObject::ComponentOnMessageBatchParams& params)
+{
+    MessageTest* self = (MessageTest*) params.m_Context;
+    self->m_MessageBatchCount++;
+    self->m_MaxMessageBatchSize = dmMath::Max(self->m_MaxMessageBatchSize, params.m_MessageCount);
+
+    dmGameObject::ComponentOnMessageParams message_params;
+    message_params.m_Instance = params.m_Instance;
+    message_params.m_World = params.m_World;
+    message_params.m_Context = params.m_Context;
+    message_params.m_UserData = params.m_UserData;
+    for (uint32_t i = 0; i < params.m_MessageCount; ++i)
+    {
+        // All messages are to the same component
+        assert(params.m_Messages[i]->m_Receiver.m_Path == dmGameObject::GetIdentifier(params.m_Instance));
+        message_params.m_Message = params.m_Messages[i];
+        dmGameObject::UpdateResult result = CompMessageTargetOnMessage(message_params);
+        if (result != dmGameObject::UPDATE_RESULT_OK)
+            return result;
+    }
+    return dmGameObject::UPDATE_RESULT_OK;
+}
+
 void DispatchCallback(dmMessage::Message *message, void* user_ptr)
 {
     MessageTest* test = (MessageTest*)user_ptr;
@@ -286,6 +314,116 @@ TEST_F(MessageTest, TestComponentMessage)
     dmGameObject::Delete(m_Collection, go, false);
 }
 
+TEST_F(MessageTest, TestComponentMessageBatch)
+{
+    HResourceType resource_type;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::GetTypeFromExtension(m_Factory, "mt", &resource_type));
+    dmGameObject::ComponentType* mt_type = dmGameObject::FindComponentType(m_Register, resource_type, 0x0);
+    ASSERT_NE((void*) 0, (void*) mt_type);
+    dmGameObject::ComponentTypeSetOnMessageBatchFn(mt_type, CompMessageTargetOnMessageBatch);
+
+    dmGameObject::HInstance go1 = dmGameObject::New(m_Collection, "/component_message.goc");
+    dmGameObject::HInstance go2 = dmGameObject::New(m_Collection, "/component_message.goc");
+    ASSERT_NE((void*) 0, (void*) go1);
+    ASSERT_NE((void*) 0, (void*) go2);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(m_Collection, go1, "test_instance1"));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(m_Collection, go2, "test_instance2"));
+
+    dmhash_t message_id = dmHashString64("inc");
+    dmMessage::URL sender;
+    sender.m_Socket = dmGameObject::GetMessageSocket(m_Collection);
+    sender.m_Path = dmGameObject::GetIdentifier(go1);
+    sender.m_Fragment = dmHashString64("script");
+    dmMessage::URL receivers[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        receivers[i].m_Socket = dmGameObject::GetMessageSocket(m_Collection);
+        receivers[i].m_Path = dmGameObject::GetIdentifier(i == 0 ? go1 : go2);
+        receivers[i].m_Fragment = dmHashString64("mt");
+    }
+
+    // Not batched unless enabled
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receivers[i % 2], message_id, 0, 0, 0x0, 0, 0));
+    }
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_EQ(5U, m_MessageTargetCounter);
+    ASSERT_EQ(0U, m_MessageBatchCount);
+
+    // Interleaved messages are grouped per component
+    dmGameObject::SetMessageBatching(m_Register, true);
+    m_MessageTargetCounter = 0;
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receivers[i % 2], message_id, 0, 0, 0x0, 0, 0));
+    }
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_EQ(5U, m_MessageTargetCounter);
+    ASSERT_EQ(2U, m_MessageBatchCount);
+    ASSERT_EQ(3U, m_MaxMessageBatchSize);
+
+    // A system message in between splits the batches, to keep the order relative to it
+    m_MessageBatchCount = 0;
+    dmMessage::URL go_receiver = receivers[0];
+    go_receiver.m_Fragment = 0;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receivers[0], message_id, 0, 0, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &go_receiver, dmGameObjectDDF::AcquireInputFocus::m_DDFDescriptor->m_NameHash, (uintptr_t)go1, (uintptr_t)dmGameObjectDDF::AcquireInputFocus::m_DDFDescriptor, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receivers[0], message_id, 0, 0, 0x0, 0, 0));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_EQ(2U, m_MessageBatchCount);
+    ASSERT_EQ(1u, m_Collection->m_Collection->m_InputFocusStack.Size());
+
+    dmGameObject::SetMessageBatching(m_Register, false);
+    dmGameObject::ComponentTypeSetOnMessageBatchFn(mt_type, 0x0);
+    dmGameObject::Delete(m_Collection, go1, false);
+    dmGameObject::Delete(m_Collection, go2, false);
+}
+
+TEST_F(MessageTest, TestScriptMessageBatch)
+{
+    dmGameObject::SetMessageBatching(m_Register, true);
+
+    dmGameObject::HInstance instance = dmGameObject::New(m_Collection, "/test_onmessage_batch.goc");
+    ASSERT_NE((void*)0, (void*)instance);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(m_Collection, instance, "test_instance"));
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmMessage::URL receiver;
+    receiver.m_Socket = dmGameObject::GetMessageSocket(m_Collection);
+    receiver.m_Path = dmGameObject::GetIdentifier(instance);
+    receiver.m_Fragment = dmHashString64("script");
+
+    dmhash_t inc_id = dmHashString64("inc");
+    dmhash_t fail_id = dmHashString64("fail");
+    TestGameObjectDDF::TestMessage ddf;
+    uintptr_t descriptor = (uintptr_t)TestGameObjectDDF::TestMessage::m_DDFDescriptor;
+    dmhash_t test_message_id = TestGameObjectDDF::TestMessage::m_DDFDescriptor->m_NameHash;
+
+    // All messages are passed to on_message in one batch
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, inc_id, 0, 0, 0x0, 0, 0));
+    }
+    ddf.m_TestUint32 = 8;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, test_message_id, 0, descriptor, &ddf, sizeof(ddf), 0));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    // An error in on_message doesn't stop the rest of the batch
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, inc_id, 0, 0, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, fail_id, 0, 0, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, inc_id, 0, 0, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, fail_id, 0, 0, 0x0, 0, 0));
+    ASSERT_FALSE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    ddf.m_TestUint32 = 12;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, test_message_id, 0, descriptor, &ddf, sizeof(ddf), 0));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    dmGameObject::SetMessageBatching(m_Register, false);
+    dmGameObject::Delete(m_Collection, instance, false);
+}
+
 TEST_F(MessageTest, TestComponentMessageFail)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/component_message.goc");
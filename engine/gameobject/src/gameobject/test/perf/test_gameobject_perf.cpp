@@ -0,0 +1,247 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdio.h>
+#include <jc_test/jc_test.h>
+
+#include <dlib/hash.h>
+#include <dlib/time.h>
+#include <resource/resource.h>
+#include "../gameobject.h"
+#include "../gameobject_private.h"
+
+using namespace dmVMath;
+
+// Benchmarks for spawning and transforming large amounts of game objects.
+// Not run as part of the test suite, run build/src/gameobject/test/test_gameobject_perf manually.
+
+static const uint32_t INSTANCE_COUNTS[] = {10000, 25000, 50000, 100000, 250000};
+static const uint32_t LEVEL_COUNTS[] = {1, 2, 4, 8};
+static const uint32_t UPDATE_ITERATIONS = 20;
+static const uint32_t SPAWN_ITERATIONS = 10;
+
+class PerfTest : public jc_test_base_class
+{
+protected:
+    virtual void SetUp()
+    {
+        dmResource::NewFactoryParams params;
+        params.m_MaxResources = 16;
+        params.m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+        m_Factory = dmResource::NewFactory(&params, "build/src/gameobject/test/perf");
+        dmScript::ContextParams script_context_params = {};
+        m_ScriptContext = dmScript::NewContext(script_context_params);
+        dmScript::Initialize(m_ScriptContext);
+        m_Register = dmGameObject::NewRegister();
+        dmGameObject::Initialize(m_Register, m_ScriptContext);
+
+        m_Contexts.SetCapacity(7,16);
+        m_Contexts.Put(dmHashString64("goc"), m_Register);
+        m_Contexts.Put(dmHashString64("collectionc"), m_Register);
+        m_Contexts.Put(dmHashString64("scriptc"), m_ScriptContext);
+        m_Contexts.Put(dmHashString64("luac"), &m_ModuleContext);
+        dmResource::RegisterTypes(m_Factory, &m_Contexts);
+
+        dmGameObject::ComponentTypeCreateCtx component_create_ctx = {};
+        component_create_ctx.m_Script = m_ScriptContext;
+        component_create_ctx.m_Register = m_Register;
+        component_create_ctx.m_Factory = m_Factory;
+        dmGameObject::CreateRegisteredComponentTypes(&component_create_ctx);
+        dmGameObject::SortComponentTypes(m_Register);
+    }
+
+    virtual void TearDown()
+    {
+        dmGameObject::PostUpdate(m_Register);
+        dmScript::Finalize(m_ScriptContext);
+        dmScript::DeleteContext(m_ScriptContext);
+        dmResource::DeleteFactory(m_Factory);
+        dmGameObject::DeleteRegister(m_Register);
+    }
+
+public:
+
+    dmScript::HContext m_ScriptContext;
+    dmGameObject::HRegister m_Register;
+    dmResource::HFactory m_Factory;
+    dmGameObject::ModuleContext m_ModuleContext;
+    dmHashTable64<void*> m_Contexts;
+};
+
+static float ToMs(uint64_t start, uint64_t end)
+{
+    return (end - start) / 1000.0f;
+}
+
+// Spawns instance_count instances as chains of level_count instances each, and measures
+// the spawn time and the time for UpdateTransforms() with all roots moved and with nothing moved
+static void Measure(PerfTest* test, uint32_t instance_count, uint32_t level_count)
+{
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("perf", test->m_Factory, test->m_Register, instance_count, 0x0);
+    ASSERT_NE((void*)0, collection);
+
+    uint32_t chain_count = instance_count / level_count;
+    dmArray<dmGameObject::HInstance> roots;
+    roots.SetCapacity(chain_count);
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t i = 0; i < chain_count; ++i)
+    {
+        dmGameObject::HInstance parent = 0;
+        for (uint32_t l = 0; l < level_count; ++l)
+        {
+            dmGameObject::HInstance instance = dmGameObject::New(collection, "/empty.goc");
+            ASSERT_NE((void*)0, instance);
+            dmGameObject::SetPosition(instance, Point3(1.0f, 0.0f, 0.0f));
+            dmGameObject::SetRotation(instance, Quat::rotationZ(0.1f));
+            if (parent)
+                ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(instance, parent));
+            else
+                roots.Push(instance);
+            parent = instance;
+        }
+    }
+    uint64_t spawned = dmTime::GetMonotonicTime();
+
+    dmGameObject::UpdateTransforms(collection);
+
+    uint64_t moved_start = dmTime::GetMonotonicTime();
+    for (uint32_t it = 0; it < UPDATE_ITERATIONS; ++it)
+    {
+        for (uint32_t i = 0; i < chain_count; ++i)
+            dmGameObject::SetPosition(roots[i], Point3((float)it, (float)i, 0.0f));
+        dmGameObject::UpdateTransforms(collection);
+    }
+    uint64_t moved_end = dmTime::GetMonotonicTime();
+
+    for (uint32_t it = 0; it < UPDATE_ITERATIONS; ++it)
+        dmGameObject::UpdateTransforms(collection);
+    uint64_t static_end = dmTime::GetMonotonicTime();
+
+    printf("%10u %8u %12.3f %14.3f %14.3f\n", chain_count * level_count, level_count,
+            ToMs(start, spawned), ToMs(moved_start, moved_end) / UPDATE_ITERATIONS, ToMs(moved_end, static_end) / UPDATE_ITERATIONS);
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(test->m_Register);
+}
+
+// Memory used per game object, excluding component user data and the components themselves
+TEST_F(PerfTest, InstanceMemory)
+{
+    printf("instance index: %u bytes, max instances per collection: %u\n", (uint32_t)sizeof(dmGameObject::InstanceIndex), dmGameObject::INVALID_INSTANCE_INDEX - 1);
+    printf("Instance: %u bytes\n", (uint32_t)sizeof(dmGameObject::Instance));
+
+    // Per slot storage in the collection, see Collection::Collection()
+    uint32_t slot_size = sizeof(dmGameObject::Instance*) + sizeof(dmGameObject::InstanceIndex) * 3 // m_Instances, m_InstanceIndices, m_DirtyTransformIndices and a level index
+                       + sizeof(Vector3) * 4 + sizeof(Quat) + sizeof(Matrix4) + sizeof(dmTransform::Transform) + sizeof(uint8_t)
+                       + sizeof(uint32_t); // m_InstanceIdPool
+    printf("collection: %u bytes per slot\n", slot_size);
+}
+
+TEST_F(PerfTest, SpawnAndUpdateTransforms)
+{
+    uint32_t max_instances = dmGameObject::INVALID_INSTANCE_INDEX - 1;
+
+    printf("times in ms, update times are per frame\n");
+    printf("%10s %8s %12s %14s %14s\n", "instances", "levels", "spawn", "update moved", "update static");
+    for (uint32_t c = 0; c < DM_ARRAY_SIZE(INSTANCE_COUNTS); ++c)
+    {
+        uint32_t instance_count = INSTANCE_COUNTS[c];
+        if (instance_count > max_instances)
+        {
+            printf("%10u: skipped, max instances per collection is %u\n", instance_count, max_instances);
+            continue;
+        }
+        for (uint32_t l = 0; l < DM_ARRAY_SIZE(LEVEL_COUNTS); ++l)
+        {
+            Measure(this, instance_count, LEVEL_COUNTS[l]);
+        }
+    }
+}
+
+// Spawns and deletes instance_count instances SPAWN_ITERATIONS times, either one at a time or as a single batch.
+// Returns the number of spawns per second
+static float MeasureSpawn(PerfTest* test, uint32_t instance_count, bool batch)
+{
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("perf", test->m_Factory, test->m_Register, instance_count, 0x0);
+    dmGameObject::HPrototype prototype = 0x0;
+    dmResource::Get(test->m_Factory, "/empty.goc", (void**)&prototype);
+
+    dmArray<Point3> positions;
+    dmArray<Quat> rotations;
+    dmArray<Vector3> scales;
+    dmArray<dmGameObject::HInstance> instances;
+    positions.SetCapacity(instance_count);
+    positions.SetSize(instance_count);
+    rotations.SetCapacity(instance_count);
+    rotations.SetSize(instance_count);
+    scales.SetCapacity(instance_count);
+    scales.SetSize(instance_count);
+    instances.SetCapacity(instance_count);
+    instances.SetSize(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        positions[i] = Point3((float)i, 0.0f, 0.0f);
+        rotations[i] = Quat::identity();
+        scales[i] = Vector3(1.0f);
+    }
+
+    uint64_t time = 0;
+    for (uint32_t it = 0; it < SPAWN_ITERATIONS; ++it)
+    {
+        uint64_t start = dmTime::GetMonotonicTime();
+        if (batch)
+        {
+            dmGameObject::SpawnBatch(collection, prototype, "/empty.goc", instance_count, 0, positions.Begin(), rotations.Begin(), scales.Begin(), instances.Begin());
+        }
+        else
+        {
+            for (uint32_t i = 0; i < instance_count; ++i)
+            {
+                uint32_t index = dmGameObject::AcquireInstanceIndex(collection);
+                instances[i] = dmGameObject::Spawn(collection, prototype, "/empty.goc", dmGameObject::ConstructInstanceId(index), 0, positions[i], rotations[i], scales[i]);
+                dmGameObject::AssignInstanceIndex(index, instances[i]);
+            }
+        }
+        time += dmTime::GetMonotonicTime() - start;
+
+        dmGameObject::DeleteAll(collection);
+        dmGameObject::PostUpdate(collection);
+    }
+
+    dmResource::Release(test->m_Factory, prototype);
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(test->m_Register);
+    return (instance_count * SPAWN_ITERATIONS) / (time / 1000000.0f);
+}
+
+TEST_F(PerfTest, SpawnBatch)
+{
+    uint32_t max_instances = dmGameObject::INVALID_INSTANCE_INDEX - 1;
+
+    printf("spawns per second\n");
+    printf("%10s %14s %14s\n", "instances", "spawn", "spawn batch");
+    for (uint32_t c = 0; c < DM_ARRAY_SIZE(INSTANCE_COUNTS); ++c)
+    {
+        uint32_t instance_count = INSTANCE_COUNTS[c];
+        if (instance_count > max_instances)
+        {
+            printf("%10u: skipped, max instances per collection is %u\n", instance_count, max_instances);
+            continue;
+        }
+        float single = MeasureSpawn(this, instance_count, false);
+        float batch = MeasureSpawn(this, instance_count, true);
+        printf("%10u %14.0f %14.0f\n", instance_count, single, batch);
+    }
+}
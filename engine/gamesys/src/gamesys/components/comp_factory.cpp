@@ -484,5 +484,15 @@ namespace dmGameSystem
         return instance;
     }
 
+    uint32_t CompFactorySpawnBatch(HFactoryWorld world, HFactoryComponent component, dmGameObject::HCollection collection, uint32_t count,
+                                    const dmVMath::Point3* positions, const dmVMath::Quat* rotations, const dmVMath::Vector3* scales,
+                                    dmGameObject::HPropertyContainer properties, dmGameObject::HInstance* out_instances)
+    {
+        dmGameObject::HPrototype prototype = CompFactoryGetPrototype(world, component);
+        const char* path = CompFactoryGetPrototypePath(world, component);
+
+        return dmGameObject::SpawnBatch(collection, prototype, path, count, properties, positions, rotations, scales, out_instances);
+    }
+
 
 }
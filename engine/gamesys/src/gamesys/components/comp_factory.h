@@ -42,6 +42,11 @@ namespace dmGameSystem
     HFactoryResource    CompFactoryGetDefaultResource(HFactoryWorld world, HFactoryComponent component);
     HFactoryResource    CompFactoryGetCustomResource(HFactoryWorld world, HFactoryComponent component);
 
+    // Spawns count instances with generated ids, see dmGameObject::SpawnBatch(). Returns the number of spawned instances
+    uint32_t            CompFactorySpawnBatch(HFactoryWorld world, HFactoryComponent component, dmGameObject::HCollection collection, uint32_t count,
+                                                const dmVMath::Point3* positions, const dmVMath::Quat* rotations, const dmVMath::Vector3* scales,
+                                                dmGameObject::HPropertyContainer properties, dmGameObject::HInstance* out_instances);
+
 }
 
 #endif
@@ -381,6 +381,7 @@ namespace dmGameSystem
         gui_world->m_MaxParticleCount = gui_context->m_MaxParticleCount;
         gui_world->m_MaxParticleBufferCount = gui_context->m_MaxParticleBufferCount;
         gui_world->m_ParticleContext = dmParticle::CreateContext(gui_world->m_MaxParticleFXCount, gui_world->m_MaxParticleCount);
+        dmParticle::SetJobThreadContext(gui_world->m_ParticleContext, dmRender::GetJobThreadContext(gui_context->m_RenderContext));
         gui_world->m_MaxAnimationCount = gui_context->m_MaxAnimationCount;
 
         gui_world->m_ScriptWorld = dmScript::NewScriptWorld(gui_context->m_ScriptContext);
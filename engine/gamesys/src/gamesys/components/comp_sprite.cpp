@@ -20,6 +20,7 @@
 
 #include <dlib/array.h>
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <dlib/log.h>
 #include <dlib/message.h>
 #include <dlib/profile.h>
@@ -51,6 +52,7 @@ DM_PROPERTY_U32(rmtp_Sprite, 0, FrameReset, "# components", &rmtp_Components);
 DM_PROPERTY_U32(rmtp_SpriteVertexCount, 0, FrameReset, "# vertices", &rmtp_Sprite);
 DM_PROPERTY_U32(rmtp_SpriteVertexSize, 0, FrameReset, "size of vertices in bytes", &rmtp_Sprite);
 DM_PROPERTY_U32(rmtp_SpriteIndexSize, 0, FrameReset, "size of indices in bytes", &rmtp_Sprite);
+DM_PROPERTY_U32(rmtp_SpriteInstanceSize, 0, FrameReset, "size of instance data in bytes", &rmtp_Sprite);
 
 namespace dmGameSystem
 {
@@ -65,9 +67,20 @@ namespace dmGameSystem
         SpriteResourceOverrides() : m_Material(0) {}
     };
 
+    // The inputs to SpriteComponent::m_World and the vertices, except the animation frame and the resources.
+    // If any of them changed since the last frame, the sprite is updated, see UpdateTransforms()
+    struct SpriteVertexKey
+    {
+        Matrix4                     m_InstanceWorld;
+        Vector3                     m_Scale;
+        Vector3                     m_Size;
+        Vector4                     m_Slice9;
+    };
+
     struct SpriteComponent
     {
         Matrix4                     m_World;
+        SpriteVertexKey             m_VertexKey;
         Vector3                     m_Position;
         Quat                        m_Rotation;
         Vector3                     m_Scale;
@@ -86,6 +99,20 @@ namespace dmGameSystem
 
         uint32_t                    m_AnimationID; // index into array
         uint32_t                    m_DynamicVertexAttributeIndex;
+        float                       m_BoundingRadiusSq;
+
+        // The vertices followed by the (zero based) indices last generated for the sprite, see CreateVertexData().
+        // Reused as long as m_VertexCacheDirty isn't set, and the sprite is rendered with the same material and vertex stride
+        uint8_t*                    m_VertexCache;
+        dmRender::HMaterial         m_VertexCacheMaterial;
+        uint32_t                    m_VertexCacheCapacity;
+        uint32_t                    m_VertexCacheStride;
+        uint32_t                    m_CachedVertexCount;
+        uint32_t                    m_CachedIndexCount;
+
+        // The number of vertices and indices the sprite outputs this frame, see UpdateVertexAndIndexCount()
+        uint32_t                    m_VertexCount;
+        uint32_t                    m_IndexCount;
 
         /// Currently playing animation
         dmhash_t                    m_CurrentAnimation;
@@ -106,26 +133,54 @@ namespace dmGameSystem
         uint16_t                    m_AddedToUpdate : 1;
         uint16_t                    m_ReHash : 1;
         uint16_t                    m_UseSlice9 : 1;
-        uint16_t                    : 6;
+        uint16_t                    m_VertexCacheDirty : 1;
+        uint16_t                    : 5;
     };
 
     const uint32_t MAX_TEXTURE_COUNT = dmRender::RenderObject::MAX_TEXTURE_COUNT;
 
+    // Batches with at least this many sprites are split into chunks, and filled in on the job threads
+    static const uint32_t VERTEX_JOB_MIN_SPRITE_COUNT = 1024;
+    static const uint32_t VERTEX_JOB_CHUNK_SIZE       = 256;
+
+    // Vertex buffer bindings of the instanced render path
+    static const uint8_t VX_DECL_BASE_BUFFER     = 0;
+    static const uint8_t VX_DECL_INSTANCE_BUFFER = 1;
+
+    // Scratch buffers used when generating the vertices of a sprite
+    struct SpriteVertexScratch
+    {
+        // We currently assume the vertex format uses 2-tuple UVs
+        dmArray<float>                      m_UVs[MAX_TEXTURE_COUNT];
+        dmArray<Vector4>                    m_PositionWorld;
+        dmArray<Vector4>                    m_PositionLocal;
+    };
+
+    // A range of sprites in a batch, and where in the buffers their vertices and indices are written
+    struct SpriteVertexChunk
+    {
+        uint32_t*                           m_Begin;
+        uint32_t*                           m_End;
+        uint8_t*                            m_Vertices;
+        uint8_t*                            m_Indices;
+        uint32_t                            m_VertexOffset;
+    };
+
     struct SpriteWorld
     {
         dmObjectPool<SpriteComponent>       m_Components;
         DynamicAttributePool                m_DynamicVertexAttributePool;
         dmArray<dmRender::RenderObject*>    m_RenderObjects;
         dmArray<float>                      m_BoundingVolumes;
-        // We currently assume the vertex format uses 2-tuple UVs
-        dmArray<float>                      m_ScratchUVs[MAX_TEXTURE_COUNT];
-        dmArray<Vector4>                    m_ScratchPositionWorld;
-        dmArray<Vector4>                    m_ScratchPositionLocal;
+        dmArray<SpriteVertexChunk>          m_VertexChunks;
+        dmArray<SpriteVertexScratch*>       m_VertexScratch; // One per chunk, so that chunks can be processed in parallel
         uint32_t                            m_RenderObjectsInUse;
         dmRender::HBufferedRenderBuffer     m_VertexBuffer;
         uint8_t*                            m_VertexBufferData;
         uint8_t*                            m_VertexBufferWritePtr;
         dmRender::HBufferedRenderBuffer     m_IndexBuffer;
+        dmRender::HBufferedRenderBuffer     m_InstanceBuffer;
+        dmArray<uint8_t>                    m_InstanceBufferData;
         uint32_t                            m_VerticesWritten;
         uint32_t                            m_VertexMemorySize;
         uint32_t                            m_VertexCount;
@@ -203,6 +258,8 @@ namespace dmGameSystem
         sprite_world->m_ReallocBuffers = 0;
     }
 
+    static void ResourceReloadedCallback(const dmResource::ResourceReloadedParams* params);
+
     dmGameObject::CreateResult CompSpriteNewWorld(const dmGameObject::ComponentNewWorldParams& params)
     {
         SpriteContext* sprite_context = (SpriteContext*)params.m_Context;
@@ -217,10 +274,14 @@ namespace dmGameSystem
         sprite_world->m_VertexBufferData = 0;
         sprite_world->m_IndexBuffer      = 0;
         sprite_world->m_IndexBufferData  = 0;
+        sprite_world->m_InstanceBuffer   = dmRender::NewBufferedRenderBuffer(sprite_context->m_RenderContext, dmRender::RENDER_BUFFER_TYPE_VERTEX_BUFFER);
 
         InitializeMaterialAttributeInfos(sprite_world->m_DynamicVertexAttributePool, 8);
 
         *params.m_World = sprite_world;
+
+        dmResource::RegisterResourceReloadedCallback(sprite_context->m_Factory, ResourceReloadedCallback, sprite_world);
+
         return dmGameObject::CREATE_RESULT_OK;
     }
 
@@ -230,16 +291,30 @@ namespace dmGameSystem
 
         DestroyMaterialAttributeInfos(sprite_world->m_DynamicVertexAttributePool);
 
+        dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
+        for (uint32_t i = 0; i < components.Size(); ++i)
+        {
+            free(components[i].m_VertexCache);
+        }
+
         for (uint32_t i = 0; i < sprite_world->m_RenderObjects.Size(); ++i)
         {
             delete sprite_world->m_RenderObjects[i];
         }
 
+        for (uint32_t i = 0; i < sprite_world->m_VertexScratch.Size(); ++i)
+        {
+            delete sprite_world->m_VertexScratch[i];
+        }
+
         SpriteContext* sprite_context = (SpriteContext*)params.m_Context;
         dmRender::DeleteBufferedRenderBuffer(sprite_context->m_RenderContext, sprite_world->m_VertexBuffer);
         free(sprite_world->m_VertexBufferData);
         dmRender::DeleteBufferedRenderBuffer(sprite_context->m_RenderContext, sprite_world->m_IndexBuffer);
         free(sprite_world->m_IndexBufferData);
+        dmRender::DeleteBufferedRenderBuffer(sprite_context->m_RenderContext, sprite_world->m_InstanceBuffer);
+
+        dmResource::UnregisterResourceReloadedCallback(sprite_context->m_Factory, ResourceReloadedCallback, sprite_world);
 
         delete sprite_world;
         return dmGameObject::CREATE_RESULT_OK;
@@ -504,6 +579,7 @@ namespace dmGameSystem
 
         uint32_t frame_current = component->m_CurrentAnimationFrame;
         component->m_CurrentAnimationFrame = frame;
+        component->m_VertexCacheDirty |= frame != frame_current;
 
         if (component->m_Resource->m_DDF->m_SizeMode == dmGameSystemDDF::SpriteDesc::SIZE_MODE_AUTO && frame != frame_current)
         {
@@ -515,6 +591,7 @@ namespace dmGameSystem
     {
         TextureSetResource* texture_set = GetFirstTextureSet(component);
         uint32_t* anim_id = texture_set ? texture_set->m_AnimationIds.Get(animation) : 0;
+        component->m_VertexCacheDirty = 1;
         if (anim_id)
         {
             component->m_AnimationID = *anim_id;
@@ -608,6 +685,7 @@ namespace dmGameSystem
         component->m_Enabled = 1;
         component->m_FunctionRef = 0;
         component->m_ReHash = 1;
+        component->m_VertexCacheDirty = 1;
         component->m_Slice9 = component->m_Resource->m_DDF->m_Slice9;
         component->m_UseSlice9 = sum(component->m_Slice9) != 0 &&
                 component->m_Resource->m_DDF->m_SizeMode == dmGameSystemDDF::SpriteDesc::SIZE_MODE_MANUAL;
@@ -655,6 +733,8 @@ namespace dmGameSystem
 
         FreeMaterialAttribute(sprite_world->m_DynamicVertexAttributePool, component->m_DynamicVertexAttributeIndex);
 
+        free(component->m_VertexCache);
+
         sprite_world->m_Components.Free(index, true);
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -1182,44 +1262,127 @@ namespace dmGameSystem
         }
     }
 
-    static void CreateVertexData(SpriteWorld* sprite_world, dmGraphics::VertexAttributeInfos* material_attribute_info, bool has_local_position_attribute, uint8_t** vb_where, uint8_t** ib_where, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    // A reloaded material keeps its handle, but may have a new vertex format
+    static inline bool HasValidVertexCache(const SpriteComponent* component, dmRender::HMaterial material, uint32_t vertex_stride)
     {
-        DM_PROFILE("CreateVertexData");
+        return !component->m_VertexCacheDirty && component->m_VertexCache != 0 &&
+               component->m_VertexCacheMaterial == material && component->m_VertexCacheStride == vertex_stride;
+    }
 
-        uint8_t* vertices        = *vb_where;
-        uint8_t* indices         = *ib_where;
-        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+    // Writes the cached vertices and indices of the sprite to the buffers
+    static void WriteCachedVertexData(const SpriteComponent* component, bool is_16_bit_index, uint32_t vertex_stride, uint32_t vertex_offset, uint8_t* vertices, uint8_t* indices)
+    {
+        uint32_t vertex_data_size = component->m_CachedVertexCount * vertex_stride;
+        memcpy(vertices, component->m_VertexCache, vertex_data_size);
 
-        const dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
+        const uint32_t* cached_indices = (const uint32_t*) (component->m_VertexCache + DM_ALIGN(vertex_data_size, sizeof(uint32_t)));
+        uint32_t index_count = component->m_CachedIndexCount;
+        if (is_16_bit_index)
+        {
+            for (uint32_t i = 0; i < index_count; ++i)
+            {
+                ((uint16_t*)indices)[i] = vertex_offset + cached_indices[i];
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < index_count; ++i)
+            {
+                ((uint32_t*)indices)[i] = vertex_offset + cached_indices[i];
+            }
+        }
+    }
 
-        // The offset for the indices
-        uint32_t vertex_offset = sprite_world->m_VerticesWritten;
-        uint32_t vertex_stride = material_attribute_info->m_VertexStride;
+    // Keeps a copy of the vertices and indices just generated for the sprite, so that they can be reused while the sprite doesn't change
+    static void StoreVertexCache(SpriteComponent* component, dmRender::HMaterial material, bool is_16_bit_index,
+                                 const uint8_t* vertices, uint32_t vertex_count, uint32_t vertex_stride,
+                                 const uint8_t* indices, uint32_t index_count, uint32_t vertex_offset)
+    {
+        // Sprites with vertex attributes set from script may change at any time
+        if (component->m_DynamicVertexAttributeIndex != INVALID_DYNAMIC_ATTRIBUTE_INDEX)
+        {
+            return;
+        }
 
-        uint32_t component_index = (uint32_t)buf[*begin].m_UserData;
-        const SpriteComponent* first = (const SpriteComponent*) &sprite_world->m_Components.GetRawObjects()[component_index];
+        uint32_t vertex_data_size = vertex_count * vertex_stride;
+        uint32_t index_data_offset = (uint32_t) DM_ALIGN(vertex_data_size, sizeof(uint32_t));
+        uint32_t size = index_data_offset + index_count * sizeof(uint32_t);
+        if (size > component->m_VertexCacheCapacity)
+        {
+            component->m_VertexCache = (uint8_t*) realloc(component->m_VertexCache, size);
+            component->m_VertexCacheCapacity = size;
+        }
+
+        memcpy(component->m_VertexCache, vertices, vertex_data_size);
+        uint32_t* cached_indices = (uint32_t*) (component->m_VertexCache + index_data_offset);
+        for (uint32_t i = 0; i < index_count; ++i)
+        {
+            uint32_t index = is_16_bit_index ? ((const uint16_t*)indices)[i] : ((const uint32_t*)indices)[i];
+            cached_indices[i] = index - vertex_offset;
+        }
+
+        component->m_VertexCacheMaterial = material;
+        component->m_VertexCacheStride = vertex_stride;
+        component->m_CachedVertexCount = vertex_count;
+        component->m_CachedIndexCount = index_count;
+        component->m_VertexCacheDirty = 0;
+    }
+
+    struct SpriteVertexJobContext
+    {
+        SpriteWorld*                        m_World;
+        dmRender::HMaterial                 m_Material;
+        dmGraphics::VertexAttributeInfos*   m_MaterialAttributeInfo;
+        dmRender::RenderListEntry*          m_Buf;
+        const TexturesData*                 m_Textures; // The texture sets of the batch
+        bool                                m_HasLocalPositionAttribute;
+    };
+
+    // Writes the vertices and indices of the sprites in the chunk. Only touches the chunk's part of the buffers, and the sprites in it.
+    static void CreateVertexDataChunk(const SpriteVertexJobContext* ctx, const SpriteVertexChunk* chunk, SpriteVertexScratch* scratch)
+    {
+        SpriteWorld* sprite_world                          = ctx->m_World;
+        dmRender::HMaterial material                       = ctx->m_Material;
+        dmGraphics::VertexAttributeInfos* material_attribute_info = ctx->m_MaterialAttributeInfo;
+        dmRender::RenderListEntry* buf                     = ctx->m_Buf;
+        bool has_local_position_attribute                  = ctx->m_HasLocalPositionAttribute;
+
+        uint8_t* vertices        = chunk->m_Vertices;
+        uint8_t* indices         = chunk->m_Indices;
+        uint32_t vertex_offset   = chunk->m_VertexOffset;
+        uint32_t vertex_stride   = material_attribute_info->m_VertexStride;
+        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
 
         // The list of pointers to the scratch uvs and page indices
         float* scratch_uv_ptrs[MAX_TEXTURE_COUNT] = {};
         float* scratch_pi_ptrs[MAX_TEXTURE_COUNT] = {};
 
-        TexturesData textures = {};
-        textures.m_NumTextures = GetNumTextures(first);
-        for (uint32_t i = 0; i < textures.m_NumTextures; ++i)
-        {
-            textures.m_Resources[i] = GetTextureSetByIndex(first, i);
-            textures.m_TextureSets[i] = textures.m_Resources[i]->m_TextureSet;
-        }
+        TexturesData textures = *ctx->m_Textures;
 
         dmGraphics::VertexAttributeInfos sprite_attribute_info = {};
         dmGraphics::WriteAttributeParams write_params = {};
 
-        for (uint32_t* i = begin; i != end; ++i)
+        for (uint32_t* i = chunk->m_Begin; i != chunk->m_End; ++i)
         {
             uint32_t component_index         = (uint32_t)buf[*i].m_UserData;
-            const SpriteComponent* component = (const SpriteComponent*) &components[component_index];
+            SpriteComponent* component       = &components[component_index];
             const Matrix4& world_matrix      = component->m_World;
 
+            if (HasValidVertexCache(component, material, vertex_stride))
+            {
+                WriteCachedVertexData(component, sprite_world->m_Is16BitIndex, vertex_stride, vertex_offset, vertices, indices);
+                vertices      += component->m_CachedVertexCount * vertex_stride;
+                indices       += component->m_CachedIndexCount * index_type_size;
+                vertex_offset += component->m_CachedVertexCount;
+                continue;
+            }
+
+            uint8_t* vertices_begin      = vertices;
+            uint8_t* indices_begin       = indices;
+            uint32_t vertex_offset_begin = vertex_offset;
+
             float sp_width  = component->m_Size.getX();
             float sp_height = component->m_Size.getY();
 
@@ -1240,16 +1403,6 @@ namespace dmGameSystem
                 sprite_attribute_info_ptr = &sprite_attribute_info;
             }
 
-            // We need to pad the buffer if the vertex stride doesn't start at an even byte offset from the start
-            const uint32_t vb_buffer_offset = vertices - sprite_world->m_VertexBufferData;
-            vertex_offset = vb_buffer_offset / vertex_stride;
-
-            if (vb_buffer_offset % vertex_stride != 0)
-            {
-                vertices      += vertex_stride - vb_buffer_offset % vertex_stride;
-                vertex_offset += 1;
-            }
-
             // if num_texture == 0, then we don't have a texture set to get any vertex/uv coordinates from
             if (textures.m_NumTextures != 0 && !CanUseQuads(&textures))
             {
@@ -1264,16 +1417,16 @@ namespace dmGameSystem
                 // to respect face winding (and backface culling)
                 int reverse = flipx ^ flipy;
 
-                ResolvePositionAndUVDataFromGeometry(&textures, sprite_world->m_ScratchPositionWorld, sprite_world->m_ScratchUVs, scratch_uv_ptrs, scratch_pi_ptrs, scaleX, scaleY, reverse);
+                ResolvePositionAndUVDataFromGeometry(&textures, scratch->m_PositionWorld, scratch->m_UVs, scratch_uv_ptrs, scratch_pi_ptrs, scaleX, scaleY, reverse);
 
                 if (has_local_position_attribute)
                 {
-                    EnsureSize(sprite_world->m_ScratchPositionLocal, sprite_world->m_ScratchPositionWorld.Size());
+                    EnsureSize(scratch->m_PositionLocal, scratch->m_PositionWorld.Size());
                 }
 
                 const float* world_matrix_channel[]    = { (float*) &world_matrix };
-                const float* world_position_channels[] = { (float*) sprite_world->m_ScratchPositionWorld.Begin() };
-                const float* local_position_channels[] = { (float*) sprite_world->m_ScratchPositionLocal.Begin() };
+                const float* world_position_channels[] = { (float*) scratch->m_PositionWorld.Begin() };
+                const float* local_position_channels[] = { (float*) scratch->m_PositionLocal.Begin() };
 
                 FillWriteVertexAttributeParams(&write_params, sprite_attribute_info_ptr,
                     world_matrix_channel,
@@ -1284,18 +1437,18 @@ namespace dmGameSystem
                     (const float**) scratch_pi_ptrs,
                     textures.m_NumTextures);
 
-                uint32_t num_vertices = sprite_world->m_ScratchPositionWorld.Size();
+                uint32_t num_vertices = scratch->m_PositionWorld.Size();
                 for (uint32_t vertex_index = 0; vertex_index < num_vertices; ++vertex_index)
                 {
                     if (has_local_position_attribute)
                     {
-                        sprite_world->m_ScratchPositionLocal[vertex_index] = Vector4(
-                            sprite_world->m_ScratchPositionWorld[vertex_index].getX() * sp_width,
-                            sprite_world->m_ScratchPositionWorld[vertex_index].getY() * sp_height,
+                        scratch->m_PositionLocal[vertex_index] = Vector4(
+                            scratch->m_PositionWorld[vertex_index].getX() * sp_width,
+                            scratch->m_PositionWorld[vertex_index].getY() * sp_height,
                             0.0f, 1.0f);
                     }
 
-                    sprite_world->m_ScratchPositionWorld[vertex_index] = world_matrix * sprite_world->m_ScratchPositionWorld[vertex_index];
+                    scratch->m_PositionWorld[vertex_index] = world_matrix * scratch->m_PositionWorld[vertex_index];
                     vertices = dmGraphics::WriteAttributes(vertices, vertex_index, write_params);
                 }
 
@@ -1343,8 +1496,8 @@ namespace dmGameSystem
                     int flipy = component->m_FlipVertical;
                     CreateVertexDataSlice9(vertices, indices, sprite_world->m_Is16BitIndex, has_local_position_attribute,
                         world_matrix, component->m_Size, component->m_Slice9, vertex_offset, vertex_stride,
-                        &textures, sprite_world->m_ScratchUVs, scratch_uv_ptrs, scratch_pi_ptrs,
-                        &sprite_world->m_ScratchPositionWorld, &sprite_world->m_ScratchPositionLocal,
+                        &textures, scratch->m_UVs, scratch_uv_ptrs, scratch_pi_ptrs,
+                        &scratch->m_PositionWorld, &scratch->m_PositionLocal,
                         flipx, flipy, sprite_attribute_info_ptr);
 
                     indices       += index_type_size * SPRITE_INDEX_COUNT_SLICE9;
@@ -1358,7 +1511,7 @@ namespace dmGameSystem
                     //    Thus we can use the corresponding quad for each image
                     // B) The first image is a quad, and any remapping
                     //    for any subsequent geometry would yield a quad anyways.
-                    ResolveUVDataFromQuads(&textures, sprite_world->m_ScratchUVs, scratch_uv_ptrs, scratch_pi_ptrs, component->m_FlipHorizontal, component->m_FlipVertical);
+                    ResolveUVDataFromQuads(&textures, scratch->m_UVs, scratch_uv_ptrs, scratch_pi_ptrs, component->m_FlipHorizontal, component->m_FlipVertical);
 
                     // We always use the first geometry for the vertices
                     float pivot_x = 0;
@@ -1438,67 +1591,145 @@ namespace dmGameSystem
                     indices       += SPRITE_INDEX_COUNT_LEGACY * index_type_size;
                 }
             }
-        }
 
-        sprite_world->m_VerticesWritten = vertex_offset;
+            StoreVertexCache(component, material, sprite_world->m_Is16BitIndex,
+                vertices_begin, vertex_offset - vertex_offset_begin, vertex_stride,
+                indices_begin, (indices - indices_begin) / index_type_size, vertex_offset_begin);
+        }
+    }
 
-        *vb_where = vertices;
-        *ib_where = indices;
+    static void CreateVertexDataChunks(void* context, void* data, uint32_t start, uint32_t end)
+    {
+        const SpriteVertexJobContext* ctx = (const SpriteVertexJobContext*) context;
+        const SpriteVertexChunk* chunks = (const SpriteVertexChunk*) data;
+        for (uint32_t i = start; i < end; ++i)
+        {
+            CreateVertexDataChunk(ctx, &chunks[i], ctx->m_World->m_VertexScratch[i]);
+        }
     }
 
-    static void RenderBatch(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    static void CreateVertexData(SpriteWorld* sprite_world, dmJobThread::HContext job_thread, dmRender::HMaterial material, dmGraphics::VertexAttributeInfos* material_attribute_info, bool has_local_position_attribute, uint8_t** vb_where, uint8_t** ib_where, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
     {
-        DM_PROFILE("SpriteRenderBatch");
+        DM_PROFILE("CreateVertexData");
+
+        uint8_t* vertices        = *vb_where;
+        uint8_t* indices         = *ib_where;
+        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+        uint32_t vertex_stride   = material_attribute_info->m_VertexStride;
+
+        const dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
+
+        // We need to pad the buffer if the vertex stride doesn't start at an even byte offset from the start
+        const uint32_t vb_buffer_offset = vertices - sprite_world->m_VertexBufferData;
+        if (vb_buffer_offset % vertex_stride != 0)
+        {
+            vertices += vertex_stride - vb_buffer_offset % vertex_stride;
+        }
+
+        // The offset for the indices
+        uint32_t vertex_offset = (vertices - sprite_world->m_VertexBufferData) / vertex_stride;
 
         uint32_t component_index = (uint32_t)buf[*begin].m_UserData;
-        const SpriteComponent* first = (const SpriteComponent*) &sprite_world->m_Components.GetRawObjects()[component_index];
-        assert(first->m_Enabled);
+        const SpriteComponent* first = (const SpriteComponent*) &components[component_index];
 
-        SpriteResource* resource = first->m_Resource;
+        TexturesData textures = {};
+        textures.m_NumTextures = GetNumTextures(first);
+        for (uint32_t i = 0; i < textures.m_NumTextures; ++i)
+        {
+            textures.m_Resources[i] = GetTextureSetByIndex(first, i);
+            textures.m_TextureSets[i] = textures.m_Resources[i]->m_TextureSet;
+        }
 
-        // Although we generally like to preallocate it, we cannot since we
-        // 1) don't want to preallocate max_sprite number of render objects and
-        // 2) We cannot keep the render object in a (small) fixed array and then reallocate it, since we pass the pointer to the render engine
-        if (sprite_world->m_RenderObjectsInUse == sprite_world->m_RenderObjects.Capacity())
+        uint32_t sprite_count = end - begin;
+        uint32_t chunk_size   = sprite_count;
+        if (job_thread && sprite_count >= VERTEX_JOB_MIN_SPRITE_COUNT)
         {
-            sprite_world->m_RenderObjects.OffsetCapacity(1);
-            dmRender::RenderObject* ro = new dmRender::RenderObject;
-            sprite_world->m_RenderObjects.Push(ro);
+            chunk_size = VERTEX_JOB_CHUNK_SIZE;
         }
+        uint32_t num_chunks = (sprite_count + chunk_size - 1) / chunk_size;
 
-        dmRender::RenderObject& ro = *sprite_world->m_RenderObjects[sprite_world->m_RenderObjectsInUse++];
-        dmRender::HMaterial material           = GetRenderMaterial(render_context, first);
-        dmGraphics::HVertexDeclaration vx_decl = dmRender::GetVertexDeclaration(material);
+        dmArray<SpriteVertexChunk>& chunks = sprite_world->m_VertexChunks;
+        if (chunks.Capacity() < num_chunks)
+        {
+            chunks.SetCapacity(num_chunks);
+        }
+        chunks.SetSize(num_chunks);
 
-        dmGraphics::VertexAttributeInfos material_attribute_info;
-        // Same default coordinate space as the editor
-        FillMaterialAttributeInfos(material, vx_decl, &material_attribute_info, dmGraphics::COORDINATE_SPACE_WORLD);
+        dmArray<SpriteVertexScratch*>& scratch = sprite_world->m_VertexScratch;
+        if (scratch.Size() < num_chunks)
+        {
+            scratch.SetCapacity(num_chunks);
+            while (scratch.Size() < num_chunks)
+            {
+                scratch.Push(new SpriteVertexScratch);
+            }
+        }
 
-        // Fill in vertex buffer
-        uint8_t* vb_begin = sprite_world->m_VertexBufferWritePtr;
-        uint8_t* ib_begin = (uint8_t*)sprite_world->m_IndexBufferWritePtr;
-        uint8_t* vb_iter  = vb_begin;
-        uint8_t* ib_iter  = ib_begin;
+        // The vertex and index counts of each sprite are known from UpdateVertexAndIndexCount(),
+        // so we know up front where each chunk writes its data. The output doesn't depend on how the chunks are scheduled.
+        for (uint32_t c = 0; c < num_chunks; ++c)
+        {
+            SpriteVertexChunk& chunk = chunks[c];
+            chunk.m_Begin        = begin + c * chunk_size;
+            chunk.m_End          = dmMath::Min(chunk.m_Begin + chunk_size, end);
+            chunk.m_Vertices     = vertices;
+            chunk.m_Indices      = indices;
+            chunk.m_VertexOffset = vertex_offset;
 
-        dmGraphics::VertexAttributeInfoMetadata material_attribute_info_meta = dmGraphics::GetVertexAttributeInfosMetaData(material_attribute_info);
-        CreateVertexData(sprite_world, &material_attribute_info, material_attribute_info_meta.m_HasAttributeLocalPosition, &vb_iter, &ib_iter, buf, begin, end);
+            for (uint32_t* i = chunk.m_Begin; i != chunk.m_End; ++i)
+            {
+                const SpriteComponent* component = &components[(uint32_t)buf[*i].m_UserData];
+                vertices      += component->m_VertexCount * vertex_stride;
+                indices       += component->m_IndexCount * index_type_size;
+                vertex_offset += component->m_VertexCount;
+            }
+        }
 
-        sprite_world->m_VertexBufferWritePtr = vb_iter;
-        sprite_world->m_IndexBufferWritePtr = ib_iter;
+        SpriteVertexJobContext ctx;
+        ctx.m_World                     = sprite_world;
+        ctx.m_Material                  = material;
+        ctx.m_MaterialAttributeInfo     = material_attribute_info;
+        ctx.m_Buf                       = buf;
+        ctx.m_Textures                  = &textures;
+        ctx.m_HasLocalPositionAttribute = has_local_position_attribute;
 
-        if (dmRender::GetBufferIndex(render_context, sprite_world->m_VertexBuffer) < sprite_world->m_DispatchCount)
+        if (num_chunks == 1)
         {
-            dmRender::AddRenderBuffer(render_context, sprite_world->m_VertexBuffer);
+            CreateVertexDataChunks(&ctx, chunks.Begin(), 0, 1);
         }
-        if (dmRender::GetBufferIndex(render_context, sprite_world->m_IndexBuffer) < sprite_world->m_DispatchCount)
+        else
         {
-            dmRender::AddRenderBuffer(render_context, sprite_world->m_IndexBuffer);
+            dmJobThread::ParallelFor(job_thread, CreateVertexDataChunks, &ctx, chunks.Begin(), num_chunks, 1);
         }
 
-        ro.Init();
-        ro.m_VertexDeclaration = vx_decl;
-        ro.m_VertexBuffer = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_VertexBuffer);
-        ro.m_IndexBuffer = (dmGraphics::HIndexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_IndexBuffer);
+        sprite_world->m_VerticesWritten = vertex_offset;
+
+        *vb_where = vertices;
+        *ib_where = indices;
+    }
+
+    static dmRender::RenderObject* AllocRenderObject(SpriteWorld* sprite_world)
+    {
+        // Although we generally like to preallocate it, we cannot since we
+        // 1) don't want to preallocate max_sprite number of render objects and
+        // 2) We cannot keep the render object in a (small) fixed array and then reallocate it, since we pass the pointer to the render engine
+        if (sprite_world->m_RenderObjectsInUse == sprite_world->m_RenderObjects.Capacity())
+        {
+            sprite_world->m_RenderObjects.OffsetCapacity(1);
+            dmRender::RenderObject* ro = new dmRender::RenderObject;
+            sprite_world->m_RenderObjects.Push(ro);
+        }
+
+        dmRender::RenderObject* ro = sprite_world->m_RenderObjects[sprite_world->m_RenderObjectsInUse++];
+        ro->Init();
+        return ro;
+    }
+
+    // Sets up the state that is shared by all sprites in a batch: material, textures, constants and blending
+    static void SetupRenderObject(SpriteWorld* sprite_world, dmRender::RenderObject& ro, const SpriteComponent* first)
+    {
+        SpriteResource* resource = first->m_Resource;
+
         ro.m_Material = GetComponentMaterial(first);
         for(uint32_t i = 0; i < resource->m_NumTextures; ++i)
         {
@@ -1508,17 +1739,6 @@ namespace dmGameSystem
         ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
         ro.m_IndexType = sprite_world->m_Is16BitIndex ? dmGraphics::TYPE_UNSIGNED_SHORT : dmGraphics::TYPE_UNSIGNED_INT;
 
-        // offset in bytes into element buffer
-        uint32_t index_offset = ib_begin - sprite_world->m_IndexBufferData;
-
-        // num elements = Number of bytes / sizeof(index_type)
-        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
-        uint32_t num_elements = ((uint8_t*)sprite_world->m_IndexBufferWritePtr - (uint8_t*)ib_begin) / index_type_size;
-
-        // These should be named "element" or "index" (as opposed to vertex)
-        ro.m_VertexStart = index_offset;
-        ro.m_VertexCount = num_elements;
-
         HComponentRenderConstants constants = GetRenderConstants(first);
         if (constants) {
             dmGameSystem::EnableRenderObjectConstants(&ro, constants);
@@ -1555,8 +1775,335 @@ namespace dmGameSystem
         }
 
         ro.m_SetBlendFactors = 1;
+    }
+
+    static void AddRenderBuffers(SpriteWorld* sprite_world, dmRender::HRenderContext render_context)
+    {
+        if (dmRender::GetBufferIndex(render_context, sprite_world->m_VertexBuffer) < sprite_world->m_DispatchCount)
+        {
+            dmRender::AddRenderBuffer(render_context, sprite_world->m_VertexBuffer);
+        }
+        if (dmRender::GetBufferIndex(render_context, sprite_world->m_IndexBuffer) < sprite_world->m_DispatchCount)
+        {
+            dmRender::AddRenderBuffer(render_context, sprite_world->m_IndexBuffer);
+        }
+        if (dmRender::GetBufferIndex(render_context, sprite_world->m_InstanceBuffer) < sprite_world->m_DispatchCount)
+        {
+            dmRender::AddRenderBuffer(render_context, sprite_world->m_InstanceBuffer);
+        }
+    }
+
+    // The instanced path draws a single unit quad per batch, and moves the per sprite data into the instance buffer.
+    // It can only be used if the per vertex attributes of the material don't carry any per sprite data.
+    static bool CanRenderInstanced(const dmGraphics::VertexAttributeInfos* material_attribute_info)
+    {
+        for (uint32_t i = 0; i < material_attribute_info->m_NumInfos; ++i)
+        {
+            const dmGraphics::VertexAttributeInfo& info = material_attribute_info->m_Infos[i];
+            if (info.m_StepFunction == dmGraphics::VERTEX_STEP_FUNCTION_VERTEX &&
+                (info.m_SemanticType == dmGraphics::VertexAttribute::SEMANTIC_TYPE_PAGE_INDEX ||
+                 info.m_SemanticType == dmGraphics::VertexAttribute::SEMANTIC_TYPE_WORLD_MATRIX))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Writes one instance per sprite. The instance data holds the world transform (including the pivot),
+    // the uv rectangle of each image as a vec4 (min uv, max uv), and the page indices.
+    // Returns false if any sprite needs more than a plain quad, in which case nothing is written.
+    static bool CreateInstanceData(SpriteWorld* sprite_world, dmGraphics::VertexAttributeInfos* instance_attribute_info, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("CreateInstanceData");
+
+        dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
+        const SpriteComponent* first = &components[(uint32_t)buf[*begin].m_UserData];
+
+        uint32_t instance_count  = end - begin;
+        uint32_t instance_stride = instance_attribute_info->m_VertexStride;
+        dmArray<uint8_t>& instance_data = sprite_world->m_InstanceBufferData;
+        if (instance_data.Remaining() < instance_count * instance_stride)
+        {
+            instance_data.OffsetCapacity(instance_count * instance_stride - instance_data.Remaining());
+        }
+
+        if (sprite_world->m_VertexScratch.Empty())
+        {
+            sprite_world->m_VertexScratch.OffsetCapacity(1);
+            sprite_world->m_VertexScratch.Push(new SpriteVertexScratch);
+        }
+        SpriteVertexScratch* scratch = sprite_world->m_VertexScratch[0];
+
+        TexturesData textures = {};
+        textures.m_NumTextures = GetNumTextures(first);
+        for (uint32_t i = 0; i < textures.m_NumTextures; ++i)
+        {
+            textures.m_Resources[i] = GetTextureSetByIndex(first, i);
+            textures.m_TextureSets[i] = textures.m_Resources[i]->m_TextureSet;
+        }
+
+        // Without any texture, the uvs will span the full [0,1] range
+        uint32_t uv_channel_count = dmMath::Max(1U, textures.m_NumTextures);
+
+        float* scratch_uv_ptrs[MAX_TEXTURE_COUNT] = {};
+        float* scratch_pi_ptrs[MAX_TEXTURE_COUNT] = {};
+        Vector4 uv_rects[MAX_TEXTURE_COUNT];
+        const float* uv_rect_channels[MAX_TEXTURE_COUNT];
+        for (uint32_t i = 0; i < MAX_TEXTURE_COUNT; ++i)
+        {
+            uv_rect_channels[i] = (const float*) &uv_rects[i];
+        }
+
+        dmGraphics::WriteAttributeParams write_params = {};
+        write_params.m_VertexAttributeInfos = instance_attribute_info;
+        write_params.m_StepFunction         = dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE;
+
+        Matrix4 world_matrix;
+        const float* world_matrix_channel[] = { (float*) &world_matrix };
+        dmGraphics::SetWriteAttributeStreamDesc(&write_params.m_WorldMatrix, world_matrix_channel, dmGraphics::VertexAttribute::VECTOR_TYPE_MAT4, 1, true);
+        dmGraphics::SetWriteAttributeStreamDesc(&write_params.m_TexCoords, uv_rect_channels, dmGraphics::VertexAttribute::VECTOR_TYPE_VEC4, uv_channel_count, true);
+        dmGraphics::SetWriteAttributeStreamDesc(&write_params.m_PageIndices, (const float**) scratch_pi_ptrs, dmGraphics::VertexAttribute::VECTOR_TYPE_SCALAR, textures.m_NumTextures, true);
+
+        uint8_t* write_ptr = instance_data.End();
+
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            const SpriteComponent* component = &components[(uint32_t)buf[*i].m_UserData];
+
+            if (component->m_UseSlice9 || component->m_Resource->m_DDF->m_Attributes.m_Count > 0 || component->m_DynamicVertexAttributeIndex != INVALID_DYNAMIC_ATTRIBUTE_INDEX)
+            {
+                return false;
+            }
+
+            ResolveAnimationData(&textures, component->m_CurrentAnimation, component->m_CurrentAnimationFrame);
+            if (!CanUseQuads(&textures))
+            {
+                return false;
+            }
+
+            ResolveUVDataFromQuads(&textures, scratch->m_UVs, scratch_uv_ptrs, scratch_pi_ptrs, component->m_FlipHorizontal, component->m_FlipVertical);
+
+            for (uint32_t t = 0; t < uv_channel_count; ++t)
+            {
+                const float* uvs = scratch_uv_ptrs[t];
+                if (!uvs)
+                {
+                    uv_rects[t] = Vector4(0.0f);
+                    continue;
+                }
+
+                // A rotated image doesn't map onto an axis aligned uv rectangle
+                if (uvs[2] != uvs[0] || uvs[3] != uvs[5] || uvs[6] != uvs[4] || uvs[7] != uvs[1])
+                {
+                    return false;
+                }
+                uv_rects[t] = Vector4(uvs[0], uvs[1], uvs[4], uvs[5]);
+            }
+
+            const dmGameSystemDDF::SpriteGeometry* geometry = textures.m_NumTextures > 0 ? textures.m_Geometries[0] : 0;
+            world_matrix = component->m_World;
+            if (geometry)
+            {
+                world_matrix = world_matrix * Matrix4::translation(Vector3(-geometry->m_PivotX, -geometry->m_PivotY, 0.0f));
+            }
+
+            write_ptr = dmGraphics::WriteAttributes(write_ptr, 0, write_params);
+        }
+
+        instance_data.SetSize(instance_data.Size() + instance_count * instance_stride);
+        return true;
+    }
+
+    // Writes the unit quad that all instances in the batch share. The texture coordinates of the quad
+    // are the weights for the corners of the uv rectangle of each instance.
+    // Returns the byte offset of the quad in the vertex buffer.
+    static uint32_t CreateInstancedQuad(SpriteWorld* sprite_world, dmGraphics::VertexAttributeInfos* material_attribute_info, uint32_t uv_channel_count)
+    {
+        uint8_t* vertices      = sprite_world->m_VertexBufferWritePtr;
+        uint8_t* indices       = sprite_world->m_IndexBufferWritePtr;
+        uint32_t vertex_stride = material_attribute_info->m_VertexStride;
+
+        // We need to pad the buffer if the vertex stride doesn't start at an even byte offset from the start
+        const uint32_t vb_buffer_offset = vertices - sprite_world->m_VertexBufferData;
+        if (vb_buffer_offset % vertex_stride != 0)
+        {
+            vertices += vertex_stride - vb_buffer_offset % vertex_stride;
+        }
+        uint32_t vertex_offset = vertices - sprite_world->m_VertexBufferData;
+
+        static const Vector4 positions[] = {
+            Vector4(-0.5f, -0.5f, 0.0f, 1.0f),
+            Vector4(-0.5f,  0.5f, 0.0f, 1.0f),
+            Vector4( 0.5f,  0.5f, 0.0f, 1.0f),
+            Vector4( 0.5f, -0.5f, 0.0f, 1.0f)};
+
+        static const float corners[] = {
+            0.0f, 0.0f,
+            0.0f, 1.0f,
+            1.0f, 1.0f,
+            1.0f, 0.0f};
+
+        const float* position_channels[] = { (float*) positions };
+        const float* uv_channels[MAX_TEXTURE_COUNT];
+        for (uint32_t i = 0; i < MAX_TEXTURE_COUNT; ++i)
+        {
+            uv_channels[i] = corners;
+        }
+
+        dmGraphics::WriteAttributeParams write_params;
+        FillWriteVertexAttributeParams(&write_params, material_attribute_info,
+            0,
+            position_channels,
+            position_channels,
+            uv_channels,
+            uv_channel_count,
+            0,
+            0);
+
+        for (uint32_t i = 0; i < SPRITE_VERTEX_COUNT_LEGACY; ++i)
+        {
+            vertices = dmGraphics::WriteAttributes(vertices, i, write_params);
+        }
+
+        // The vertex buffer offset of the render object points to the quad, so the indices start at zero
+        static const uint8_t quad_indices[] = { 0, 1, 2, 2, 3, 0 };
+        for (uint32_t i = 0; i < SPRITE_INDEX_COUNT_LEGACY; ++i)
+        {
+            if (sprite_world->m_Is16BitIndex)
+                ((uint16_t*) indices)[i] = quad_indices[i];
+            else
+                ((uint32_t*) indices)[i] = quad_indices[i];
+        }
+
+        sprite_world->m_VertexBufferWritePtr = vertices;
+        sprite_world->m_IndexBufferWritePtr  = indices + SPRITE_INDEX_COUNT_LEGACY * (sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t));
+        return vertex_offset;
+    }
+
+    static bool RenderBatchInstanced(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::HMaterial material, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    {
+        dmGraphics::HVertexDeclaration vx_decl_vert = dmRender::GetVertexDeclaration(material, dmGraphics::VERTEX_STEP_FUNCTION_VERTEX);
+        dmGraphics::HVertexDeclaration vx_decl_inst = dmRender::GetVertexDeclaration(material, dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE);
+
+        dmGraphics::VertexAttributeInfos material_attribute_info;
+        FillMaterialAttributeInfos(material, vx_decl_vert, &material_attribute_info, dmGraphics::COORDINATE_SPACE_WORLD);
+        if (!CanRenderInstanced(&material_attribute_info))
+        {
+            return false;
+        }
+
+        dmGraphics::VertexAttributeInfos instance_attribute_info;
+        FillMaterialAttributeInfos(material, vx_decl_inst, &instance_attribute_info, dmGraphics::COORDINATE_SPACE_WORLD);
+
+        uint32_t instance_offset = sprite_world->m_InstanceBufferData.Size();
+        if (!CreateInstanceData(sprite_world, &instance_attribute_info, buf, begin, end))
+        {
+            return false;
+        }
+
+        DM_PROFILE("SpriteRenderBatchInstanced");
+
+        const SpriteComponent* first = &sprite_world->m_Components.GetRawObjects()[(uint32_t)buf[*begin].m_UserData];
+
+        uint32_t index_offset  = sprite_world->m_IndexBufferWritePtr - sprite_world->m_IndexBufferData;
+        uint32_t vertex_offset = CreateInstancedQuad(sprite_world, &material_attribute_info, dmMath::Max(1U, GetNumTextures(first)));
+
+        AddRenderBuffers(sprite_world, render_context);
+
+        dmRender::RenderObject& ro = *AllocRenderObject(sprite_world);
+        ro.m_VertexDeclarations[VX_DECL_BASE_BUFFER]      = vx_decl_vert;
+        ro.m_VertexBuffers[VX_DECL_BASE_BUFFER]           = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_VertexBuffer);
+        ro.m_VertexBufferOffsets[VX_DECL_BASE_BUFFER]     = vertex_offset;
+        ro.m_VertexDeclarations[VX_DECL_INSTANCE_BUFFER]  = vx_decl_inst;
+        ro.m_VertexBuffers[VX_DECL_INSTANCE_BUFFER]       = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_InstanceBuffer);
+        ro.m_VertexBufferOffsets[VX_DECL_INSTANCE_BUFFER] = instance_offset;
+        ro.m_IndexBuffer   = (dmGraphics::HIndexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_IndexBuffer);
+        ro.m_VertexStart   = index_offset;
+        ro.m_VertexCount   = SPRITE_INDEX_COUNT_LEGACY;
+        ro.m_InstanceCount = end - begin;
+
+        SetupRenderObject(sprite_world, ro, first);
 
         dmRender::AddToRender(render_context, &ro);
+        return true;
+    }
+
+    static void RenderBatch(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("SpriteRenderBatch");
+
+        uint32_t component_index = (uint32_t)buf[*begin].m_UserData;
+        const SpriteComponent* first = (const SpriteComponent*) &sprite_world->m_Components.GetRawObjects()[component_index];
+        assert(first->m_Enabled);
+
+        dmRender::HMaterial material = GetRenderMaterial(render_context, first);
+
+        // Materials with per instance attributes (e.g. "mtx_world") draw the whole batch with a single instanced draw call
+        if (dmRender::GetVertexDeclaration(material, dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE) &&
+            RenderBatchInstanced(sprite_world, render_context, material, buf, begin, end))
+        {
+            return;
+        }
+
+        dmGraphics::HVertexDeclaration vx_decl = dmRender::GetVertexDeclaration(material);
+
+        dmGraphics::VertexAttributeInfos material_attribute_info;
+        // Same default coordinate space as the editor
+        FillMaterialAttributeInfos(material, vx_decl, &material_attribute_info, dmGraphics::COORDINATE_SPACE_WORLD);
+
+        // Fill in vertex buffer
+        uint8_t* vb_begin = sprite_world->m_VertexBufferWritePtr;
+        uint8_t* ib_begin = (uint8_t*)sprite_world->m_IndexBufferWritePtr;
+        uint8_t* vb_iter  = vb_begin;
+        uint8_t* ib_iter  = ib_begin;
+
+        dmGraphics::VertexAttributeInfoMetadata material_attribute_info_meta = dmGraphics::GetVertexAttributeInfosMetaData(material_attribute_info);
+        CreateVertexData(sprite_world, dmRender::GetJobThreadContext(render_context), material, &material_attribute_info, material_attribute_info_meta.m_HasAttributeLocalPosition, &vb_iter, &ib_iter, buf, begin, end);
+
+        sprite_world->m_VertexBufferWritePtr = vb_iter;
+        sprite_world->m_IndexBufferWritePtr = ib_iter;
+
+        AddRenderBuffers(sprite_world, render_context);
+
+        dmRender::RenderObject& ro = *AllocRenderObject(sprite_world);
+        ro.m_VertexDeclaration = vx_decl;
+        ro.m_VertexBuffer = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_VertexBuffer);
+        ro.m_IndexBuffer = (dmGraphics::HIndexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_IndexBuffer);
+
+        // offset in bytes into element buffer
+        uint32_t index_offset = ib_begin - sprite_world->m_IndexBufferData;
+
+        // num elements = Number of bytes / sizeof(index_type)
+        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+        uint32_t num_elements = ((uint8_t*)sprite_world->m_IndexBufferWritePtr - (uint8_t*)ib_begin) / index_type_size;
+
+        // These should be named "element" or "index" (as opposed to vertex)
+        ro.m_VertexStart = index_offset;
+        ro.m_VertexCount = num_elements;
+
+        SetupRenderObject(sprite_world, ro, first);
+
+        dmRender::AddToRender(render_context, &ro);
+    }
+
+    static void UpdateTransform(SpriteComponent* c, const Matrix4& world, bool scale_along_z, bool sub_pixels)
+    {
+        Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
+        Matrix4 w = scale_along_z ? world * local : dmTransform::MulNoScaleZ(world, local);
+        Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
+        c->m_World = dmVMath::AppendScale(w, size);
+        // we need to consider the full scale here
+        // I.e. we want the length of the diagonal C, where C = X + Y
+        c->m_BoundingRadiusSq = dmVMath::LengthSqr((c->m_World.getCol(0).getXYZ() + c->m_World.getCol(1).getXYZ()) * 0.5f);
+
+        // The "sub_pixels" is set by default
+        if (!sub_pixels) {
+            Vector4 position = c->m_World.getCol3();
+            position.setX((int) position.getX());
+            position.setY((int) position.getY());
+            c->m_World.setCol3(position);
+        }
     }
 
     static void UpdateTransforms(SpriteWorld* sprite_world, bool sub_pixels)
@@ -1571,47 +2118,26 @@ namespace dmGameSystem
             SpriteComponent* c = &components[0];
             scale_along_z = dmGameObject::ScaleAlongZ(dmGameObject::GetCollection(c->m_Instance));
         }
-        // Note: We update all sprites, even though they might be disabled, or not added to update
 
-        if (scale_along_z) {
-            for (uint32_t i = 0; i < n; ++i)
-            {
-                SpriteComponent* c = &components[i];
-                Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
-                Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
-                Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = dmVMath::AppendScale(world * local, size);
-                // we need to consider the full scale here
-                // I.e. we want the length of the diagonal C, where C = X + Y
-                float radius_sq = dmVMath::LengthSqr((c->m_World.getCol(0).getXYZ() + c->m_World.getCol(1).getXYZ()) * 0.5f);
-                sprite_world->m_BoundingVolumes[i] = radius_sq;
-            }
-        } else
+        // Note: We check all sprites, even though they might be disabled, or not added to update.
+        // Only the sprites that moved or changed size are recalculated, and need new vertices
+        SpriteVertexKey key;
+        memset(&key, 0, sizeof(key));
+        for (uint32_t i = 0; i < n; ++i)
         {
-            for (uint32_t i = 0; i < n; ++i)
+            SpriteComponent* c = &components[i];
+            key.m_InstanceWorld = dmGameObject::GetWorldMatrix(c->m_Instance);
+            key.m_Scale = c->m_Scale;
+            key.m_Size = c->m_Size;
+            key.m_Slice9 = c->m_Slice9;
+            if (memcmp(&key, &c->m_VertexKey, sizeof(key)) != 0)
             {
-                SpriteComponent* c = &components[i];
-                Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
-                Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
-                Matrix4 w = dmTransform::MulNoScaleZ(world, local);
-                Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = dmVMath::AppendScale(w, size);
-                // we need to consider the full scale here
-                // I.e. we want the length of the diagonal C, where C = X + Y
-                float radius_sq = dmVMath::LengthSqr((c->m_World.getCol(0).getXYZ() + c->m_World.getCol(1).getXYZ()) * 0.5f);
-                sprite_world->m_BoundingVolumes[i] = radius_sq;
-            }
-        }
-
-        // The "sub_pixels" is set by default
-        if (!sub_pixels) {
-            for (uint32_t i = 0; i < n; ++i) {
-                SpriteComponent* c = &components[i];
-                Vector4 position = c->m_World.getCol3();
-                position.setX((int) position.getX());
-                position.setY((int) position.getY());
-                c->m_World.setCol3(position);
+                c->m_VertexKey = key;
+                UpdateTransform(c, key.m_InstanceWorld, scale_along_z, sub_pixels);
+                c->m_VertexCacheDirty = 1;
             }
+            // The sprites may have been reordered in the pool
+            sprite_world->m_BoundingVolumes[i] = c->m_BoundingRadiusSq;
         }
     }
 
@@ -1737,6 +2263,52 @@ namespace dmGameSystem
         }
     }
 
+    // Gets the number of vertices and indices the sprite outputs with its current animation frame
+    static void GetVertexAndIndexCount(const SpriteComponent* component, uint32_t* vertex_count, uint32_t* index_count)
+    {
+        TexturesData textures = {};
+        textures.m_NumTextures = GetNumTextures(component);
+
+        if (textures.m_NumTextures != 0)
+        {
+            for (uint32_t i = 0; i < textures.m_NumTextures; ++i)
+            {
+                textures.m_Resources[i] = GetTextureSetByIndex(component, i);
+                textures.m_TextureSets[i] = textures.m_Resources[i]->m_TextureSet;
+            }
+
+            // Get the correct animation frames, and other meta data
+            ResolveAnimationData(&textures, component->m_CurrentAnimation, component->m_CurrentAnimationFrame);
+
+            if (!CanUseQuads(&textures))
+            {
+                TextureSetResource* texture_set                     = GetFirstTextureSet(component);
+                dmGameSystemDDF::TextureSet* texture_set_ddf        = texture_set->m_TextureSet;
+                dmGameSystemDDF::TextureSetAnimation* animations    = texture_set_ddf->m_Animations.m_Data;
+                dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+                uint32_t* frame_indices                             = texture_set_ddf->m_FrameIndices.m_Data;
+                uint32_t frame_index                                = frame_indices[animation_ddf->m_Start + component->m_CurrentAnimationFrame];
+                dmGameSystemDDF::SpriteGeometry* geometries         = texture_set_ddf->m_Geometries.m_Data;
+                dmGameSystemDDF::SpriteGeometry* geometry           = &geometries[frame_index];
+
+                *vertex_count = geometry->m_Vertices.m_Count / 2; // (x,y) coordinates
+                *index_count  = geometry->m_Indices.m_Count;
+                return;
+            }
+        }
+
+        if (component->m_UseSlice9)
+        {
+            *vertex_count = SPRITE_VERTEX_COUNT_SLICE9;
+            *index_count  = SPRITE_INDEX_COUNT_SLICE9;
+        }
+        else
+        {
+            *vertex_count = SPRITE_VERTEX_COUNT_LEGACY;
+            *index_count  = SPRITE_INDEX_COUNT_LEGACY;
+        }
+    }
+
     static void UpdateVertexAndIndexCount(SpriteWorld* sprite_world, dmRender::HRenderContext render_context)
     {
         DM_PROFILE("UpdateVertexAndIndexCount");
@@ -1762,66 +2334,19 @@ namespace dmGameSystem
             // We need to pad the buffer if the vertex stride doesn't start at an even byte offset from the start
             vertex_memsize += vertex_stride - vertex_memsize % vertex_stride;
 
-            TexturesData textures = {};
-            textures.m_NumTextures = GetNumTextures(component);
-
-            if (textures.m_NumTextures == 0)
+            if (HasValidVertexCache(component, material, vertex_stride))
             {
-                if (component->m_UseSlice9)
-                {
-                    num_vertices   += SPRITE_VERTEX_COUNT_SLICE9;
-                    num_indices    += SPRITE_INDEX_COUNT_SLICE9;
-                    vertex_memsize += SPRITE_VERTEX_COUNT_SLICE9 * vertex_stride;
-                }
-                else
-                {
-                    num_vertices   += SPRITE_VERTEX_COUNT_LEGACY;
-                    num_indices    += SPRITE_INDEX_COUNT_LEGACY;
-                    vertex_memsize += SPRITE_VERTEX_COUNT_LEGACY * vertex_stride;
-                }
-                continue;
-            }
-
-            for (uint32_t i = 0; i < textures.m_NumTextures; ++i)
-            {
-                textures.m_Resources[i] = GetTextureSetByIndex(component, i);
-                textures.m_TextureSets[i] = textures.m_Resources[i]->m_TextureSet;
-            }
-
-            // Get the correct animation frames, and other meta data
-            ResolveAnimationData(&textures, component->m_CurrentAnimation, component->m_CurrentAnimationFrame);
-
-            if (!CanUseQuads(&textures))
-            {
-                TextureSetResource* texture_set                     = GetFirstTextureSet(component);
-                dmGameSystemDDF::TextureSet* texture_set_ddf        = texture_set->m_TextureSet;
-                dmGameSystemDDF::TextureSetAnimation* animations    = texture_set_ddf->m_Animations.m_Data;
-                dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
-                uint32_t* frame_indices                             = texture_set_ddf->m_FrameIndices.m_Data;
-                uint32_t frame_index                                = frame_indices[animation_ddf->m_Start + component->m_CurrentAnimationFrame];
-                dmGameSystemDDF::SpriteGeometry* geometries         = texture_set_ddf->m_Geometries.m_Data;
-                dmGameSystemDDF::SpriteGeometry* geometry           = &geometries[frame_index];
-                uint32_t geometry_vx_count                          = geometry->m_Vertices.m_Count / 2;
-
-                num_vertices   += geometry_vx_count; // (x,y) coordinates
-                num_indices    += geometry->m_Indices.m_Count;
-                vertex_memsize += geometry_vx_count * vertex_stride;
+                component->m_VertexCount = component->m_CachedVertexCount;
+                component->m_IndexCount  = component->m_CachedIndexCount;
             }
             else
             {
-                if (component->m_UseSlice9)
-                {
-                    num_vertices   += SPRITE_VERTEX_COUNT_SLICE9;
-                    num_indices    += SPRITE_INDEX_COUNT_SLICE9;
-                    vertex_memsize += SPRITE_VERTEX_COUNT_SLICE9 * vertex_stride;
-                }
-                else
-                {
-                    num_vertices   += SPRITE_VERTEX_COUNT_LEGACY;
-                    num_indices    += SPRITE_INDEX_COUNT_LEGACY;
-                    vertex_memsize += SPRITE_VERTEX_COUNT_LEGACY * vertex_stride;
-                }
+                GetVertexAndIndexCount(component, &component->m_VertexCount, &component->m_IndexCount);
             }
+
+            num_vertices   += component->m_VertexCount;
+            num_indices    += component->m_IndexCount;
+            vertex_memsize += component->m_VertexCount * vertex_stride;
         }
 
         sprite_world->m_ReallocBuffers   = vertex_memsize > sprite_world->m_VertexMemorySize || num_indices > sprite_world->m_IndexCount;
@@ -1858,6 +2383,9 @@ namespace dmGameSystem
         dmRender::TrimBuffer(sprite_context->m_RenderContext, world->m_IndexBuffer);
         dmRender::RewindBuffer(sprite_context->m_RenderContext, world->m_IndexBuffer);
 
+        dmRender::TrimBuffer(sprite_context->m_RenderContext, world->m_InstanceBuffer);
+        dmRender::RewindBuffer(sprite_context->m_RenderContext, world->m_InstanceBuffer);
+
         world->m_DispatchCount = 0;
 
         return dmGameObject::UPDATE_RESULT_OK;
@@ -1892,6 +2420,7 @@ namespace dmGameSystem
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
                 world->m_VertexBufferWritePtr = world->m_VertexBufferData;
                 world->m_IndexBufferWritePtr = world->m_IndexBufferData;
+                world->m_InstanceBufferData.SetSize(0);
                 world->m_RenderObjectsInUse = 0;
                 break;
             case dmRender::RENDER_LIST_OPERATION_END:
@@ -1911,6 +2440,12 @@ namespace dmGameSystem
                         DM_PROPERTY_ADD_U32(rmtp_SpriteVertexSize, vertex_data_size);
                         DM_PROPERTY_ADD_U32(rmtp_SpriteIndexSize, index_data_size);
 
+                        if (!world->m_InstanceBufferData.Empty())
+                        {
+                            dmRender::SetBufferData(params.m_Context, world->m_InstanceBuffer, world->m_InstanceBufferData.Size(), world->m_InstanceBufferData.Begin(), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                            DM_PROPERTY_ADD_U32(rmtp_SpriteInstanceSize, world->m_InstanceBufferData.Size());
+                        }
+
                         world->m_DispatchCount++;
                     }
                 }
@@ -1947,7 +2482,7 @@ namespace dmGameSystem
 
         // Submit all sprites as entries in the render list for sorting.
         dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, sprite_count);
-        dmRender::HRenderListDispatch sprite_dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, &RenderListFrustumCulling, sprite_world);
+        dmRender::HRenderListDispatch sprite_dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, &RenderListFrustumCulling, sprite_world, dmRender::RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY);
         dmRender::RenderListEntry* write_ptr = render_list;
 
         for (uint32_t i = 0; i < sprite_count; ++i)
@@ -2098,11 +2633,13 @@ namespace dmGameSystem
             {
                 dmGameSystemDDF::SetFlipHorizontal* ddf = (dmGameSystemDDF::SetFlipHorizontal*)params.m_Message->m_Data;
                 component->m_FlipHorizontal = ddf->m_Flip != 0 ? 1 : 0;
+                component->m_VertexCacheDirty = 1;
             }
             else if (params.m_Message->m_Id == dmGameSystemDDF::SetFlipVertical::m_DDFDescriptor->m_NameHash)
             {
                 dmGameSystemDDF::SetFlipVertical* ddf = (dmGameSystemDDF::SetFlipVertical*)params.m_Message->m_Data;
                 component->m_FlipVertical = ddf->m_Flip != 0 ? 1 : 0;
+                component->m_VertexCacheDirty = 1;
             }
             else if (params.m_Message->m_Id == dmGameSystemDDF::SetConstant::m_DDFDescriptor->m_NameHash)
             {
@@ -2137,14 +2674,54 @@ namespace dmGameSystem
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
-    void CompSpriteOnReload(const dmGameObject::ComponentOnReloadParams& params)
+    static void OnResourceReloaded(SpriteComponent* component)
     {
-        SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
-        SpriteComponent* component = &sprite_world->m_Components.Get(*params.m_UserData);
+        component->m_VertexCacheDirty = 1;
         if (component->m_Playing)
             PlayAnimation(component, component->m_CurrentAnimation, component->m_AnimTimer, component->m_PlaybackRate);
     }
 
+    void CompSpriteOnReload(const dmGameObject::ComponentOnReloadParams& params)
+    {
+        SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
+        OnResourceReloaded(&sprite_world->m_Components.Get(*params.m_UserData));
+    }
+
+    static inline bool UsesTextureSet(const SpriteTexture* textures, uint32_t count, const void* resource)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const TextureSetResource* texture_set = textures[i].m_TextureSet;
+            if (texture_set && (texture_set == resource || texture_set->m_Texture == resource))
+                return true;
+        }
+        return false;
+    }
+
+    // The cached vertices are generated from the texture sets and the material, so they must be regenerated when an atlas,
+    // tile source, their texture or the material is reloaded. The sprite resource itself is handled by CompSpriteOnReload()
+    static void ResourceReloadedCallback(const dmResource::ResourceReloadedParams* params)
+    {
+        SpriteWorld* sprite_world = (SpriteWorld*) params->m_UserData;
+        dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
+        const void* resource = dmResource::GetResource(params->m_Resource);
+        for (uint32_t i = 0; i < components.Size(); ++i)
+        {
+            SpriteComponent* component = &components[i];
+            const SpriteResourceOverrides* overrides = component->m_Overrides;
+            if (UsesTextureSet(component->m_Resource->m_Textures, component->m_Resource->m_NumTextures, resource) ||
+                (overrides && UsesTextureSet(overrides->m_Textures.Begin(), overrides->m_Textures.Size(), resource)))
+            {
+                OnResourceReloaded(component);
+            }
+            else if (GetMaterialResource(component) == resource)
+            {
+                // The vertex format or the default attribute values may have changed
+                component->m_VertexCacheDirty = 1;
+            }
+        }
+    }
+
     dmGameObject::PropertyResult CompSpriteGetProperty(const dmGameObject::ComponentGetPropertyParams& params, dmGameObject::PropertyDesc& out_value)
     {
         SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
@@ -2275,6 +2852,7 @@ namespace dmGameSystem
         {
             dmGameObject::PropertyResult res = AddOverrideMaterial(dmGameObject::GetFactory(params.m_Instance), component, params.m_Value.m_Hash);
             component->m_ReHash |= res == dmGameObject::PROPERTY_RESULT_OK;
+            component->m_VertexCacheDirty |= res == dmGameObject::PROPERTY_RESULT_OK;
             return res;
         }
         else if (set_property == PROP_IMAGE)
@@ -2282,6 +2860,7 @@ namespace dmGameSystem
             dmhash_t sampler_name_hash = params.m_Options.m_HasKey ? params.m_Options.m_Key : 0;
             dmGameObject::PropertyResult res = AddOverrideTextureSet(dmGameObject::GetFactory(params.m_Instance), component, sampler_name_hash, params.m_Value.m_Hash);
             component->m_ReHash |= res == dmGameObject::PROPERTY_RESULT_OK;
+            component->m_VertexCacheDirty |= res == dmGameObject::PROPERTY_RESULT_OK;
 
             // Since the animation referred to the old texture, we need to update it
             if (res == dmGameObject::PROPERTY_RESULT_OK)
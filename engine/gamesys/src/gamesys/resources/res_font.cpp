@@ -373,6 +373,9 @@ namespace dmGameSystem
         glyph->m_DataImageHeight = inglyph->m_Height;
         font->m_DynamicGlyphs.Put(codepoint, glyph);
 
+        // Texts laid out before may have used the fallback glyph instead
+        dmRender::InvalidateFontMapLayouts(font->m_FontMap);
+
         dmResource::SetResourceSize(font->m_Resource, GetResourceSize(font));
         return dmResource::RESULT_OK;
     }
@@ -385,6 +388,9 @@ namespace dmGameSystem
 
         font->m_DynamicGlyphs.Erase(codepoint);
 
+        // The cached text layouts may point to the glyph
+        dmRender::InvalidateFontMapLayouts(font->m_FontMap);
+
         DynamicGlyph* glyph = *glyphp;
         free((void*)glyph->m_Data);
         delete glyph;
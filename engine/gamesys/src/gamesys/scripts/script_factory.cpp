@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <assert.h>
 
+#include <dlib/array.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
@@ -380,6 +381,209 @@ namespace dmGameSystem
         return 1;
     }
 
+    struct BatchTransformArgs
+    {
+        dmVMath::Point3  m_DefaultPosition;
+        dmVMath::Quat    m_DefaultRotation;
+        dmVMath::Vector3 m_DefaultScale;
+        bool             m_HasPositions;
+        bool             m_HasRotations;
+        bool             m_HasScales;
+    };
+
+    // Reads entry i of the position, rotation and scale tables of factory.create_batch
+    static void GetBatchTransform(lua_State* L, const BatchTransformArgs& args, int i, dmVMath::Point3* position, dmVMath::Quat* rotation, dmVMath::Vector3* scale)
+    {
+        *position = args.m_DefaultPosition;
+        if (args.m_HasPositions)
+        {
+            lua_rawgeti(L, 3, i + 1);
+            if (!lua_isnil(L, -1))
+                *position = dmVMath::Point3(*dmScript::CheckVector3(L, -1));
+            lua_pop(L, 1);
+        }
+
+        *rotation = args.m_DefaultRotation;
+        if (args.m_HasRotations)
+        {
+            lua_rawgeti(L, 4, i + 1);
+            if (!lua_isnil(L, -1))
+                *rotation = *dmScript::CheckQuat(L, -1);
+            lua_pop(L, 1);
+        }
+
+        *scale = args.m_DefaultScale;
+        if (args.m_HasScales)
+        {
+            lua_rawgeti(L, 6, i + 1);
+            if (!lua_isnil(L, -1))
+            {
+                // We check for zero in the ToTransform/ResetScale in transform.h
+                dmVMath::Vector3* v = dmScript::ToVector3(L, -1);
+                if (v != 0)
+                {
+                    *scale = *v;
+                }
+                else
+                {
+                    float val = luaL_checknumber(L, -1);
+                    *scale = dmVMath::Vector3(val, val, val);
+                }
+            }
+            lua_pop(L, 1);
+        }
+    }
+
+    /*# make a factory create several new game objects
+     *
+     * The URL identifies which factory should create the game objects.
+     * Works like calling [ref:factory.create] `count` times, but the instance ids are allocated once for the whole batch,
+     * which makes it cheaper to spawn many game objects (e.g. bullets or particles-as-game-objects) in the same frame.
+     *
+     * If there is not enough room in the collection for all game objects, as many as possible are created.
+     *
+     * @name factory.create_batch
+     * @param url [type:string|hash|url] the factory that should create the game objects.
+     * @param count [type:number] the number of game objects to create.
+     * @param [positions] [type:table] a table of `count` vector3 positions. The position of the game object calling `factory.create_batch()` is used by default, or if the value or an entry is `nil`.
+     * @param [rotations] [type:table] a table of `count` quaternion rotations. The rotation of the game object calling `factory.create_batch()` is used by default, or if the value or an entry is `nil`.
+     * @param [properties] [type:table] the properties defined in a script attached to the new game objects, shared by all of them.
+     * @param [scales] [type:table] a table of `count` scales (number|vector3, must be greater than 0). The scale of the game object calling `factory.create_batch()` is used by default, or if the value or an entry is `nil`.
+     * @return ids [type:table] the global ids of the spawned game objects
+     * @examples
+     *
+     * How to create a row of game objects:
+     *
+     * ```lua
+     * function init(self)
+     *     local positions = {}
+     *     for i = 1, 100 do
+     *         positions[i] = vmath.vector3(i * 10, 0, 0)
+     *     end
+     *     self.ids = factory.create_batch("#factory", 100, positions)
+     * end
+     * ```
+     */
+    static int FactoryComp_CreateBatch(lua_State* L)
+    {
+        int top = lua_gettop(L);
+
+        dmGameObject::HInstance sender_instance = dmScript::CheckGOInstance(L);
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(sender_instance);
+
+        HFactoryWorld world;
+        HFactoryComponent component;
+        dmMessage::URL receiver;
+        dmScript::GetComponentFromLua(L, 1, FACTORY_EXT, (dmGameObject::HComponentWorld*)&world, (dmGameObject::HComponent*)&component, &receiver);
+
+        int count = luaL_checkinteger(L, 2);
+        if (count < 0)
+        {
+            return luaL_error(L, "factory.create_batch requires a non-negative count, got %d", count);
+        }
+
+        uint32_t remaining = dmGameObject::GetRemainingInstanceCount(collection);
+        if ((uint32_t)count > remaining)
+        {
+            dmLogError("factory.create_batch can only create %u of %d game objects since the buffer is full. See `collection.max_instances` in game.project", remaining, count);
+            count = (int)remaining;
+        }
+
+        BatchTransformArgs args;
+        args.m_HasPositions = top >= 3 && !lua_isnil(L, 3);
+        args.m_HasRotations = top >= 4 && !lua_isnil(L, 4);
+        args.m_HasScales = top >= 6 && !lua_isnil(L, 6);
+        if (args.m_HasPositions)
+            luaL_checktype(L, 3, LUA_TTABLE);
+        if (args.m_HasRotations)
+            luaL_checktype(L, 4, LUA_TTABLE);
+        if (args.m_HasScales)
+            luaL_checktype(L, 6, LUA_TTABLE);
+
+        args.m_DefaultPosition = dmGameObject::GetWorldPosition(sender_instance);
+        args.m_DefaultRotation = dmGameObject::GetWorldRotation(sender_instance);
+        args.m_DefaultScale = dmGameObject::GetWorldScale(sender_instance);
+
+        // A bad entry raises a Lua error, so all the entries are checked before anything is allocated
+        for (int i = 0; i < count; ++i)
+        {
+            dmVMath::Point3 position;
+            dmVMath::Quat rotation;
+            dmVMath::Vector3 scale;
+            GetBatchTransform(L, args, i, &position, &rotation, &scale);
+        }
+
+        dmGameObject::HPropertyContainer properties = 0;
+        if (top >= 5 && lua_istable(L, 5))
+        {
+            properties = dmGameObject::PropertyContainerCreateFromLua(L, 5);
+        }
+
+        dmArray<dmVMath::Point3> positions;
+        dmArray<dmVMath::Quat> rotations;
+        dmArray<dmVMath::Vector3> scales;
+        positions.SetCapacity(count);
+        positions.SetSize(count);
+        rotations.SetCapacity(count);
+        rotations.SetSize(count);
+        scales.SetCapacity(count);
+        scales.SetSize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            GetBatchTransform(L, args, i, &positions[i], &rotations[i], &scales[i]);
+        }
+
+        lua_createtable(L, count, 0);
+
+        bool msg_passing = dmGameObject::GetInstanceFromLua(L) == 0x0;
+        if (msg_passing)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                uint32_t index = dmGameObject::AcquireInstanceIndex(collection);
+                if (index == dmGameObject::INVALID_INSTANCE_POOL_INDEX)
+                {
+                    dmLogError("factory.create_batch can not create gameobject since the buffer is full. See `collection.max_instances` in game.project");
+                    break;
+                }
+                dmhash_t id = dmGameObject::ConstructInstanceId(index);
+                FactoryComp_CreateWithMessage(L, collection, &receiver, index, id, properties, positions[i], rotations[i], scales[i]);
+                // We currently don't know if the creation succeeds
+                dmScript::PushHash(L, id);
+                lua_rawseti(L, -2, i + 1);
+            }
+        }
+        else
+        {
+            dmArray<dmGameObject::HInstance> instances;
+            instances.SetCapacity(count);
+            instances.SetSize(count);
+
+            // Since the spawning will invoke any scripts on the new instances,
+            // we need a way to restore the state
+            dmScript::GetInstance(L);
+            int ref = dmScript::Ref(L, LUA_REGISTRYINDEX);
+
+            uint32_t spawned = CompFactorySpawnBatch(world, component, collection, count,
+                                                     positions.Begin(), rotations.Begin(), scales.Begin(), properties, instances.Begin());
+
+            lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+            dmScript::SetInstance(L);
+            dmScript::Unref(L, LUA_REGISTRYINDEX, ref);
+
+            for (uint32_t i = 0; i < spawned; ++i)
+            {
+                dmScript::PushHash(L, dmGameObject::GetIdentifier(instances[i]));
+                lua_rawseti(L, -2, i + 1);
+            }
+        }
+
+        dmGameObject::PropertyContainerDestroy(properties);
+
+        assert(top + 1 == lua_gettop(L));
+        return 1;
+    }
+
     /*# changes the prototype for the factory
      *
      * Changes the prototype for the factory.
@@ -481,6 +685,7 @@ namespace dmGameSystem
     static const luaL_reg FACTORY_COMP_FUNCTIONS[] =
     {
         {"create",            FactoryComp_Create},
+        {"create_batch",      FactoryComp_CreateBatch},
         {"load",              FactoryComp_Load},
         {"unload",            FactoryComp_Unload},
         {"get_status",        FactoryComp_GetStatus},
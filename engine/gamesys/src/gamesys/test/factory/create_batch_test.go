@@ -0,0 +1,8 @@
+components {
+  id: "script"
+  component: "/factory/create_batch_test.script"
+}
+components {
+  id: "factory"
+  component: "/factory/create_batch.factory"
+}
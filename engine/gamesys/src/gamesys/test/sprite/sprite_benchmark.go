@@ -0,0 +1,8 @@
+components {
+  id: "sprite1"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite2"
+  component: "/sprite/sprite_benchmark.sprite"
+}
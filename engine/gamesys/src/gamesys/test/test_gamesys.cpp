@@ -1227,6 +1227,93 @@ TEST_F(SpriteTest, GetSetImagesByHash)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+static void CopySpriteVertexData(dmRender::HRenderContext render_context, dmArray<char>& out)
+{
+    ASSERT_LT(0U, render_context->m_RenderObjects.Size());
+    dmGraphics::VertexBuffer* vertex_buffer = (dmGraphics::VertexBuffer*) render_context->m_RenderObjects[0]->m_VertexBuffer;
+    out.SetCapacity(vertex_buffer->m_Size);
+    out.SetSize(vertex_buffer->m_Size);
+    memcpy(out.Begin(), vertex_buffer->m_Buffer, vertex_buffer->m_Size);
+}
+
+// Large sprite batches are generated on the job threads, the output must not depend on how the work was scheduled
+// See test_gamesys_perf.cpp for the benchmark
+TEST_F(SpriteTest, RenderJobThreads)
+{
+    const uint32_t instance_count = 2048; // Two sprites each
+
+    uint32_t max_sprite_count = m_SpriteContext.m_MaxSpriteCount;
+    m_SpriteContext.m_MaxSpriteCount = instance_count * 2;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("job_threads", m_Factory, m_Register, instance_count, 0x0);
+    m_SpriteContext.m_MaxSpriteCount = max_sprite_count;
+    ASSERT_NE((dmGameObject::HCollection) 0, collection);
+
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        char id[32];
+        dmSnPrintf(id, sizeof(id), "/go%u", i);
+        dmGameObject::HInstance go = Spawn(m_Factory, collection, "/sprite/sprite_benchmark.goc", dmHashString64(id));
+        ASSERT_NE((void*)0, go);
+        instances.Push(go);
+    }
+
+    dmJobThread::HContext job_thread = m_RenderContext->m_JobThread;
+    dmArray<char> parallel_vertices;
+    dmArray<char> serial_vertices;
+
+    RenderMovedSprites(m_RenderContext, collection, &m_UpdateContext, instances.Begin(), instance_count, 0);
+    CopySpriteVertexData(m_RenderContext, parallel_vertices);
+
+    m_RenderContext->m_JobThread = 0;
+    RenderMovedSprites(m_RenderContext, collection, &m_UpdateContext, instances.Begin(), instance_count, 0);
+    CopySpriteVertexData(m_RenderContext, serial_vertices);
+    m_RenderContext->m_JobThread = job_thread;
+
+    ASSERT_EQ(serial_vertices.Size(), parallel_vertices.Size());
+    ASSERT_EQ(0, memcmp(serial_vertices.Begin(), parallel_vertices.Begin(), serial_vertices.Size()));
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+}
+
+// Sprites with a material that has per instance attributes are drawn with a single instanced draw call
+TEST_F(SpriteTest, InstancedRendering)
+{
+    const uint32_t instance_count = 4;
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        char id[32];
+        dmSnPrintf(id, sizeof(id), "/go%u", i);
+        dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/sprite/sprite_instanced.goc", dmHashString64(id), 0, Point3(i * 32.0f, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+        ASSERT_NE((void*)0, go);
+    }
+
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    dmRender::RenderListBegin(m_RenderContext);
+    dmGameObject::Render(m_Collection);
+    dmRender::RenderListEnd(m_RenderContext);
+
+    dmGraphics::ResetDrawCount();
+    dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0, 0x0);
+    ASSERT_EQ(1u, dmGraphics::GetDrawCount());
+
+    ASSERT_EQ(1u, m_RenderContext->m_RenderObjects.Size());
+    dmRender::RenderObject* ro = m_RenderContext->m_RenderObjects[0];
+    ASSERT_EQ(instance_count, ro->m_InstanceCount);
+    ASSERT_EQ(6u, ro->m_VertexCount);
+
+    // All instances share the same quad
+    uint32_t vertex_stride = dmGraphics::GetVertexDeclarationStride(ro->m_VertexDeclarations[0]);
+    ASSERT_EQ(4 * vertex_stride, ((dmGraphics::VertexBuffer*) ro->m_VertexBuffers[0])->m_Size);
+
+    uint32_t instance_stride = dmGraphics::GetVertexDeclarationStride(ro->m_VertexDeclarations[1]);
+    ASSERT_EQ(sizeof(dmVMath::Matrix4) + sizeof(dmVMath::Vector4), instance_stride);
+    ASSERT_EQ(instance_count * instance_stride, ((dmGraphics::VertexBuffer*) ro->m_VertexBuffers[1])->m_Size);
+}
+
 // Test that animation done event reaches callback
 TEST_F(ParticleFxTest, PlayAnim)
 {
@@ -1657,6 +1744,59 @@ TEST_F(FontTest, DynamicGlyph)
     dmResource::Release(m_Factory, font);
 }
 
+// Texts drawn each frame must pick up glyphs added or removed between the frames
+TEST_F(FontTest, DynamicGlyphDrawText)
+{
+    const char path_font[] = "/font/glyph_bank_test_1.fontc";
+    dmGameSystem::FontResource* font;
+
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, path_font, (void**) &font));
+    ASSERT_NE((void*)0, font);
+
+    dmRender::HFont font_map = dmGameSystem::ResFontGetHandle(font);
+
+    uint32_t codepoint = 0x263A;
+    ASSERT_FALSE(dmGameSystem::ResFontHasGlyph(font, codepoint));
+
+    dmRender::DrawTextParams params;
+    params.m_Text = "A\xE2\x98\xBA";
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (i == 1)
+        {
+            const uint32_t image_size = 2 * 2 * 4;
+            uint8_t* mem = (uint8_t*)malloc(image_size + 1);
+            memset(mem, 0xff, image_size + 1);
+            mem[0] = 0; // No compression
+
+            dmGameSystem::FontGlyph new_glyph;
+            new_glyph.m_Width = 2;
+            new_glyph.m_Height = 2;
+            new_glyph.m_Channels = 4;
+            new_glyph.m_Advance = 3;
+            new_glyph.m_LeftBearing = 0;
+            new_glyph.m_Ascent = 2;
+            new_glyph.m_Descent = 0;
+            ASSERT_EQ(dmResource::RESULT_OK, dmGameSystem::ResFontAddGlyph(font, codepoint, &new_glyph, mem, image_size + 1));
+            ASSERT_EQ(codepoint, dmRender::GetGlyph(font_map, codepoint)->m_Character);
+        }
+        else if (i == 2)
+        {
+            ASSERT_EQ(dmResource::RESULT_OK, dmGameSystem::ResFontRemoveGlyph(font, codepoint));
+            ASSERT_FALSE(dmGameSystem::ResFontHasGlyph(font, codepoint));
+        }
+
+        dmRender::RenderListBegin(m_RenderContext);
+        dmRender::DrawText(m_RenderContext, font_map, 0, 0, params);
+        dmRender::RenderListEnd(m_RenderContext);
+        dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0, 0x0);
+        dmRender::ClearRenderObjects(m_RenderContext);
+    }
+
+    dmResource::Release(m_Factory, font);
+}
+
 TEST_F(WindowTest, MouseLock)
 {
     dmPlatform::WindowParams window_params = {};
@@ -1957,6 +2097,16 @@ TEST_P(FactoryTest, Test)
     dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
 }
 
+TEST_F(ComponentTest, FactoryCreateBatch)
+{
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/factory/create_batch_test.goc", dmHashString64("/go"), 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+
+    WaitForTestsDone(10, false, 0);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
 /* Collection factory dynamic and static loading */
 
 TEST_P(CollectionFactoryTest, Test)
@@ -57,6 +57,23 @@ static inline dmGameObject::HInstance Spawn(dmResource::HFactory factory, dmGame
     return Spawn(factory, collection, prototype_name, id, 0, dmVMath::Point3(0, 0, 0), dmVMath::Quat(0, 0, 0, 1), dmVMath::Vector3(1, 1, 1));
 }
 
+// Moves all game objects, so that all sprite vertices are generated again, and renders the collection
+static inline void RenderMovedSprites(dmRender::HRenderContext render_context, dmGameObject::HCollection collection, dmGameObject::UpdateContext* update_context,
+                                      dmGameObject::HInstance* instances, uint32_t instance_count, uint32_t frame)
+{
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmGameObject::SetPosition(instances[i], dmVMath::Point3((float)(i % 256) * 4.0f + frame, (float)(i / 256) * 4.0f, 0.0f));
+    }
+
+    dmGameObject::Update(collection, update_context);
+
+    dmRender::RenderListBegin(render_context);
+    dmGameObject::Render(collection);
+    dmRender::RenderListEnd(render_context);
+    dmRender::DrawRenderList(render_context, 0x0, 0x0, 0x0);
+}
+
 struct Params
 {
     const char* m_ValidResource;
@@ -547,6 +564,7 @@ void GamesysTest<T>::SetUp()
     render_params.m_ScriptContext = m_ScriptContext;
     render_params.m_MaxCharacters = 256;
     render_params.m_MaxBatches = 128;
+    render_params.m_JobThread = m_JobThread;
     m_RenderContext = dmRender::NewRenderContext(m_GraphicsContext, render_params);
 
     dmInput::NewContextParams input_params;
@@ -577,6 +595,7 @@ void GamesysTest<T>::SetUp()
     m_ParticleFXContext.m_MaxEmitterCount = 8;
 
     m_SpriteContext.m_RenderContext = m_RenderContext;
+    m_SpriteContext.m_Factory = m_Factory;
     m_SpriteContext.m_MaxSpriteCount = 32;
 
     m_CollectionProxyContext.m_Factory = m_Factory;
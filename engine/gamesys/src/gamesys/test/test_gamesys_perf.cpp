@@ -0,0 +1,94 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test_gamesys.h"
+
+#include "../../../../render/src/render/render_private.h"
+
+#include <stdio.h>
+
+#include <dlib/dstrings.h>
+#include <dlib/log.h>
+#include <dlib/time.h>
+#include <testmain/testmain.h>
+
+#include <ddf/ddf.h>
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+// Renders 50k animated sprites through the null graphics adapter, with and without the job threads
+TEST_F(SpriteTest, RenderBenchmark)
+{
+    const uint32_t instance_count = 25000; // Two sprites each
+    const uint32_t frame_count = 10;
+
+    uint32_t max_sprite_count = m_SpriteContext.m_MaxSpriteCount;
+    m_SpriteContext.m_MaxSpriteCount = instance_count * 2;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("benchmark", m_Factory, m_Register, instance_count, 0x0);
+    m_SpriteContext.m_MaxSpriteCount = max_sprite_count;
+    ASSERT_NE((dmGameObject::HCollection) 0, collection);
+
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        char id[32];
+        dmSnPrintf(id, sizeof(id), "/go%u", i);
+        dmGameObject::HInstance go = Spawn(m_Factory, collection, "/sprite/sprite_benchmark.goc", dmHashString64(id));
+        ASSERT_NE((void*)0, go);
+        instances.Push(go);
+    }
+
+    dmJobThread::HContext job_thread = m_RenderContext->m_JobThread;
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t frame = 0; frame < frame_count; ++frame)
+    {
+        RenderMovedSprites(m_RenderContext, collection, &m_UpdateContext, instances.Begin(), instance_count, frame);
+    }
+    uint64_t parallel_time = dmTime::GetMonotonicTime() - start;
+
+    m_RenderContext->m_JobThread = 0;
+    start = dmTime::GetMonotonicTime();
+    for (uint32_t frame = 0; frame < frame_count; ++frame)
+    {
+        RenderMovedSprites(m_RenderContext, collection, &m_UpdateContext, instances.Begin(), instance_count, frame);
+    }
+    uint64_t serial_time = dmTime::GetMonotonicTime() - start;
+    m_RenderContext->m_JobThread = job_thread;
+
+    printf("Rendering %u sprites: %.3f ms/frame with job threads, %.3f ms/frame without\n", instance_count * 2,
+        parallel_time / (1000.0 * frame_count), serial_time / (1000.0 * frame_count));
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+}
+
+extern "C" void dmExportedSymbols();
+
+int main(int argc, char **argv)
+{
+    dmExportedSymbols();
+    TestMainPlatformInit();
+
+    dmLog::LogParams params;
+    dmLog::LogInitialize(&params);
+
+    dmHashEnableReverseHash(true);
+    dmDDF::RegisterAllTypes();
+
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
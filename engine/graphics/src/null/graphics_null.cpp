@@ -587,7 +587,7 @@ namespace dmGraphics
         }
     }
 
-    void EnableVertexDeclaration(HContext _context, HVertexDeclaration vertex_declaration, uint32_t binding_index)
+    static void EnableVertexDeclaration(HContext _context, HVertexDeclaration vertex_declaration, uint32_t binding_index, uint32_t base_offset)
     {
         assert(_context);
         assert(vertex_declaration);
@@ -611,7 +611,7 @@ namespace dmGraphics
             if (stream.m_Size > 0)
             {
                 stream.m_Location = i;
-                EnableVertexStream(context, binding_index, i, stream.m_Size, stream.m_Type, stride, &vb->m_Buffer[offset]);
+                EnableVertexStream(context, binding_index, i, stream.m_Size, stream.m_Type, stride, &vb->m_Buffer[base_offset + offset]);
                 offset += stream.m_Size * TYPE_SIZE[stream.m_Type - dmGraphics::TYPE_BYTE];
             }
         }
@@ -619,9 +619,14 @@ namespace dmGraphics
         context->m_VertexDeclarations[binding_index] = vertex_declaration;
     }
 
+    void EnableVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, uint32_t binding_index)
+    {
+        EnableVertexDeclaration(context, vertex_declaration, binding_index, 0);
+    }
+
     static void NullEnableVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, uint32_t binding_index, uint32_t base_offset, HProgram program)
     {
-        EnableVertexDeclaration(context, vertex_declaration, binding_index);
+        EnableVertexDeclaration(context, vertex_declaration, binding_index, base_offset);
     }
 
     static void NullDisableVertexDeclaration(HContext _context, HVertexDeclaration vertex_declaration)
@@ -651,6 +656,8 @@ namespace dmGraphics
                 DisableVertexStream(context, binding_index, i);
             }
         }
+
+        context->m_VertexDeclarations[binding_index] = 0x0;
     }
 
     static uint32_t GetIndex(Type type, HIndexBuffer ib, uint32_t index)
@@ -676,25 +683,37 @@ namespace dmGraphics
         assert(index_buffer);
         NullContext* context = (NullContext*) _context;
 
-        uint32_t binding_index = 0;
-
-        for (uint32_t i = 0; i < MAX_VERTEX_STREAM_COUNT; ++i)
+        for (uint32_t binding_index = 0; binding_index < MAX_VERTEX_BUFFERS; ++binding_index)
         {
-            VertexStreamBuffer& vs = context->m_VertexStreams[binding_index][i];
-            if (vs.m_Size > 0)
+            VertexDeclaration* vertex_declaration = context->m_VertexDeclarations[binding_index];
+            if (vertex_declaration == 0x0)
             {
-                vs.m_Buffer = new char[vs.m_Size * count];
+                continue;
             }
-        }
-        for (uint32_t i = 0; i < count; ++i)
-        {
-            uint32_t index = GetIndex(type, index_buffer, i + first);
-            for (uint32_t j = 0; j < MAX_VERTEX_STREAM_COUNT; ++j)
+
+            // Per instance streams are fetched once per instance, per vertex streams once per index
+            bool per_instance     = vertex_declaration->m_StepFunction == VERTEX_STEP_FUNCTION_INSTANCE;
+            uint32_t fetch_count  = per_instance ? dmMath::Max(1U, instance_count) : count;
+
+            for (uint32_t i = 0; i < MAX_VERTEX_STREAM_COUNT; ++i)
             {
-                VertexStreamBuffer& vs = context->m_VertexStreams[binding_index][j];
+                VertexStreamBuffer& vs = context->m_VertexStreams[binding_index][i];
                 if (vs.m_Size > 0)
                 {
-                    memcpy(&((char*)vs.m_Buffer)[i * vs.m_Size], &((char*)vs.m_Source)[index * vs.m_Stride], vs.m_Size);
+                    delete [] (char*)vs.m_Buffer;
+                    vs.m_Buffer = new char[vs.m_Size * fetch_count];
+                }
+            }
+            for (uint32_t i = 0; i < fetch_count; ++i)
+            {
+                uint32_t index = per_instance ? i : GetIndex(type, index_buffer, i + first);
+                for (uint32_t j = 0; j < MAX_VERTEX_STREAM_COUNT; ++j)
+                {
+                    VertexStreamBuffer& vs = context->m_VertexStreams[binding_index][j];
+                    if (vs.m_Size > 0)
+                    {
+                        memcpy(&((char*)vs.m_Buffer)[i * vs.m_Size], &((char*)vs.m_Source)[index * vs.m_Stride], vs.m_Size);
+                    }
                 }
             }
         }
@@ -1164,6 +1183,7 @@ namespace dmGraphics
         NullContext* context = (NullContext*) _context;
         assert(context->m_Program != 0x0);
         memcpy(&context->m_ProgramRegisters[base_location], data, sizeof(Vector4) * count);
+        context->m_SetConstantCount++;
     }
 
     static void NullSetConstantM4(HContext _context, const Vector4* data, int count, HUniformLocation base_location)
@@ -1172,6 +1192,7 @@ namespace dmGraphics
         NullContext* context = (NullContext*) _context;
         assert(context->m_Program != 0x0);
         memcpy(&context->m_ProgramRegisters[base_location], data, sizeof(Vector4) * 4 * count);
+        context->m_SetConstantCount++;
     }
 
     static void NullSetSampler(HContext context, HUniformLocation location, int32_t unit)
@@ -1696,6 +1717,7 @@ namespace dmGraphics
         NullSetTextureParams(texture, tex->m_Sampler.m_MinFilter, tex->m_Sampler.m_MagFilter, tex->m_Sampler.m_UWrap, tex->m_Sampler.m_VWrap, tex->m_Sampler.m_Anisotropy);
 
         tex->m_LastBoundUnit[id_index] = unit;
+        context->m_EnableTextureCount++;
     }
 
     static void NullDisableTexture(HContext context, uint32_t unit, HTexture texture)
@@ -130,6 +130,8 @@ namespace dmGraphics
         uint32_t                           m_TextureFormatSupport;
         uint32_t                           m_TextureUnit;
         // Only use for testing
+        uint32_t                           m_SetConstantCount;
+        uint32_t                           m_EnableTextureCount;
         uint32_t                           m_AsyncProcessingSupport : 1;
         uint32_t                           m_UseAsyncTextureLoad    : 1;
         uint32_t                           m_RequestWindowClose     : 1;
@@ -22,6 +22,7 @@
 
 #include <dlib/log.h>
 #include <dlib/time.h>
+#include <dlib/sys.h>
 
 #include "test_app_graphics.h"
 
@@ -507,6 +508,68 @@ struct StorageBufferTest : ITest
     }
 };
 
+// Creates and deletes a batch of buffers and textures every frame, to measure the cost of the device memory allocations
+struct AllocationBenchmarkTest : ITest
+{
+    static const uint32_t BATCH_SIZE = 256;
+
+    dmGraphics::HVertexBuffer m_VertexBuffers[BATCH_SIZE];
+    dmGraphics::HTexture      m_Textures[BATCH_SIZE];
+    uint64_t                  m_TotalTime;
+    uint32_t                  m_FrameCount;
+
+    void Initialize(EngineCtx* engine) override
+    {
+        m_TotalTime  = 0;
+        m_FrameCount = 0;
+    }
+
+    void Execute(EngineCtx* engine) override
+    {
+        uint8_t vertex_data[1024] = {};
+        uint8_t texture_data[32 * 32 * 4] = {};
+
+        uint64_t t_start = dmTime::GetMonotonicTime();
+
+        for (uint32_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            m_VertexBuffers[i] = dmGraphics::NewVertexBuffer(engine->m_GraphicsContext, sizeof(vertex_data), vertex_data, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+
+            dmGraphics::TextureCreationParams tp = {};
+            tp.m_Width          = 32;
+            tp.m_Height         = 32;
+            tp.m_OriginalWidth  = 32;
+            tp.m_OriginalHeight = 32;
+            m_Textures[i] = dmGraphics::NewTexture(engine->m_GraphicsContext, tp);
+
+            dmGraphics::TextureParams p = {};
+            p.m_Width    = 32;
+            p.m_Height   = 32;
+            p.m_Format   = dmGraphics::TEXTURE_FORMAT_RGBA;
+            p.m_Data     = texture_data;
+            p.m_DataSize = sizeof(texture_data);
+            dmGraphics::SetTexture(m_Textures[i], p);
+        }
+
+        for (uint32_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            dmGraphics::DeleteVertexBuffer(m_VertexBuffers[i]);
+            dmGraphics::DeleteTexture(m_Textures[i]);
+        }
+
+        m_TotalTime += dmTime::GetMonotonicTime() - t_start;
+        m_FrameCount++;
+
+        if (m_FrameCount == 60)
+        {
+            dmLogInfo("Created and deleted %u buffers and %u textures in %.3f ms on average",
+                BATCH_SIZE, BATCH_SIZE, (m_TotalTime / (double) m_FrameCount) / 1000.0);
+            m_TotalTime  = 0;
+            m_FrameCount = 0;
+        }
+    }
+};
+
 static bool OnWindowClose(void* user_data)
 {
     EngineCtx* engine = (EngineCtx*) user_data;
@@ -550,6 +613,7 @@ static void* EngineCreate(int argc, char** argv)
     //engine->m_Test = new ComputeTest();
     //engine->m_Test = new StorageBufferTest();
     //engine->m_Test = new ReadPixelsTest();
+    //engine->m_Test = new AllocationBenchmarkTest();
     engine->m_Test = new ClearBackbufferTest();
     engine->m_Test->Initialize(engine);
 
@@ -615,6 +679,80 @@ static void InstallAdapter(int argc, char **argv)
     dmGraphics::InstallAdapter(family);
 }
 
+static long GetFileSize(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+    {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+// Creates a compute pipeline and checks that the pipeline cache is written to disk when the context is deleted
+static long RunPipelineCacheContext(const char* path)
+{
+    EngineCtx* engine = &g_EngineCtx;
+    engine->m_Window = dmPlatform::NewWindow();
+
+    dmPlatform::WindowParams window_params = {};
+    window_params.m_Width       = 64;
+    window_params.m_Height      = 64;
+    window_params.m_Title       = "Vulkan Pipeline Cache Test";
+    window_params.m_GraphicsApi = dmPlatform::PLATFORM_GRAPHICS_API_VULKAN;
+    dmPlatform::OpenWindow(engine->m_Window, window_params);
+
+    dmGraphics::ContextParams graphics_context_params = {};
+    graphics_context_params.m_Window            = engine->m_Window;
+    graphics_context_params.m_Width             = 64;
+    graphics_context_params.m_Height            = 64;
+    graphics_context_params.m_PipelineCachePath = path;
+    engine->m_GraphicsContext = dmGraphics::NewContext(graphics_context_params);
+
+    ComputeTest test;
+    test.Initialize(engine);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        dmGraphics::BeginFrame(engine->m_GraphicsContext);
+        test.Execute(engine);
+        dmGraphics::Flip(engine->m_GraphicsContext);
+    }
+
+    dmGraphics::CloseWindow(engine->m_GraphicsContext);
+    dmGraphics::DeleteContext(engine->m_GraphicsContext);
+    dmGraphics::Finalize();
+    dmPlatform::DeleteWindow(engine->m_Window);
+    memset(&g_EngineCtx, 0, sizeof(g_EngineCtx));
+
+    return GetFileSize(path);
+}
+
+TEST(App, PipelineCache)
+{
+    if (dmGraphics::GetInstalledAdapterFamily() != dmGraphics::ADAPTER_FAMILY_VULKAN)
+    {
+        return;
+    }
+
+    const char* path     = "test_pipeline_cache";
+    const char* tmp_path = "test_pipeline_cache.tmp";
+    dmSys::Unlink(path);
+
+    long size = RunPipelineCacheContext(path);
+    ASSERT_GT(size, 0);
+    ASSERT_EQ(-1, GetFileSize(tmp_path));
+
+    // The second run loads the saved cache, and must write back a cache at least as large
+    ASSERT_GE(RunPipelineCacheContext(path), size);
+    ASSERT_EQ(-1, GetFileSize(tmp_path));
+
+    dmSys::Unlink(path);
+}
+
 TEST(App, Run)
 {
     AppCtx ctx;
@@ -397,6 +397,52 @@ TEST_F(dmGraphicsTest, Drawing)
     dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
 }
 
+TEST_F(dmGraphicsTest, InstancedDrawing)
+{
+    float v[] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
+    float inst[] = { 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f };
+    uint32_t i[] = { 0, 1, 2, 2, 3, 0 };
+
+    dmGraphics::HVertexStreamDeclaration stream_declaration = dmGraphics::NewVertexStreamDeclaration(m_Context);
+    dmGraphics::AddVertexStream(stream_declaration, "position", 2, dmGraphics::TYPE_FLOAT, false);
+
+    dmGraphics::HVertexStreamDeclaration stream_declaration_instance = dmGraphics::NewVertexStreamDeclaration(m_Context, dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE);
+    dmGraphics::AddVertexStream(stream_declaration_instance, "offset", 2, dmGraphics::TYPE_FLOAT, false);
+
+    dmGraphics::HVertexDeclaration vd      = dmGraphics::NewVertexDeclaration(m_Context, stream_declaration);
+    dmGraphics::HVertexDeclaration vd_inst = dmGraphics::NewVertexDeclaration(m_Context, stream_declaration_instance);
+    dmGraphics::HVertexBuffer vb      = dmGraphics::NewVertexBuffer(m_Context, sizeof(v), v, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::HVertexBuffer vb_inst = dmGraphics::NewVertexBuffer(m_Context, sizeof(inst), inst, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::HIndexBuffer ib       = dmGraphics::NewIndexBuffer(m_Context, sizeof(i), i, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+
+    dmGraphics::EnableVertexBuffer(m_Context, vb, 0);
+    dmGraphics::EnableVertexBuffer(m_Context, vb_inst, 1);
+    dmGraphics::EnableVertexDeclaration(m_Context, vd, 0);
+    dmGraphics::EnableVertexDeclaration(m_Context, vd_inst, 1);
+
+    dmGraphics::ResetDrawCount();
+    dmGraphics::DrawElements(m_Context, dmGraphics::PRIMITIVE_TRIANGLES, 0, 6, dmGraphics::TYPE_UNSIGNED_INT, ib, 3);
+    ASSERT_EQ(1u, dmGraphics::GetDrawCount());
+
+    // The per vertex stream is fetched per index, the per instance stream once per instance
+    float p[] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 4.0f, 5.0f, 6.0f, 7.0f, 0.0f, 1.0f };
+    ASSERT_EQ(0, memcmp(p, m_NullContext->m_VertexStreams[0][0].m_Buffer, sizeof(p)));
+    ASSERT_EQ(0, memcmp(inst, m_NullContext->m_VertexStreams[1][0].m_Buffer, sizeof(inst)));
+
+    dmGraphics::DisableVertexDeclaration(m_Context, vd_inst);
+    dmGraphics::DisableVertexDeclaration(m_Context, vd);
+    dmGraphics::DisableVertexBuffer(m_Context, vb_inst);
+    dmGraphics::DisableVertexBuffer(m_Context, vb);
+
+    dmGraphics::DeleteIndexBuffer(ib);
+    dmGraphics::DeleteVertexBuffer(vb_inst);
+    dmGraphics::DeleteVertexBuffer(vb);
+    dmGraphics::DeleteVertexDeclaration(vd_inst);
+    dmGraphics::DeleteVertexDeclaration(vd);
+    dmGraphics::DeleteVertexStreamDeclaration(stream_declaration_instance);
+    dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
+}
+
 static inline dmGraphics::ShaderDesc MakeDDFShaderDesc(dmGraphics::ShaderDesc::Shader* shader,
     dmGraphics::ShaderDesc::ShaderType type,
     dmGraphics::ShaderDesc::ResourceBinding* inputs, uint32_t input_count,
@@ -17,6 +17,7 @@
 #include <dlib/profile.h>
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/time.h>
 
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
@@ -121,6 +122,7 @@ namespace dmGraphics
         m_Width                   = params.m_Width;
         m_Height                  = params.m_Height;
         m_SwapInterval            = params.m_SwapInterval;
+        m_PipelineCachePath       = params.m_PipelineCachePath ? strdup(params.m_PipelineCachePath) : 0;
 
         // We need to have some sort of valid default filtering
         if (m_DefaultTextureMinFilter == TEXTURE_FILTER_DEFAULT)
@@ -1092,6 +1094,7 @@ namespace dmGraphics
         }
 
         context->m_LogicalDevice    = logical_device;
+        InitializeDeviceMemoryAllocator(context->m_PhysicalDevice.m_MemoryProperties, DM_DEVICE_MEMORY_BLOCK_SIZE);
         vk_closest_multisample_flag = GetClosestSampleCountFlag(selected_device, BUFFER_TYPE_COLOR0_BIT | BUFFER_TYPE_DEPTH_BIT, dmPlatform::GetWindowStateParam(context->m_Window, dmPlatform::WINDOW_STATE_SAMPLE_COUNT));
 
         // Create swap chain
@@ -1119,6 +1122,14 @@ namespace dmGraphics
         context->m_PipelineCache.SetCapacity(32,64);
         context->m_TextureSamplers.SetCapacity(4);
 
+        // A missing or incompatible cache file only means the pipelines are compiled from scratch
+        res = CreatePipelineCache(&context->m_PhysicalDevice, context->m_LogicalDevice.m_Device, context->m_PipelineCachePath, &context->m_DevicePipelineCache);
+        if (res != VK_SUCCESS)
+        {
+            dmLogWarning("Could not create a pipeline cache for Vulkan, reason: %s", VkResultToStr(res));
+            context->m_DevicePipelineCache = VK_NULL_HANDLE;
+        }
+
         // Create framebuffers, default renderpass etc.
         res = CreateMainRenderingResources(context);
         if (res != VK_SUCCESS)
@@ -1238,6 +1249,7 @@ bail:
                 context->m_Instance = VK_NULL_HANDLE;
             }
 
+            free(context->m_PipelineCachePath);
             delete context;
             g_VulkanContext = 0x0;
         }
@@ -1259,6 +1271,7 @@ bail:
     {
         VulkanContext* context = (VulkanContext*) _context;
         NativeBeginFrame(context);
+        ProfileDeviceMemory();
 
         FrameResource& current_frame_resource = context->m_FrameResources[context->m_CurrentFrameInFlight];
 
@@ -1337,6 +1350,33 @@ bail:
         tex_sc->m_GraphicsFormat     = TEXTURE_FORMAT_BGRA8U;
     }
 
+    // The context is never destroyed when a mobile app is killed by the OS, so new pipelines are saved while the app is running.
+    // This is done when no new pipelines have been created for a while, or immediately when the app loses focus.
+    static void UpdatePipelineCacheFile(VulkanContext* context)
+    {
+        const uint64_t save_delay = 5 * 1000000;
+
+        uint64_t time           = dmTime::GetMonotonicTime();
+        uint32_t pipeline_count = context->m_PipelineCache.Size();
+        if (pipeline_count != context->m_PipelineCacheCount)
+        {
+            context->m_PipelineCacheCount     = pipeline_count;
+            context->m_PipelineCacheDirtyTime = time;
+        }
+
+        if (context->m_PipelineCacheDirtyTime == 0)
+        {
+            return;
+        }
+
+        if (time - context->m_PipelineCacheDirtyTime >= save_delay || !dmPlatform::GetWindowStateParam(context->m_Window, dmPlatform::WINDOW_STATE_ACTIVE))
+        {
+            DM_PROFILE("SavePipelineCache");
+            SavePipelineCache(context->m_LogicalDevice.m_Device, context->m_DevicePipelineCache, context->m_PipelineCachePath);
+            context->m_PipelineCacheDirtyTime = 0;
+        }
+    }
+
     static void VulkanFlip(HContext _context)
     {
         DM_PROFILE(__FUNCTION__);
@@ -1389,6 +1429,11 @@ bail:
         context->m_CurrentFrameInFlight = (context->m_CurrentFrameInFlight + 1) % context->m_NumFramesInFlight;
         context->m_FrameBegun           = 0;
 
+        if (context->m_PipelineCachePath && context->m_DevicePipelineCache != VK_NULL_HANDLE)
+        {
+            UpdatePipelineCacheFile(context);
+        }
+
 #if defined(ANDROID) || defined(DM_PLATFORM_IOS) || defined(DM_PLATFORM_VENDOR)
         dmPlatform::SwapBuffers(context->m_Window);
 #endif
@@ -1550,7 +1595,7 @@ bail:
         resource->m_Destroyed = 1;
     }
 
-    static Pipeline* GetOrCreateComputePipeline(VkDevice vk_device, PipelineCache& pipelineCache, Program* program)
+    static Pipeline* GetOrCreateComputePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, PipelineCache& pipelineCache, Program* program)
     {
         HashState64 pipeline_hash_state;
         dmHashInit64(&pipeline_hash_state, false);
@@ -1563,7 +1608,7 @@ bail:
         {
             Pipeline new_pipeline = {};
 
-            VkResult res = CreateComputePipeline(vk_device, program, &new_pipeline);
+            VkResult res = CreateComputePipeline(vk_device, vk_pipeline_cache, program, &new_pipeline);
             CHECK_VK_ERROR(res);
 
             if (pipelineCache.Full())
@@ -1580,7 +1625,7 @@ bail:
         return cached_pipeline;
     }
 
-    static Pipeline* GetOrCreatePipeline(VkDevice vk_device, VkSampleCountFlagBits vk_sample_count,
+    static Pipeline* GetOrCreatePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, VkSampleCountFlagBits vk_sample_count,
         const PipelineState pipelineState, PipelineCache& pipelineCache,
         Program* program, RenderTarget* rt, VertexDeclaration** vertexDeclaration, uint32_t vertexDeclarationCount)
     {
@@ -1611,7 +1656,7 @@ bail:
             vk_scissor.offset.x = 0;
             vk_scissor.offset.y = 0;
 
-            VkResult res = CreateGraphicsPipeline(vk_device, vk_scissor, vk_sample_count, pipelineState, program, vertexDeclaration, vertexDeclarationCount, rt, &new_pipeline);
+            VkResult res = CreateGraphicsPipeline(vk_device, vk_pipeline_cache, vk_scissor, vk_sample_count, pipelineState, program, vertexDeclaration, vertexDeclarationCount, rt, &new_pipeline);
             CHECK_VK_ERROR(res);
 
             if (pipelineCache.Full())
@@ -2224,7 +2269,7 @@ bail:
         VkResult res               = CommitUniforms(context, vk_command_buffer, vk_device, program_ptr, VK_PIPELINE_BIND_POINT_COMPUTE, scratchBuffer, context->m_DynamicOffsetBuffer, dynamic_alignment);
         CHECK_VK_ERROR(res);
 
-        Pipeline* pipeline = GetOrCreateComputePipeline(vk_device, context->m_PipelineCache, program_ptr);
+        Pipeline* pipeline = GetOrCreateComputePipeline(vk_device, context->m_DevicePipelineCache, context->m_PipelineCache, program_ptr);
         vkCmdBindPipeline(vk_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, *pipeline);
     }
 
@@ -2308,7 +2353,7 @@ bail:
             vk_sample_count = context->m_SwapChain->m_SampleCountFlag;
         }
 
-        Pipeline* pipeline = GetOrCreatePipeline(vk_device, vk_sample_count,
+        Pipeline* pipeline = GetOrCreatePipeline(vk_device, context->m_DevicePipelineCache, vk_sample_count,
             pipeline_state_draw, context->m_PipelineCache,
             program_ptr, current_rt, vx_declarations, num_vx_buffers);
 
@@ -3989,6 +4034,16 @@ bail:
 
         context->m_PipelineCache.Iterate(DestroyPipelineCacheCb, context);
 
+        if (context->m_DevicePipelineCache != VK_NULL_HANDLE)
+        {
+            if (context->m_PipelineCachePath)
+            {
+                SavePipelineCache(vk_device, context->m_DevicePipelineCache, context->m_PipelineCachePath);
+            }
+            vkDestroyPipelineCache(vk_device, context->m_DevicePipelineCache, 0);
+            context->m_DevicePipelineCache = VK_NULL_HANDLE;
+        }
+
         DestroyDeviceBuffer(vk_device, &context->m_MainTextureDepthStencil.m_DeviceBuffer.m_Handle);
         DestroyTexture(vk_device, &context->m_MainTextureDepthStencil.m_Handle);
         DestroyTexture(vk_device, &context->m_DefaultTexture2D->m_Handle);
@@ -4033,6 +4088,7 @@ bail:
         }
 
         DestroySwapChain(vk_device, context->m_SwapChain);
+        FinalizeDeviceMemoryAllocator(vk_device);
         DestroyLogicalDevice(&context->m_LogicalDevice);
         DestroyPhysicalDevice(&context->m_PhysicalDevice);
     }
@@ -12,8 +12,13 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <stdio.h>
+
 #include <dlib/math.h>
 #include <dlib/log.h>
+#include <dlib/dstrings.h>
+#include <dlib/path.h>
+#include <dlib/sys.h>
 
 #include "graphics_vulkan_defines.h"
 #include "graphics_vulkan_private.h"
@@ -292,7 +297,19 @@ namespace dmGraphics
         {
             return VK_SUCCESS;
         }
-        return vkMapMemory(vk_device, m_Handle.m_Memory, offset, size > 0 ? size : m_MemorySize, 0, &m_MappedDataPtr);
+
+        // Memory blocks are mapped once when they are created
+        if (m_Handle.m_Memory.m_Block)
+        {
+            uint8_t* block_data_ptr = (uint8_t*) GetDeviceMemoryMappedPtr(m_Handle.m_Memory);
+            if (block_data_ptr == 0)
+            {
+                return VK_ERROR_MEMORY_MAP_FAILED;
+            }
+            m_MappedDataPtr = block_data_ptr + offset;
+            return VK_SUCCESS;
+        }
+        return vkMapMemory(vk_device, m_Handle.m_Memory.m_Memory, offset, size > 0 ? size : m_MemorySize, 0, &m_MappedDataPtr);
     }
 
     void DeviceBuffer::UnmapMemory(VkDevice vk_device)
@@ -301,7 +318,10 @@ namespace dmGraphics
         {
             return;
         }
-        vkUnmapMemory(vk_device, m_Handle.m_Memory);
+        if (m_Handle.m_Memory.m_Block == 0)
+        {
+            vkUnmapMemory(vk_device, m_Handle.m_Memory.m_Memory);
+        }
         m_MappedDataPtr = 0;
     }
 
@@ -732,13 +752,6 @@ namespace dmGraphics
         VkMemoryRequirements vk_buffer_memory_req;
         vkGetBufferMemoryRequirements(vk_device, bufferOut->m_Handle.m_Buffer, &vk_buffer_memory_req);
 
-        VkMemoryAllocateInfo vk_memory_alloc_info;
-        memset(&vk_memory_alloc_info, 0, sizeof(vk_memory_alloc_info));
-
-        vk_memory_alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        vk_memory_alloc_info.allocationSize  = vk_buffer_memory_req.size;
-        vk_memory_alloc_info.memoryTypeIndex = 0;
-
         uint32_t memory_type_index = 0;
         if (!GetMemoryTypeIndex(vk_physical_device, vk_buffer_memory_req.memoryTypeBits, vk_memory_flags, &memory_type_index))
         {
@@ -746,15 +759,13 @@ namespace dmGraphics
             goto bail;
         }
 
-        vk_memory_alloc_info.memoryTypeIndex = memory_type_index;
-
-        res = vkAllocateMemory(vk_device, &vk_memory_alloc_info, 0, &bufferOut->m_Handle.m_Memory);
+        res = AllocateDeviceMemory(vk_device, vk_buffer_memory_req, memory_type_index, false, &bufferOut->m_Handle.m_Memory);
         if (res != VK_SUCCESS)
         {
             goto bail;
         }
 
-        res = vkBindBufferMemory(vk_device, bufferOut->m_Handle.m_Buffer, bufferOut->m_Handle.m_Memory, 0);
+        res = vkBindBufferMemory(vk_device, bufferOut->m_Handle.m_Buffer, bufferOut->m_Handle.m_Memory.m_Memory, bufferOut->m_Handle.m_Memory.m_Offset);
         if (res != VK_SUCCESS)
         {
             return res;
@@ -872,13 +883,6 @@ bail:
         VkMemoryRequirements vk_memory_req;
         vkGetImageMemoryRequirements(vk_device, textureOut->m_Handle.m_Image, &vk_memory_req);
 
-        VkMemoryAllocateInfo vk_memory_alloc_info;
-        memset(&vk_memory_alloc_info, 0, sizeof(vk_memory_alloc_info));
-
-        vk_memory_alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        vk_memory_alloc_info.allocationSize  = vk_memory_req.size;
-        vk_memory_alloc_info.memoryTypeIndex = 0;
-
         uint32_t memory_type_index = 0;
 
         // Lazy / memorless might not be supported on this platform
@@ -893,15 +897,13 @@ bail:
             goto bail;
         }
 
-        vk_memory_alloc_info.memoryTypeIndex = memory_type_index;
-
-        res = vkAllocateMemory(vk_device, &vk_memory_alloc_info, 0, &device_buffer.m_Handle.m_Memory);
+        res = AllocateDeviceMemory(vk_device, vk_memory_req, memory_type_index, vk_tiling == VK_IMAGE_TILING_OPTIMAL, &device_buffer.m_Handle.m_Memory);
         if (res != VK_SUCCESS)
         {
             goto bail;
         }
 
-        res = vkBindImageMemory(vk_device, textureOut->m_Handle.m_Image, device_buffer.m_Handle.m_Memory, 0);
+        res = vkBindImageMemory(vk_device, textureOut->m_Handle.m_Image, device_buffer.m_Handle.m_Memory.m_Memory, device_buffer.m_Handle.m_Memory.m_Offset);
         if (res != VK_SUCCESS)
         {
             goto bail;
@@ -1192,7 +1194,7 @@ bail:
         VK_COMPARE_OP_ALWAYS
     };
 
-    VkResult CreateComputePipeline(VkDevice vk_device, Program* program, Pipeline* pipelineOut)
+    VkResult CreateComputePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, Program* program, Pipeline* pipelineOut)
     {
         assert(pipelineOut && *pipelineOut == VK_NULL_HANDLE);
 
@@ -1204,10 +1206,10 @@ bail:
         vk_pipeline_create_info.layout             = program->m_Handle.m_PipelineLayout;
         vk_pipeline_create_info.pNext              = 0;
         vk_pipeline_create_info.stage              = program->m_ComputeModule->m_PipelineStageInfo;
-        return vkCreateComputePipelines(vk_device, 0, 1, &vk_pipeline_create_info, 0, pipelineOut);
+        return vkCreateComputePipelines(vk_device, vk_pipeline_cache, 1, &vk_pipeline_create_info, 0, pipelineOut);
     }
 
-    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count,
+    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count,
         PipelineState pipelineState, Program* program, VertexDeclaration** vertexDeclarations, uint32_t vertexDeclarationCount,
         RenderTarget* render_target, Pipeline* pipelineOut)
     {
@@ -1414,7 +1416,113 @@ bail:
         vk_pipeline_info.basePipelineHandle  = VK_NULL_HANDLE;
         vk_pipeline_info.basePipelineIndex   = -1;
 
-        return vkCreateGraphicsPipelines(vk_device, VK_NULL_HANDLE, 1, &vk_pipeline_info, 0, pipelineOut);
+        return vkCreateGraphicsPipelines(vk_device, vk_pipeline_cache, 1, &vk_pipeline_info, 0, pipelineOut);
+    }
+
+    // The cache data starts with a VkPipelineCacheHeaderVersionOne, which identifies the device and driver it was created with
+    static bool IsPipelineCacheDataCompatible(PhysicalDevice* device, const uint8_t* data, uint32_t data_size)
+    {
+        const uint32_t header_size = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+        if (data_size < header_size)
+        {
+            return false;
+        }
+
+        uint32_t header[4]; // size, version, vendor id, device id
+        memcpy(header, data, sizeof(header));
+        return header[0] >= header_size &&
+               header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header[2] == device->m_Properties.vendorID &&
+               header[3] == device->m_Properties.deviceID &&
+               memcmp(data + sizeof(header), device->m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    VkResult CreatePipelineCache(PhysicalDevice* device, VkDevice vk_device, const char* path, VkPipelineCache* vk_pipeline_cache_out)
+    {
+        uint8_t* data      = 0;
+        uint32_t data_size = 0;
+
+        FILE* file = path ? fopen(path, "rb") : 0;
+        if (file)
+        {
+            fseek(file, 0, SEEK_END);
+            long file_size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+
+            if (file_size > 0)
+            {
+                data = new uint8_t[file_size];
+                if (fread(data, 1, file_size, file) == (size_t) file_size)
+                {
+                    data_size = (uint32_t) file_size;
+                }
+            }
+            fclose(file);
+
+            if (data_size > 0 && !IsPipelineCacheDataCompatible(device, data, data_size))
+            {
+                dmLogInfo("Discarding pipeline cache '%s', it was created with a different device or driver", path);
+                data_size = 0;
+            }
+        }
+
+        VkPipelineCacheCreateInfo vk_pipeline_cache_create_info;
+        memset(&vk_pipeline_cache_create_info, 0, sizeof(vk_pipeline_cache_create_info));
+        vk_pipeline_cache_create_info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        vk_pipeline_cache_create_info.initialDataSize = data_size;
+        vk_pipeline_cache_create_info.pInitialData    = data_size > 0 ? data : 0;
+
+        VkResult res = vkCreatePipelineCache(vk_device, &vk_pipeline_cache_create_info, 0, vk_pipeline_cache_out);
+        delete[] data;
+        return res;
+    }
+
+    bool SavePipelineCache(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, const char* path)
+    {
+        size_t data_size = 0;
+        if (vkGetPipelineCacheData(vk_device, vk_pipeline_cache, &data_size, 0) != VK_SUCCESS || data_size == 0)
+        {
+            return false;
+        }
+
+        // Write to a temporary file first, so that a crash in the middle of the write can't leave a truncated cache behind
+        char tmp_path[DMPATH_MAX_PATH];
+        if (dmSnPrintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) == -1)
+        {
+            dmLogWarning("Unable to write pipeline cache '%s', the path is too long", path);
+            return false;
+        }
+
+        uint8_t* data = new uint8_t[data_size];
+        bool result = vkGetPipelineCacheData(vk_device, vk_pipeline_cache, &data_size, data) == VK_SUCCESS;
+        if (result)
+        {
+            FILE* file = fopen(tmp_path, "wb");
+            if (file)
+            {
+                result = fwrite(data, 1, data_size, file) == data_size;
+                result = (fclose(file) == 0) && result;
+
+                if (!result)
+                {
+                    dmSys::Unlink(tmp_path);
+                    dmLogWarning("Unable to write pipeline cache '%s'", tmp_path);
+                }
+                else if (dmSys::Rename(path, tmp_path) != dmSys::RESULT_OK)
+                {
+                    dmSys::Unlink(tmp_path);
+                    dmLogWarning("Unable to rename '%s' to '%s'", tmp_path, path);
+                    result = false;
+                }
+            }
+            else
+            {
+                dmLogWarning("Unable to open pipeline cache '%s' for writing", tmp_path);
+                result = false;
+            }
+        }
+        delete[] data;
+        return result;
     }
 
     void ResetScratchBuffer(VkDevice vk_device, ScratchBuffer* scratchBuffer)
@@ -1516,11 +1624,7 @@ bail:
             handle->m_Buffer = VK_NULL_HANDLE;
         }
 
-        if (handle->m_Memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(vk_device, handle->m_Memory, 0);
-            handle->m_Memory = VK_NULL_HANDLE;
-        }
+        FreeDeviceMemory(vk_device, &handle->m_Memory);
     }
 
     void DestroyShaderModule(VkDevice vk_device, ShaderModule* shaderModule)
@@ -0,0 +1,442 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <dlib/array.h>
+#include <dlib/log.h>
+#include <dlib/mutex.h>
+#include <dlib/profile.h>
+
+#include "graphics_vulkan_defines.h"
+#include "graphics_vulkan_private.h"
+
+DM_PROPERTY_EXTERN(rmtp_Graphics);
+DM_PROPERTY_GROUP(rmtp_VulkanMemory, "Vulkan memory", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_VulkanMemoryBlocks, 0, FrameReset, "# memory blocks", &rmtp_VulkanMemory);
+DM_PROPERTY_U32(rmtp_VulkanMemoryBlockSize, 0, FrameReset, "size of all memory blocks in kb", &rmtp_VulkanMemory);
+DM_PROPERTY_U32(rmtp_VulkanMemoryUsedSize, 0, FrameReset, "size of all allocations in the memory blocks in kb", &rmtp_VulkanMemory);
+DM_PROPERTY_U32(rmtp_VulkanMemoryAllocations, 0, FrameReset, "# allocations in the memory blocks", &rmtp_VulkanMemory);
+DM_PROPERTY_U32(rmtp_VulkanMemoryDedicated, 0, FrameReset, "# dedicated allocations", &rmtp_VulkanMemory);
+DM_PROPERTY_U32(rmtp_VulkanMemoryDedicatedSize, 0, FrameReset, "size of all dedicated allocations in kb", &rmtp_VulkanMemory);
+
+namespace dmGraphics
+{
+    struct DeviceMemoryRange
+    {
+        VkDeviceSize m_Offset;
+        VkDeviceSize m_Size;
+    };
+
+    struct DeviceMemoryBlock
+    {
+        VkDeviceMemory             m_Memory;
+        VkDeviceSize               m_Size;
+        VkDeviceSize               m_UsedSize;
+        uint8_t*                   m_MappedDataPtr;
+        dmArray<DeviceMemoryRange> m_FreeRanges; // Sorted by offset, neighbouring ranges are always merged
+        uint32_t                   m_AllocationCount;
+        uint16_t                   m_PoolIndex;
+    };
+
+    struct DeviceMemoryAllocator
+    {
+        // Linear resources (buffers and linear images) and optimal images are kept in separate pools,
+        // so that we never need to care about the bufferImageGranularity between neighbouring resources.
+        dmArray<DeviceMemoryBlock*>      m_Pools[VK_MAX_MEMORY_TYPES * 2];
+        VkPhysicalDeviceMemoryProperties m_MemoryProperties; // Cached, so that allocations don't need to query the physical device
+        DeviceMemoryStats                m_Stats;
+        dmMutex::HMutex                  m_Mutex;
+        VkDeviceSize                     m_BlockSize;
+    };
+
+    static DeviceMemoryAllocator g_DeviceMemoryAllocator;
+
+    static inline VkDeviceSize AlignOffset(VkDeviceSize offset, VkDeviceSize alignment)
+    {
+        return alignment > 1 ? (offset + alignment - 1) & ~(alignment - 1) : offset;
+    }
+
+    static void InsertRange(dmArray<DeviceMemoryRange>& ranges, uint32_t index, const DeviceMemoryRange& range)
+    {
+        if (ranges.Full())
+        {
+            ranges.OffsetCapacity(16);
+        }
+        ranges.SetSize(ranges.Size() + 1);
+        DeviceMemoryRange* ranges_ptr = ranges.Begin();
+        memmove(ranges_ptr + index + 1, ranges_ptr + index, sizeof(DeviceMemoryRange) * (ranges.Size() - 1 - index));
+        ranges_ptr[index] = range;
+    }
+
+    static void EraseRange(dmArray<DeviceMemoryRange>& ranges, uint32_t index)
+    {
+        DeviceMemoryRange* ranges_ptr = ranges.Begin();
+        memmove(ranges_ptr + index, ranges_ptr + index + 1, sizeof(DeviceMemoryRange) * (ranges.Size() - 1 - index));
+        ranges.SetSize(ranges.Size() - 1);
+    }
+
+    void InitializeDeviceMemoryAllocator(const VkPhysicalDeviceMemoryProperties& vk_memory_props, VkDeviceSize blockSize)
+    {
+        DeviceMemoryAllocator& allocator = g_DeviceMemoryAllocator;
+        if (allocator.m_Mutex == 0)
+        {
+            allocator.m_Mutex = dmMutex::New();
+        }
+        allocator.m_MemoryProperties = vk_memory_props;
+        allocator.m_BlockSize        = blockSize;
+    }
+
+    static void DestroyMemoryBlock(VkDevice vk_device, DeviceMemoryBlock* block)
+    {
+        if (block->m_MappedDataPtr)
+        {
+            vkUnmapMemory(vk_device, block->m_Memory);
+        }
+        vkFreeMemory(vk_device, block->m_Memory, 0);
+
+        g_DeviceMemoryAllocator.m_Stats.m_BlockCount--;
+        g_DeviceMemoryAllocator.m_Stats.m_BlockBytes -= block->m_Size;
+        delete block;
+    }
+
+    void FinalizeDeviceMemoryAllocator(VkDevice vk_device)
+    {
+        DeviceMemoryAllocator& allocator = g_DeviceMemoryAllocator;
+        if (allocator.m_Mutex == 0)
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(allocator.m_Pools); ++i)
+        {
+            dmArray<DeviceMemoryBlock*>& pool = allocator.m_Pools[i];
+            for (uint32_t j = 0; j < pool.Size(); ++j)
+            {
+                if (pool[j]->m_AllocationCount > 0)
+                {
+                    dmLogWarning("Destroying device memory block with %u allocations still in use", pool[j]->m_AllocationCount);
+                }
+                DestroyMemoryBlock(vk_device, pool[j]);
+            }
+            pool.SetCapacity(0);
+        }
+
+        memset(&allocator.m_Stats, 0, sizeof(allocator.m_Stats));
+        dmMutex::Delete(allocator.m_Mutex);
+        allocator.m_Mutex = 0;
+    }
+
+    static VkResult CreateMemoryBlock(VkDevice vk_device, uint32_t memory_type_index, uint16_t pool_index, DeviceMemoryBlock** block_out)
+    {
+        DeviceMemoryAllocator& allocator = g_DeviceMemoryAllocator;
+
+        VkMemoryAllocateInfo vk_memory_alloc_info;
+        memset(&vk_memory_alloc_info, 0, sizeof(vk_memory_alloc_info));
+        vk_memory_alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        vk_memory_alloc_info.allocationSize  = allocator.m_BlockSize;
+        vk_memory_alloc_info.memoryTypeIndex = memory_type_index;
+
+        VkDeviceMemory vk_memory = VK_NULL_HANDLE;
+        VkResult res = vkAllocateMemory(vk_device, &vk_memory_alloc_info, 0, &vk_memory);
+        if (res != VK_SUCCESS)
+        {
+            return res;
+        }
+
+        void* mapped_data_ptr = 0;
+        if (allocator.m_MemoryProperties.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            // Memory can only be mapped once, so the block stays mapped for all resources placed in it
+            res = vkMapMemory(vk_device, vk_memory, 0, VK_WHOLE_SIZE, 0, &mapped_data_ptr);
+            if (res != VK_SUCCESS)
+            {
+                vkFreeMemory(vk_device, vk_memory, 0);
+                return res;
+            }
+        }
+
+        DeviceMemoryBlock* block = new DeviceMemoryBlock;
+        block->m_Memory          = vk_memory;
+        block->m_Size            = allocator.m_BlockSize;
+        block->m_UsedSize        = 0;
+        block->m_MappedDataPtr   = (uint8_t*) mapped_data_ptr;
+        block->m_AllocationCount = 0;
+        block->m_PoolIndex       = pool_index;
+        block->m_FreeRanges.SetCapacity(16);
+
+        DeviceMemoryRange range = { 0, block->m_Size };
+        block->m_FreeRanges.Push(range);
+
+        allocator.m_Stats.m_BlockCount++;
+        allocator.m_Stats.m_BlockBytes += block->m_Size;
+
+        *block_out = block;
+        return VK_SUCCESS;
+    }
+
+    // Places the allocation in the free range that leaves the least space unused (best fit)
+    static bool AllocateFromBlock(DeviceMemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, DeviceMemory* memory_out)
+    {
+        if (block->m_Size - block->m_UsedSize < size)
+        {
+            return false;
+        }
+
+        uint32_t best_index         = ~0u;
+        VkDeviceSize best_remaining = 0;
+
+        for (uint32_t i = 0; i < block->m_FreeRanges.Size(); ++i)
+        {
+            const DeviceMemoryRange& range = block->m_FreeRanges[i];
+            VkDeviceSize padding           = AlignOffset(range.m_Offset, alignment) - range.m_Offset;
+            if (padding + size > range.m_Size)
+            {
+                continue;
+            }
+
+            VkDeviceSize remaining = range.m_Size - padding - size;
+            if (best_index == ~0u || remaining < best_remaining)
+            {
+                best_index     = i;
+                best_remaining = remaining;
+                if (remaining == 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (best_index == ~0u)
+        {
+            return false;
+        }
+
+        DeviceMemoryRange range = block->m_FreeRanges[best_index];
+        VkDeviceSize offset     = AlignOffset(range.m_Offset, alignment);
+        VkDeviceSize padding    = offset - range.m_Offset;
+
+        // The alignment padding stays in the free list at the start of the range, the rest is kept after the allocation
+        if (padding > 0 && best_remaining > 0)
+        {
+            block->m_FreeRanges[best_index].m_Size = padding;
+            DeviceMemoryRange tail = { offset + size, best_remaining };
+            InsertRange(block->m_FreeRanges, best_index + 1, tail);
+        }
+        else if (padding > 0)
+        {
+            block->m_FreeRanges[best_index].m_Size = padding;
+        }
+        else if (best_remaining > 0)
+        {
+            block->m_FreeRanges[best_index].m_Offset = offset + size;
+            block->m_FreeRanges[best_index].m_Size   = best_remaining;
+        }
+        else
+        {
+            EraseRange(block->m_FreeRanges, best_index);
+        }
+
+        block->m_UsedSize += size;
+        block->m_AllocationCount++;
+
+        memory_out->m_Memory = block->m_Memory;
+        memory_out->m_Offset = offset;
+        memory_out->m_Size   = size;
+        memory_out->m_Block  = block;
+        return true;
+    }
+
+    static void FreeToBlock(DeviceMemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+    {
+        dmArray<DeviceMemoryRange>& ranges = block->m_FreeRanges;
+
+        uint32_t index = 0;
+        while (index < ranges.Size() && ranges[index].m_Offset < offset)
+        {
+            index++;
+        }
+
+        bool merge_prev = index > 0 && ranges[index - 1].m_Offset + ranges[index - 1].m_Size == offset;
+        bool merge_next = index < ranges.Size() && offset + size == ranges[index].m_Offset;
+
+        if (merge_prev && merge_next)
+        {
+            ranges[index - 1].m_Size += size + ranges[index].m_Size;
+            EraseRange(ranges, index);
+        }
+        else if (merge_prev)
+        {
+            ranges[index - 1].m_Size += size;
+        }
+        else if (merge_next)
+        {
+            ranges[index].m_Offset = offset;
+            ranges[index].m_Size  += size;
+        }
+        else
+        {
+            DeviceMemoryRange range = { offset, size };
+            InsertRange(ranges, index, range);
+        }
+
+        block->m_UsedSize -= size;
+        block->m_AllocationCount--;
+    }
+
+    static VkResult AllocateDedicatedMemory(VkDevice vk_device, VkDeviceSize size, uint32_t memory_type_index, DeviceMemory* memory_out)
+    {
+        VkMemoryAllocateInfo vk_memory_alloc_info;
+        memset(&vk_memory_alloc_info, 0, sizeof(vk_memory_alloc_info));
+        vk_memory_alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        vk_memory_alloc_info.allocationSize  = size;
+        vk_memory_alloc_info.memoryTypeIndex = memory_type_index;
+
+        VkDeviceMemory vk_memory = VK_NULL_HANDLE;
+        VkResult res = vkAllocateMemory(vk_device, &vk_memory_alloc_info, 0, &vk_memory);
+        if (res != VK_SUCCESS)
+        {
+            return res;
+        }
+
+        memory_out->m_Memory = vk_memory;
+        memory_out->m_Offset = 0;
+        memory_out->m_Size   = size;
+        memory_out->m_Block  = 0;
+
+        g_DeviceMemoryAllocator.m_Stats.m_DedicatedCount++;
+        g_DeviceMemoryAllocator.m_Stats.m_DedicatedBytes += size;
+        return VK_SUCCESS;
+    }
+
+    VkResult AllocateDeviceMemory(VkDevice vk_device, const VkMemoryRequirements& vk_memory_req, uint32_t memoryTypeIndex, bool isOptimalImage, DeviceMemory* memoryOut)
+    {
+        DeviceMemoryAllocator& allocator = g_DeviceMemoryAllocator;
+        assert(allocator.m_Mutex);
+        DM_MUTEX_SCOPED_LOCK(allocator.m_Mutex);
+
+        // Large resources would waste most of a block, and lazily allocated (memoryless) attachments
+        // must have memory of their own for the driver to be able to skip backing them.
+        bool dedicated = vk_memory_req.size > allocator.m_BlockSize / 2 ||
+            (allocator.m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+
+        if (dedicated)
+        {
+            return AllocateDedicatedMemory(vk_device, vk_memory_req.size, memoryTypeIndex, memoryOut);
+        }
+
+        uint16_t pool_index = memoryTypeIndex * 2 + (isOptimalImage ? 1 : 0);
+        dmArray<DeviceMemoryBlock*>& pool = allocator.m_Pools[pool_index];
+
+        for (uint32_t i = 0; i < pool.Size(); ++i)
+        {
+            if (AllocateFromBlock(pool[i], vk_memory_req.size, vk_memory_req.alignment, memoryOut))
+            {
+                allocator.m_Stats.m_AllocationCount++;
+                allocator.m_Stats.m_UsedBytes += vk_memory_req.size;
+                return VK_SUCCESS;
+            }
+        }
+
+        DeviceMemoryBlock* block = 0;
+        VkResult res = CreateMemoryBlock(vk_device, memoryTypeIndex, pool_index, &block);
+        if (res != VK_SUCCESS)
+        {
+            // The heap might not have room for a full block, but still for the resource itself
+            return AllocateDedicatedMemory(vk_device, vk_memory_req.size, memoryTypeIndex, memoryOut);
+        }
+
+        if (pool.Full())
+        {
+            pool.OffsetCapacity(4);
+        }
+        pool.Push(block);
+
+        bool allocated = AllocateFromBlock(block, vk_memory_req.size, vk_memory_req.alignment, memoryOut);
+        assert(allocated);
+        (void) allocated;
+
+        allocator.m_Stats.m_AllocationCount++;
+        allocator.m_Stats.m_UsedBytes += vk_memory_req.size;
+        return VK_SUCCESS;
+    }
+
+    void FreeDeviceMemory(VkDevice vk_device, DeviceMemory* memory)
+    {
+        if (memory->m_Memory == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        DeviceMemoryAllocator& allocator = g_DeviceMemoryAllocator;
+        DM_MUTEX_SCOPED_LOCK(allocator.m_Mutex);
+
+        DeviceMemoryBlock* block = memory->m_Block;
+        if (block == 0)
+        {
+            vkFreeMemory(vk_device, memory->m_Memory, 0);
+            allocator.m_Stats.m_DedicatedCount--;
+            allocator.m_Stats.m_DedicatedBytes -= memory->m_Size;
+        }
+        else
+        {
+            FreeToBlock(block, memory->m_Offset, memory->m_Size);
+            allocator.m_Stats.m_AllocationCount--;
+            allocator.m_Stats.m_UsedBytes -= memory->m_Size;
+
+            // Empty blocks are released, but we keep one per pool to avoid reallocating
+            // it when resources are created and deleted in the same frame.
+            dmArray<DeviceMemoryBlock*>& pool = allocator.m_Pools[block->m_PoolIndex];
+            if (block->m_AllocationCount == 0 && pool.Size() > 1)
+            {
+                for (uint32_t i = 0; i < pool.Size(); ++i)
+                {
+                    if (pool[i] == block)
+                    {
+                        pool.EraseSwap(i);
+                        break;
+                    }
+                }
+                DestroyMemoryBlock(vk_device, block);
+            }
+        }
+
+        memset(memory, 0, sizeof(*memory));
+    }
+
+    void* GetDeviceMemoryMappedPtr(const DeviceMemory& memory)
+    {
+        if (memory.m_Block == 0 || memory.m_Block->m_MappedDataPtr == 0)
+        {
+            return 0;
+        }
+        return memory.m_Block->m_MappedDataPtr + memory.m_Offset;
+    }
+
+    void GetDeviceMemoryStats(DeviceMemoryStats* stats)
+    {
+        DM_MUTEX_SCOPED_LOCK(g_DeviceMemoryAllocator.m_Mutex);
+        *stats = g_DeviceMemoryAllocator.m_Stats;
+    }
+
+    void ProfileDeviceMemory()
+    {
+        DeviceMemoryStats stats;
+        GetDeviceMemoryStats(&stats);
+        DM_PROPERTY_SET_U32(rmtp_VulkanMemoryBlocks, stats.m_BlockCount);
+        DM_PROPERTY_SET_U32(rmtp_VulkanMemoryBlockSize, (uint32_t) (stats.m_BlockBytes / 1024));
+        DM_PROPERTY_SET_U32(rmtp_VulkanMemoryUsedSize, (uint32_t) (stats.m_UsedBytes / 1024));
+        DM_PROPERTY_SET_U32(rmtp_VulkanMemoryAllocations, stats.m_AllocationCount);
+        DM_PROPERTY_SET_U32(rmtp_VulkanMemoryDedicated, stats.m_DedicatedCount);
+        DM_PROPERTY_SET_U32(rmtp_VulkanMemoryDedicatedSize, (uint32_t) (stats.m_DedicatedBytes / 1024));
+    }
+}
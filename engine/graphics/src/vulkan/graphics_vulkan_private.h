@@ -34,6 +34,7 @@ namespace dmGraphics
     const static uint8_t DM_MAX_TEXTURE_UNITS          = 32;
     const static uint8_t DM_RENDERTARGET_BACKBUFFER_ID = 0;
     const static uint8_t DM_MAX_FRAMES_IN_FLIGHT       = 2; // In flight frames - number of concurrent frames being processed
+    const static uint32_t DM_DEVICE_MEMORY_BLOCK_SIZE  = 32 * 1024 * 1024; // Size of the device memory blocks that buffers and textures are placed in
 
     enum VulkanResourceType
     {
@@ -53,6 +54,28 @@ namespace dmGraphics
         VkCommandBuffer        m_CmdBuffer;
     };
 
+    struct DeviceMemoryBlock;
+
+    // A range of device memory. Either a part of a larger memory block shared with other resources,
+    // or a dedicated allocation when m_Block is 0.
+    struct DeviceMemory
+    {
+        VkDeviceMemory     m_Memory;
+        VkDeviceSize       m_Offset;
+        VkDeviceSize       m_Size;
+        DeviceMemoryBlock* m_Block;
+    };
+
+    struct DeviceMemoryStats
+    {
+        uint32_t     m_BlockCount;
+        uint32_t     m_DedicatedCount;
+        uint32_t     m_AllocationCount;
+        VkDeviceSize m_BlockBytes;      // Size of all memory blocks
+        VkDeviceSize m_UsedBytes;       // Size of all sub allocations in the memory blocks
+        VkDeviceSize m_DedicatedBytes;
+    };
+
     struct DeviceBuffer
     {
         DeviceBuffer(){}
@@ -67,8 +90,8 @@ namespace dmGraphics
 
         struct VulkanHandle
         {
-            VkBuffer       m_Buffer;
-            VkDeviceMemory m_Memory;
+            VkBuffer     m_Buffer;
+            DeviceMemory m_Memory;
         };
 
         void*              m_MappedDataPtr;
@@ -367,6 +390,10 @@ namespace dmGraphics
         HTexture                           m_TextureUnits[DM_MAX_TEXTURE_UNITS];
         dmOpaqueHandleContainer<uintptr_t> m_AssetHandleContainer;
         PipelineCache                      m_PipelineCache;
+        VkPipelineCache                    m_DevicePipelineCache;  // Driver side cache of compiled pipelines, persisted between runs
+        char*                              m_PipelineCachePath;
+        uint64_t                           m_PipelineCacheDirtyTime;  // When the last unsaved pipeline was created, 0 if there are none
+        uint32_t                           m_PipelineCacheCount;      // Number of pipelines the last time the cache was checked
         PipelineState                      m_PipelineState;
         SwapChain*                         m_SwapChain;
         SwapChainCapabilities              m_SwapChainCapabilities;
@@ -459,8 +486,9 @@ namespace dmGraphics
     VkResult CreateRenderPass(VkDevice vk_device, VkSampleCountFlagBits vk_sample_flags, RenderPassAttachment* colorAttachments, uint8_t numColorAttachments, RenderPassAttachment* depthStencilAttachment, RenderPassAttachment* resolveAttachment, VkRenderPass* renderPassOut);
     VkResult CreateDeviceBuffer(VkPhysicalDevice vk_physical_device, VkDevice vk_device, VkDeviceSize vk_size, VkMemoryPropertyFlags vk_memory_flags, DeviceBuffer* bufferOut);
     VkResult CreateShaderModule(VkDevice vk_device, const void* source, uint32_t sourceSize, VkShaderStageFlagBits stage_flag, ShaderModule* shaderModuleOut);
-    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count, const PipelineState pipelineState, Program* program, VertexDeclaration** vertexDeclarations, uint32_t vertexDeclarationCount, RenderTarget* render_target, Pipeline* pipelineOut);
-    VkResult CreateComputePipeline(VkDevice vk_device, Program* program, Pipeline* pipelineOut);
+    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count, const PipelineState pipelineState, Program* program, VertexDeclaration** vertexDeclarations, uint32_t vertexDeclarationCount, RenderTarget* render_target, Pipeline* pipelineOut);
+    VkResult CreateComputePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, Program* program, Pipeline* pipelineOut);
+    VkResult CreatePipelineCache(PhysicalDevice* device, VkDevice vk_device, const char* path, VkPipelineCache* vk_pipeline_cache_out);
 
     // Destroy functions
     void DestroyDeviceBuffer(VkDevice vk_device, DeviceBuffer::VulkanHandle* handle);
@@ -490,9 +518,21 @@ namespace dmGraphics
     VkResult TransitionImageLayout(VkDevice vk_device, VkCommandPool vk_command_pool, VkQueue vk_graphics_queue, VulkanTexture* texture, VkImageAspectFlags vk_image_aspect, VkImageLayout vk_to_layout, uint32_t baseMipLevel = 0, uint32_t layer_count = 1);
     VkResult WriteToDeviceBuffer(VkDevice vk_device, VkDeviceSize size, VkDeviceSize offset, const void* data, DeviceBuffer* buffer);
     void     DestroyPipelineCacheCb(VulkanContext* context, const uint64_t* key, Pipeline* value);
+    bool     SavePipelineCache(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, const char* path);
     void     FlushResourcesToDestroy(VkDevice vk_device, ResourcesToDestroyList* resource_list);
     void     ResetScratchBuffer(VkDevice vk_device, ScratchBuffer* scratchBuffer);
 
+    // Implemented in graphics_vulkan_memory.cpp
+    //   Buffers and images are placed in larger memory blocks per memory type, instead of
+    //   allocating device memory for each resource. Host visible blocks stay mapped.
+    void     InitializeDeviceMemoryAllocator(const VkPhysicalDeviceMemoryProperties& vk_memory_props, VkDeviceSize blockSize);
+    void     FinalizeDeviceMemoryAllocator(VkDevice vk_device);
+    VkResult AllocateDeviceMemory(VkDevice vk_device, const VkMemoryRequirements& vk_memory_req, uint32_t memoryTypeIndex, bool isOptimalImage, DeviceMemory* memoryOut);
+    void     FreeDeviceMemory(VkDevice vk_device, DeviceMemory* memory);
+    void*    GetDeviceMemoryMappedPtr(const DeviceMemory& memory);
+    void     GetDeviceMemoryStats(DeviceMemoryStats* stats);
+    void     ProfileDeviceMemory();
+
     // Implemented in graphics_vulkan_swap_chain.cpp
     //   wantedWidth and wantedHeight might be written to, we might not get the
     //   dimensions we wanted from Vulkan.
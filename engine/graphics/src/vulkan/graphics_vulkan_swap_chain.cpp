@@ -224,6 +224,7 @@ namespace dmGraphics
         {
             DestroyVkSwapChain(vk_device, vk_old_swap_chain, swapChain->m_ImageViews);
             DestroyTexture(vk_device, &swapChain->m_ResolveTexture->m_Handle);
+            DestroyDeviceBuffer(vk_device, &swapChain->m_ResolveTexture->m_DeviceBuffer.m_Handle);
         }
 
         vkGetSwapchainImagesKHR(vk_device, swapChain->m_SwapChain, &swap_chain_image_count, 0);
@@ -303,6 +304,7 @@ namespace dmGraphics
         assert(swapChain);
         DestroyVkSwapChain(vk_device, swapChain->m_SwapChain, swapChain->m_ImageViews);
         DestroyTexture(vk_device, &swapChain->m_ResolveTexture->m_Handle);
+        DestroyDeviceBuffer(vk_device, &swapChain->m_ResolveTexture->m_DeviceBuffer.m_Handle);
 
         swapChain->m_SwapChain = VK_NULL_HANDLE;
     }
@@ -359,6 +359,7 @@ namespace dmGui
         scene->m_Nodes.SetCapacity(params->m_MaxNodes);
         scene->m_NodePool.SetCapacity(params->m_MaxNodes);
         scene->m_Animations.SetCapacity(params->m_MaxAnimations);
+        scene->m_NodeEnabledCache.SetCapacity(params->m_MaxNodes);
         scene->m_Textures.SetCapacity(params->m_MaxTextures*2, params->m_MaxTextures);
         // hashtable has zero capacity by default
         if (params->m_MaxDynamicTextures > 0)
@@ -378,6 +379,7 @@ namespace dmGui
         scene->m_RenderTail = INVALID_INDEX;
         scene->m_NextVersionNumber = 0;
         scene->m_RenderOrder = 0;
+        scene->m_RenderListDirty = 1;
         scene->m_Width = context->m_DefaultProjectWidth;
         scene->m_Height = context->m_DefaultProjectHeight;
         scene->m_FetchTextureSetAnimCallback = params->m_FetchTextureSetAnimCallback;
@@ -843,6 +845,7 @@ namespace dmGui
             if (nodes[i].m_Node.m_LayerHash == layer_hash)
                 nodes[i].m_Node.m_LayerIndex = index;
         }
+        scene->m_RenderListDirty = 1;
         return RESULT_OK;
     }
 
@@ -942,6 +945,7 @@ namespace dmGui
             set_node_callback(scene, GetNodeHandle(n), n->m_Node.m_NodeDescTable[index]);
             n->m_Node.m_DirtyLocal = 1;
         }
+        scene->m_RenderListDirty = 1;
         return RESULT_OK;
     }
 
@@ -1098,14 +1102,6 @@ namespace dmGui
         }
     };
 
-    struct RenderEntrySortDisabledPred
-    {
-        bool operator ()(const RenderEntry& a, const RenderEntry& b) const
-        {
-            return a.m_RenderKey < b.m_RenderKey;
-        }
-    };
-
     struct ScopeContext {
         ScopeContext() {
             memset(this, 0, sizeof(*this));
@@ -1270,11 +1266,9 @@ namespace dmGui
             render_entries.Push(e);
 
         uint16_t index = start_index;
-        uint32_t active_nodes = 0;
         while (index != INVALID_INDEX) {
             InternalNode* n = &scene->m_Nodes[index];
             if (n->m_Node.m_Enabled) {
-                ++active_nodes;
                 HNode node = GetNodeHandle(n);
                 uint16_t layer = GetLayerIndex(scene, n);
                 if (n->m_ClipperIndex != INVALID_INDEX) {
@@ -1346,15 +1340,68 @@ namespace dmGui
             index = n->m_NextIndex;
         }
         #undef PUSH_RENDER_ENTRY
-
-        DM_PROPERTY_ADD_U32(rmtp_GuiActiveNodes, active_nodes);
         return order;
     }
 
-    static void CollectNodes(HScene scene, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries)
+    // Collects the enabled nodes and their clippers, sorted in render order
+    static void UpdateRenderList(HScene scene)
     {
+        DM_PROFILE(__FUNCTION__);
+
+        dmArray<InternalClippingNode>& clippers = scene->m_RenderClippers;
+        dmArray<RenderEntry>& render_entries = scene->m_RenderEntries;
+        clippers.SetSize(0);
+        render_entries.SetSize(0);
+        if (clippers.Capacity() < scene->m_NodePool.Capacity())
+        {
+            clippers.SetCapacity(scene->m_NodePool.Capacity());
+        }
+
         CollectClippers(scene, scene->m_RenderHead, 0, 0, clippers, INVALID_INDEX);
         CollectRenderEntries(scene, scene->m_RenderHead, 0, clippers, render_entries);
+        std::sort(render_entries.Begin(), render_entries.End(), RenderEntrySortPred());
+
+        scene->m_RenderListDirty = 0;
+    }
+
+    // Updates the local and world transforms of the enabled nodes that are dirty, or have a dirty parent.
+    // The opacity is cheap enough to always update, since it isn't tracked by the dirty flags.
+    // Returns the number of enabled nodes.
+    static uint32_t UpdateWorldTransforms(HScene scene, uint16_t start_index, const InternalNode* parent, bool parent_changed)
+    {
+        bool update_all = scene->m_ResChanged && scene->m_AdjustReference != ADJUST_REFERENCE_DISABLED;
+        uint32_t active_nodes = 0;
+        uint16_t index = start_index;
+        while (index != INVALID_INDEX)
+        {
+            InternalNode* n = &scene->m_Nodes[index];
+            Node& node = n->m_Node;
+            if (node.m_Enabled)
+            {
+                ++active_nodes;
+                if (node.m_DirtyLocal || update_all)
+                {
+                    UpdateLocalTransform(scene, n);
+                }
+
+                bool changed = parent_changed || n->m_DirtyWorld;
+                if (changed)
+                {
+                    n->m_WorldTransform = parent ? parent->m_WorldTransform * node.m_LocalTransform : node.m_LocalTransform;
+                    n->m_DirtyWorld = 0;
+                }
+
+                n->m_WorldOpacity = node.m_Properties[PROPERTY_COLOR].getW();
+                if (parent && node.m_InheritAlpha)
+                {
+                    n->m_WorldOpacity *= parent->m_WorldOpacity;
+                }
+
+                active_nodes += UpdateWorldTransforms(scene, n->m_ChildHead, n, changed);
+            }
+            index = n->m_NextIndex;
+        }
+        return active_nodes;
     }
 
     static inline bool IsVisible(InternalNode* n, float opacity)
@@ -1368,82 +1415,62 @@ namespace dmGui
     {
         Context* c = scene->m_Context;
 
-        c->m_RenderNodes.SetSize(0);
-        c->m_RenderTransforms.SetSize(0);
-        c->m_RenderOpacities.SetSize(0);
-        c->m_StencilClippingNodes.SetSize(0);
-        c->m_StencilScopes.SetSize(0);
-        c->m_StencilScopeIndices.SetSize(0);
-        uint32_t capacity = scene->m_NodePool.Size() * 2;
-        if (capacity > c->m_RenderNodes.Capacity())
+        // The emitters of the particlefx nodes come and go with the particle instances, so they are collected every frame
+        if (scene->m_RenderListDirty || scene->m_AliveParticlefxs.Size() > 0)
         {
-            c->m_RenderNodes.SetCapacity(capacity);
-            c->m_RenderTransforms.SetCapacity(capacity);
-            c->m_RenderOpacities.SetCapacity(capacity);
-            c->m_SceneTraversalCache.m_Data.SetCapacity(capacity);
-            c->m_SceneTraversalCache.m_Data.SetSize(capacity);
-            c->m_StencilClippingNodes.SetCapacity(capacity);
-            c->m_StencilScopes.SetCapacity(capacity);
-            c->m_StencilScopeIndices.SetCapacity(capacity);
+            UpdateRenderList(scene);
         }
 
-        c->m_SceneTraversalCache.m_NodeIndex = 0;
-        if(++c->m_SceneTraversalCache.m_Version == INVALID_INDEX)
-        {
-            c->m_SceneTraversalCache.m_Version = 0;
-        }
+        // Ideally, we'd like to be able to do this in an Update step,
+        // but since the gui script is updated _after_ the gui component, we need to accomodate
+        // for any late scripting changes
+        // Note: We need this update step for bones as well, since they update their transform
+        uint32_t active_nodes = UpdateWorldTransforms(scene, scene->m_RenderHead, 0x0, false);
+        DM_PROPERTY_ADD_U32(rmtp_GuiActiveNodes, active_nodes);
 
-        CollectNodes(scene, c->m_StencilClippingNodes, c->m_RenderNodes);
-        uint32_t node_count = c->m_RenderNodes.Size();
-        std::sort(c->m_RenderNodes.Begin(), c->m_RenderNodes.End(), RenderEntrySortPred());
-        Matrix4 transform;
+        const dmArray<RenderEntry>& render_entries = scene->m_RenderEntries;
+        uint32_t entry_count = render_entries.Size();
 
-        if (c->m_RenderNodes.Capacity() > c->m_RenderTransforms.Capacity())
+        c->m_RenderNodes.SetSize(0);
+        c->m_RenderTransforms.SetSize(0);
+        c->m_RenderOpacities.SetSize(0);
+        c->m_StencilScopes.SetSize(0);
+        if (entry_count > c->m_RenderNodes.Capacity())
         {
-            uint32_t new_capacity = c->m_RenderNodes.Capacity();
-            c->m_RenderTransforms.SetCapacity(new_capacity);
-            c->m_RenderOpacities.SetCapacity(new_capacity);
-            c->m_SceneTraversalCache.m_Data.SetCapacity(new_capacity);
-            c->m_SceneTraversalCache.m_Data.SetSize(new_capacity);
-            c->m_StencilClippingNodes.SetCapacity(new_capacity);
-            c->m_StencilScopes.SetCapacity(new_capacity);
-            c->m_StencilScopeIndices.SetCapacity(new_capacity);
+            c->m_RenderNodes.SetCapacity(entry_count);
+            c->m_RenderTransforms.SetCapacity(entry_count);
+            c->m_RenderOpacities.SetCapacity(entry_count);
+            c->m_StencilScopes.SetCapacity(entry_count);
         }
 
-        uint32_t num_pruned = 0;
-        for (uint32_t i = 0; i < node_count; ++i)
+        const CalculateNodeTransformFlags flags = CalculateNodeTransformFlags(CALCULATE_NODE_INCLUDE_SIZE | CALCULATE_NODE_RESET_PIVOT);
+        for (uint32_t i = 0; i < entry_count; ++i)
         {
-            RenderEntry& entry = c->m_RenderNodes[i];
+            const RenderEntry& entry = render_entries[i];
             uint16_t index = entry.m_Node & 0xffff;
             InternalNode* n = &scene->m_Nodes[index];
-            float opacity = 1.0f;
-
-            // Ideally, we'd like to be able to do this in an Update step,
-            // but since the gui script is updated _after_ the gui component, we need to accomodate
-            // for any late scripting changes
-            // Note: We need this update step for bones as well, since they update their transform
+            float opacity = n->m_WorldOpacity;
             CalculateNodeSize(n);
-            CalculateNodeTransformAndAlphaCached(scene, n, CalculateNodeTransformFlags(CALCULATE_NODE_INCLUDE_SIZE | CALCULATE_NODE_RESET_PIVOT), transform, opacity);
 
-            // Ideally, we'd like to have this update step in the Update function (I'm not even sure why it isn't tbh)
-            // But for now, let's prune the list here
+            // The render list keeps the invisible nodes, since visibility and opacity change often
             if (!IsVisible(n, opacity) || n->m_Node.m_IsBone)
             {
-                entry.m_Node = INVALID_HANDLE;
-                entry.m_RenderKey = INVALID_RENDER_KEY;
-                ++num_pruned;
                 continue;
             }
 
+            Matrix4 transform = n->m_WorldTransform;
+            CalculateNodeExtents(n->m_Node, flags, transform);
+
+            c->m_RenderNodes.Push(entry);
             c->m_RenderTransforms.Push(transform);
             c->m_RenderOpacities.Push(opacity);
             if (n->m_ClipperIndex != INVALID_INDEX) {
-                InternalClippingNode* clipper = &c->m_StencilClippingNodes[n->m_ClipperIndex];
+                InternalClippingNode* clipper = &scene->m_RenderClippers[n->m_ClipperIndex];
                 if (clipper->m_NodeIndex == index) {
                     if (clipper->m_VisibleRenderKey == entry.m_RenderKey) {
                         StencilScope* scope = 0x0;
                         if (clipper->m_ParentIndex != INVALID_INDEX) {
-                            scope = &c->m_StencilClippingNodes[clipper->m_ParentIndex].m_ChildScope;
+                            scope = &scene->m_RenderClippers[clipper->m_ParentIndex].m_ChildScope;
                         }
                         c->m_StencilScopes.Push(scope);
                     } else {
@@ -1457,12 +1484,6 @@ namespace dmGui
             }
         }
 
-        if (num_pruned)
-        {
-            std::sort(c->m_RenderNodes.Begin(), c->m_RenderNodes.End(), RenderEntrySortDisabledPred());
-            c->m_RenderNodes.SetSize(c->m_RenderNodes.Size() - num_pruned);
-        }
-
         scene->m_ResChanged = 0;
         params.m_RenderNodes(scene, c->m_RenderNodes.Begin(), c->m_RenderTransforms.Begin(), c->m_RenderOpacities.Begin(), (const StencilScope**)c->m_StencilScopes.Begin(), c->m_RenderNodes.Size(), context);
     }
@@ -1480,6 +1501,32 @@ namespace dmGui
         }
     }
 
+    enum NodeEnabledState
+    {
+        NODE_ENABLED_UNKNOWN  = 0,
+        NODE_ENABLED_FALSE    = 1,
+        NODE_ENABLED_TRUE     = 2,
+    };
+
+    // Same as IsNodeEnabledRecursive, but each node is only visited once per update.
+    // Siblings and children share the result of their parents.
+    static bool IsNodeEnabledCached(HScene scene, uint8_t* cache, uint16_t node_index)
+    {
+        uint8_t state = cache[node_index];
+        if (state == NODE_ENABLED_UNKNOWN)
+        {
+            InternalNode* node = &scene->m_Nodes[node_index];
+            bool enabled = node->m_Node.m_Enabled;
+            if (enabled && node->m_ParentIndex != INVALID_INDEX)
+            {
+                enabled = IsNodeEnabledCached(scene, cache, node->m_ParentIndex);
+            }
+            state = enabled ? NODE_ENABLED_TRUE : NODE_ENABLED_FALSE;
+            cache[node_index] = state;
+        }
+        return state == NODE_ENABLED_TRUE;
+    }
+
     #define OLD_VERSION false
 
     static bool AnimCompare(const Animation& lhs, const float* value)
@@ -1550,15 +1597,123 @@ namespace dmGui
         }
     }
 
+    static inline void QueueAnimationComplete(dmArray<AnimationCompletion>& completions, Animation* anim, bool finished)
+    {
+        if (completions.Full())
+        {
+            completions.OffsetCapacity(dmMath::Max(16U, completions.Capacity()));
+        }
+        AnimationCompletion completion;
+        completion.m_Node = anim->m_Node;
+        completion.m_AnimationComplete = anim->m_AnimationComplete;
+        completion.m_Userdata1 = anim->m_Userdata1;
+        completion.m_Userdata2 = anim->m_Userdata2;
+        completion.m_Finished = finished;
+        completions.Push(completion);
+    }
+
+    // Keeps AnimationSamples::m_CurveCounts up to date when animations are added (count 1) or removed (count -1)
+    static inline void CountAnimationCurve(HScene scene, const Animation* anim, int32_t count)
+    {
+        dmEasing::Type curve = anim->m_Easing.type;
+        if (curve < dmEasing::TYPE_FLOAT_VECTOR)
+        {
+            scene->m_AnimationSamples.m_CurveCounts[curve] += count;
+        }
+    }
+
+    static void ReserveAnimationSamples(AnimationSamples& samples, uint32_t count)
+    {
+        if (samples.m_T.Capacity() < count)
+        {
+            samples.m_T.SetCapacity(count);
+            samples.m_From.SetCapacity(count);
+            samples.m_Delta.SetCapacity(count);
+            samples.m_Value.SetCapacity(count);
+        }
+        samples.m_T.SetSize(count);
+        samples.m_From.SetSize(count);
+        samples.m_Delta.SetSize(count);
+        samples.m_Value.SetSize(count);
+    }
+
+    // Evaluates the easing curves one curve segment at a time, and writes the interpolated values
+    static void EvaluateAnimationSamples(AnimationSamples& samples, const uint32_t* offsets, const uint32_t* sample_counts)
+    {
+        for (uint32_t c = 0; c < dmEasing::TYPE_FLOAT_VECTOR; ++c)
+        {
+            uint32_t count = sample_counts[c];
+            if (count == 0)
+            {
+                continue;
+            }
+
+            uint32_t offset = offsets[c];
+            float* x = samples.m_T.Begin() + offset;
+            const float* from = samples.m_From.Begin() + offset;
+            const float* delta = samples.m_Delta.Begin() + offset;
+            float** value = samples.m_Value.Begin() + offset;
+
+            dmEasing::GetValues((dmEasing::Type) c, x, x, count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                x[i] = from[i] + delta[i] * x[i];
+            }
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                *value[i] = x[i];
+            }
+        }
+    }
+
     void UpdateAnimations(HScene scene, float dt)
     {
         dmArray<Animation>* animations = &scene->m_Animations;
+        dmArray<AnimationCompletion>& completions = scene->m_AnimationCompletions;
 
         uint32_t active_animations = 0;
 
-        for (uint32_t i = 0; i < animations->Size(); ++i)
+        uint32_t n = animations->Size();
+        if (n == 0)
         {
-            Animation* anim = &(*animations)[i];
+            return;
+        }
+
+        // Completion callbacks are queued and invoked after the update and removal passes.
+        // Nothing can change the node hierarchy or the animation array while we iterate,
+        // which also keeps the enabled-cache valid for the whole update.
+        completions.SetSize(0);
+
+        dmArray<uint8_t>& enabled_cache = scene->m_NodeEnabledCache;
+        if (enabled_cache.Capacity() < scene->m_Nodes.Size())
+        {
+            enabled_cache.SetCapacity(scene->m_Nodes.Size());
+        }
+        enabled_cache.SetSize(scene->m_Nodes.Size());
+        memset(enabled_cache.Begin(), NODE_ENABLED_UNKNOWN, enabled_cache.Size());
+
+        AnimationSamples& samples = scene->m_AnimationSamples;
+        uint32_t curve_offsets[dmEasing::TYPE_FLOAT_VECTOR];
+        uint32_t curve_samples[dmEasing::TYPE_FLOAT_VECTOR];
+        uint32_t sample_capacity = 0;
+        for (uint32_t c = 0; c < dmEasing::TYPE_FLOAT_VECTOR; ++c)
+        {
+            curve_offsets[c] = sample_capacity;
+            curve_samples[c] = 0;
+            sample_capacity += samples.m_CurveCounts[c];
+        }
+        ReserveAnimationSamples(samples, sample_capacity);
+        bool has_samples = false;
+        float* sample_t = samples.m_T.Begin();
+        float* sample_from = samples.m_From.Begin();
+        float* sample_delta = samples.m_Delta.Begin();
+        float** sample_value = samples.m_Value.Begin();
+
+        Animation* anims = animations->Begin();
+        InternalNode* nodes = scene->m_Nodes.Begin();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            Animation* anim = &anims[i];
 
             dmGui::Playback playback = anim->m_Playback;
             bool looping = playback == PLAYBACK_LOOP_FORWARD || playback == PLAYBACK_LOOP_BACKWARD || playback == PLAYBACK_LOOP_PINGPONG;
@@ -1569,7 +1724,8 @@ namespace dmGui
             {
                 continue;
             }
-            if (!IsNodeEnabledRecursive(scene, anim->m_Node & 0xffff))
+            uint16_t node_index = anim->m_Node & 0xffff;
+            if (!IsNodeEnabledCached(scene, enabled_cache.Begin(), node_index))
             {
                 continue;
             }
@@ -1609,11 +1765,24 @@ namespace dmGui
                     }
                 }
 
-                float x = dmEasing::GetValue(anim->m_Easing, t2);
-
-                *anim->m_Value = anim->m_From + (anim->m_To - anim->m_From) * x;
+                dmEasing::Type curve = anim->m_Easing.type;
+                if (curve < dmEasing::TYPE_FLOAT_VECTOR && curve_samples[curve] < samples.m_CurveCounts[curve])
+                {
+                    // Evaluated with the other samples of the same curve, see EvaluateAnimationSamples
+                    uint32_t sample = curve_offsets[curve] + curve_samples[curve]++;
+                    sample_t[sample] = t2;
+                    sample_from[sample] = anim->m_From;
+                    sample_delta[sample] = anim->m_To - anim->m_From;
+                    sample_value[sample] = anim->m_Value;
+                    has_samples = true;
+                }
+                else
+                {
+                    float x = dmEasing::GetValue(anim->m_Easing, t2);
+                    *anim->m_Value = anim->m_From + (anim->m_To - anim->m_From) * x;
+                }
                 // Flag local transform as dirty for the node
-                scene->m_Nodes[anim->m_Node & 0xffff].m_Node.m_DirtyLocal = 1;
+                nodes[node_index].m_Node.m_DirtyLocal = 1;
 
                 // Animation complete, see above
                 if (t >= 1.0f)
@@ -1623,8 +1792,17 @@ namespace dmGui
                         if (playback == PLAYBACK_LOOP_PINGPONG) {
                             anim->m_Backwards ^= 1;
                         }
-                    } else {
-                        CompleteAnimation(scene, anim, true);
+                    } else if (!anim->m_AnimationCompleteCalled) {
+                        // Same order as CompleteAnimation: release the easing curve before the callback
+                        anim->m_AnimationCompleteCalled = 1;
+                        if (anim->m_Easing.release_callback)
+                        {
+                            anim->m_Easing.release_callback(&anim->m_Easing);
+                        }
+                        if (anim->m_AnimationComplete)
+                        {
+                            QueueAnimationComplete(completions, anim, true);
+                        }
                     }
                 }
             }
@@ -1634,10 +1812,16 @@ namespace dmGui
             }
         }
 
-        uint32_t n = animations->Size();
+        if (has_samples)
+        {
+            EvaluateAnimationSamples(samples, curve_offsets, curve_samples);
+        }
+
+        // Remove finished and cancelled animations in a single pass, keeping the array sorted
+        uint32_t keep = 0;
         for (uint32_t i = 0; i < n; ++i)
         {
-            Animation* anim = &(*animations)[i];
+            Animation* anim = &anims[i];
             if ((anim->m_Elapsed >= anim->m_Duration && anim->m_Delay == 0) || anim->m_Cancelled)
             {
                 // If we have cancelled an animation, its callback won't be called which means
@@ -1645,17 +1829,33 @@ namespace dmGui
                 if (!anim->m_AnimationCompleteCalled && anim->m_AnimationComplete)
                 {
                     anim->m_AnimationCompleteCalled = 1;
-                    anim->m_AnimationComplete(scene, anim->m_Node, !anim->m_Cancelled, anim->m_Userdata1, anim->m_Userdata2);
+                    QueueAnimationComplete(completions, anim, !anim->m_Cancelled);
                 }
-
-                RemoveAnimation(*animations, i);
-                i--;
-                n--;
+                CountAnimationCurve(scene, anim, -1);
                 continue;
             }
+            if (keep != i)
+            {
+                anims[keep] = *anim;
+            }
+            ++keep;
         }
+        animations->SetSize(keep);
 
-        DM_PROPERTY_ADD_U32(rmtp_GuiAnimations, n);
+        // The callbacks may start new animations or delete nodes, so the queue is only
+        // flushed once the array is consistent again
+        uint32_t completion_count = completions.Size();
+        for (uint32_t i = 0; i < completion_count; ++i)
+        {
+            AnimationCompletion* completion = &completions[i];
+            // An earlier callback may have deleted the node. The callback is still invoked to release
+            // its resources, but as not finished, like DeleteNode does for running animations.
+            bool finished = completion->m_Finished && IsNodeValid(scene, completion->m_Node);
+            completion->m_AnimationComplete(scene, completion->m_Node, finished, completion->m_Userdata1, completion->m_Userdata2);
+        }
+        completions.SetSize(0);
+
+        DM_PROPERTY_ADD_U32(rmtp_GuiAnimations, keep);
         DM_PROPERTY_ADD_U32(rmtp_GuiActiveAnimations, active_animations);
     }
 
@@ -2068,6 +2268,7 @@ namespace dmGui
             dmParticle::DestroyInstance(scene->m_ParticlefxContext, c->m_Instance);
         }
         scene->m_AliveParticlefxs.SetSize(0);
+        scene->m_RenderListDirty = 1;
 
         DeleteDynamicTextures(scene);
         ClearLayouts(scene);
@@ -2157,6 +2358,7 @@ namespace dmGui
 
                 dmParticle::DestroyInstance(scene->m_ParticlefxContext, c->m_Instance);
                 scene->m_AliveParticlefxs.EraseSwap(i);
+                scene->m_RenderListDirty = 1;
                 --count;
             }
             else
@@ -2354,7 +2556,6 @@ namespace dmGui
         node->m_ParentIndex = INVALID_INDEX;
         node->m_ChildHead = INVALID_INDEX;
         node->m_ChildTail = INVALID_INDEX;
-        node->m_SceneTraversalCacheVersion = INVALID_INDEX;
         node->m_ClipperIndex = INVALID_INDEX;
         scene->m_NextVersionNumber = (version + 1) % ((1 << 16) - 1);
 
@@ -2454,6 +2655,8 @@ namespace dmGui
             tail = &parent_n->m_ChildTail;
         }
         n->m_ParentIndex = parent_index;
+        n->m_DirtyWorld = 1;
+        scene->m_RenderListDirty = 1;
         if (prev_n != 0x0)
         {
             if (*tail == prev_n->m_Index)
@@ -2489,6 +2692,7 @@ namespace dmGui
 
     static void RemoveFromNodeList(HScene scene, InternalNode* n)
     {
+        scene->m_RenderListDirty = 1;
         // Remove from list
         if (n->m_PrevIndex != INVALID_INDEX)
             scene->m_Nodes[n->m_PrevIndex].m_NextIndex = n->m_NextIndex;
@@ -2581,6 +2785,7 @@ namespace dmGui
 
             if (anim->m_Node == node)
             {
+                CountAnimationCurve(scene, anim, -1);
                 CompleteAnimation(scene, anim, false);
                 RemoveAnimation(*animations, i);
                 i--;
@@ -2614,6 +2819,8 @@ namespace dmGui
         scene->m_RenderTail = INVALID_INDEX;
         scene->m_NodePool.Clear();
         scene->m_Animations.SetSize(0);
+        memset(scene->m_AnimationSamples.m_CurveCounts, 0, sizeof(scene->m_AnimationSamples.m_CurveCounts));
+        scene->m_RenderListDirty = 1;
     }
 
     static Vector4 ApplyAdjustOnReferenceScale(const Vector4& reference_scale, uint32_t adjust_mode)
@@ -2749,6 +2956,7 @@ namespace dmGui
         }
 
         node.m_DirtyLocal = 0;
+        n->m_DirtyWorld = 1;
     }
 
     void ResetNodes(HScene scene)
@@ -2765,6 +2973,8 @@ namespace dmGui
             }
         }
         scene->m_Animations.SetSize(0);
+        memset(scene->m_AnimationSamples.m_CurveCounts, 0, sizeof(scene->m_AnimationSamples.m_CurveCounts));
+        scene->m_RenderListDirty = 1;
     }
 
     uint16_t GetRenderOrder(HScene scene)
@@ -3199,6 +3409,7 @@ namespace dmGui
             InternalNode* n = GetNode(scene, node);
             n->m_Node.m_LayerHash = layer_id;
             n->m_Node.m_LayerIndex = *layer_index;
+            scene->m_RenderListDirty = 1;
             return RESULT_OK;
         }
         else
@@ -3371,6 +3582,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingMode = mode;
+        scene->m_RenderListDirty = 1;
     }
 
     ClippingMode GetNodeClippingMode(HScene scene, HNode node)
@@ -3383,6 +3595,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingVisible = (uint32_t) visible;
+        scene->m_RenderListDirty = 1;
     }
 
     bool GetNodeClippingVisible(HScene scene, HNode node)
@@ -3395,6 +3608,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingInverted = (uint32_t) inverted;
+        scene->m_RenderListDirty = 1;
     }
 
     bool GetNodeClippingInverted(HScene scene, HNode node)
@@ -3533,6 +3747,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_AdjustMode = (uint32_t) adjust_mode;
+        n->m_Node.m_DirtyLocal = 1;
     }
 
     void SetNodeSizeMode(HScene scene, HNode node, SizeMode size_mode)
@@ -3599,6 +3814,7 @@ namespace dmGui
             {
                 anim->m_AnimationComplete(scene, anim->m_Node, false, anim->m_Userdata1, anim->m_Userdata2);
             }
+            CountAnimationCurve(scene, &scene->m_Animations[animation_index], -1);
         }
 
         animation.m_Node = node;
@@ -3619,6 +3835,7 @@ namespace dmGui
         animation.m_Backwards = 0;
 
         animation_index = InsertAnimation(scene->m_Animations, &animation);
+        CountAnimationCurve(scene, &animation, 1);
         return &scene->m_Animations[animation_index];
     }
 
@@ -3980,6 +4197,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Enabled = enabled;
+        scene->m_RenderListDirty = 1;
         if(enabled)
         {
             SetDirtyLocalRecursive(scene, node);
@@ -4226,7 +4444,6 @@ namespace dmGui
         out_n->m_NameHash = dmHashString64(name);
         out_n->m_Version = version;
         out_n->m_Index = index;
-        out_n->m_SceneTraversalCacheVersion = INVALID_INDEX;
         out_n->m_PrevIndex = INVALID_INDEX;
         out_n->m_NextIndex = INVALID_INDEX;
         out_n->m_ParentIndex = INVALID_INDEX;
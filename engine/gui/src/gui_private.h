@@ -55,19 +55,6 @@ namespace dmGui
         CALCULATE_NODE_RESET_PIVOT  = (1<<2)    // ignore pivot in the resulting transform
     };
 
-    struct SceneTraversalCache
-    {
-        SceneTraversalCache() : m_NodeIndex(0), m_Version(0) {}
-        struct Data
-        {
-            dmVMath::Matrix4 m_Transform;
-            float     	     m_Opacity;
-        };
-        dmArray<Data>   m_Data;
-        uint16_t        m_NodeIndex;
-        uint16_t        m_Version;
-    };
-
     struct InternalClippingNode
     {
         StencilScope            m_Scope;
@@ -94,13 +81,10 @@ namespace dmGui
         dmArray<RenderEntry>            m_RenderNodes;
         dmArray<dmVMath::Matrix4>       m_RenderTransforms;
         dmArray<float>                	m_RenderOpacities;
-        dmArray<InternalClippingNode>   m_StencilClippingNodes;
         dmArray<StencilScope*>          m_StencilScopes;
-        dmArray<uint16_t>               m_StencilScopeIndices;
         dmArray<HNode>                  m_ScratchBoneNodes;
         dmHID::HContext                 m_HidContext;
         void*                           m_DisplayProfiles;
-        SceneTraversalCache             m_SceneTraversalCache;
     };
 
     struct Node
@@ -184,11 +168,12 @@ namespace dmGui
         uint16_t        m_ParentIndex;
         uint16_t        m_ChildHead;
         uint16_t        m_ChildTail;
-        uint16_t        m_SceneTraversalCacheIndex;
-        uint16_t        m_SceneTraversalCacheVersion;
         uint16_t        m_ClipperIndex;
         uint16_t        m_Deleted : 1; // Set to true for deferred deletion
-        uint16_t        m_Padding : 15;
+        uint16_t        m_DirtyWorld : 1; // Set when the local transform changes, m_WorldTransform is then recalculated for the node and its children
+        uint16_t        m_Padding : 14;
+        dmVMath::Matrix4 m_WorldTransform; // Kept between frames, see m_DirtyWorld
+        float           m_WorldOpacity;
     };
 
     struct NodeProxy
@@ -218,6 +203,28 @@ namespace dmGui
         uint16_t m_Backwards : 1;
     };
 
+    // Completion callback queued during UpdateAnimations and invoked once the update is done
+    struct AnimationCompletion
+    {
+        HNode             m_Node;
+        AnimationComplete m_AnimationComplete;
+        void*             m_Userdata1;
+        void*             m_Userdata2;
+        bool              m_Finished;
+    };
+
+    // The values sampled by UpdateAnimations in a frame, as streams that are evaluated in batches per
+    // easing curve. The streams have one segment per built-in curve, sized by the number of animations
+    // using the curve. Animations with custom curves (TYPE_FLOAT_VECTOR) are evaluated directly.
+    struct AnimationSamples
+    {
+        dmArray<float>  m_T;      // The normalized time, i.e. the easing curve input
+        dmArray<float>  m_From;
+        dmArray<float>  m_Delta;  // m_To - m_From
+        dmArray<float*> m_Value;
+        uint32_t        m_CurveCounts[dmEasing::TYPE_FLOAT_VECTOR]; // The number of animations per built-in curve
+    };
+
     struct Script
     {
         int         m_FunctionReferences[MAX_SCRIPT_FUNCTION_COUNT];
@@ -264,6 +271,9 @@ namespace dmGui
         dmIndexPool16                         m_NodePool;
         dmArray<InternalNode>                 m_Nodes;
         dmArray<Animation>                    m_Animations;
+        dmArray<AnimationCompletion>          m_AnimationCompletions;
+        AnimationSamples                      m_AnimationSamples;
+        dmArray<uint8_t>                      m_NodeEnabledCache; // Per node enabled state, recalculated for each UpdateAnimations
         dmHashTable<uintptr_t, dmhash_t>      m_ResourceToPath;
         dmHashTable64<void*>                  m_Fonts;
         dmHashTable64<TextureInfo>            m_Textures;
@@ -272,6 +282,8 @@ namespace dmGui
         dmParticle::HParticleContext          m_ParticlefxContext;
         dmHashTable64<dmParticle::HPrototype> m_Particlefxs;
         dmArray<ParticlefxComponent>          m_AliveParticlefxs;
+        dmArray<RenderEntry>                  m_RenderEntries;  // Enabled nodes in render order, kept between frames
+        dmArray<InternalClippingNode>         m_RenderClippers; // Stencil clippers of m_RenderEntries
         dmHashTable64<uint16_t>               m_Layers;
         dmArray<dmhash_t>                     m_Layouts;
         dmArray<void*>                        m_LayoutsNodeDescs;
@@ -285,6 +297,7 @@ namespace dmGui
         uint16_t                              m_RenderOrder; // For the render-key
         uint16_t                              m_NextLayerIndex;
         uint16_t                              m_ResChanged : 1;
+        uint16_t                              m_RenderListDirty : 1; // Rebuild m_RenderEntries on the next render, set on hierarchy, layer and clipping changes
         uint32_t                              m_Width;
         uint32_t                              m_Height;
         dmScript::ScriptWorld*                m_ScriptWorld;
@@ -409,112 +422,6 @@ namespace dmGui
         }
     }
 
-    /** calculates the transform of a parent node
-     *
-     * @param scene scene of the node
-     * @param node node for which to calculate the transform
-     * @param flags CalculateNodeTransformFlags enumerated behaviour flags
-     * @param out_transform [out] out-parameter to write the calculated transform to
-     * @param out_opacity [out] out-parameter to write the calculated opacity
-     * @param traversal_cache [in, out] a helper cache to store/retrieve properties during traversal
-     */
-    inline void CalculateParentNodeTransformAndAlphaCached(HScene scene, InternalNode* n, dmVMath::Matrix4& out_transform, float& out_opacity, SceneTraversalCache& traversal_cache)
-    {
-        const Node& node = n->m_Node;
-        uint16_t cache_index;
-        bool cached;
-        uint16_t cache_version = n->m_SceneTraversalCacheVersion;
-        if(cache_version != traversal_cache.m_Version)
-        {
-            n->m_SceneTraversalCacheVersion = traversal_cache.m_Version;
-            cache_index = n->m_SceneTraversalCacheIndex = traversal_cache.m_NodeIndex++;
-            cached = false;
-        }
-        else
-        {
-            cache_index = n->m_SceneTraversalCacheIndex;
-            cached = true;
-        }
-        SceneTraversalCache::Data& cache_data = traversal_cache.m_Data[cache_index];
-
-        dmVMath::Matrix4 parent_trans;
-        float parent_opacity;
-        if (n->m_ParentIndex != INVALID_INDEX)
-        {
-            InternalNode* parent = &scene->m_Nodes[n->m_ParentIndex];
-            CalculateParentNodeTransformAndAlphaCached(scene, parent, parent_trans, parent_opacity, traversal_cache);
-        }
-
-        if (node.m_DirtyLocal || (scene->m_ResChanged && scene->m_AdjustReference != ADJUST_REFERENCE_DISABLED))
-        {
-            UpdateLocalTransform(scene, n);
-        }
-        else if(cached)
-        {
-            out_transform = cache_data.m_Transform;
-            out_opacity = cache_data.m_Opacity;
-            return;
-        }
-        out_transform = node.m_LocalTransform;
-        out_opacity = n->m_Node.m_Properties[dmGui::PROPERTY_COLOR].getW();
-
-        if (n->m_ParentIndex != INVALID_INDEX)
-        {
-            out_transform = parent_trans * out_transform;
-
-            if (node.m_InheritAlpha)
-            {
-                out_opacity *= parent_opacity;
-            }
-        }
-
-        cache_data.m_Transform = out_transform;
-        cache_data.m_Opacity = out_opacity;
-    }
-
-    /** calculates the transform of a node
-     * A boundary transform maps the local rectangle (0,1),(0,1) to screen space such that it inclusively encapsulates the node boundaries in screen space.
-     * Box nodes are rendered in boundary space (quad with dimensions (0,1),(0,1)), so the same transform is calculated whether or not the CALCULATE_NODE_BOUNDARY flag is set.
-     * Text nodes are rendered in a transform where the origin is located at the left edge of the base line, excluding the text size, since it's implicitly spanned by glyph quads.
-     * Their boundary transform is analogue to the box boundary transform.
-     * This is complicated and could be simplified by supporting different pivots when rendering text.
-     *
-     * @param scene scene of the node
-     * @param node node for which to calculate the transform
-     * @param flags CalculateNodeTransformFlags enumerated behaviour flags
-     * @param out_transform [out] out-parameter to write the calculated transform to
-     * @param out_opacity [out] out-parameter to write the calculated opacity
-     */
-    inline void CalculateNodeTransformAndAlphaCached(HScene scene, InternalNode* n, const CalculateNodeTransformFlags flags, dmVMath::Matrix4& out_transform, float& out_opacity)
-    {
-        dmVMath::Matrix4 parent_trans;
-        float parent_opacity;
-        if (n->m_ParentIndex != INVALID_INDEX)
-        {
-            InternalNode* parent = &scene->m_Nodes[n->m_ParentIndex];
-            CalculateParentNodeTransformAndAlphaCached(scene, parent, parent_trans, parent_opacity, scene->m_Context->m_SceneTraversalCache);
-        }
-
-        const Node& node = n->m_Node;
-        if (node.m_DirtyLocal || (scene->m_ResChanged && scene->m_AdjustReference != ADJUST_REFERENCE_DISABLED))
-        {
-            UpdateLocalTransform(scene, n);
-        }
-        out_transform = node.m_LocalTransform;
-        CalculateNodeExtents(node, flags, out_transform);
-
-        out_opacity = node.m_Properties[dmGui::PROPERTY_COLOR].getW();
-        if (n->m_ParentIndex != INVALID_INDEX)
-        {
-            out_transform = parent_trans * out_transform;
-            if (node.m_InheritAlpha)
-            {
-                out_opacity *= parent_opacity;
-            }
-        }
-    }
-
-
     /** calculates the reference scale for a node
      * The reference scale is defined as scaling from the predefined screen space to the actual screen space.
      *
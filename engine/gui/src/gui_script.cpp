@@ -2590,10 +2590,10 @@ namespace dmGui
      */
     static int LuaSetClippingMode(lua_State* L)
     {
-        HNode hnode;
-        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        Scene* scene = GuiScriptInstance_Check(L);
+        HNode hnode = LuaCheckNode(L, 1);
         int clipping_mode = (int) luaL_checknumber(L, 2);
-        n->m_Node.m_ClippingMode = (ClippingMode) clipping_mode;
+        SetNodeClippingMode(scene, hnode, (ClippingMode) clipping_mode);
         return 0;
     }
 
@@ -2621,10 +2621,10 @@ namespace dmGui
      */
     static int LuaSetClippingVisible(lua_State* L)
     {
-        HNode hnode;
-        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        Scene* scene = GuiScriptInstance_Check(L);
+        HNode hnode = LuaCheckNode(L, 1);
         int visible = lua_toboolean(L, 2);
-        n->m_Node.m_ClippingVisible = visible;
+        SetNodeClippingVisible(scene, hnode, visible != 0);
         return 0;
     }
 
@@ -2652,10 +2652,10 @@ namespace dmGui
      */
     static int LuaSetClippingInverted(lua_State* L)
     {
-        HNode hnode;
-        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        Scene* scene = GuiScriptInstance_Check(L);
+        HNode hnode = LuaCheckNode(L, 1);
         int inverted = lua_toboolean(L, 2);
-        n->m_Node.m_ClippingInverted = inverted;
+        SetNodeClippingInverted(scene, hnode, inverted != 0);
         return 0;
     }
 
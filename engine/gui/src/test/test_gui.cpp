@@ -151,8 +151,6 @@ public:
         context_params.m_DefaultProjectHeight = 1;
 
         m_Context = dmGui::NewContext(&context_params);
-        m_Context->m_SceneTraversalCache.m_Data.SetCapacity(MAX_NODES);
-        m_Context->m_SceneTraversalCache.m_Data.SetSize(MAX_NODES);
 
         dmGui::NewSceneParams params = {};
         params.m_MaxNodes = MAX_NODES;
@@ -1297,6 +1295,82 @@ TEST_F(dmGuiTest, AnimateNodeOfDisabledParent)
     dmGui::DeleteNode(m_Scene, parent, true);
 }
 
+uint32_t DeleteOtherCompleteCount = 0;
+void DeleteOtherComplete(dmGui::HScene scene,
+                         dmGui::HNode node,
+                         bool finished,
+                         void* userdata1,
+                         void* userdata2)
+{
+    DeleteOtherCompleteCount++;
+    dmGui::HNode other = (dmGui::HNode)(uintptr_t) userdata1;
+    if (other != dmGui::INVALID_HANDLE)
+    {
+        dmGui::DeleteNode(scene, other, true);
+    }
+}
+
+// Completion callbacks of animations finishing in the same frame may delete nodes animated in that frame
+TEST_F(dmGuiTest, AnimateCompleteDeleteOther)
+{
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode n2 = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmhash_t property = dmGui::GetPropertyHash(dmGui::PROPERTY_POSITION);
+    dmGui::AnimateNodeHash(m_Scene, n1, property, Vector4(1,0,0,0), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0, &DeleteOtherComplete, (void*)(uintptr_t) n2, 0);
+    dmGui::AnimateNodeHash(m_Scene, n2, property, Vector4(1,0,0,0), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0, &DeleteOtherComplete, (void*)(uintptr_t) dmGui::INVALID_HANDLE, 0);
+
+    for (int i = 0; i < 60; ++i)
+    {
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    }
+    ASSERT_EQ(2U, DeleteOtherCompleteCount);
+    ASSERT_EQ(0U, m_Scene->m_Animations.Size());
+    ASSERT_NEAR(dmGui::GetNodePosition(m_Scene, n1).getX(), 1.0f, EPSILON);
+
+    dmGui::DeleteNode(m_Scene, n1, true);
+}
+
+uint32_t DeleteParentCompleteCount = 0;
+uint32_t DeleteParentFinishedCount = 0;
+void DeleteParentComplete(dmGui::HScene scene,
+                          dmGui::HNode node,
+                          bool finished,
+                          void* userdata1,
+                          void* userdata2)
+{
+    DeleteParentCompleteCount++;
+    if (finished)
+    {
+        DeleteParentFinishedCount++;
+        if (userdata1)
+        {
+            // Deletes the child as well
+            dmGui::DeleteNode(scene, node, true);
+        }
+    }
+}
+
+// A completion callback deleting its node cancels the completions of the children animated in the same frame
+TEST_F(dmGuiTest, AnimateCompleteDeleteParent)
+{
+    dmGui::HNode parent = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode child = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::SetNodeParent(m_Scene, child, parent, false);
+    dmhash_t property = dmGui::GetPropertyHash(dmGui::PROPERTY_COLOR);
+    dmGui::AnimateNodeHash(m_Scene, parent, property, Vector4(0,0,0,0), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0, &DeleteParentComplete, (void*)1, 0);
+    dmGui::AnimateNodeHash(m_Scene, child, property, Vector4(0,0,0,0), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0, &DeleteParentComplete, 0, 0);
+
+    for (int i = 0; i < 60; ++i)
+    {
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    }
+    ASSERT_EQ(2U, DeleteParentCompleteCount);
+    ASSERT_EQ(1U, DeleteParentFinishedCount);
+    ASSERT_FALSE(dmGui::IsNodeValid(m_Scene, parent));
+    ASSERT_FALSE(dmGui::IsNodeValid(m_Scene, child));
+    ASSERT_EQ(0U, m_Scene->m_Animations.Size());
+}
+
 TEST_F(dmGuiTest, Reset)
 {
     dmGui::HNode n1 = dmGui::NewNode(m_Scene, Point3(10, 20, 30), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
@@ -2882,7 +2956,7 @@ TEST_F(dmGuiTest, CalculateNodeTransform)
 
 TEST_F(dmGuiTest, CalculateNodeTransformCached)
 {
-    // Tests for the same bug as CalculateNodeTransform does, just in the sibling function CalculateNodeTransformAndAlphaCached
+    // Tests for the same bug as CalculateNodeTransform does, just in the world transforms that RenderScene keeps between frames
     uint32_t physical_width = 200;
     uint32_t physical_height = 100;
     float ref_scale_width = 0.25f;
@@ -2916,17 +2990,12 @@ TEST_F(dmGuiTest, CalculateNodeTransformCached)
     dmGui::InternalNode* nn2 = dmGui::GetNode(m_Scene, n2);
     dmGui::InternalNode* nn3 = dmGui::GetNode(m_Scene, n3);
 
-    Matrix4 transform;
-    float opacity;
-    (void)transform;
-    (void)opacity;
-
     //
     dmGui::SetNodeAdjustMode(m_Scene, n1, dmGui::ADJUST_MODE_STRETCH);
     dmGui::SetNodeAdjustMode(m_Scene, n2, dmGui::ADJUST_MODE_STRETCH);
     dmGui::SetNodeAdjustMode(m_Scene, n3, dmGui::ADJUST_MODE_STRETCH);
 
-    dmGui::CalculateNodeTransformAndAlphaCached(m_Scene, nn3, dmGui::CalculateNodeTransformFlags(dmGui::CALCULATE_NODE_BOUNDARY | dmGui::CALCULATE_NODE_INCLUDE_SIZE | dmGui::CALCULATE_NODE_RESET_PIVOT), transform, opacity);
+    dmGui::RenderScene(m_Scene, m_RenderParams, this);
 
     ASSERT_EQ( Vector4(4, 2, 1, 1), nn1->m_Node.m_LocalAdjustScale );
     ASSERT_EQ( Vector4(4, 2, 1, 1), nn2->m_Node.m_LocalAdjustScale );
@@ -2937,7 +3006,7 @@ TEST_F(dmGuiTest, CalculateNodeTransformCached)
     dmGui::SetNodeAdjustMode(m_Scene, n2, dmGui::ADJUST_MODE_FIT);
     dmGui::SetNodeAdjustMode(m_Scene, n3, dmGui::ADJUST_MODE_FIT);
 
-    dmGui::CalculateNodeTransformAndAlphaCached(m_Scene, nn3, dmGui::CalculateNodeTransformFlags(dmGui::CALCULATE_NODE_BOUNDARY | dmGui::CALCULATE_NODE_INCLUDE_SIZE | dmGui::CALCULATE_NODE_RESET_PIVOT), transform, opacity);
+    dmGui::RenderScene(m_Scene, m_RenderParams, this);
 
     ASSERT_EQ( Vector4(2, 2, 1, 1), nn1->m_Node.m_LocalAdjustScale );
     ASSERT_EQ( Vector4(2, 2, 1, 1), nn2->m_Node.m_LocalAdjustScale );
@@ -2948,7 +3017,7 @@ TEST_F(dmGuiTest, CalculateNodeTransformCached)
     dmGui::SetNodeAdjustMode(m_Scene, n2, dmGui::ADJUST_MODE_ZOOM);
     dmGui::SetNodeAdjustMode(m_Scene, n3, dmGui::ADJUST_MODE_ZOOM);
 
-    dmGui::CalculateNodeTransformAndAlphaCached(m_Scene, nn3, dmGui::CalculateNodeTransformFlags(dmGui::CALCULATE_NODE_BOUNDARY | dmGui::CALCULATE_NODE_INCLUDE_SIZE | dmGui::CALCULATE_NODE_RESET_PIVOT), transform, opacity);
+    dmGui::RenderScene(m_Scene, m_RenderParams, this);
 
     ASSERT_EQ( Vector4(4, 4, 1, 1), nn1->m_Node.m_LocalAdjustScale );
     ASSERT_EQ( Vector4(4, 4, 1, 1), nn2->m_Node.m_LocalAdjustScale );
@@ -3794,6 +3863,73 @@ TEST_F(dmGuiTest, MoveNodesLoad)
     dmGui::DeleteScene(scene);
 }
 
+// Verify that the easing evaluated in batches per curve gives the same values as evaluating each animation on its own,
+// with all the built in curves mixed with custom curves
+TEST_F(dmGuiTest, BatchedAnimationEasing)
+{
+    const uint32_t builtin_count = dmEasing::TYPE_FLOAT_VECTOR * 2;
+    const uint32_t custom_count = 4;
+    const uint32_t node_count = builtin_count + custom_count;
+    // One animation per vector component
+    const uint32_t animation_count = node_count * 4;
+    const float durations[] = { 1.0f, 1.5f };
+    const float dt = 1.0f / 60.0f;
+
+    dmGui::NewSceneParams params;
+    params.m_MaxNodes = node_count;
+    params.m_MaxAnimations = animation_count;
+    params.m_UserData = this;
+    dmGui::HScene scene = dmGui::NewScene(m_Context, &params);
+
+    dmVMath::FloatVector vector(64);
+    for (int i = 0; i < 64; ++i)
+    {
+        float t = i / 63.0f;
+        vector.values[i] = t * t;
+    }
+    dmEasing::Curve custom(dmEasing::TYPE_FLOAT_VECTOR);
+    custom.vector = &vector;
+
+    dmhash_t property = dmGui::GetPropertyHash(dmGui::PROPERTY_POSITION);
+    dmGui::HNode nodes[node_count];
+    dmEasing::Curve curves[node_count];
+    float from[node_count];
+    float to[node_count];
+    float duration[node_count];
+    for (uint32_t i = 0, builtin = 0; i < node_count; ++i)
+    {
+        // Put the custom curves in between the built in ones
+        if (i % (node_count / custom_count) == custom_count - 1)
+        {
+            curves[i] = custom;
+        }
+        else
+        {
+            curves[i] = dmEasing::Curve((dmEasing::Type) (builtin++ % dmEasing::TYPE_FLOAT_VECTOR));
+        }
+        from[i] = (float) i;
+        to[i] = from[i] + 1.0f + (i % 3);
+        duration[i] = durations[i % 2];
+        nodes[i] = dmGui::NewNode(scene, Point3(from[i], 0.0f, 0.0f), Vector3(10, 10, 0), dmGui::NODE_TYPE_BOX, 0);
+        dmGui::AnimateNodeHash(scene, nodes[i], property, Vector4(to[i], 0.0f, 0.0f, 0.0f), curves[i], dmGui::PLAYBACK_ONCE_FORWARD, duration[i], 0.0f, 0, 0, 0);
+    }
+    ASSERT_EQ(animation_count, scene->m_Animations.Size());
+
+    float elapsed = 0.0f;
+    for (uint32_t f = 0; f < 50; ++f)
+    {
+        dmGui::UpdateScene(scene, dt);
+        elapsed += dt;
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            float expected = from[i] + (to[i] - from[i]) * dmEasing::GetValue(curves[i], elapsed / duration[i]);
+            ASSERT_NEAR(expected, dmGui::GetNodePosition(scene, nodes[i]).getX(), EPSILON);
+        }
+    }
+
+    dmGui::DeleteScene(scene);
+}
+
 // Verify specific use cases of parenting nodes:
 // - single node (nop)
 //   - parent to nil
@@ -3968,6 +4104,201 @@ TEST_F(dmGuiTest, HierarchicalTransforms)
     ASSERT_MAT4(transforms[0], transforms[2]);
 }
 
+// Verify that the render list and world transforms kept between frames follow the changes of the scene:
+// - moving a parent moves its children
+// - a disabled subtree is removed, and catches up with its parent when enabled again
+// - layer changes reorder the nodes
+TEST_F(dmGuiTest, RetainedRenderList)
+{
+    Vector3 size(1, 1, 0);
+
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, Point3(0.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode n2 = dmGui::NewNode(m_Scene, Point3(1.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode n3 = dmGui::NewNode(m_Scene, Point3(0.0f, 1.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::SetNodeParent(m_Scene, n2, n1, false);
+    dmGui::SetNodeParent(m_Scene, n3, n2, false);
+
+    dmGui::RenderSceneParams render_params;
+    render_params.m_RenderNodes = RenderNodesStoreTransform;
+    dmVMath::Matrix4 transforms[3];
+
+    dmGui::RenderScene(m_Scene, render_params, transforms);
+    ASSERT_NEAR(1.0f, transforms[2].getTranslation().getX() - transforms[0].getTranslation().getX(), EPSILON);
+    ASSERT_NEAR(1.0f, transforms[2].getTranslation().getY() - transforms[0].getTranslation().getY(), EPSILON);
+
+    // Moving the root moves the whole hierarchy
+    dmGui::SetNodePosition(m_Scene, n1, Point3(2.0f, 3.0f, 0.0f));
+    dmGui::RenderScene(m_Scene, render_params, transforms);
+    dmVMath::Matrix4 expected = transforms[0];
+    expected.setTranslation(expected.getTranslation() + Vector3(1.0f, 1.0f, 0.0f));
+    ASSERT_MAT4(expected, transforms[2]);
+
+    // Static scene
+    dmGui::RenderScene(m_Scene, render_params, transforms);
+    ASSERT_MAT4(expected, transforms[2]);
+
+    uint32_t count = 0;
+    dmGui::RenderSceneParams count_params;
+    count_params.m_RenderNodes = RenderNodesCount;
+
+    dmGui::SetNodeEnabled(m_Scene, n2, false);
+    dmGui::RenderScene(m_Scene, count_params, &count);
+    ASSERT_EQ(1u, count);
+
+    // The disabled subtree is not updated, until it is enabled
+    dmGui::SetNodePosition(m_Scene, n1, Point3(-2.0f, 0.0f, 0.0f));
+    dmGui::RenderScene(m_Scene, count_params, &count);
+    ASSERT_EQ(1u, count);
+    dmGui::SetNodeEnabled(m_Scene, n2, true);
+    dmGui::RenderScene(m_Scene, render_params, transforms);
+    expected = transforms[0];
+    expected.setTranslation(expected.getTranslation() + Vector3(1.0f, 1.0f, 0.0f));
+    ASSERT_MAT4(expected, transforms[2]);
+
+    // Put the root on top of its children
+    std::map<dmGui::HNode, uint16_t> order;
+    dmGui::RenderSceneParams order_params;
+    order_params.m_RenderNodes = RenderNodesOrder;
+    dmGui::RenderScene(m_Scene, order_params, &order);
+    ASSERT_EQ(0u, order[n1]);
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayer(m_Scene, "l1"));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayer(m_Scene, "l2"));
+    dmGui::SetNodeLayer(m_Scene, n1, "l2");
+    dmGui::SetNodeLayer(m_Scene, n2, "l1");
+    dmGui::RenderScene(m_Scene, order_params, &order);
+    ASSERT_EQ(2u, order[n1]);
+    ASSERT_EQ(0u, order[n2]);
+    ASSERT_EQ(1u, order[n3]);
+}
+
+struct RenderedEntry
+{
+    dmVMath::Matrix4    m_Transform;
+    dmGui::HNode        m_Node;
+    float               m_Opacity;
+    dmGui::StencilScope m_StencilScope;
+    bool                m_HasStencilScope;
+};
+
+static void RenderNodesStoreEntries(dmGui::HScene scene, const dmGui::RenderEntry* nodes, const dmVMath::Matrix4* node_transforms, const float* node_opacities,
+        const dmGui::StencilScope** stencil_scopes, uint32_t node_count, void* context)
+{
+    dmArray<RenderedEntry>* out_entries = (dmArray<RenderedEntry>*) context;
+    out_entries->SetCapacity(node_count);
+    out_entries->SetSize(node_count);
+    for (uint32_t i = 0; i < node_count; ++i)
+    {
+        RenderedEntry& entry = (*out_entries)[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.m_Transform = node_transforms[i];
+        entry.m_Node = nodes[i].m_Node;
+        entry.m_Opacity = node_opacities[i];
+        entry.m_HasStencilScope = stencil_scopes[i] != 0x0;
+        if (entry.m_HasStencilScope)
+        {
+            entry.m_StencilScope = *stencil_scopes[i];
+        }
+    }
+}
+
+// Renders the scene as if nothing was kept from the previous frame
+static void RenderSceneRebuilt(dmGui::HScene scene, dmArray<RenderedEntry>* out_entries)
+{
+    scene->m_RenderListDirty = 1;
+    for (uint32_t i = 0; i < scene->m_Nodes.Size(); ++i)
+    {
+        scene->m_Nodes[i].m_Node.m_DirtyLocal = 1;
+        scene->m_Nodes[i].m_DirtyWorld = 1;
+    }
+    dmGui::RenderSceneParams render_params;
+    render_params.m_RenderNodes = RenderNodesStoreEntries;
+    dmGui::RenderScene(scene, render_params, out_entries);
+}
+
+static void AssertRetainedMatchesRebuilt(dmGui::HScene scene)
+{
+    dmArray<RenderedEntry> retained;
+    dmArray<RenderedEntry> rebuilt;
+    dmGui::RenderSceneParams render_params;
+    render_params.m_RenderNodes = RenderNodesStoreEntries;
+    dmGui::RenderScene(scene, render_params, &retained);
+    RenderSceneRebuilt(scene, &rebuilt);
+
+    ASSERT_EQ(rebuilt.Size(), retained.Size());
+    for (uint32_t i = 0; i < rebuilt.Size(); ++i)
+    {
+        const RenderedEntry& r = retained[i];
+        const RenderedEntry& e = rebuilt[i];
+        ASSERT_EQ(e.m_Node, r.m_Node);
+        ASSERT_MAT4(e.m_Transform, r.m_Transform);
+        ASSERT_NEAR(e.m_Opacity, r.m_Opacity, EPSILON);
+        ASSERT_EQ(e.m_HasStencilScope, r.m_HasStencilScope);
+        ASSERT_EQ(e.m_StencilScope.m_RefVal, r.m_StencilScope.m_RefVal);
+        ASSERT_EQ(e.m_StencilScope.m_TestMask, r.m_StencilScope.m_TestMask);
+        ASSERT_EQ(e.m_StencilScope.m_WriteMask, r.m_StencilScope.m_WriteMask);
+        ASSERT_EQ(e.m_StencilScope.m_ColorMask, r.m_StencilScope.m_ColorMask);
+    }
+}
+
+// Verify that the render list kept between frames is identical to one built from scratch, after:
+// - moving nodes
+// - disabling and enabling a subtree
+// - changing the clipping of a node
+// - changing layers and the sibling order
+TEST_F(dmGuiTest, RetainedRenderListMatchesRebuild)
+{
+    Vector3 size(1, 1, 0);
+
+    dmGui::HNode root = dmGui::NewNode(m_Scene, Point3(0.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode a = dmGui::NewNode(m_Scene, Point3(1.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode b = dmGui::NewNode(m_Scene, Point3(0.0f, 1.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode c = dmGui::NewNode(m_Scene, Point3(1.0f, 1.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode clipper = dmGui::NewNode(m_Scene, Point3(2.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode clipped = dmGui::NewNode(m_Scene, Point3(0.0f, 2.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::SetNodeParent(m_Scene, a, root, false);
+    dmGui::SetNodeParent(m_Scene, b, root, false);
+    dmGui::SetNodeParent(m_Scene, c, a, false);
+    dmGui::SetNodeParent(m_Scene, clipped, clipper, false);
+    dmGui::SetNodeClippingMode(m_Scene, clipper, dmGui::CLIPPING_MODE_STENCIL);
+    AssertRetainedMatchesRebuilt(m_Scene);
+
+    // Static scene
+    AssertRetainedMatchesRebuilt(m_Scene);
+
+    dmGui::SetNodePosition(m_Scene, root, Point3(2.0f, 3.0f, 0.0f));
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_SCALE, Vector4(2.0f, 2.0f, 1.0f, 1.0f));
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_COLOR, Vector4(1.0f, 1.0f, 1.0f, 0.5f));
+    AssertRetainedMatchesRebuilt(m_Scene);
+
+    dmGui::SetNodeEnabled(m_Scene, a, false);
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::SetNodePosition(m_Scene, root, Point3(-2.0f, 0.0f, 0.0f));
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::SetNodeEnabled(m_Scene, a, true);
+    AssertRetainedMatchesRebuilt(m_Scene);
+
+    dmGui::SetNodeClippingMode(m_Scene, b, dmGui::CLIPPING_MODE_STENCIL);
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::SetNodeClippingInverted(m_Scene, clipper, true);
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::SetNodeClippingMode(m_Scene, clipper, dmGui::CLIPPING_MODE_NONE);
+    AssertRetainedMatchesRebuilt(m_Scene);
+
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayer(m_Scene, "l1"));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayer(m_Scene, "l2"));
+    dmGui::SetNodeLayer(m_Scene, root, "l2");
+    dmGui::SetNodeLayer(m_Scene, c, "l1");
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::SetNodeLayer(m_Scene, c, "l2");
+    AssertRetainedMatchesRebuilt(m_Scene);
+
+    dmGui::MoveNodeAbove(m_Scene, root, clipper);
+    AssertRetainedMatchesRebuilt(m_Scene);
+    dmGui::MoveNodeBelow(m_Scene, b, a);
+    AssertRetainedMatchesRebuilt(m_Scene);
+}
+
 #undef ASSERT_MAT4
 
 struct TransformColorData
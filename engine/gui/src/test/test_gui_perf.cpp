@@ -0,0 +1,210 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include <testmain/testmain.h>
+#include <dlib/easing.h>
+#include <dlib/time.h>
+#include <dmsdk/dlib/vmath.h>
+#include <script/script.h>
+#include "../gui.h"
+#include "../gui_private.h"
+
+using namespace dmVMath;
+
+// Timings of the gui scene update and render. These are not run as part of the unit tests,
+// the correctness of the same code paths is verified in test_gui.cpp.
+
+class dmGuiPerfTest : public jc_test_base_class
+{
+public:
+    dmScript::HContext m_ScriptContext;
+    dmGui::HContext m_Context;
+
+    virtual void SetUp()
+    {
+        dmScript::ContextParams script_context_params = {};
+        m_ScriptContext = dmScript::NewContext(script_context_params);
+        dmScript::Initialize(m_ScriptContext);
+
+        dmGui::NewContextParams context_params;
+        context_params.m_ScriptContext = m_ScriptContext;
+        m_Context = dmGui::NewContext(&context_params);
+    }
+
+    virtual void TearDown()
+    {
+        dmGui::DeleteContext(m_Context, m_ScriptContext);
+        dmScript::Finalize(m_ScriptContext);
+        dmScript::DeleteContext(m_ScriptContext);
+    }
+};
+
+static void RenderNodesCount(dmGui::HScene scene, const dmGui::RenderEntry* nodes, const dmVMath::Matrix4* node_transforms, const float* node_opacities,
+        const dmGui::StencilScope** stencil_scopes, uint32_t node_count, void* context)
+{
+    uint32_t* count = (uint32_t*)context;
+    *count = node_count;
+}
+
+static void RenderNodesNop(dmGui::HScene scene, const dmGui::RenderEntry* nodes, const dmVMath::Matrix4* node_transforms, const float* node_opacities,
+        const dmGui::StencilScope** stencil_scopes, uint32_t node_count, void* context)
+{
+}
+
+// Measure the render cost of a menu-like scene, when it is static and when some of it is animated or rearranged
+TEST_F(dmGuiPerfTest, RenderSceneBenchmark)
+{
+    const uint32_t panel_count = 100;
+    const uint32_t items_per_panel = 49;
+    const uint32_t frame_count = 100;
+
+    dmGui::NewSceneParams params;
+    params.m_MaxNodes = panel_count * (items_per_panel + 1);
+    params.m_MaxAnimations = 32;
+    params.m_UserData = this;
+    dmGui::HScene scene = dmGui::NewScene(m_Context, &params);
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayer(scene, "background"));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayer(scene, "foreground"));
+
+    Vector3 size(10, 10, 0);
+    dmGui::HNode panels[panel_count];
+    dmGui::HNode items[panel_count * items_per_panel];
+    for (uint32_t p = 0; p < panel_count; ++p)
+    {
+        panels[p] = dmGui::NewNode(scene, Point3(p * 10.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+        dmGui::SetNodeLayer(scene, panels[p], "background");
+        if (p % 10 == 0)
+        {
+            dmGui::SetNodeClippingMode(scene, panels[p], dmGui::CLIPPING_MODE_STENCIL);
+        }
+        for (uint32_t i = 0; i < items_per_panel; ++i)
+        {
+            dmGui::HNode item = dmGui::NewNode(scene, Point3(0.0f, i * 10.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+            dmGui::SetNodeParent(scene, item, panels[p], false);
+            dmGui::SetNodeLayer(scene, item, (i % 2) ? "foreground" : "background");
+            items[p * items_per_panel + i] = item;
+        }
+    }
+
+    uint32_t render_count = 0;
+    dmGui::RenderSceneParams render_params;
+    render_params.m_RenderNodes = RenderNodesCount;
+    dmGui::RenderScene(scene, render_params, &render_count);
+    // The visible clipping nodes are rendered twice
+    ASSERT_EQ(params.m_MaxNodes + panel_count / 10, render_count);
+    render_params.m_RenderNodes = RenderNodesNop;
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        dmGui::RenderScene(scene, render_params, 0x0);
+    }
+    uint64_t static_time = dmTime::GetMonotonicTime() - start;
+
+    // Animate every tenth item, and one of the panels
+    start = dmTime::GetMonotonicTime();
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        for (uint32_t i = 0; i < panel_count * items_per_panel; i += 10)
+        {
+            dmGui::SetNodePosition(scene, items[i], Point3(f * 0.1f, i * 10.0f, 0.0f));
+        }
+        dmGui::SetNodePosition(scene, panels[f % panel_count], Point3(f * 10.0f, f * 0.1f, 0.0f));
+        dmGui::RenderScene(scene, render_params, 0x0);
+    }
+    uint64_t animated_time = dmTime::GetMonotonicTime() - start;
+
+    // Reorder the panels every frame
+    start = dmTime::GetMonotonicTime();
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        dmGui::MoveNodeAbove(scene, panels[f % panel_count], dmGui::INVALID_HANDLE);
+        dmGui::RenderScene(scene, render_params, 0x0);
+    }
+    uint64_t reordered_time = dmTime::GetMonotonicTime() - start;
+
+    printf("[STATS] %u nodes, render scene static: %.3f ms animated: %.3f ms reordered: %.3f ms\n", params.m_MaxNodes,
+        static_time / (1000.0f * frame_count), animated_time / (1000.0f * frame_count), reordered_time / (1000.0f * frame_count));
+
+    dmGui::DeleteScene(scene);
+}
+
+// Measure the update cost of many concurrent tweens, some of them under disabled parents
+TEST_F(dmGuiPerfTest, UpdateAnimationsBenchmark)
+{
+    const uint32_t parent_count = 50;
+    const uint32_t children_per_parent = 50;
+    const uint32_t frame_count = 60;
+    const uint32_t node_count = parent_count * (children_per_parent + 1);
+    const uint32_t animation_count = parent_count * children_per_parent * 4;
+
+    dmGui::NewSceneParams params;
+    params.m_MaxNodes = node_count;
+    params.m_MaxAnimations = animation_count;
+    params.m_UserData = this;
+    dmGui::HScene scene = dmGui::NewScene(m_Context, &params);
+
+    dmhash_t position = dmGui::GetPropertyHash(dmGui::PROPERTY_POSITION);
+    dmhash_t color = dmGui::GetPropertyHash(dmGui::PROPERTY_COLOR);
+    Vector3 size(10, 10, 0);
+    for (uint32_t p = 0; p < parent_count; ++p)
+    {
+        dmGui::HNode parent = dmGui::NewNode(scene, Point3(0.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+        for (uint32_t c = 0; c < children_per_parent; ++c)
+        {
+            dmGui::HNode child = dmGui::NewNode(scene, Point3(0.0f, 0.0f, 0.0f), size, dmGui::NODE_TYPE_BOX, 0);
+            dmGui::SetNodeParent(scene, child, parent, false);
+            dmEasing::Curve curve((dmEasing::Type) (c % dmEasing::TYPE_FLOAT_VECTOR));
+            dmGui::AnimateNodeHash(scene, child, (c % 2) ? position : color, Vector4(1, 1, 1, 1), curve, dmGui::PLAYBACK_LOOP_PINGPONG, 1.0f + c * 0.01f, 0.0f, 0, 0, 0);
+        }
+        if (p % 5 == 0)
+        {
+            dmGui::SetNodeEnabled(scene, parent, false);
+        }
+    }
+    ASSERT_EQ(animation_count, scene->m_Animations.Size());
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        dmGui::UpdateScene(scene, 1.0f / 60.0f);
+    }
+    uint64_t looping_time = dmTime::GetMonotonicTime() - start;
+
+    // Cancel every other tween, all of them are removed in the next update
+    for (uint32_t i = 0; i < animation_count; i += 2)
+    {
+        scene->m_Animations[i].m_Cancelled = 1;
+    }
+    start = dmTime::GetMonotonicTime();
+    dmGui::UpdateScene(scene, 1.0f / 60.0f);
+    uint64_t cancel_time = dmTime::GetMonotonicTime() - start;
+    ASSERT_EQ(animation_count / 2, scene->m_Animations.Size());
+
+    printf("[STATS] %u animations, update scene: %.3f ms cancel half: %.3f ms\n", animation_count,
+        looping_time / (1000.0f * frame_count), cancel_time / 1000.0f);
+
+    dmGui::DeleteScene(scene);
+}
+
+int main(int argc, char **argv)
+{
+    TestMainPlatformInit();
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -15,18 +15,21 @@
 #include <string.h>
 #include <stdint.h>
 #include <float.h>
-#include <algorithm>
+#include <dlib/align.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/vmath.h>
 #include <dlib/profile.h>
+#include <dlib/radix_sort.h>
 #include <dlib/time.h>
 #include <dmsdk/dlib/vmath.h>
 
 #include "particle.h"
 #include "particle_private.h"
+#include "particle_simd.h"
 
 DM_PROPERTY_GROUP(rmtp_Particles, "Particles");
 DM_PROPERTY_U32(rmtp_ParticlesAlive, 0, FrameReset, "# particles alive", &rmtp_Particles);
@@ -59,11 +62,225 @@ namespace dmParticle
     /// Simulate motion blur at 60 fps with a 180 deg shutter
     const static float STRETCH_SCALING = (1.0f/60.0f) * 0.5f;
 
+    /// Streams are padded to the widest SIMD register (AVX2) and aligned to match
+    const static uint32_t PARTICLE_STREAM_PADDING = 8;
+    const static uint32_t PARTICLE_STREAM_ALIGNMENT = PARTICLE_STREAM_PADDING * sizeof(float);
+
+    /// Sorting switches from insertion sort to radix sort when the keys are moved more than this on average
+    const static uint32_t SORT_INSERTION_MAX_MOVES_PER_PARTICLE = 4;
+
     AnimationData::AnimationData()
     {
         memset(this, 0, sizeof(*this));
     }
 
+    void ParticleBuffer::SetCapacity(uint32_t capacity)
+    {
+        if (capacity == m_Capacity)
+            return;
+
+        uint32_t size = dmMath::Min(m_Size, capacity);
+        ParticleBuffer buffer;
+        memset(&buffer, 0, sizeof(ParticleBuffer));
+        if (capacity > 0)
+        {
+            uint32_t stride = (capacity + PARTICLE_STREAM_PADDING - 1) & ~(PARTICLE_STREAM_PADDING - 1);
+            uint32_t stream_size = stride * sizeof(float);
+            // Particle streams, the scratch stream, the sort keys, the sort indices and their scratch
+            uint32_t memory_size = (PARTICLE_STREAM_COUNT + 2) * stream_size + 2 * stride * sizeof(uint32_t);
+            dmMemory::Result r = dmMemory::AlignedMalloc(&buffer.m_Memory, PARTICLE_STREAM_ALIGNMENT, memory_size);
+            assert(r == dmMemory::RESULT_OK);
+            (void)r;
+            // Cleared since the SIMD loops read the padding past the last particle
+            memset(buffer.m_Memory, 0, memory_size);
+
+            uint8_t* cursor = (uint8_t*)buffer.m_Memory;
+            for (uint32_t i = 0; i < PARTICLE_STREAM_COUNT; ++i)
+            {
+                buffer.m_Streams[i] = (float*)cursor;
+                cursor += stream_size;
+                if (size > 0)
+                    memcpy(buffer.m_Streams[i], m_Streams[i], size * sizeof(float));
+            }
+            buffer.m_Scratch = (float*)cursor;
+            cursor += stream_size;
+            buffer.m_SortKeys = (uint32_t*)cursor;
+            cursor += stream_size;
+            if (size > 0)
+                memcpy(buffer.m_SortKeys, m_SortKeys, size * sizeof(uint32_t));
+            buffer.m_SortIndices = (uint32_t*)cursor;
+            cursor += stride * sizeof(uint32_t);
+            buffer.m_SortIndexScratch = (uint32_t*)cursor;
+            buffer.m_Size = size;
+            buffer.m_Capacity = capacity;
+        }
+        if (m_Memory != 0x0)
+        {
+            dmMemory::AlignedFree(m_Memory);
+        }
+        *this = buffer;
+    }
+
+    void ParticleBuffer::SetSize(uint32_t size)
+    {
+        assert(size <= m_Capacity);
+        m_Size = size;
+    }
+
+    void ParticleBuffer::Swap(ParticleBuffer& other)
+    {
+        ParticleBuffer tmp = *this;
+        *this = other;
+        other = tmp;
+    }
+
+    void ParticleBuffer::Push(const Particle& particle)
+    {
+        assert(m_Size < m_Capacity);
+        ++m_Size;
+        Set(m_Size - 1, particle);
+    }
+
+    void ParticleBuffer::EraseSwap(uint32_t index)
+    {
+        assert(index < m_Size);
+        uint32_t last = m_Size - 1;
+        for (uint32_t i = 0; i < PARTICLE_STREAM_COUNT; ++i)
+        {
+            m_Streams[i][index] = m_Streams[i][last];
+        }
+        m_SortKeys[index] = m_SortKeys[last];
+        m_Size = last;
+    }
+
+    Particle ParticleBuffer::Get(uint32_t index) const
+    {
+        assert(index < m_Size);
+        float* const* s = m_Streams;
+        Particle p;
+        // Cleared so that the padding is deterministic when comparing particles
+        memset(&p, 0, sizeof(Particle));
+        p.m_Position.setX(s[PARTICLE_STREAM_POSITION_X][index]);
+        p.m_Position.setY(s[PARTICLE_STREAM_POSITION_Y][index]);
+        p.m_Position.setZ(s[PARTICLE_STREAM_POSITION_Z][index]);
+        p.m_SourceRotation.setX(s[PARTICLE_STREAM_SOURCE_ROTATION_X][index]);
+        p.m_SourceRotation.setY(s[PARTICLE_STREAM_SOURCE_ROTATION_Y][index]);
+        p.m_SourceRotation.setZ(s[PARTICLE_STREAM_SOURCE_ROTATION_Z][index]);
+        p.m_SourceRotation.setW(s[PARTICLE_STREAM_SOURCE_ROTATION_W][index]);
+        p.m_Rotation.setX(s[PARTICLE_STREAM_ROTATION_X][index]);
+        p.m_Rotation.setY(s[PARTICLE_STREAM_ROTATION_Y][index]);
+        p.m_Rotation.setZ(s[PARTICLE_STREAM_ROTATION_Z][index]);
+        p.m_Rotation.setW(s[PARTICLE_STREAM_ROTATION_W][index]);
+        p.m_Velocity.setX(s[PARTICLE_STREAM_VELOCITY_X][index]);
+        p.m_Velocity.setY(s[PARTICLE_STREAM_VELOCITY_Y][index]);
+        p.m_Velocity.setZ(s[PARTICLE_STREAM_VELOCITY_Z][index]);
+        p.m_TimeLeft = s[PARTICLE_STREAM_TIME_LEFT][index];
+        p.m_MaxLifeTime = s[PARTICLE_STREAM_MAX_LIFE_TIME][index];
+        p.m_ooMaxLifeTime = s[PARTICLE_STREAM_OO_MAX_LIFE_TIME][index];
+        p.m_SpreadFactor = s[PARTICLE_STREAM_SPREAD_FACTOR][index];
+        p.m_SourceSize = s[PARTICLE_STREAM_SOURCE_SIZE][index];
+        p.m_SourceStretchFactorX = s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X][index];
+        p.m_SourceStretchFactorY = s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y][index];
+        p.m_SourceColor.setX(s[PARTICLE_STREAM_SOURCE_COLOR_R][index]);
+        p.m_SourceColor.setY(s[PARTICLE_STREAM_SOURCE_COLOR_G][index]);
+        p.m_SourceColor.setZ(s[PARTICLE_STREAM_SOURCE_COLOR_B][index]);
+        p.m_SourceColor.setW(s[PARTICLE_STREAM_SOURCE_COLOR_A][index]);
+        p.m_Color.setX(s[PARTICLE_STREAM_COLOR_R][index]);
+        p.m_Color.setY(s[PARTICLE_STREAM_COLOR_G][index]);
+        p.m_Color.setZ(s[PARTICLE_STREAM_COLOR_B][index]);
+        p.m_Color.setW(s[PARTICLE_STREAM_COLOR_A][index]);
+        p.m_Scale.setX(s[PARTICLE_STREAM_SCALE_X][index]);
+        p.m_Scale.setY(s[PARTICLE_STREAM_SCALE_Y][index]);
+        p.m_Scale.setZ(s[PARTICLE_STREAM_SCALE_Z][index]);
+        p.m_SortKey.m_Key = m_SortKeys[index];
+        p.m_StretchFactorX = s[PARTICLE_STREAM_STRETCH_FACTOR_X][index];
+        p.m_StretchFactorY = s[PARTICLE_STREAM_STRETCH_FACTOR_Y][index];
+        p.m_SourceAngularVelocity = s[PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY][index];
+        return p;
+    }
+
+    void ParticleBuffer::Set(uint32_t index, const Particle& p)
+    {
+        assert(index < m_Size);
+        float* const* s = m_Streams;
+        s[PARTICLE_STREAM_POSITION_X][index] = p.m_Position.getX();
+        s[PARTICLE_STREAM_POSITION_Y][index] = p.m_Position.getY();
+        s[PARTICLE_STREAM_POSITION_Z][index] = p.m_Position.getZ();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_X][index] = p.m_SourceRotation.getX();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_Y][index] = p.m_SourceRotation.getY();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_Z][index] = p.m_SourceRotation.getZ();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_W][index] = p.m_SourceRotation.getW();
+        s[PARTICLE_STREAM_ROTATION_X][index] = p.m_Rotation.getX();
+        s[PARTICLE_STREAM_ROTATION_Y][index] = p.m_Rotation.getY();
+        s[PARTICLE_STREAM_ROTATION_Z][index] = p.m_Rotation.getZ();
+        s[PARTICLE_STREAM_ROTATION_W][index] = p.m_Rotation.getW();
+        s[PARTICLE_STREAM_VELOCITY_X][index] = p.m_Velocity.getX();
+        s[PARTICLE_STREAM_VELOCITY_Y][index] = p.m_Velocity.getY();
+        s[PARTICLE_STREAM_VELOCITY_Z][index] = p.m_Velocity.getZ();
+        s[PARTICLE_STREAM_TIME_LEFT][index] = p.m_TimeLeft;
+        s[PARTICLE_STREAM_MAX_LIFE_TIME][index] = p.m_MaxLifeTime;
+        s[PARTICLE_STREAM_OO_MAX_LIFE_TIME][index] = p.m_ooMaxLifeTime;
+        s[PARTICLE_STREAM_SPREAD_FACTOR][index] = p.m_SpreadFactor;
+        s[PARTICLE_STREAM_SOURCE_SIZE][index] = p.m_SourceSize;
+        s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X][index] = p.m_SourceStretchFactorX;
+        s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y][index] = p.m_SourceStretchFactorY;
+        s[PARTICLE_STREAM_SOURCE_COLOR_R][index] = p.m_SourceColor.getX();
+        s[PARTICLE_STREAM_SOURCE_COLOR_G][index] = p.m_SourceColor.getY();
+        s[PARTICLE_STREAM_SOURCE_COLOR_B][index] = p.m_SourceColor.getZ();
+        s[PARTICLE_STREAM_SOURCE_COLOR_A][index] = p.m_SourceColor.getW();
+        s[PARTICLE_STREAM_COLOR_R][index] = p.m_Color.getX();
+        s[PARTICLE_STREAM_COLOR_G][index] = p.m_Color.getY();
+        s[PARTICLE_STREAM_COLOR_B][index] = p.m_Color.getZ();
+        s[PARTICLE_STREAM_COLOR_A][index] = p.m_Color.getW();
+        s[PARTICLE_STREAM_SCALE_X][index] = p.m_Scale.getX();
+        s[PARTICLE_STREAM_SCALE_Y][index] = p.m_Scale.getY();
+        s[PARTICLE_STREAM_SCALE_Z][index] = p.m_Scale.getZ();
+        m_SortKeys[index] = p.m_SortKey.m_Key;
+        s[PARTICLE_STREAM_STRETCH_FACTOR_X][index] = p.m_StretchFactorX;
+        s[PARTICLE_STREAM_STRETCH_FACTOR_Y][index] = p.m_StretchFactorY;
+        s[PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY][index] = p.m_SourceAngularVelocity;
+    }
+
+    static inline SimdFloat LoadParticles(const ParticleBuffer& particles, ParticleStream stream, uint32_t index)
+    {
+        return SimdLoad(&particles.GetStream(stream)[index]);
+    }
+
+    static inline void StoreParticles(ParticleBuffer& particles, ParticleStream stream, uint32_t index, SimdFloat v)
+    {
+        SimdStore(&particles.GetStream(stream)[index], v);
+    }
+
+    // The components of vectors and quaternions are stored in consecutive streams, starting with x
+
+    static inline SimdVector3 LoadParticlesVector3(const ParticleBuffer& particles, ParticleStream stream_x, uint32_t index)
+    {
+        SimdVector3 v = {
+            SimdLoad(&particles.GetStream(stream_x)[index]),
+            SimdLoad(&particles.GetStream((ParticleStream)(stream_x + 1))[index]),
+            SimdLoad(&particles.GetStream((ParticleStream)(stream_x + 2))[index])
+        };
+        return v;
+    }
+
+    static inline void StoreParticlesVector3(ParticleBuffer& particles, ParticleStream stream_x, uint32_t index, const SimdVector3& v)
+    {
+        SimdStore(&particles.GetStream(stream_x)[index], v.m_X);
+        SimdStore(&particles.GetStream((ParticleStream)(stream_x + 1))[index], v.m_Y);
+        SimdStore(&particles.GetStream((ParticleStream)(stream_x + 2))[index], v.m_Z);
+    }
+
+    static inline SimdQuat LoadParticlesQuat(const ParticleBuffer& particles, ParticleStream stream_x, uint32_t index)
+    {
+        SimdQuat q = {
+            SimdLoad(&particles.GetStream(stream_x)[index]),
+            SimdLoad(&particles.GetStream((ParticleStream)(stream_x + 1))[index]),
+            SimdLoad(&particles.GetStream((ParticleStream)(stream_x + 2))[index]),
+            SimdLoad(&particles.GetStream((ParticleStream)(stream_x + 3))[index])
+        };
+        return q;
+    }
+
     void ResetEmitterStateChangedData(Instance* instance)
     {
         // Deallocate callback data if it is present
@@ -114,6 +331,11 @@ namespace dmParticle
         context->m_MaxParticleCount = max_particle_count;
     }
 
+    void SetJobThreadContext(HParticleContext context, dmJobThread::HContext job_thread)
+    {
+        context->m_JobThread = job_thread;
+    }
+
     static Instance* GetInstance(HParticleContext context, HInstance instance)
     {
         if (instance == INVALID_INSTANCE)
@@ -292,6 +514,21 @@ namespace dmParticle
                 instance->m_NumAwakeEmitters -= 1;
             }
 
+            // The callback might run script code, which isn't allowed on the job threads
+            if (instance->m_DeferStateChanges)
+            {
+                if (instance->m_StateChanges.Full())
+                {
+                    instance->m_StateChanges.OffsetCapacity(4);
+                }
+                EmitterStateChange change;
+                change.m_EmitterId = emitter->m_Id;
+                change.m_NumAwakeEmitters = instance->m_NumAwakeEmitters;
+                change.m_State = emitter->m_State;
+                instance->m_StateChanges.Push(change);
+                return;
+            }
+
             instance->m_EmitterStateChangedData.m_StateChangedCallback(
                 instance->m_NumAwakeEmitters,
                 emitter->m_Id,
@@ -300,6 +537,26 @@ namespace dmParticle
         }
     }
 
+    static void FlushEmitterStateChanges(HParticleContext context, uint32_t index)
+    {
+        Instance* instance = context->m_Instances[index];
+        instance->m_DeferStateChanges = 0;
+        uint32_t count = instance->m_StateChanges.Size();
+        for (uint32_t i = 0; i < count && instance->m_EmitterStateChangedData.m_UserData != 0x0; ++i)
+        {
+            EmitterStateChange change = instance->m_StateChanges[i];
+            instance->m_EmitterStateChangedData.m_StateChangedCallback(
+                change.m_NumAwakeEmitters,
+                change.m_EmitterId,
+                change.m_State,
+                instance->m_EmitterStateChangedData.m_UserData);
+            // The callback might have destroyed the instance
+            if (context->m_Instances[index] != instance)
+                return;
+        }
+        instance->m_StateChanges.SetSize(0);
+    }
+
     static bool IsSleeping(Emitter* emitter);
     static void UpdateEmitter(Prototype* prototype, Instance* instance, EmitterPrototype* emitter_prototype, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt);
 
@@ -492,7 +749,8 @@ namespace dmParticle
     static void ResetEmitter(Emitter* emitter)
     {
         // Save particles array and id
-        dmArray<Particle> tmp;
+        ParticleBuffer tmp;
+        memset(&tmp, 0, sizeof(ParticleBuffer));
         tmp.Swap(emitter->m_Particles);
         dmhash_t id = emitter->m_Id;
         uint32_t original_seed = emitter->m_OriginalSeed;
@@ -604,8 +862,6 @@ namespace dmParticle
     static GenerateVertexDataResult UpdateRenderData(HParticleContext context, Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf,
                                                     uint32_t particle_start, uint32_t particle_count,
                                                     const dmGraphics::VertexAttributeInfos& attribute_infos, const Vector4& color, uint32_t vertex_index, uint8_t* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* bytes_written, float dt);
-    static void GenerateKeys(Emitter* emitter, float max_particle_life_time);
-    static void SortParticles(Emitter* emitter);
     static void Simulate(Instance* instance, Emitter* emitter, EmitterPrototype* prototype, dmParticleDDF::Emitter* ddf, float dt);
 
     static void UpdateEmitter(Prototype* prototype, Instance* instance, EmitterPrototype* emitter_prototype, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt)
@@ -729,51 +985,101 @@ namespace dmParticle
         return GenerateVertexDataInternal(context, dt, instance, emitter_index, particle_start, particle_count, attribute_infos, color, vertex_buffer, vertex_buffer_size, out_vertex_buffer_size);
     }
 
+    // Number of instance slots updated by each job
+    static const uint32_t UPDATE_JOB_INSTANCE_COUNT = 8;
+
+    struct UpdateJobContext
+    {
+        HParticleContext        m_Context;
+        FetchAnimationCallback  m_FetchAnimationCallback;
+        float                   m_DT;
+    };
+
+    static void UpdateInstance(Instance* instance, uint32_t index, float dt, FetchAnimationCallback fetch_animation_callback)
+    {
+        // don't update sleeping instances
+        if (IsSleeping(instance))
+        {
+            // update velocity and clear vertex count (don't render)
+            uint32_t emitter_count = instance->m_Emitters.Size();
+            for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
+            {
+                Emitter* emitter = &instance->m_Emitters[emitter_i];
+                emitter->m_VertexCount = 0;
+                dmParticleDDF::Emitter* emitter_ddf = &instance->m_Prototype->m_DDF->m_Emitters[emitter_i];
+                UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
+            }
+            return;
+        }
+        uint32_t instance_handle = instance->m_VersionNumber << 16 | index;
+        instance->m_PlayTime += dt;
+        Prototype* prototype = instance->m_Prototype;
+        uint32_t emitter_count = instance->m_Emitters.Size();
+        for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
+        {
+            Emitter* emitter = &instance->m_Emitters[emitter_i];
+            EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
+            dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
+
+            UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
+            UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
+            FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
+            UpdateEmitterRenderData(instance_handle, emitter_i, instance, emitter, emitter_ddf);
+
+            if (emitter->m_ReHash)
+                ReHashEmitter(emitter);
+        }
+    }
+
+    static void UpdateInstances(void* context, void* data, uint32_t start, uint32_t end)
+    {
+        DM_PROFILE("UpdateInstances");
+        const UpdateJobContext* ctx = (const UpdateJobContext*) context;
+        Instance** instances = (Instance**) data;
+        for (uint32_t i = start; i < end; ++i)
+        {
+            // empty slot
+            if (instances[i] == 0x0) continue;
+            UpdateInstance(instances[i], i, ctx->m_DT, ctx->m_FetchAnimationCallback);
+        }
+    }
+
     void Update(HParticleContext context, float dt, FetchAnimationCallback fetch_animation_callback)
     {
         DM_PROFILE(__FUNCTION__);
 
         uint32_t size = context->m_Instances.Size();
-        uint32_t TotalAliveParticles = 0;
+        if (size == 0)
+            return;
+
+        // Instances are independent of each other, and each instance is updated by a single thread.
+        // The emitters use their own random seeds, so the result doesn't depend on the number of threads.
         for (uint32_t i = 0; i < size; i++)
         {
             Instance* instance = context->m_Instances[i];
+            if (instance != 0x0)
+                instance->m_DeferStateChanges = 1;
+        }
 
-            // empty slot
+        UpdateJobContext ctx;
+        ctx.m_Context = context;
+        ctx.m_FetchAnimationCallback = fetch_animation_callback;
+        ctx.m_DT = dt;
+        dmJobThread::ParallelFor(context->m_JobThread, UpdateInstances, &ctx, context->m_Instances.Begin(), size, UPDATE_JOB_INSTANCE_COUNT);
+
+        // Report the state changes in instance order, on the calling thread
+        uint32_t TotalAliveParticles = 0;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            Instance* instance = context->m_Instances[i];
             if (instance == 0x0) continue;
-            // don't update sleeping instances
-            if (IsSleeping(instance))
-            {
-                // update velocity and clear vertex count (don't render)
-                uint32_t emitter_count = instance->m_Emitters.Size();
-                for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
-                {
-                    Emitter* emitter = &instance->m_Emitters[emitter_i];
-                    emitter->m_VertexCount = 0;
-                    dmParticleDDF::Emitter* emitter_ddf = &instance->m_Prototype->m_DDF->m_Emitters[emitter_i];
-                    UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
-                }
-                continue;
-            }
-            uint32_t instance_handle = instance->m_VersionNumber << 16 | i;
-            instance->m_PlayTime += dt;
-            Prototype* prototype = instance->m_Prototype;
+
             uint32_t emitter_count = instance->m_Emitters.Size();
             for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
             {
-                Emitter* emitter = &instance->m_Emitters[emitter_i];
-                EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
-                dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
-
-                UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
-                UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
-                TotalAliveParticles += (uint32_t)emitter->m_Particles.Size();
-                FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
-                UpdateEmitterRenderData(instance_handle, emitter_i, instance, emitter, emitter_ddf);
-
-                if (emitter->m_ReHash)
-                    ReHashEmitter(emitter);
+                TotalAliveParticles += instance->m_Emitters[emitter_i].m_Particles.Size();
             }
+            FlushEmitterStateChanges(context, i);
         }
 
         DM_PROPERTY_SET_U32(rmtp_ParticlesAlive, TotalAliveParticles);
@@ -806,17 +1112,31 @@ namespace dmParticle
     {
         DM_PROFILE(__FUNCTION__);
 
-        // Step particle life, prune dead particles
-        uint32_t particle_count = emitter->m_Particles.Size();
+        ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t particle_count = particles.Size();
+        float* time_left = particles.GetStream(PARTICLE_STREAM_TIME_LEFT);
+
+        // Step particle life
+        uint32_t padded_count = SimdRoundUp(particle_count);
+        SimdFloat dt_v = SimdSplat(dt);
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
+        {
+            SimdStore(&time_left[i], SimdSub(SimdLoad(&time_left[i]), dt_v));
+        }
+
+        // Prune dead particles, whole registers of living particles are skipped
+        // The padding past the last particle is only read, a dead particle there merely disables the skip
         uint32_t j = 0;
         while (j < particle_count)
         {
-            Particle* p = &emitter->m_Particles[j];
-            p->SetTimeLeft(p->GetTimeLeft() - dt);
-            if (p->GetTimeLeft() < 0.0f)
+            if ((j % SIMD_WIDTH) == 0 && SimdNegativeMask(SimdLoad(&time_left[j])) == 0)
+            {
+                j += SIMD_WIDTH;
+            }
+            else if (time_left[j] < 0.0f)
             {
                 // TODO Handle death-action
-                emitter->m_Particles.EraseSwap(j);
+                particles.EraseSwap(j);
                 --particle_count;
             } else {
                 ++j;
@@ -824,7 +1144,7 @@ namespace dmParticle
         }
     }
 
-    static void SpawnParticle(dmArray<Particle>& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt);
+    static void SpawnParticle(ParticleBuffer& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt);
 
     static void UpdateEmitterState(Instance* instance, Emitter* emitter, EmitterPrototype* emitter_prototype, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
@@ -903,13 +1223,12 @@ namespace dmParticle
         return particle_count * vertices_per_particle;
     }
 
-    static void SpawnParticle(dmArray<Particle>& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt)
+    static void SpawnParticle(ParticleBuffer& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt)
     {
         DM_PROFILE(__FUNCTION__);
 
-        uint32_t particle_count = particles.Size();
-        particles.SetSize(particle_count + 1);
-        Particle *particle = &particles[particle_count];
+        Particle spawned_particle;
+        Particle* particle = &spawned_particle;
         memset(particle, 0, sizeof(Particle));
 
         // TODO Handle birth-action
@@ -1073,7 +1392,36 @@ namespace dmParticle
         particle->m_SourceStretchFactorY = emitter_properties[EMITTER_KEY_PARTICLE_STRETCH_FACTOR_Y];
         particle->m_StretchFactorY = particle->m_SourceStretchFactorY;
         particle->m_SourceAngularVelocity = emitter_properties[EMITTER_KEY_PARTICLE_ANGULAR_VELOCITY];
-    }
+
+        particles.Push(spawned_particle);
+    }
+
+    /// Number of particles evaluated at a time when generating vertex data, must be a power of two
+    static const uint32_t RENDER_BATCH_SIZE = 64;
+
+    /// Intermediate particle data when generating vertex data
+    enum RenderStream
+    {
+        RENDER_STREAM_WIDTH,
+        RENDER_STREAM_HEIGHT,
+        RENDER_STREAM_POSITION_X,
+        RENDER_STREAM_POSITION_Y,
+        RENDER_STREAM_POSITION_Z,
+        RENDER_STREAM_AXIS_X_X,
+        RENDER_STREAM_AXIS_X_Y,
+        RENDER_STREAM_AXIS_X_Z,
+        RENDER_STREAM_AXIS_Y_X,
+        RENDER_STREAM_AXIS_Y_Y,
+        RENDER_STREAM_AXIS_Y_Z,
+        RENDER_STREAM_ROTATION_X,
+        RENDER_STREAM_ROTATION_Y,
+        RENDER_STREAM_ROTATION_Z,
+        RENDER_STREAM_ROTATION_W,
+        RENDER_STREAM_SCALE_X,
+        RENDER_STREAM_SCALE_Y,
+        RENDER_STREAM_SCALE_Z,
+        RENDER_STREAM_COUNT
+    };
 
     static float unit_tex_coords[] = {
         0.0f, 1.0f,
@@ -1150,7 +1498,6 @@ namespace dmParticle
 
         // calculate emission space
         dmTransform::TransformS1 emission_transform;
-        dmTransform::Transform particle_transform;
         emission_transform.SetIdentity();
 
         dmVMath::Matrix4 normal_matrix;
@@ -1193,15 +1540,14 @@ namespace dmParticle
             height_factor *= 0.5f;
         }
 
-        // Create a pivot transform
-        dmTransform::Transform pivot_transform;
-        pivot_transform.SetIdentity();
+        // Pivot offset, in particle space
+        Vector3 pivot_translation(0.0f);
         if (use_pivot)
         {
-            pivot_transform.SetTranslation(Vector3(
+            pivot_translation = Vector3(
                 ddf->m_Pivot.getX() * tile_width_factor,
                 ddf->m_Pivot.getY() * tile_height_factor,
-                ddf->m_Pivot.getZ()));
+                ddf->m_Pivot.getZ());
         }
 
         Vector3 position_world_flat[6];
@@ -1233,137 +1579,212 @@ namespace dmParticle
         dmGraphics::SetWriteAttributeStreamDesc(&write_params.m_PositionsLocalSpace, position_local_channel, dmGraphics::VertexAttribute::VECTOR_TYPE_VEC4, 1, false);
         dmGraphics::SetWriteAttributeStreamDesc(&write_params.m_TexCoords, tex_coord_channel, dmGraphics::VertexAttribute::VECTOR_TYPE_VEC2, 1, false);
 
-        uint32_t particle_full_count = emitter->m_Particles.Size();
+        // The particles are processed in batches. The quads are first evaluated for whole SIMD registers of particles,
+        // then written vertex by vertex. The batches start at multiples of the batch size to keep the stream loads aligned.
+        DM_ALIGNED(32) float batch[RENDER_STREAM_COUNT][RENDER_BATCH_SIZE];
+        uint32_t batch_tiles[RENDER_BATCH_SIZE];
+        // Auto sized quads get their extents per particle
+        memset(batch[RENDER_STREAM_WIDTH], 0, sizeof(batch[RENDER_STREAM_WIDTH]));
+        memset(batch[RENDER_STREAM_HEIGHT], 0, sizeof(batch[RENDER_STREAM_HEIGHT]));
+
+        const ParticleBuffer& particles = emitter->m_Particles;
+        const float* time_left = particles.GetStream(PARTICLE_STREAM_TIME_LEFT);
+        const float* max_life_time = particles.GetStream(PARTICLE_STREAM_MAX_LIFE_TIME);
+        const float* oo_max_life_time = particles.GetStream(PARTICLE_STREAM_OO_MAX_LIFE_TIME);
+
+        const Quat emission_rotation = emission_transform.GetRotation();
+        const Vector3 emission_translation = emission_transform.GetTranslation();
+        const SimdQuat em_rot = { SimdSplat(emission_rotation.getX()), SimdSplat(emission_rotation.getY()), SimdSplat(emission_rotation.getZ()), SimdSplat(emission_rotation.getW()) };
+        const SimdVector3 em_pos = { SimdSplat(emission_translation.getX()), SimdSplat(emission_translation.getY()), SimdSplat(emission_translation.getZ()) };
+        const SimdFloat em_scale = SimdSplat(emission_transform.GetScale());
+        const SimdVector3 pivot = { SimdSplat(pivot_translation.getX()), SimdSplat(pivot_translation.getY()), SimdSplat(pivot_translation.getZ()) };
+        const SimdFloat zero = SimdSplat(0.0f);
+        const SimdFloat one = SimdSplat(1.0f);
+
+        uint32_t particle_full_count = particles.Size();
         uint32_t particle_end = dmMath::Min(particle_start + particle_count, particle_full_count);
-        for (j = particle_start; j < particle_end && vertex_index + 6 <= max_vertex_count; j++)
+        j = particle_start;
+        while (j < particle_end && vertex_index + 6 <= max_vertex_count)
         {
-            Particle* particle = &emitter->m_Particles[j];
+            uint32_t batch_base = j & ~(RENDER_BATCH_SIZE - 1);
+            uint32_t batch_end = dmMath::Min(batch_base + RENDER_BATCH_SIZE, particle_end);
+
             // Evaluate anim frame
-            uint32_t tile = 0;
-            Vector3 size;
-            if (anim_playing)
+            for (uint32_t pi = j; pi < batch_end; ++pi)
             {
-                float anim_cursor = particle->GetMaxLifeTime() - particle->GetTimeLeft() - half_dt;
-                float anim_t = 0.0f;
-                if (anim_once) // stretch over particle life
-                {
-                    anim_t = anim_cursor * particle->GetooMaxLifeTime();
-                }
-                else // use anim FPS
+                uint32_t b = pi - batch_base;
+                uint32_t tile = 0;
+                if (anim_playing)
                 {
-                    anim_t = anim_cursor * inv_anim_length;
-                }
-                tile = (uint32_t)(tile_count * anim_t);
-                tile = tile % tile_count;
-                if (tile >= interval) {
-                    tile = (interval-1) * 2 - tile;
-                }
-                if (anim_bwd)
-                    tile = tile_count - tile - 1;
+                    float anim_cursor = max_life_time[pi] - time_left[pi] - half_dt;
+                    float anim_t = 0.0f;
+                    if (anim_once) // stretch over particle life
+                    {
+                        anim_t = anim_cursor * oo_max_life_time[pi];
+                    }
+                    else // use anim FPS
+                    {
+                        anim_t = anim_cursor * inv_anim_length;
+                    }
+                    tile = (uint32_t)(tile_count * anim_t);
+                    tile = tile % tile_count;
+                    if (tile >= interval) {
+                        tile = (interval-1) * 2 - tile;
+                    }
+                    if (anim_bwd)
+                        tile = tile_count - tile - 1;
 
-                size = particle->GetScale();
-                if(anim_auto_size)
-                {
-                    const float* td = &tex_dims[(start_tile + tile) << 1];
-                    width_factor = td[0] * 0.5;
-                    height_factor = td[1] * 0.5;
-                }
-                else
-                {
-                    size *= particle->GetSourceSize();
+                    if(anim_auto_size)
+                    {
+                        const float* td = &tex_dims[(start_tile + tile) << 1];
+                        batch[RENDER_STREAM_WIDTH][b] = td[0] * 0.5;
+                        batch[RENDER_STREAM_HEIGHT][b] = td[1] * 0.5;
+                    }
                 }
+                batch_tiles[b] = tile + start_tile;
             }
-            else
-            {
-                size = particle->GetScale() * particle->GetSourceSize();
-            }
-            tile += start_tile;
-            float* tex_coord = &tex_coords[tile << 3];
-
-            particle_transform.SetTranslation(Vector3(particle->GetPosition()));
-            particle_transform.SetRotation(particle->GetRotation());
-            particle_transform.SetScale(size);
-            particle_transform.SetRotation(emission_transform.GetRotation() * particle_transform.GetRotation());
-            particle_transform.SetTranslation(Vector3(Apply(emission_transform, Point3(particle_transform.GetTranslation()))));
-            particle_transform.SetScale(emission_transform.GetScale() * particle_transform.GetScale());
 
-            if (use_pivot)
+            // Evaluate the quads
+            uint32_t simd_end = SimdRoundUp(batch_end - batch_base);
+            for (uint32_t b = (j - batch_base) & ~(SIMD_WIDTH - 1); b < simd_end; b += SIMD_WIDTH)
             {
-                particle_transform = dmTransform::Mul(particle_transform, pivot_transform);
-            }
-
-            Vector3 x_local = Vector3(width_factor, 0.0f, 0.0f);
-            Vector3 y_local = Vector3(0.0f, height_factor, 0.0f);
-            Vector3 x       = dmTransform::Apply(particle_transform, x_local);
-            Vector3 y       = dmTransform::Apply(particle_transform, y_local);
+                uint32_t pi = batch_base + b;
+                SimdFloat size_factor = anim_auto_size ? one : LoadParticles(particles, PARTICLE_STREAM_SOURCE_SIZE, pi);
+                SimdVector3 size = LoadParticlesVector3(particles, PARTICLE_STREAM_SCALE_X, pi);
+                size.m_X = SimdMul(SimdMul(size.m_X, size_factor), em_scale);
+                size.m_Y = SimdMul(SimdMul(size.m_Y, size_factor), em_scale);
+                size.m_Z = SimdMul(SimdMul(size.m_Z, size_factor), em_scale);
+
+                SimdQuat rotation = SimdQuatMul(em_rot, LoadParticlesQuat(particles, PARTICLE_STREAM_ROTATION_X, pi));
+
+                SimdVector3 position = LoadParticlesVector3(particles, PARTICLE_STREAM_POSITION_X, pi);
+                position.m_X = SimdMul(position.m_X, em_scale);
+                position.m_Y = SimdMul(position.m_Y, em_scale);
+                position.m_Z = SimdMul(position.m_Z, em_scale);
+                position = SimdRotate(em_rot, position);
+                position.m_X = SimdAdd(position.m_X, em_pos.m_X);
+                position.m_Y = SimdAdd(position.m_Y, em_pos.m_Y);
+                position.m_Z = SimdAdd(position.m_Z, em_pos.m_Z);
+
+                if (use_pivot)
+                {
+                    SimdVector3 offset = { SimdMul(pivot.m_X, size.m_X), SimdMul(pivot.m_Y, size.m_Y), SimdMul(pivot.m_Z, size.m_Z) };
+                    offset = SimdRotate(rotation, offset);
+                    position.m_X = SimdAdd(offset.m_X, position.m_X);
+                    position.m_Y = SimdAdd(offset.m_Y, position.m_Y);
+                    position.m_Z = SimdAdd(offset.m_Z, position.m_Z);
+                }
 
-            if (material_attribute_info_meta.m_HasAttributeWorldPosition)
-            {
-                position_world_flat[0] = -x - y + particle_transform.GetTranslation();
-                position_world_flat[1] = -x + y + particle_transform.GetTranslation();
-                position_world_flat[2] = x + y + particle_transform.GetTranslation();
-                position_world_flat[3] = position_world_flat[2];
-                position_world_flat[4] = x - y + particle_transform.GetTranslation();
-                position_world_flat[5] = position_world_flat[0];
+                SimdFloat quad_width = anim_auto_size ? SimdLoad(&batch[RENDER_STREAM_WIDTH][b]) : SimdSplat(width_factor);
+                SimdFloat quad_height = anim_auto_size ? SimdLoad(&batch[RENDER_STREAM_HEIGHT][b]) : SimdSplat(height_factor);
+                SimdVector3 x_local = { SimdMul(quad_width, size.m_X), zero, zero };
+                SimdVector3 y_local = { zero, SimdMul(quad_height, size.m_Y), zero };
+                SimdVector3 x = SimdRotate(rotation, x_local);
+                SimdVector3 y = SimdRotate(rotation, y_local);
+
+                SimdStore(&batch[RENDER_STREAM_POSITION_X][b], position.m_X);
+                SimdStore(&batch[RENDER_STREAM_POSITION_Y][b], position.m_Y);
+                SimdStore(&batch[RENDER_STREAM_POSITION_Z][b], position.m_Z);
+                SimdStore(&batch[RENDER_STREAM_AXIS_X_X][b], x.m_X);
+                SimdStore(&batch[RENDER_STREAM_AXIS_X_Y][b], x.m_Y);
+                SimdStore(&batch[RENDER_STREAM_AXIS_X_Z][b], x.m_Z);
+                SimdStore(&batch[RENDER_STREAM_AXIS_Y_X][b], y.m_X);
+                SimdStore(&batch[RENDER_STREAM_AXIS_Y_Y][b], y.m_Y);
+                SimdStore(&batch[RENDER_STREAM_AXIS_Y_Z][b], y.m_Z);
+                SimdStore(&batch[RENDER_STREAM_ROTATION_X][b], rotation.m_X);
+                SimdStore(&batch[RENDER_STREAM_ROTATION_Y][b], rotation.m_Y);
+                SimdStore(&batch[RENDER_STREAM_ROTATION_Z][b], rotation.m_Z);
+                SimdStore(&batch[RENDER_STREAM_ROTATION_W][b], rotation.m_W);
+                SimdStore(&batch[RENDER_STREAM_SCALE_X][b], size.m_X);
+                SimdStore(&batch[RENDER_STREAM_SCALE_Y][b], size.m_Y);
+                SimdStore(&batch[RENDER_STREAM_SCALE_Z][b], size.m_Z);
             }
 
-            if (material_attribute_info_meta.m_HasAttributeLocalPosition)
+            // Write the vertices
+            for (; j < batch_end && vertex_index + 6 <= max_vertex_count; j++)
             {
-                position_local_flat[0] = -x - y;
-                position_local_flat[1] = -x + y;
-                position_local_flat[2] = x + y;
-                position_local_flat[3] = position_local_flat[2];
-                position_local_flat[4] = x - y;
-                position_local_flat[5] = position_local_flat[0];
-            }
+                uint32_t b = j - batch_base;
+                uint32_t tile = batch_tiles[b];
+                float* tex_coord = &tex_coords[tile << 3];
 
-            if (material_attribute_info_meta.m_HasAttributeColor)
-            {
-                Vector4 c      = particle->GetColor();
-                color_to_write = Vector4(mulPerElem(c.getXYZ(), color.getXYZ()), c.getW() * color.getW());
-            }
+                Vector3 translation(batch[RENDER_STREAM_POSITION_X][b], batch[RENDER_STREAM_POSITION_Y][b], batch[RENDER_STREAM_POSITION_Z][b]);
+                Vector3 x(batch[RENDER_STREAM_AXIS_X_X][b], batch[RENDER_STREAM_AXIS_X_Y][b], batch[RENDER_STREAM_AXIS_X_Z][b]);
+                Vector3 y(batch[RENDER_STREAM_AXIS_Y_X][b], batch[RENDER_STREAM_AXIS_Y_Y][b], batch[RENDER_STREAM_AXIS_Y_Z][b]);
 
-            if (material_attribute_info_meta.m_HasAttributeTexCoord)
-            {
-                uint32_t flip_flag = 0;
-                if (hFlip)
+                if (material_attribute_info_meta.m_HasAttributeWorldPosition)
                 {
-                    flip_flag = 1;
+                    position_world_flat[0] = -x - y + translation;
+                    position_world_flat[1] = -x + y + translation;
+                    position_world_flat[2] = x + y + translation;
+                    position_world_flat[3] = position_world_flat[2];
+                    position_world_flat[4] = x - y + translation;
+                    position_world_flat[5] = position_world_flat[0];
                 }
-                if (vFlip)
+
+                if (material_attribute_info_meta.m_HasAttributeLocalPosition)
                 {
-                    flip_flag |= 2;
+                    position_local_flat[0] = -x - y;
+                    position_local_flat[1] = -x + y;
+                    position_local_flat[2] = x + y;
+                    position_local_flat[3] = position_local_flat[2];
+                    position_local_flat[4] = x - y;
+                    position_local_flat[5] = position_local_flat[0];
                 }
-                const int* tex_lookup = &tex_coord_order[flip_flag * 6];
-                for (int i = 0; i < 6; ++i)
+
+                if (material_attribute_info_meta.m_HasAttributeColor)
                 {
-                    tex_coord_flat[i * 2]     = tex_coord[tex_lookup[i] * 2];
-                    tex_coord_flat[i * 2 + 1] = tex_coord[tex_lookup[i] * 2 + 1];
+                    Vector4 c(particles.GetStream(PARTICLE_STREAM_COLOR_R)[j],
+                              particles.GetStream(PARTICLE_STREAM_COLOR_G)[j],
+                              particles.GetStream(PARTICLE_STREAM_COLOR_B)[j],
+                              particles.GetStream(PARTICLE_STREAM_COLOR_A)[j]);
+                    color_to_write = Vector4(mulPerElem(c.getXYZ(), color.getXYZ()), c.getW() * color.getW());
                 }
-            }
 
-            if (material_attribute_info_meta.m_HasAttributePageIndex)
-            {
-                if (frame_indices != 0x0)
+                if (material_attribute_info_meta.m_HasAttributeTexCoord)
                 {
-                    uint32_t page_indices_index = frame_indices[tile];
-                    page_index                  = (float) page_indices[page_indices_index];
+                    uint32_t flip_flag = 0;
+                    if (hFlip)
+                    {
+                        flip_flag = 1;
+                    }
+                    if (vFlip)
+                    {
+                        flip_flag |= 2;
+                    }
+                    const int* tex_lookup = &tex_coord_order[flip_flag * 6];
+                    for (int i = 0; i < 6; ++i)
+                    {
+                        tex_coord_flat[i * 2]     = tex_coord[tex_lookup[i] * 2];
+                        tex_coord_flat[i * 2 + 1] = tex_coord[tex_lookup[i] * 2 + 1];
+                    }
                 }
-            }
 
-            if (material_attribute_info_meta.m_HasAttributeWorldMatrix)
-            {
-                world_matrix = dmTransform::ToMatrix4(particle_transform);
-            }
+                if (material_attribute_info_meta.m_HasAttributePageIndex)
+                {
+                    if (frame_indices != 0x0)
+                    {
+                        uint32_t page_indices_index = frame_indices[tile];
+                        page_index                  = (float) page_indices[page_indices_index];
+                    }
+                }
+
+                if (material_attribute_info_meta.m_HasAttributeWorldMatrix)
+                {
+                    dmTransform::Transform particle_transform(translation,
+                        Quat(batch[RENDER_STREAM_ROTATION_X][b], batch[RENDER_STREAM_ROTATION_Y][b], batch[RENDER_STREAM_ROTATION_Z][b], batch[RENDER_STREAM_ROTATION_W][b]),
+                        Vector3(batch[RENDER_STREAM_SCALE_X][b], batch[RENDER_STREAM_SCALE_Y][b], batch[RENDER_STREAM_SCALE_Z][b]));
+                    world_matrix = dmTransform::ToMatrix4(particle_transform);
+                }
 
-            uint8_t* write_ptr = vertex_buffer + vertex_index * attribute_infos.m_VertexStride;
-            write_ptr = dmGraphics::WriteAttributes(write_ptr, 0, write_params);
-            write_ptr = dmGraphics::WriteAttributes(write_ptr, 1, write_params);
-            write_ptr = dmGraphics::WriteAttributes(write_ptr, 2, write_params);
-            write_ptr = dmGraphics::WriteAttributes(write_ptr, 3, write_params);
-            write_ptr = dmGraphics::WriteAttributes(write_ptr, 4, write_params);
-            write_ptr = dmGraphics::WriteAttributes(write_ptr, 5, write_params);
-            vertex_index += 6;
+                uint8_t* write_ptr = vertex_buffer + vertex_index * attribute_infos.m_VertexStride;
+                write_ptr = dmGraphics::WriteAttributes(write_ptr, 0, write_params);
+                write_ptr = dmGraphics::WriteAttributes(write_ptr, 1, write_params);
+                write_ptr = dmGraphics::WriteAttributes(write_ptr, 2, write_params);
+                write_ptr = dmGraphics::WriteAttributes(write_ptr, 3, write_params);
+                write_ptr = dmGraphics::WriteAttributes(write_ptr, 4, write_params);
+                write_ptr = dmGraphics::WriteAttributes(write_ptr, 5, write_params);
+                vertex_index += 6;
+            }
         }
 
         GenerateVertexDataResult res = GENERATE_VERTEX_DATA_OK;
@@ -1379,43 +1800,118 @@ namespace dmParticle
         return res;
     }
 
-    struct SortPred
-    {
-        inline bool operator () (const Particle& p1, const Particle& p2)
-        {
-            return p1.GetSortKey().m_Key < p2.GetSortKey().m_Key;
-        }
-
-    };
-
     void GenerateKeys(Emitter* emitter, float max_particle_life_time)
     {
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         uint32_t n = particles.Size();
 
         float range = 1.0f / max_particle_life_time;
 
-        Particle* first = particles.Begin();
-        for (uint32_t i = 0; i < n; ++i)
+        const float* time_left = particles.GetStream(PARTICLE_STREAM_TIME_LEFT);
+        uint32_t* keys = particles.m_SortKeys;
+        const SimdFloat range_v = SimdSplat(range);
+        const SimdFloat one = SimdSplat(1.0f);
+        const SimdFloat zero = SimdSplat(0.0f);
+        const SimdFloat max_life_time = SimdSplat(65535.0f);
+        const SimdInt index_mask = SimdIntSplat(0xffff);
+        uint32_t padded_count = SimdRoundUp(n);
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
         {
-            Particle* p = &particles[i];
-            uint32_t index = p - first;
+            // Quantified relative life time in the upper half, index for stable sort in the lower half (see SortKey)
+            SimdFloat life_time = SimdMul(SimdSub(one, SimdMul(SimdLoad(&time_left[i]), range_v)), max_life_time);
+            life_time = SimdMin(SimdMax(life_time, zero), max_life_time);
+            SimdInt key = SimdIntOr(SimdIntShiftLeft16(SimdToInt(life_time)), SimdIntAnd(SimdIntRamp(i), index_mask));
+            SimdIntStore(&keys[i], key);
+        }
+    }
+
+    // Sorts the keys with insertion sort, unless more than max_moves keys need to be moved
+    // Returns false if it gave up, the keys are then partially sorted
+    static bool InsertionSortKeys(uint32_t* keys, uint32_t* indices, uint32_t count, uint32_t max_moves)
+    {
+        uint32_t moves = 0;
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            uint32_t key = keys[i];
+            uint32_t index = indices[i];
+            uint32_t j = i;
+            while (j > 0 && keys[j - 1] > key)
+            {
+                keys[j] = keys[j - 1];
+                indices[j] = indices[j - 1];
+                --j;
+            }
+            keys[j] = key;
+            indices[j] = index;
 
-            float life_time = (1.0f - p->GetTimeLeft() * range) * 65535;
-            life_time = dmMath::Clamp(life_time, 0.0f, 65535.0f);
-            uint16_t lt = (uint16_t) life_time;
-            SortKey key;
-            key.m_LifeTime = lt;
-            key.m_Index = index;
-            p->SetSortKey(key);
+            moves += i - j;
+            if (moves > max_moves)
+                return false;
         }
+        return true;
     }
 
     void SortParticles(Emitter* emitter)
     {
         DM_PROFILE(__FUNCTION__);
 
-        std::sort(emitter->m_Particles.Begin(), emitter->m_Particles.End(), SortPred());
+        ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t n = particles.Size();
+        uint32_t* keys = particles.m_SortKeys;
+
+        // The keys stay in order when the particles age at the same rate
+        uint32_t i = 1;
+        while (i < n && keys[i - 1] < keys[i])
+            ++i;
+        if (i >= n)
+            return;
+
+        uint32_t* indices = particles.m_SortIndices;
+        for (i = 0; i < n; ++i)
+        {
+            indices[i] = i;
+        }
+
+        // The order mostly changes a little between frames, which is cheap for insertion sort.
+        // Otherwise the radix sort takes over, the keys are unique so the partial sort doesn't matter.
+        if (!InsertionSortKeys(keys, indices, n, n * SORT_INSERTION_MAX_MOVES_PER_PARTICLE))
+        {
+            // The scratch stream is unused until the streams are reordered
+            dmRadixSort::Sort32(keys, indices, (uint32_t*)particles.m_Scratch, particles.m_SortIndexScratch, n);
+        }
+
+        // Only the particles between the first and last moved one need to be reordered
+        uint32_t first = 0;
+        while (indices[first] == first)
+            ++first;
+        uint32_t end = n;
+        while (indices[end - 1] == end - 1)
+            --end;
+        uint32_t span = end - first;
+        bool copy_back = span * 2 < n;
+
+        // Gather the span of each stream into the scratch stream. A short span is copied back,
+        // otherwise the rest is copied over and the scratch stream takes the place of the stream.
+        for (uint32_t s = 0; s < PARTICLE_STREAM_COUNT; ++s)
+        {
+            float* src = particles.m_Streams[s];
+            float* dst = particles.m_Scratch;
+            for (i = first; i < end; ++i)
+            {
+                dst[i] = src[indices[i]];
+            }
+            if (copy_back)
+            {
+                memcpy(&src[first], &dst[first], span * sizeof(float));
+            }
+            else
+            {
+                memcpy(dst, src, first * sizeof(float));
+                memcpy(&dst[end], &src[end], (n - end) * sizeof(float));
+                particles.m_Scratch = src;
+                particles.m_Streams[s] = dst;
+            }
+        }
     }
 
 #define SAMPLE_PROP(segment, x, target)\
@@ -1434,187 +1930,282 @@ namespace dmParticle
         }
     }
 
+    /// Relative life time of a register of particles, and the property segment to sample for each of them
+    static inline SimdFloat EvaluateParticleLife(const ParticleBuffer& particles, uint32_t index, uint32_t* segment_indices)
+    {
+        const SimdFloat zero = SimdSplat(0.0f);
+        SimdFloat max_life_time = LoadParticles(particles, PARTICLE_STREAM_MAX_LIFE_TIME, index);
+        SimdFloat x = SimdSub(SimdSplat(1.0f), SimdMul(LoadParticles(particles, PARTICLE_STREAM_TIME_LEFT, index), LoadParticles(particles, PARTICLE_STREAM_OO_MAX_LIFE_TIME, index)));
+        x = SimdSelect(SimdSub(zero, max_life_time), zero, x);
+        // Clamped in float, which also keeps the padding past the last particle within the segments
+        SimdFloat segment = SimdMin(SimdMax(SimdMul(x, SimdSplat((float)PROPERTY_SAMPLE_COUNT)), zero), SimdSplat((float)(PROPERTY_SAMPLE_COUNT - 1)));
+        SimdIntStore(segment_indices, SimdToInt(segment));
+        return x;
+    }
+
+    /// Samples a particle property for a register of particles
+    static inline SimdFloat SampleParticleProperty(const Property& property, const uint32_t* segment_indices, SimdFloat x)
+    {
+        DM_ALIGNED(32) float segment_x[SIMD_WIDTH];
+        DM_ALIGNED(32) float segment_y[SIMD_WIDTH];
+        DM_ALIGNED(32) float segment_k[SIMD_WIDTH];
+        for (uint32_t i = 0; i < SIMD_WIDTH; ++i)
+        {
+            const LinearSegment& s = property.m_Segments[segment_indices[i]];
+            segment_x[i] = s.m_X;
+            segment_y[i] = s.m_Y;
+            segment_k[i] = s.m_K;
+        }
+        return SimdAdd(SimdMul(SimdSub(x, SimdLoad(segment_x)), SimdLoad(segment_k)), SimdLoad(segment_y));
+    }
+
+    static inline Quat GetParticleQuat(const ParticleBuffer& particles, ParticleStream stream_x, uint32_t index)
+    {
+        return Quat(particles.GetStream(stream_x)[index],
+                    particles.GetStream((ParticleStream)(stream_x + 1))[index],
+                    particles.GetStream((ParticleStream)(stream_x + 2))[index],
+                    particles.GetStream((ParticleStream)(stream_x + 3))[index]);
+    }
+
+    static inline void SetParticleQuat(ParticleBuffer& particles, ParticleStream stream_x, uint32_t index, const Quat& q)
+    {
+        particles.GetStream(stream_x)[index] = q.getX();
+        particles.GetStream((ParticleStream)(stream_x + 1))[index] = q.getY();
+        particles.GetStream((ParticleStream)(stream_x + 2))[index] = q.getZ();
+        particles.GetStream((ParticleStream)(stream_x + 3))[index] = q.getW();
+    }
+
     void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
-        float properties[PARTICLE_KEY_COUNT];
-        // TODO Optimize this
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         uint32_t count = particles.Size();
-        for (uint32_t i = 0; i < count; ++i)
-        {
-            Particle* particle = &particles[i];
-            float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-            uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_SCALE].m_Segments[segment_index], x, properties[PARTICLE_KEY_SCALE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_RED].m_Segments[segment_index], x, properties[PARTICLE_KEY_RED])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_GREEN].m_Segments[segment_index], x, properties[PARTICLE_KEY_GREEN])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_BLUE].m_Segments[segment_index], x, properties[PARTICLE_KEY_BLUE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ALPHA].m_Segments[segment_index], x, properties[PARTICLE_KEY_ALPHA])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_X])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_Y])
-            Vector4 c = particle->GetSourceColor();
-            particle->SetScale(Vector3(properties[PARTICLE_KEY_SCALE]));
-            particle->SetColor(Vector4(dmMath::Clamp(c.getX() * properties[PARTICLE_KEY_RED], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getY() * properties[PARTICLE_KEY_GREEN], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getZ() * properties[PARTICLE_KEY_BLUE], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getW() * properties[PARTICLE_KEY_ALPHA], 0.0f, 1.0f)));
-            particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_KEY_STRETCH_FACTOR_X]);
-            particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_KEY_STRETCH_FACTOR_Y]);
-        }
-
-        if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION) {
-            for (uint32_t i = 0; i < count; ++i)
+        uint32_t padded_count = SimdRoundUp(count);
+
+        const SimdFloat zero = SimdSplat(0.0f);
+        const SimdFloat one = SimdSplat(1.0f);
+        DM_ALIGNED(32) uint32_t segment_indices[SIMD_WIDTH];
+        DM_ALIGNED(32) float rotation_properties[SIMD_WIDTH];
+
+        float* velocity_x = particles.GetStream(PARTICLE_STREAM_VELOCITY_X);
+        float* velocity_y = particles.GetStream(PARTICLE_STREAM_VELOCITY_Y);
+        float* velocity_z = particles.GetStream(PARTICLE_STREAM_VELOCITY_Z);
+        float* source_angular_velocity = particles.GetStream(PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY);
+
+        ParticleKey rotation_key = PARTICLE_KEY_ROTATION;
+        if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY)
+            rotation_key = PARTICLE_KEY_ANGULAR_VELOCITY;
+
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
+        {
+            SimdFloat x = EvaluateParticleLife(particles, i, segment_indices);
+
+            SimdFloat scale = SampleParticleProperty(particle_properties[PARTICLE_KEY_SCALE], segment_indices, x);
+            SimdFloat red = SampleParticleProperty(particle_properties[PARTICLE_KEY_RED], segment_indices, x);
+            SimdFloat green = SampleParticleProperty(particle_properties[PARTICLE_KEY_GREEN], segment_indices, x);
+            SimdFloat blue = SampleParticleProperty(particle_properties[PARTICLE_KEY_BLUE], segment_indices, x);
+            SimdFloat alpha = SampleParticleProperty(particle_properties[PARTICLE_KEY_ALPHA], segment_indices, x);
+            SimdFloat stretch_factor_x = SampleParticleProperty(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X], segment_indices, x);
+            SimdFloat stretch_factor_y = SampleParticleProperty(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y], segment_indices, x);
+
+            StoreParticles(particles, PARTICLE_STREAM_SCALE_X, i, scale);
+            StoreParticles(particles, PARTICLE_STREAM_SCALE_Y, i, scale);
+            StoreParticles(particles, PARTICLE_STREAM_SCALE_Z, i, scale);
+            StoreParticles(particles, PARTICLE_STREAM_COLOR_R, i, SimdMin(SimdMax(SimdMul(LoadParticles(particles, PARTICLE_STREAM_SOURCE_COLOR_R, i), red), zero), one));
+            StoreParticles(particles, PARTICLE_STREAM_COLOR_G, i, SimdMin(SimdMax(SimdMul(LoadParticles(particles, PARTICLE_STREAM_SOURCE_COLOR_G, i), green), zero), one));
+            StoreParticles(particles, PARTICLE_STREAM_COLOR_B, i, SimdMin(SimdMax(SimdMul(LoadParticles(particles, PARTICLE_STREAM_SOURCE_COLOR_B, i), blue), zero), one));
+            StoreParticles(particles, PARTICLE_STREAM_COLOR_A, i, SimdMin(SimdMax(SimdMul(LoadParticles(particles, PARTICLE_STREAM_SOURCE_COLOR_A, i), alpha), zero), one));
+            StoreParticles(particles, PARTICLE_STREAM_STRETCH_FACTOR_X, i, SimdAdd(LoadParticles(particles, PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X, i), stretch_factor_x));
+            StoreParticles(particles, PARTICLE_STREAM_STRETCH_FACTOR_Y, i, SimdAdd(LoadParticles(particles, PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y, i), stretch_factor_y));
+
+            SimdStore(rotation_properties, SampleParticleProperty(particle_properties[rotation_key], segment_indices, x));
+
+            // The rotations need trigonometry per particle
+            uint32_t lane_count = dmMath::Min(SIMD_WIDTH, count - i);
+            for (uint32_t lane = 0; lane < lane_count; ++lane)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
-                if (lengthSqr(particle->m_Velocity) > EPSILON)
+                uint32_t pi = i + lane;
+                float rotation_property = rotation_properties[lane];
+                if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY)
                 {
-                    Vector3 vel_norm = normalize(particle->m_Velocity);
-                    float y_dot = dot(Vector3::yAxis(), vel_norm);
-                    // Corner case, https://gamedev.stackexchange.com/questions/61672/align-a-rotation-to-a-direction
-                    Quat q_vel = (dmMath::Abs(y_dot + 1.0f) > EPSILON) ? Quat::rotation(Vector3::yAxis(), vel_norm) : Quat(0.0, 0.0, 1.0, 0.0);
-                    Quat q = particle->GetRotation() * q_vel;
-                    particle->SetRotation(q);
+                    Quat rotation = GetParticleQuat(particles, PARTICLE_STREAM_ROTATION_X, pi);
+                    SetParticleQuat(particles, PARTICLE_STREAM_ROTATION_X, pi, rotation * Quat::rotationZ(DEG_RAD * (source_angular_velocity[pi] * rotation_property) * dt));
+                    continue;
                 }
-            }
-
-        } else if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY) {
-            for (uint32_t i = 0; i < count; ++i)
-            {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, properties[PARTICLE_KEY_ANGULAR_VELOCITY])
-                particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt));
-            }
 
-        } else {
-            for (uint32_t i = 0; i < count; ++i)
-            {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+                Quat rotation = GetParticleQuat(particles, PARTICLE_STREAM_SOURCE_ROTATION_X, pi) * dmVMath::QuatFromAngle(2, DEG_RAD * rotation_property);
+                if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION)
+                {
+                    Vector3 velocity(velocity_x[pi], velocity_y[pi], velocity_z[pi]);
+                    if (lengthSqr(velocity) > EPSILON)
+                    {
+                        Vector3 vel_norm = normalize(velocity);
+                        float y_dot = dot(Vector3::yAxis(), vel_norm);
+                        // Corner case, https://gamedev.stackexchange.com/questions/61672/align-a-rotation-to-a-direction
+                        Quat q_vel = (dmMath::Abs(y_dot + 1.0f) > EPSILON) ? Quat::rotation(Vector3::yAxis(), vel_norm) : Quat(0.0, 0.0, 1.0, 0.0);
+                        rotation = rotation * q_vel;
+                    }
+                }
+                SetParticleQuat(particles, PARTICLE_STREAM_ROTATION_X, pi, rotation);
             }
         }
-
     }
 
-    void ApplyAcceleration(dmArray<Particle>& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyAcceleration(ParticleBuffer& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
+        uint32_t padded_count = SimdRoundUp(particles.Size());
         Vector3 acc_step = rotate(rotation, ACCELERATION_LOCAL_DIR) * dt * scale;
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
+        const SimdFloat magnitude_v = SimdSplat(magnitude);
+        const SimdFloat mag_spread = SimdSplat(magnitude_property.m_Spread);
+        const SimdFloat acc_x = SimdSplat(acc_step.getX());
+        const SimdFloat acc_y = SimdSplat(acc_step.getY());
+        const SimdFloat acc_z = SimdSplat(acc_step.getZ());
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
         {
-            Particle* particle = &particles[i];
-            particle->SetVelocity(particle->GetVelocity() + acc_step * (magnitude + mag_spread * particle->GetSpreadFactor()));
+            SimdFloat applied_magnitude = SimdAdd(magnitude_v, SimdMul(mag_spread, LoadParticles(particles, PARTICLE_STREAM_SPREAD_FACTOR, i)));
+            SimdVector3 v = LoadParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i);
+            v.m_X = SimdAdd(v.m_X, SimdMul(acc_x, applied_magnitude));
+            v.m_Y = SimdAdd(v.m_Y, SimdMul(acc_y, applied_magnitude));
+            v.m_Z = SimdAdd(v.m_Z, SimdMul(acc_z, applied_magnitude));
+            StoreParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i, v);
         }
     }
 
-    void ApplyDrag(dmArray<Particle>& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
+    void ApplyDrag(ParticleBuffer& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
+        uint32_t padded_count = SimdRoundUp(particles.Size());
         Vector3 direction = rotate(rotation, DRAG_LOCAL_DIR);
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* particle = &particles[i];
-            Vector3 v = particle->GetVelocity();
-            if (modifier_ddf->m_UseDirection)
-                v = projection(Point3(particle->GetVelocity()), direction) * direction;
+        const SimdFloat magnitude_v = SimdSplat(magnitude);
+        const SimdFloat mag_spread = SimdSplat(magnitude_property.m_Spread);
+        const SimdFloat dt_v = SimdSplat(dt);
+        const SimdFloat one = SimdSplat(1.0f);
+        const SimdVector3 dir = { SimdSplat(direction.getX()), SimdSplat(direction.getY()), SimdSplat(direction.getZ()) };
+        bool use_direction = modifier_ddf->m_UseDirection;
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
+        {
+            SimdVector3 velocity = LoadParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i);
+            SimdVector3 v = velocity;
+            if (use_direction)
+            {
+                SimdFloat projection = SimdAdd(SimdAdd(SimdMul(velocity.m_X, dir.m_X), SimdMul(velocity.m_Y, dir.m_Y)), SimdMul(velocity.m_Z, dir.m_Z));
+                v.m_X = SimdMul(dir.m_X, projection);
+                v.m_Y = SimdMul(dir.m_Y, projection);
+                v.m_Z = SimdMul(dir.m_Z, projection);
+            }
             // Applied drag > 1 means the particle would travel in the reverse direction
-            float applied_drag = dmMath::Min((magnitude + mag_spread * particle->GetSpreadFactor()) * dt, 1.0f);
-            particle->SetVelocity(particle->GetVelocity() - v * applied_drag);
+            SimdFloat applied_drag = SimdMin(SimdMul(SimdAdd(magnitude_v, SimdMul(mag_spread, LoadParticles(particles, PARTICLE_STREAM_SPREAD_FACTOR, i))), dt_v), one);
+            velocity.m_X = SimdSub(velocity.m_X, SimdMul(v.m_X, applied_drag));
+            velocity.m_Y = SimdSub(velocity.m_Y, SimdMul(v.m_Y, applied_drag));
+            velocity.m_Z = SimdSub(velocity.m_Z, SimdMul(v.m_Z, applied_drag));
+            StoreParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i, velocity);
         }
     }
 
-    static Vector3 GetParticleDir(Particle* particle)
-    {
-        return rotate(particle->GetRotation(), PARTICLE_LOCAL_BASE_DIR);
-    }
-
-    static Vector3 NonZeroVector3(Vector3 v, float sq_length, Vector3 fallback)
+    /// Same as NonZeroVector3 for a register of vectors, the fallback is used where v has zero length
+    static inline SimdVector3 SimdNonZeroVector3(const SimdVector3& v, SimdFloat sq_length, const SimdVector3& fallback)
     {
-        Vector3 result;
-        float neg_sq_length = -sq_length;
-        result.setX(dmMath::Select(neg_sq_length, fallback.getX(), v.getX()));
-        result.setY(dmMath::Select(neg_sq_length, fallback.getY(), v.getY()));
-        result.setZ(dmMath::Select(neg_sq_length, fallback.getZ(), v.getZ()));
+        SimdFloat neg_sq_length = SimdSub(SimdSplat(0.0f), sq_length);
+        SimdVector3 result = {
+            SimdSelect(neg_sq_length, fallback.m_X, v.m_X),
+            SimdSelect(neg_sq_length, fallback.m_Y, v.m_Y),
+            SimdSelect(neg_sq_length, fallback.m_Z, v.m_Z)
+        };
         return result;
     }
 
-    void ApplyRadial(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
+    void ApplyRadial(ParticleBuffer& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
+        uint32_t padded_count = SimdRoundUp(particles.Size());
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         const Property& max_distance_property = modifier_properties[MODIFIER_KEY_MAX_DISTANCE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
         // We temporarily only sample the first frame until we have decided what to animate over
         float max_distance = max_distance_property.m_Segments[0].m_Y * scale;
-        float max_sq_distance = max_distance * max_distance;
-        float applied_factor = dt * scale;
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* particle = &particles[i];
-            Vector3 delta = particle->GetPosition() - position;
-            float delta_sq_len = lengthSqr(delta);
-            float applied_magnitude = magnitude + mag_spread * particle->GetSpreadFactor();
+        const SimdFloat magnitude_v = SimdSplat(magnitude);
+        const SimdFloat mag_spread = SimdSplat(magnitude_property.m_Spread);
+        const SimdFloat max_sq_distance = SimdSplat(max_distance * max_distance);
+        const SimdFloat applied_factor = SimdSplat(dt * scale);
+        const SimdFloat zero = SimdSplat(0.0f);
+        const SimdVector3 origin = { SimdSplat(position.getX()), SimdSplat(position.getY()), SimdSplat(position.getZ()) };
+        const SimdVector3 base_dir = { SimdSplat(PARTICLE_LOCAL_BASE_DIR.getX()), SimdSplat(PARTICLE_LOCAL_BASE_DIR.getY()), SimdSplat(PARTICLE_LOCAL_BASE_DIR.getZ()) };
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
+        {
+            SimdVector3 p = LoadParticlesVector3(particles, PARTICLE_STREAM_POSITION_X, i);
+            SimdVector3 delta = { SimdSub(p.m_X, origin.m_X), SimdSub(p.m_Y, origin.m_Y), SimdSub(p.m_Z, origin.m_Z) };
+            SimdFloat delta_sq_len = SimdLengthSqr(delta);
+            SimdFloat applied_magnitude = SimdAdd(magnitude_v, SimdMul(mag_spread, LoadParticles(particles, PARTICLE_STREAM_SPREAD_FACTOR, i)));
             // 0 acc delta lies outside max dist
-            float a = dmMath::Select(max_sq_distance - delta_sq_len, applied_magnitude, 0.0f);
-            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(particle)));
-            particle->SetVelocity(particle->GetVelocity() + dir * a * applied_factor);
+            SimdFloat a = SimdSelect(SimdSub(max_sq_distance, delta_sq_len), applied_magnitude, zero);
+            SimdVector3 particle_dir = SimdRotate(LoadParticlesQuat(particles, PARTICLE_STREAM_ROTATION_X, i), base_dir);
+            SimdVector3 dir = SimdNormalize(SimdNonZeroVector3(delta, delta_sq_len, particle_dir));
+            SimdVector3 v = LoadParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i);
+            v.m_X = SimdAdd(v.m_X, SimdMul(SimdMul(dir.m_X, a), applied_factor));
+            v.m_Y = SimdAdd(v.m_Y, SimdMul(SimdMul(dir.m_Y, a), applied_factor));
+            v.m_Z = SimdAdd(v.m_Z, SimdMul(SimdMul(dir.m_Z, a), applied_factor));
+            StoreParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i, v);
         }
     }
 
-    void ApplyVortex(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyVortex(ParticleBuffer& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
+        uint32_t padded_count = SimdRoundUp(particles.Size());
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         const Property& max_distance_property = modifier_properties[MODIFIER_KEY_MAX_DISTANCE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
         // We temporarily only sample the first frame until we have decided what to animate over
         float max_distance = max_distance_property.m_Segments[0].m_Y * scale;
-        float max_sq_distance = max_distance * max_distance;
-        Vector3 axis = rotate(rotation, VORTEX_LOCAL_AXIS);
-        Vector3 start = rotate(rotation, VORTEX_LOCAL_START_DIR);
-        float applied_factor = dt * scale;
-        for (uint32_t i = 0; i < particle_count; ++i)
+        Vector3 axis_v = rotate(rotation, VORTEX_LOCAL_AXIS);
+        Vector3 start_v = rotate(rotation, VORTEX_LOCAL_START_DIR);
+        const SimdFloat magnitude_v = SimdSplat(magnitude);
+        const SimdFloat mag_spread = SimdSplat(magnitude_property.m_Spread);
+        const SimdFloat max_sq_distance = SimdSplat(max_distance * max_distance);
+        const SimdFloat applied_factor = SimdSplat(dt * scale);
+        const SimdFloat zero = SimdSplat(0.0f);
+        const SimdVector3 origin = { SimdSplat(position.getX()), SimdSplat(position.getY()), SimdSplat(position.getZ()) };
+        const SimdVector3 axis = { SimdSplat(axis_v.getX()), SimdSplat(axis_v.getY()), SimdSplat(axis_v.getZ()) };
+        const SimdVector3 start = { SimdSplat(start_v.getX()), SimdSplat(start_v.getY()), SimdSplat(start_v.getZ()) };
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
         {
-            Particle* particle = &particles[i];
             // delta from vortex position
-            Vector3 delta = particle->GetPosition() - position;
+            SimdVector3 p = LoadParticlesVector3(particles, PARTICLE_STREAM_POSITION_X, i);
+            SimdVector3 delta = { SimdSub(p.m_X, origin.m_X), SimdSub(p.m_Y, origin.m_Y), SimdSub(p.m_Z, origin.m_Z) };
             // normal from vortex axis (non-unit)
-            Vector3 normal = delta - projection(Point3(delta), axis) * axis;
+            SimdFloat projection = SimdAdd(SimdAdd(SimdMul(delta.m_X, axis.m_X), SimdMul(delta.m_Y, axis.m_Y)), SimdMul(delta.m_Z, axis.m_Z));
+            SimdVector3 normal = {
+                SimdSub(delta.m_X, SimdMul(axis.m_X, projection)),
+                SimdSub(delta.m_Y, SimdMul(axis.m_Y, projection)),
+                SimdSub(delta.m_Z, SimdMul(axis.m_Z, projection))
+            };
             // tangent is the direction of the vortex acceleration
-            Vector3 tangent = cross(axis, normal);
+            SimdVector3 tangent = {
+                SimdSub(SimdMul(axis.m_Y, normal.m_Z), SimdMul(axis.m_Z, normal.m_Y)),
+                SimdSub(SimdMul(axis.m_Z, normal.m_X), SimdMul(axis.m_X, normal.m_Z)),
+                SimdSub(SimdMul(axis.m_X, normal.m_Y), SimdMul(axis.m_Y, normal.m_X))
+            };
             // In case the particle is directed along the axis, give it a guaranteed orthogonal start
-            tangent = NonZeroVector3(tangent, lengthSqr(tangent), start);
+            tangent = SimdNonZeroVector3(tangent, SimdLengthSqr(tangent), start);
             // tangent is now guaranteed to be non-zero
-            tangent = normalize(tangent);
+            tangent = SimdNormalize(tangent);
             // use normal for max distance test
-            float normal_sq_len = lengthSqr(normal);
-            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * particle->GetSpreadFactor(), 0.0f);
-            particle->SetVelocity(particle->GetVelocity() + tangent * acceleration * applied_factor);
+            SimdFloat normal_sq_len = SimdLengthSqr(normal);
+            SimdFloat applied_magnitude = SimdAdd(magnitude_v, SimdMul(mag_spread, LoadParticles(particles, PARTICLE_STREAM_SPREAD_FACTOR, i)));
+            SimdFloat acceleration = SimdSelect(SimdSub(max_sq_distance, normal_sq_len), applied_magnitude, zero);
+            SimdVector3 v = LoadParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i);
+            v.m_X = SimdAdd(v.m_X, SimdMul(SimdMul(tangent.m_X, acceleration), applied_factor));
+            v.m_Y = SimdAdd(v.m_Y, SimdMul(SimdMul(tangent.m_Y, acceleration), applied_factor));
+            v.m_Z = SimdAdd(v.m_Z, SimdMul(SimdMul(tangent.m_Z, acceleration), applied_factor));
+            StoreParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i, v);
         }
     }
 
@@ -1643,7 +2234,7 @@ namespace dmParticle
     {
         DM_PROFILE(__FUNCTION__);
 
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         EvaluateParticleProperties(emitter, prototype->m_ParticleProperties, ddf, dt);
         float emitter_t = dmMath::Select(-ddf->m_Duration, 0.0f, emitter->m_Timer / ddf->m_Duration);
         float scale = 1.0f;
@@ -1684,19 +2275,28 @@ namespace dmParticle
                 break;
             }
         }
-        uint32_t particle_count = particles.Size();
-        for (uint32_t i = 0; i < particle_count; ++i)
+        uint32_t padded_count = SimdRoundUp(particles.Size());
+        const SimdFloat dt_v = SimdSplat(dt);
+        const SimdFloat stretch_scaling = SimdSplat(STRETCH_SCALING);
+        bool stretch_with_velocity = ddf->m_StretchWithVelocity;
+        for (uint32_t i = 0; i < padded_count; i += SIMD_WIDTH)
         {
-            Particle* p = &particles[i];
+            SimdVector3 v = LoadParticlesVector3(particles, PARTICLE_STREAM_VELOCITY_X, i);
+            SimdVector3 p = LoadParticlesVector3(particles, PARTICLE_STREAM_POSITION_X, i);
             // NOTE This velocity integration has a larger error than normal since we don't use the velocity at the
             // beginning of the frame, but it's ok since particle movement does not need to be very exact
-            p->SetPosition(p->GetPosition() + p->m_Velocity * dt);
+            p.m_X = SimdAdd(p.m_X, SimdMul(v.m_X, dt_v));
+            p.m_Y = SimdAdd(p.m_Y, SimdMul(v.m_Y, dt_v));
+            p.m_Z = SimdAdd(p.m_Z, SimdMul(v.m_Z, dt_v));
+            StoreParticlesVector3(particles, PARTICLE_STREAM_POSITION_X, i, p);
 
-            p->m_Scale[0] += p->m_Scale[0] * p->m_StretchFactorX;
-            if (!ddf->m_StretchWithVelocity)
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY;
-            else
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(p->m_Velocity) * STRETCH_SCALING;
+            SimdFloat scale_x = LoadParticles(particles, PARTICLE_STREAM_SCALE_X, i);
+            SimdFloat scale_y = LoadParticles(particles, PARTICLE_STREAM_SCALE_Y, i);
+            SimdFloat stretch_y = SimdMul(scale_y, LoadParticles(particles, PARTICLE_STREAM_STRETCH_FACTOR_Y, i));
+            if (stretch_with_velocity)
+                stretch_y = SimdMul(SimdMul(stretch_y, SimdSqrt(SimdLengthSqr(v))), stretch_scaling);
+            StoreParticles(particles, PARTICLE_STREAM_SCALE_X, i, SimdAdd(scale_x, SimdMul(scale_x, LoadParticles(particles, PARTICLE_STREAM_STRETCH_FACTOR_X, i))));
+            StoreParticles(particles, PARTICLE_STREAM_SCALE_Y, i, SimdAdd(scale_y, stretch_y));
         }
     }
 
@@ -2322,6 +2922,7 @@ namespace dmParticle
     DM_PARTICLE_TRAMPOLINE1(void, DestroyContext, HParticleContext);
     DM_PARTICLE_TRAMPOLINE1(uint32_t, GetContextMaxParticleCount, HParticleContext);
     DM_PARTICLE_TRAMPOLINE2(void, SetContextMaxParticleCount, HParticleContext, uint32_t);
+    DM_PARTICLE_TRAMPOLINE2(void, SetJobThreadContext, HParticleContext, dmJobThread::HContext);
 
     DM_PARTICLE_TRAMPOLINE3(HInstance, CreateInstance, HParticleContext, HPrototype, EmitterStateChangedData*);
     DM_PARTICLE_TRAMPOLINE2(void, DestroyInstance, HParticleContext, HInstance);
@@ -17,6 +17,7 @@
 
 #include <dmsdk/dlib/vmath.h>
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <ddf/ddf.h>
 #include <graphics/graphics.h>
 #include "particle/particle_ddf.h"
@@ -163,6 +164,7 @@ namespace dmParticle
 
     /**
     * Callback for emitter state changed
+    * State changes happening during Update are reported on the calling thread once all instances have been updated.
     */
     typedef void (*EmitterStateChanged)(uint32_t num_awake_emitters, dmhash_t emitter_id, EmitterState emitter_state, void* user_data);
 
@@ -182,6 +184,8 @@ namespace dmParticle
 
     /**
      * Callback to fetch the animation from a tile source
+     * When the context has a job thread context, the callback is called from the job threads, and may be called
+     * concurrently for different emitters. It must only read shared data.
      */
     typedef FetchAnimationResult (*FetchAnimationCallback)(void* tile_source, dmhash_t animation, AnimationData* out_data);
 
@@ -247,6 +251,13 @@ namespace dmParticle
      * @param max_particle_count Max number of particles
      */
     DM_PARTICLE_PROTO(void, SetContextMaxParticleCount, HParticleContext context, uint32_t max_particle_count);
+    /**
+     * Set the job thread context used to update the instances of the context in parallel.
+     * Each instance is updated on a single thread, and the result is the same regardless of the number of threads.
+     * @param context Context to update.
+     * @param job_thread Job thread context, or 0x0 to update the instances on the calling thread
+     */
+    DM_PARTICLE_PROTO(void, SetJobThreadContext, HParticleContext context, dmJobThread::HContext job_thread);
 
     /**
      * Create an instance from the supplied path and fetch resources using the supplied factory.
@@ -336,8 +347,10 @@ namespace dmParticle
 
     /**
      * Update the instances within the specified context.
+     * Instances are updated on the job threads if the context has a job thread context (see SetJobThreadContext).
      * @param context Context of the instances to update.
      * @param dt Time step.
+     * @param fetch_animation_callback Callback to fetch the animation of an emitter, see FetchAnimationCallback
      */
     DM_PARTICLE_PROTO(void, Update, HParticleContext context, float dt, FetchAnimationCallback fetch_animation_callback);
 
@@ -17,6 +17,7 @@
 #define DM_PARTICLE_PRIVATE_H
 
 #include <dlib/index_pool.h>
+#include <dlib/job_thread.h>
 #include <dlib/transform.h>
 
 #include "particle/particle_ddf.h"
@@ -45,6 +46,9 @@ namespace dmParticle
     /**
      * Representation of a particle.
      *
+     * Particles are stored per emitter as streams (see ParticleBuffer), this struct is the
+     * gathered state of a single particle used when spawning and inspecting particles.
+     *
      * TODO Separate source state from current (chaining modifiers)
      */
     struct Particle
@@ -102,6 +106,100 @@ namespace dmParticle
         float       m_SourceAngularVelocity;
     };
 
+    /**
+     * Streams of the particle state, see ParticleBuffer.
+     */
+    enum ParticleStream
+    {
+        PARTICLE_STREAM_POSITION_X,
+        PARTICLE_STREAM_POSITION_Y,
+        PARTICLE_STREAM_POSITION_Z,
+        PARTICLE_STREAM_VELOCITY_X,
+        PARTICLE_STREAM_VELOCITY_Y,
+        PARTICLE_STREAM_VELOCITY_Z,
+        PARTICLE_STREAM_SOURCE_ROTATION_X,
+        PARTICLE_STREAM_SOURCE_ROTATION_Y,
+        PARTICLE_STREAM_SOURCE_ROTATION_Z,
+        PARTICLE_STREAM_SOURCE_ROTATION_W,
+        PARTICLE_STREAM_ROTATION_X,
+        PARTICLE_STREAM_ROTATION_Y,
+        PARTICLE_STREAM_ROTATION_Z,
+        PARTICLE_STREAM_ROTATION_W,
+        PARTICLE_STREAM_SOURCE_COLOR_R,
+        PARTICLE_STREAM_SOURCE_COLOR_G,
+        PARTICLE_STREAM_SOURCE_COLOR_B,
+        PARTICLE_STREAM_SOURCE_COLOR_A,
+        PARTICLE_STREAM_COLOR_R,
+        PARTICLE_STREAM_COLOR_G,
+        PARTICLE_STREAM_COLOR_B,
+        PARTICLE_STREAM_COLOR_A,
+        PARTICLE_STREAM_SCALE_X,
+        PARTICLE_STREAM_SCALE_Y,
+        PARTICLE_STREAM_SCALE_Z,
+        PARTICLE_STREAM_TIME_LEFT,
+        PARTICLE_STREAM_MAX_LIFE_TIME,
+        PARTICLE_STREAM_OO_MAX_LIFE_TIME,
+        PARTICLE_STREAM_SPREAD_FACTOR,
+        PARTICLE_STREAM_SOURCE_SIZE,
+        PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X,
+        PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y,
+        PARTICLE_STREAM_STRETCH_FACTOR_X,
+        PARTICLE_STREAM_STRETCH_FACTOR_Y,
+        PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY,
+        PARTICLE_STREAM_COUNT
+    };
+
+    /**
+     * Particle buffer of an emitter, stored as one float stream per particle property (structure of arrays)
+     * so that the simulation can process several particles per instruction.
+     *
+     * Each stream is aligned and padded to whole SIMD registers, which allows loops to run past the last
+     * particle without a scalar tail. The sort keys are kept in a separate stream since they are integers.
+     *
+     * Like dmArray it is valid when zeroed, but the memory must be released explicitly with SetCapacity(0).
+     */
+    struct ParticleBuffer
+    {
+        inline uint32_t Size() const         { return m_Size; }
+        inline uint32_t Capacity() const     { return m_Capacity; }
+        inline uint32_t Remaining() const    { return m_Capacity - m_Size; }
+        inline bool     Empty() const        { return m_Size == 0; }
+        inline bool     Full() const         { return m_Size == m_Capacity; }
+        inline float*   GetStream(ParticleStream stream) const { return m_Streams[stream]; }
+
+        /// Changes the capacity, the particles that fit are kept
+        void SetCapacity(uint32_t capacity);
+        void SetSize(uint32_t size);
+        void Swap(ParticleBuffer& other);
+        /// Appends a particle, the buffer must not be full
+        void Push(const Particle& particle);
+        /// Removes a particle by moving the last particle into its place
+        void EraseSwap(uint32_t index);
+        Particle Get(uint32_t index) const;
+        void Set(uint32_t index, const Particle& particle);
+
+        float*      m_Streams[PARTICLE_STREAM_COUNT];
+        /// Spare stream which is swapped with the streams when they are reordered
+        float*      m_Scratch;
+        uint32_t*   m_SortKeys;
+        /// Particle indices in sorted order, and scratch space for the radix sort
+        uint32_t*   m_SortIndices;
+        uint32_t*   m_SortIndexScratch;
+        void*       m_Memory;
+        uint32_t    m_Size;
+        uint32_t    m_Capacity;
+    };
+
+    /**
+     * Emitter state change recorded while an instance is updated, reported once all instances are updated
+     */
+    struct EmitterStateChange
+    {
+        dmhash_t        m_EmitterId;
+        uint32_t        m_NumAwakeEmitters;
+        EmitterState    m_State;
+    };
+
     /**
      * Representation of an emitter.
      */
@@ -114,7 +212,7 @@ namespace dmParticle
 
         AnimationData           m_AnimationData;
         /// Particle buffer.
-        dmArray<Particle>       m_Particles;
+        ParticleBuffer          m_Particles;
         dmArray<RenderConstant> m_RenderConstants;
         dmVMath::Vector3        m_Velocity;
         dmVMath::Point3         m_LastPosition;
@@ -158,6 +256,7 @@ namespace dmParticle
         , m_PlayTime(0.0f)
         , m_VersionNumber(0)
         , m_ScaleAlongZ(0)
+        , m_DeferStateChanges(0)
         {
             m_WorldTransform.SetIdentity();
         }
@@ -172,12 +271,16 @@ namespace dmParticle
         Prototype*              m_Prototype;
         /// Emitter state changed callback
         EmitterStateChangedData m_EmitterStateChangedData;
+        /// State changes recorded while the instance is updated
+        dmArray<EmitterStateChange> m_StateChanges;
         /// Used when reloading to fast forward new emitters
         float                   m_PlayTime;
         /// Version number used to check that the handle is still valid.
         uint16_t                m_VersionNumber;
         /// Whether the scale of the world transform should be used along Z.
         uint16_t                m_ScaleAlongZ : 1;
+        /// Whether state changes should be recorded instead of reported immediately
+        uint16_t                m_DeferStateChanges : 1;
     };
 
     /**
@@ -186,7 +289,8 @@ namespace dmParticle
     struct Context
     {
         Context(uint32_t max_instance_count, uint32_t max_particle_count)
-        : m_AttributeDataPtrIndex(0)
+        : m_JobThread(0)
+        , m_AttributeDataPtrIndex(0)
         , m_MaxParticleCount(max_particle_count)
         , m_NextVersionNumber(1)
         , m_InstanceSeeding(0)
@@ -210,6 +314,8 @@ namespace dmParticle
         dmArray<Instance*>  m_Instances;
         /// Index pool used to index the instance buffer.
         dmIndexPool16       m_InstanceIndexPool;
+        /// Job thread context used to update instances in parallel, optional
+        dmJobThread::HContext m_JobThread;
         /// An intermediate array of pointers to use for the custom attribute backing data (Editor only!)
         dmArray<void*>      m_AttributeDataPtrs;
         /// An increasing serial number to keep track of when aqcuiring a pointer for the attribute backing data (Editor only!)
@@ -290,6 +396,10 @@ namespace dmParticle
     };
 
     void UpdateRenderData(HParticleContext context, HInstance instance, uint32_t emitter_index);
+    /// Packs the relative life time and index of each particle into its sort key
+    void GenerateKeys(Emitter* emitter, float max_particle_life_time);
+    /// Reorders the particles by their sort keys
+    void SortParticles(Emitter* emitter);
 }
 
 #endif // DM_PARTICLE_PRIVATE_H
@@ -0,0 +1,205 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_PARTICLE_SIMD_H
+#define DM_PARTICLE_SIMD_H
+
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * Thin wrappers over the SIMD registers used by the particle simulation loops.
+ *
+ * The width is picked at compile time: 8 lanes with AVX2, 4 lanes with SSE2 and
+ * a single lane otherwise. The loops over the particle streams are written once
+ * against these functions and step SIMD_WIDTH particles at a time.
+ *
+ * The operations mirror the scalar ones used elsewhere (dmMath::Select, dmMath::Min, the
+ * vectormath operators) so that the simulation gives the same result regardless of width.
+ */
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define DM_PARTICLE_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_PARTICLE_SIMD_SSE2
+#endif
+
+namespace dmParticle
+{
+#if defined(DM_PARTICLE_SIMD_AVX2)
+
+    static const uint32_t SIMD_WIDTH = 8;
+    typedef __m256 SimdFloat;
+    typedef __m256i SimdInt;
+
+    static inline SimdFloat SimdLoad(const float* p)                        { return _mm256_load_ps(p); }
+    static inline void      SimdStore(float* p, SimdFloat a)                { _mm256_store_ps(p, a); }
+    static inline SimdFloat SimdSplat(float a)                              { return _mm256_set1_ps(a); }
+    static inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b)               { return _mm256_add_ps(a, b); }
+    static inline SimdFloat SimdSub(SimdFloat a, SimdFloat b)               { return _mm256_sub_ps(a, b); }
+    static inline SimdFloat SimdMul(SimdFloat a, SimdFloat b)               { return _mm256_mul_ps(a, b); }
+    static inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)               { return _mm256_div_ps(a, b); }
+    static inline SimdFloat SimdSqrt(SimdFloat a)                           { return _mm256_sqrt_ps(a); }
+    // Operand order follows dmMath::Min/Max, i.e. (a < b) ? a : b
+    static inline SimdFloat SimdMin(SimdFloat a, SimdFloat b)               { return _mm256_min_ps(a, b); }
+    static inline SimdFloat SimdMax(SimdFloat a, SimdFloat b)               { return _mm256_max_ps(a, b); }
+    /// Same as dmMath::Select, (x >= 0) ? a : b
+    static inline SimdFloat SimdSelect(SimdFloat x, SimdFloat a, SimdFloat b)
+    {
+        return _mm256_blendv_ps(b, a, _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    /// Bit mask of the lanes where a < 0
+    static inline uint32_t  SimdNegativeMask(SimdFloat a)                   { return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_LT_OQ)); }
+
+    /// Truncates towards zero, like a C cast
+    static inline SimdInt   SimdToInt(SimdFloat a)                          { return _mm256_cvttps_epi32(a); }
+    static inline SimdInt   SimdIntSplat(int32_t a)                         { return _mm256_set1_epi32(a); }
+    static inline SimdInt   SimdIntRamp(int32_t a)                          { return _mm256_add_epi32(_mm256_set1_epi32(a), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+    static inline SimdInt   SimdIntAnd(SimdInt a, SimdInt b)                { return _mm256_and_si256(a, b); }
+    static inline SimdInt   SimdIntOr(SimdInt a, SimdInt b)                 { return _mm256_or_si256(a, b); }
+    static inline SimdInt   SimdIntShiftLeft16(SimdInt a)                   { return _mm256_slli_epi32(a, 16); }
+    static inline void      SimdIntStore(uint32_t* p, SimdInt a)            { _mm256_store_si256((__m256i*)p, a); }
+
+#elif defined(DM_PARTICLE_SIMD_SSE2)
+
+    static const uint32_t SIMD_WIDTH = 4;
+    typedef __m128 SimdFloat;
+    typedef __m128i SimdInt;
+
+    static inline SimdFloat SimdLoad(const float* p)                        { return _mm_load_ps(p); }
+    static inline void      SimdStore(float* p, SimdFloat a)                { _mm_store_ps(p, a); }
+    static inline SimdFloat SimdSplat(float a)                              { return _mm_set1_ps(a); }
+    static inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b)               { return _mm_add_ps(a, b); }
+    static inline SimdFloat SimdSub(SimdFloat a, SimdFloat b)               { return _mm_sub_ps(a, b); }
+    static inline SimdFloat SimdMul(SimdFloat a, SimdFloat b)               { return _mm_mul_ps(a, b); }
+    static inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)               { return _mm_div_ps(a, b); }
+    static inline SimdFloat SimdSqrt(SimdFloat a)                           { return _mm_sqrt_ps(a); }
+    // Operand order follows dmMath::Min/Max, i.e. (a < b) ? a : b
+    static inline SimdFloat SimdMin(SimdFloat a, SimdFloat b)               { return _mm_min_ps(a, b); }
+    static inline SimdFloat SimdMax(SimdFloat a, SimdFloat b)               { return _mm_max_ps(a, b); }
+    /// Same as dmMath::Select, (x >= 0) ? a : b
+    static inline SimdFloat SimdSelect(SimdFloat x, SimdFloat a, SimdFloat b)
+    {
+        __m128 mask = _mm_cmpge_ps(x, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    /// Bit mask of the lanes where a < 0
+    static inline uint32_t  SimdNegativeMask(SimdFloat a)                   { return (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps())); }
+
+    /// Truncates towards zero, like a C cast
+    static inline SimdInt   SimdToInt(SimdFloat a)                          { return _mm_cvttps_epi32(a); }
+    static inline SimdInt   SimdIntSplat(int32_t a)                         { return _mm_set1_epi32(a); }
+    static inline SimdInt   SimdIntRamp(int32_t a)                          { return _mm_add_epi32(_mm_set1_epi32(a), _mm_setr_epi32(0, 1, 2, 3)); }
+    static inline SimdInt   SimdIntAnd(SimdInt a, SimdInt b)                { return _mm_and_si128(a, b); }
+    static inline SimdInt   SimdIntOr(SimdInt a, SimdInt b)                 { return _mm_or_si128(a, b); }
+    static inline SimdInt   SimdIntShiftLeft16(SimdInt a)                   { return _mm_slli_epi32(a, 16); }
+    static inline void      SimdIntStore(uint32_t* p, SimdInt a)            { _mm_store_si128((__m128i*)p, a); }
+
+#else
+
+    static const uint32_t SIMD_WIDTH = 1;
+    typedef float SimdFloat;
+    typedef int32_t SimdInt;
+
+    static inline SimdFloat SimdLoad(const float* p)                        { return *p; }
+    static inline void      SimdStore(float* p, SimdFloat a)                { *p = a; }
+    static inline SimdFloat SimdSplat(float a)                              { return a; }
+    static inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b)               { return a + b; }
+    static inline SimdFloat SimdSub(SimdFloat a, SimdFloat b)               { return a - b; }
+    static inline SimdFloat SimdMul(SimdFloat a, SimdFloat b)               { return a * b; }
+    static inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)               { return a / b; }
+    static inline SimdFloat SimdSqrt(SimdFloat a)                           { return sqrtf(a); }
+    static inline SimdFloat SimdMin(SimdFloat a, SimdFloat b)               { return (a < b) ? a : b; }
+    static inline SimdFloat SimdMax(SimdFloat a, SimdFloat b)               { return (a > b) ? a : b; }
+    static inline SimdFloat SimdSelect(SimdFloat x, SimdFloat a, SimdFloat b) { return (x >= 0.0f) ? a : b; }
+    static inline uint32_t  SimdNegativeMask(SimdFloat a)                   { return a < 0.0f ? 1 : 0; }
+
+    static inline SimdInt   SimdToInt(SimdFloat a)                          { return (int32_t)a; }
+    static inline SimdInt   SimdIntSplat(int32_t a)                         { return a; }
+    static inline SimdInt   SimdIntRamp(int32_t a)                          { return a; }
+    static inline SimdInt   SimdIntAnd(SimdInt a, SimdInt b)                { return a & b; }
+    static inline SimdInt   SimdIntOr(SimdInt a, SimdInt b)                 { return a | b; }
+    static inline SimdInt   SimdIntShiftLeft16(SimdInt a)                   { return (SimdInt)((uint32_t)a << 16); }
+    static inline void      SimdIntStore(uint32_t* p, SimdInt a)            { *p = (uint32_t)a; }
+
+#endif
+
+    /// Three component vector, one vector per lane
+    struct SimdVector3
+    {
+        SimdFloat m_X;
+        SimdFloat m_Y;
+        SimdFloat m_Z;
+    };
+
+    /// Quaternion, one quaternion per lane
+    struct SimdQuat
+    {
+        SimdFloat m_X;
+        SimdFloat m_Y;
+        SimdFloat m_Z;
+        SimdFloat m_W;
+    };
+
+    /// Same as lengthSqr(vec) from vectormath
+    static inline SimdFloat SimdLengthSqr(const SimdVector3& v)
+    {
+        return SimdAdd(SimdAdd(SimdMul(v.m_X, v.m_X), SimdMul(v.m_Y, v.m_Y)), SimdMul(v.m_Z, v.m_Z));
+    }
+
+    /// Same as normalize(vec) from vectormath
+    static inline SimdVector3 SimdNormalize(const SimdVector3& v)
+    {
+        SimdFloat len_inv = SimdDiv(SimdSplat(1.0f), SimdSqrt(SimdLengthSqr(v)));
+        SimdVector3 result = { SimdMul(v.m_X, len_inv), SimdMul(v.m_Y, len_inv), SimdMul(v.m_Z, len_inv) };
+        return result;
+    }
+
+    /// Same as rotate(quat, vec) from vectormath
+    static inline SimdVector3 SimdRotate(const SimdQuat& q, const SimdVector3& v)
+    {
+        SimdFloat tx = SimdSub(SimdAdd(SimdMul(q.m_W, v.m_X), SimdMul(q.m_Y, v.m_Z)), SimdMul(q.m_Z, v.m_Y));
+        SimdFloat ty = SimdSub(SimdAdd(SimdMul(q.m_W, v.m_Y), SimdMul(q.m_Z, v.m_X)), SimdMul(q.m_X, v.m_Z));
+        SimdFloat tz = SimdSub(SimdAdd(SimdMul(q.m_W, v.m_Z), SimdMul(q.m_X, v.m_Y)), SimdMul(q.m_Y, v.m_X));
+        SimdFloat tw = SimdAdd(SimdAdd(SimdMul(q.m_X, v.m_X), SimdMul(q.m_Y, v.m_Y)), SimdMul(q.m_Z, v.m_Z));
+        SimdVector3 result = {
+            SimdAdd(SimdSub(SimdAdd(SimdMul(tw, q.m_X), SimdMul(tx, q.m_W)), SimdMul(ty, q.m_Z)), SimdMul(tz, q.m_Y)),
+            SimdAdd(SimdSub(SimdAdd(SimdMul(tw, q.m_Y), SimdMul(ty, q.m_W)), SimdMul(tz, q.m_X)), SimdMul(tx, q.m_Z)),
+            SimdAdd(SimdSub(SimdAdd(SimdMul(tw, q.m_Z), SimdMul(tz, q.m_W)), SimdMul(tx, q.m_Y)), SimdMul(ty, q.m_X))
+        };
+        return result;
+    }
+
+    /// Same as the quaternion product a * b from vectormath
+    static inline SimdQuat SimdQuatMul(const SimdQuat& a, const SimdQuat& b)
+    {
+        SimdQuat result = {
+            SimdSub(SimdAdd(SimdAdd(SimdMul(a.m_W, b.m_X), SimdMul(a.m_X, b.m_W)), SimdMul(a.m_Y, b.m_Z)), SimdMul(a.m_Z, b.m_Y)),
+            SimdSub(SimdAdd(SimdAdd(SimdMul(a.m_W, b.m_Y), SimdMul(a.m_Y, b.m_W)), SimdMul(a.m_Z, b.m_X)), SimdMul(a.m_X, b.m_Z)),
+            SimdSub(SimdAdd(SimdAdd(SimdMul(a.m_W, b.m_Z), SimdMul(a.m_Z, b.m_W)), SimdMul(a.m_X, b.m_Y)), SimdMul(a.m_Y, b.m_X)),
+            SimdSub(SimdSub(SimdSub(SimdMul(a.m_W, b.m_W), SimdMul(a.m_X, b.m_X)), SimdMul(a.m_Y, b.m_Y)), SimdMul(a.m_Z, b.m_Z))
+        };
+        return result;
+    }
+
+    /// Number of elements needed to cover count with whole SIMD registers
+    static inline uint32_t SimdRoundUp(uint32_t count)
+    {
+        return (count + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1);
+    }
+}
+
+#endif // DM_PARTICLE_SIMD_H
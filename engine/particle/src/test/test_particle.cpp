@@ -18,6 +18,7 @@
 #include <algorithm>
 
 #include <dlib/dstrings.h>
+#include <dlib/job_thread.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 #include <dlib/vmath.h>
@@ -30,75 +31,9 @@
 #include "../particle.h"
 #include "../particle_private.h"
 
-using namespace dmVMath;
-
-struct TestVertex
-{
-    // Offset 0
-    float m_X, m_Y, m_Z;
-    // Offset 12
-    float m_Red, m_Green, m_Blue, m_Alpha;
-    // Offset 28
-    float m_U, m_V;
-    // Offset 36
-    float m_PageIndex;
-    // Offset 40
-};
-
-static inline void FillAttribute(dmGraphics::VertexAttributeInfo& info, dmhash_t name_hash, dmGraphics::VertexAttribute::SemanticType semantic_type, dmGraphics::VertexAttribute::VectorType source_vector_type)
-{
-    info.m_NameHash        = name_hash;
-    info.m_SemanticType    = semantic_type;
-    info.m_CoordinateSpace = dmGraphics::COORDINATE_SPACE_WORLD;
-    info.m_DataType        = dmGraphics::VertexAttribute::TYPE_FLOAT;
-    info.m_VectorType      = source_vector_type;
-    info.m_ValuePtr        = 0;
-    info.m_ValueVectorType = source_vector_type;
-}
-
-class ParticleTest : public jc_test_base_class
-{
-protected:
-    virtual void SetUp()
-    {
-        m_Context = dmParticle::CreateContext(64, 1024);
-        assert(m_Context != 0);
-        m_VertexBufferSize = dmParticle::GetVertexBufferSize(1024, sizeof(TestVertex));
-        m_VertexBuffer = new uint8_t[m_VertexBufferSize];
-        m_Prototype = 0x0;
-
-        FillAttribute(m_AttributeInfos.m_Infos[0], dmHashString64("position"),   dmGraphics::VertexAttribute::SEMANTIC_TYPE_POSITION,   dmGraphics::VertexAttribute::VECTOR_TYPE_VEC3);
-        FillAttribute(m_AttributeInfos.m_Infos[1], dmHashString64("color"),      dmGraphics::VertexAttribute::SEMANTIC_TYPE_COLOR,      dmGraphics::VertexAttribute::VECTOR_TYPE_VEC4);
-        FillAttribute(m_AttributeInfos.m_Infos[2], dmHashString64("texcoord0"),  dmGraphics::VertexAttribute::SEMANTIC_TYPE_TEXCOORD,   dmGraphics::VertexAttribute::VECTOR_TYPE_VEC2);
-        FillAttribute(m_AttributeInfos.m_Infos[3], dmHashString64("page_index"), dmGraphics::VertexAttribute::SEMANTIC_TYPE_PAGE_INDEX, dmGraphics::VertexAttribute::VECTOR_TYPE_SCALAR);
-
-        m_AttributeInfos.m_NumInfos     = 4;
-        m_AttributeInfos.m_VertexStride = sizeof(TestVertex);
-    }
+#include "test_particle.h"
 
-    virtual void TearDown()
-    {
-        if (m_Prototype != 0x0)
-        {
-            dmParticle::Particle_DeletePrototype(m_Prototype);
-        }
-        dmParticle::DestroyContext(m_Context);
-        delete [] m_VertexBuffer;
-    }
-
-    void VerifyVertexTexCoords(TestVertex* vertex_buffer, float* tex_coords, uint32_t tile, bool rotated_on_atlas);
-    void VerifyVertexDims(TestVertex* vertex_buffer, uint32_t particle_count, float size, uint32_t tile_width, uint32_t tile_height);
-
-    dmParticle::HParticleContext m_Context;
-    dmParticle::HPrototype m_Prototype;
-    dmGraphics::VertexAttributeInfos m_AttributeInfos;
-
-    uint8_t* m_VertexBuffer;
-    uint32_t m_VertexBufferSize;
-
-    dmParticle::EmitterStateChanged m_CallbackFunc;
-    dmParticle::EmitterStateChangedData m_CallbackData;
-};
+using namespace dmVMath;
 
 static const float EPSILON = 0.000007f;
 
@@ -180,11 +115,6 @@ void ParticleTest::VerifyVertexDims(TestVertex* vertex_buffer, uint32_t particle
     }
 }
 
-dmParticle::Emitter* GetEmitter(dmParticle::HParticleContext context, dmParticle::HInstance instance, uint32_t index)
-{
-    return &context->m_Instances[instance & 0xffff]->m_Emitters[index];
-}
-
 bool IsSleeping(dmParticle::Emitter* emitter)
 {
     return emitter->m_State == dmParticle::EMITTER_STATE_SLEEPING;
@@ -195,35 +125,6 @@ bool IsSpawning(dmParticle::Emitter* emitter)
     return emitter->m_State == dmParticle::EMITTER_STATE_SPAWNING;
 }
 
-uint32_t ParticleCount(dmParticle::Emitter* emitter)
-{
-    return emitter->m_Particles.Size();
-}
-
-bool LoadPrototype(const char* filename, dmParticle::HPrototype* prototype)
-{
-    char path[128];
-    dmTestUtil::MakeHostPathf(path, sizeof(path), "build/src/test/%s", filename);
-
-    const uint32_t MAX_FILE_SIZE = 4 * 1024;
-    unsigned char buffer[MAX_FILE_SIZE];
-    uint32_t file_size = 0;
-
-    FILE* f = fopen(path, "rb");
-    if (f)
-    {
-        file_size = fread(buffer, 1, MAX_FILE_SIZE, f);
-        fclose(f);
-        *prototype = dmParticle::NewPrototype(buffer, file_size);
-        return *prototype != 0x0;
-    }
-    else
-    {
-        dmLogWarning("Particle FX could not be loaded: %s.", path);
-        return false;
-    }
-}
-
 bool LoadPrototypeFromDDF(const char* filename, dmParticle::HPrototype* prototype)
 {
     char path[128];
@@ -761,8 +662,8 @@ TEST_F(ParticleTest, EmissionSpace)
     dmParticle::Update(m_Context, dt, 0x0);
 
     dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
-    dmParticle::Particle* p = &e->m_Particles[0];
-    ASSERT_EQ(10.0f, p->GetPosition().getX());
+    dmParticle::Particle p = e->m_Particles.Get(0);
+    ASSERT_EQ(10.0f, p.GetPosition().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
     dmParticle::Particle_DeletePrototype(m_Prototype);
@@ -778,8 +679,8 @@ TEST_F(ParticleTest, EmissionSpace)
     dmParticle::Update(m_Context, dt, 0x0);
 
     e = GetEmitter(m_Context, instance, 0);
-    p = &e->m_Particles[0];
-    ASSERT_EQ(0.0f, p->GetPosition().getX());
+    p = e->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, p.GetPosition().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -808,7 +709,7 @@ TEST_F(ParticleTest, ParticleLife)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    ASSERT_EQ(0.0f, e->m_Particles[0].GetTimeLeft());
+    ASSERT_EQ(0.0f, e->m_Particles.Get(0).GetTimeLeft());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -855,10 +756,10 @@ TEST_F(ParticleTest, ParticleVelocityStretch)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(3.5f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(3.5f, e->m_Particles.Get(0).m_Scale[1], EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(1.0f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(1.0f, e->m_Particles.Get(0).m_Scale[1], EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -877,12 +778,12 @@ TEST_F(ParticleTest, ParticleStretch)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[0], EPSILON);
-    ASSERT_NEAR(4.f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(2.f, e->m_Particles.Get(0).m_Scale[0], EPSILON);
+    ASSERT_NEAR(4.f, e->m_Particles.Get(0).m_Scale[1], EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[0], EPSILON);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(2.f, e->m_Particles.Get(0).m_Scale[0], EPSILON);
+    ASSERT_NEAR(2.f, e->m_Particles.Get(0).m_Scale[1], EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -902,7 +803,7 @@ TEST_F(ParticleTest, ParticleOrientationMovementDirection)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = e->m_Particles.Get(0).GetRotation();
 
     // Represents an euler rotation of 90 deg around Z
     ASSERT_EQ(0.0f, q.getX());
@@ -929,7 +830,7 @@ TEST_F(ParticleTest, ParticleApplyLifeRotationToMovementDirection)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = e->m_Particles.Get(0).GetRotation();
 
     // Represents an euler rotation of 90deg particle life rotation combined with 90deg rotation along direction
     ASSERT_EQ(0.0f, q.getX());
@@ -962,7 +863,7 @@ TEST_F(ParticleTest, ParticleMovementDirection)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = e->m_Particles.Get(0).GetRotation();
 
     ASSERT_EQ(0.0f, q.getX());
     ASSERT_EQ(0.0f, q.getY());
@@ -970,7 +871,7 @@ TEST_F(ParticleTest, ParticleMovementDirection)
     ASSERT_NEAR(0.70710677, q.getW(), EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = e->m_Particles.Get(0).GetRotation();
 
     ASSERT_EQ(0.0f, q.getX());
     ASSERT_EQ(0.0f, q.getY());
@@ -995,7 +896,7 @@ TEST_F(ParticleTest, ParticleAngularVelocity)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = e->m_Particles.Get(0).GetRotation();
 
     Vector3 r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -1003,7 +904,7 @@ TEST_F(ParticleTest, ParticleAngularVelocity)
     ASSERT_EQ(90.0f, r.getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = e->m_Particles.Get(0).GetRotation();
 
     r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -1028,7 +929,7 @@ TEST_F(ParticleTest, ParticleAngularVelocityInitialRotation)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = e->m_Particles.Get(0).GetRotation();
 
     Vector3 r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
 
@@ -1037,7 +938,7 @@ TEST_F(ParticleTest, ParticleAngularVelocityInitialRotation)
     ASSERT_NEAR(0.0f, r.getZ(), EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = e->m_Particles.Get(0).GetRotation();
 
     r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -1213,36 +1114,43 @@ TEST_F(ParticleTest, EvaluateEmitterProperty)
 
     // t = 0.125, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    dmParticle::Particle particle = e->m_Particles.Get(0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.25, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.375, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.5, size = 1
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(1.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(1.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.625, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.75, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.875, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 1, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize(), EPSILON);
+    particle = e->m_Particles.Get(0);
+    ASSERT_NEAR(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize(), EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1264,10 +1172,10 @@ TEST_F(ParticleTest, EvaluateEmitterPropertySpread)
         dmParticle::StartInstance(m_Context, instance);
 
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &emitter->m_Particles[0];
+        dmParticle::Particle particle = emitter->m_Particles.Get(0);
         // NOTE size could potentially be 0, but not likely
-        ASSERT_NE(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
-        ASSERT_GE(1.0f, dmMath::Abs(minElem(particle->GetScale()) * particle->GetSourceSize()));
+        ASSERT_NE(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
+        ASSERT_GE(1.0f, dmMath::Abs(minElem(particle.GetScale()) * particle.GetSourceSize()));
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1296,37 +1204,44 @@ TEST_F(ParticleTest, EvaluateParticleProperty)
 
     // t = 0.125, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    dmParticle::Particle particle = e->m_Particles.Get(0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.25, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.375, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.5, size = 1
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(1.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(1.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.625, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.75, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.875, size < 0
     // Updating with a full dt here will make the emitter reach its duration
     dmParticle::Update(m_Context, dt - EPSILON, 0x0);
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = e->m_Particles.Get(0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 1, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize(), EPSILON);
+    particle = e->m_Particles.Get(0);
+    ASSERT_NEAR(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize(), EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1347,8 +1262,8 @@ TEST_F(ParticleTest, ParticleInstanceScale)
     dmParticle::Update(m_Context, dt, 0x0);
 
     dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
-    dmParticle::Particle* p = &e->m_Particles[0];
-    ASSERT_EQ(2.0f, minElem(p->GetScale()) * p->GetSourceSize());
+    dmParticle::Particle p = e->m_Particles.Get(0);
+    ASSERT_EQ(2.0f, minElem(p.GetScale()) * p.GetSourceSize());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1536,25 +1451,29 @@ TEST_F(ParticleTest, StableSort)
     ASSERT_EQ(particle_count, i->m_Emitters[0].m_Particles.Size());
 
     float x[particle_count];
-    dmParticle::Particle* p = &i->m_Emitters[0].m_Particles[0];
+    dmParticle::ParticleBuffer& particles = i->m_Emitters[0].m_Particles;
     // Store x-positions
     for (uint32_t pi = 0; pi < particle_count; ++pi)
     {
         float f = (float)pi + 1;
         x[pi] = f;
-        Point3 pos = p[pi].GetPosition();
+        dmParticle::Particle p = particles.Get(pi);
+        Point3 pos = p.GetPosition();
         pos.setX(f);
-        p[pi].SetPosition(pos);
+        p.SetPosition(pos);
+        particles.Set(pi, p);
     }
     // Disturb order by altering a few particles
     const uint32_t disturb_count = particle_count / 2;
     for (uint32_t d = 0; d < disturb_count; ++d)
     {
-        p[d].SetTimeLeft(p[d].GetTimeLeft() - dt);
+        dmParticle::Particle p = particles.Get(d);
+        p.SetTimeLeft(p.GetTimeLeft() - dt);
         x[d] += particle_count;
-        Point3 pos = p[d].GetPosition();
+        Point3 pos = p.GetPosition();
         pos.setX(x[d]);
-        p[d].SetPosition(pos);
+        p.SetPosition(pos);
+        particles.Set(d, p);
     }
     // Sort
     dmParticle::Update(m_Context, dt, 0x0);
@@ -1563,7 +1482,7 @@ TEST_F(ParticleTest, StableSort)
     // Verify order of undisturbed
     for (uint32_t pi = 0; pi < particle_count; ++pi)
     {
-        ASSERT_EQ(x[pi], p[pi].GetPosition().getX());
+        ASSERT_EQ(x[pi], particles.Get(pi).GetPosition().getX());
     }
 
     dmParticle::DestroyInstance(m_Context, instance);
@@ -1595,8 +1514,7 @@ TEST_F(ParticleTest, ReloadInstance)
 
     ASSERT_EQ(1u, e->m_Particles.Size());
 
-    dmParticle::Particle original_particle;
-    memcpy(&original_particle, &e->m_Particles[0], sizeof(dmParticle::Particle));
+    dmParticle::Particle original_particle = e->m_Particles.Get(0);
 
     uint32_t seed = e->m_Seed;
     float timer = e->m_Timer;
@@ -1607,8 +1525,8 @@ TEST_F(ParticleTest, ReloadInstance)
     ASSERT_EQ(timer, e->m_Timer);
     ASSERT_EQ(seed, e->m_Seed);
     ASSERT_EQ(1u, e->m_Particles.Size());
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::Particle particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::Emitter* e1 = GetEmitter(m_Context, instance, 1);
     ASSERT_EQ(1u, e1->m_Particles.Size());
@@ -1618,8 +1536,8 @@ TEST_F(ParticleTest, ReloadInstance)
     e = GetEmitter(m_Context, instance, 0);
 
     ASSERT_EQ(1u, e->m_Particles.Size());
-    particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     // Test reload with max_particle_count changed
     ASSERT_TRUE(ReloadPrototype("reload3.particlefxc", m_Prototype));
@@ -1627,8 +1545,8 @@ TEST_F(ParticleTest, ReloadInstance)
     e = GetEmitter(m_Context, instance, 0);
 
     ASSERT_EQ(2u, e->m_Particles.Size());
-    particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1655,8 +1573,7 @@ TEST_F(ParticleTest, ReloadInstanceLoop)
     ASSERT_EQ(1u, e->m_Particles.Size());
     float emitter_timer = e->m_Timer;
 
-    dmParticle::Particle original_particle;
-    memcpy(&original_particle, &e->m_Particles[0], sizeof(dmParticle::Particle));
+    dmParticle::Particle original_particle = e->m_Particles.Get(0);
 
     ASSERT_TRUE(ReloadPrototype("reload_loop.particlefxc", m_Prototype));
     dmParticle::ReloadInstance(m_Context, instance, true);
@@ -1665,8 +1582,8 @@ TEST_F(ParticleTest, ReloadInstanceLoop)
     ASSERT_EQ(1u, e->m_Particles.Size());
     ASSERT_EQ(emitter_timer, e->m_Timer);
     ASSERT_EQ(1u, e->m_Particles.Size());
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::Particle particle = e->m_Particles.Get(0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1723,19 +1640,19 @@ TEST_F(ParticleTest, AccelerationWorld)
 
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::SetRotation(m_Context, instance, Quat::rotationZ(M_PI * 0.5f));
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1759,8 +1676,8 @@ TEST_F(ParticleTest, AccelerationScaledEmitter)
 
         dmParticle::StartInstance(m_Context, instance);
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &inst->m_Emitters[0].m_Particles[0];
-        delta[i] = Vector3(particle->GetPosition());
+        dmParticle::Particle particle = inst->m_Emitters[0].m_Particles.Get(0);
+        delta[i] = Vector3(particle.GetPosition());
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1790,8 +1707,8 @@ TEST_F(ParticleTest, AccelerationScaledWorld)
 
         dmParticle::StartInstance(m_Context, instance);
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &inst->m_Emitters[0].m_Particles[0];
-        delta[i] = Vector3(particle->GetPosition());
+        dmParticle::Particle particle = inst->m_Emitters[0].m_Particles.Get(0);
+        delta[i] = Vector3(particle.GetPosition());
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1813,19 +1730,19 @@ TEST_F(ParticleTest, AccelerationEmitter)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_NEAR(0.0f, particle->GetVelocity().getX(), EPSILON);
-    ASSERT_NEAR(1.0f, particle->GetVelocity().getY(), EPSILON);
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_NEAR(0.0f, particle.GetVelocity().getX(), EPSILON);
+    ASSERT_NEAR(1.0f, particle.GetVelocity().getY(), EPSILON);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::SetRotation(m_Context, instance, Quat::rotationZ(M_PI));
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_NEAR(0.0f, particle->GetVelocity().getX(), EPSILON);
-    ASSERT_NEAR(1.0f, particle->GetVelocity().getY(), EPSILON);
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_NEAR(0.0f, particle.GetVelocity().getX(), EPSILON);
+    ASSERT_NEAR(1.0f, particle.GetVelocity().getY(), EPSILON);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1841,22 +1758,22 @@ TEST_F(ParticleTest, AccelerationAnimated)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_LT(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = emitter->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_LT(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
     // New particle at 0 because of sorting
-    particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = emitter->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::Update(m_Context, dt, 0x0);
     // New particle at 0 because of sorting
-    particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_GT(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = emitter->m_Particles.Get(0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_GT(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1873,8 +1790,8 @@ TEST_F(ParticleTest, DragNoDir)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1891,8 +1808,8 @@ TEST_F(ParticleTest, DragDir)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    Vector3 velocity = particle->GetVelocity();
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    Vector3 velocity = particle.GetVelocity();
     ASSERT_NEAR(0.0f, velocity.getX(), EPSILON);
     ASSERT_LT(0.0f, velocity.getY());
     ASSERT_EQ(0.0f, velocity.getZ());
@@ -1912,8 +1829,8 @@ TEST_F(ParticleTest, DragBigMagnitude)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0u, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0u, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1930,9 +1847,9 @@ TEST_F(ParticleTest, Radial)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(1.0f, lengthSqr(particle->GetVelocity()));
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getX());
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(1.0f, lengthSqr(particle.GetVelocity()));
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1949,16 +1866,16 @@ TEST_F(ParticleTest, RadialMaxDistance)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     // Test with instance scale
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::SetScale(m_Context, instance, 2.0f);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1976,8 +1893,8 @@ TEST_F(ParticleTest, RadialEdgeCase)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(1.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(1.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1994,10 +1911,10 @@ TEST_F(ParticleTest, Vortex)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2014,16 +1931,16 @@ TEST_F(ParticleTest, VortexMaxDistance)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     // Test with instance scale
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::SetScale(m_Context, instance, 2.0f);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2040,10 +1957,10 @@ TEST_F(ParticleTest, VortexEdgeCase)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = i->m_Emitters[0].m_Particles.Get(0);
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2105,8 +2022,8 @@ TEST_F(ParticleTest, InheritVelocity)
     dmParticle::SetPosition(m_Context, instance, Point3(10, 0, 0));
     dmParticle::Update(m_Context, dt, 0x0);
 
-    ASSERT_EQ(0.0f, lengthSqr(e1->m_Particles[0].GetVelocity()));
-    ASSERT_NE(0.0f, lengthSqr(e2->m_Particles[0].GetVelocity()));
+    ASSERT_EQ(0.0f, lengthSqr(e1->m_Particles.Get(0).GetVelocity()));
+    ASSERT_NE(0.0f, lengthSqr(e2->m_Particles.Get(0).GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2202,6 +2119,198 @@ TEST_F(ParticleTest, Pivot)
     dmParticle::DestroyInstance(m_Context, instance);
 }
 
+/**
+ * Verify that updating the instances on the job threads gives the same result as updating them on the calling thread
+ */
+TEST_F(ParticleTest, ParallelUpdate)
+{
+    const uint32_t instance_count = 32;
+    const uint32_t frame_count = 150;
+    float dt = 1.0f / 30.0f;
+
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread1";
+    job_thread_create_params.m_ThreadNames[1] = "DefoldTestJobThread2";
+    job_thread_create_params.m_ThreadNames[2] = "DefoldTestJobThread3";
+    job_thread_create_params.m_ThreadNames[3] = "DefoldTestJobThread4";
+    job_thread_create_params.m_ThreadCount    = 4;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_params);
+
+    const char* prototype_names[] = {"benchmark.particlefxc", "once_three_emitters.particlefxc", "mod_vortex.particlefxc", "loop.particlefxc"};
+    const uint32_t prototype_count = DM_ARRAY_SIZE(prototype_names);
+    dmParticle::HPrototype prototypes[prototype_count];
+    for (uint32_t i = 0; i < prototype_count; ++i)
+    {
+        ASSERT_TRUE(LoadPrototype(prototype_names[i], &prototypes[i]));
+    }
+
+    // The first context is updated on the calling thread, the second on the job threads
+    dmParticle::HParticleContext contexts[2];
+    dmParticle::HInstance instances[2][instance_count];
+    EmitterStateChangedCallbackTestData* callback_data[2][instance_count];
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        contexts[c] = dmParticle::CreateContext(instance_count, instance_count * 1000);
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            callback_data[c][i] = new (malloc(sizeof(EmitterStateChangedCallbackTestData))) EmitterStateChangedCallbackTestData();
+            dmParticle::EmitterStateChangedData state_changed_data;
+            state_changed_data.m_StateChangedCallback = EmitterStateChangedCallback;
+            state_changed_data.m_UserData = (void*)callback_data[c][i];
+            instances[c][i] = dmParticle::CreateInstance(contexts[c], prototypes[i % prototype_count], &state_changed_data);
+            dmParticle::SetPosition(contexts[c], instances[c][i], Point3((float)i, 0.0f, 0.0f));
+        }
+    }
+    // The seeds are based on the time of creation
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        uint32_t emitter_count = dmParticle::GetInstanceEmitterCount(contexts[0], instances[0][i]);
+        for (uint32_t e = 0; e < emitter_count; ++e)
+        {
+            dmParticle::Emitter* e0 = GetEmitter(contexts[0], instances[0][i], e);
+            dmParticle::Emitter* e1 = GetEmitter(contexts[1], instances[1][i], e);
+            e1->m_OriginalSeed    = e0->m_OriginalSeed;
+            e1->m_Seed            = e0->m_Seed;
+            e1->m_Duration        = e0->m_Duration;
+            e1->m_StartDelay      = e0->m_StartDelay;
+            e1->m_SpawnRateSpread = e0->m_SpawnRateSpread;
+        }
+        dmParticle::StartInstance(contexts[0], instances[0][i]);
+        dmParticle::StartInstance(contexts[1], instances[1][i]);
+    }
+    dmParticle::SetJobThreadContext(contexts[1], job_thread);
+
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        dmParticle::Update(contexts[0], dt, 0x0);
+        dmParticle::Update(contexts[1], dt, 0x0);
+
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            ASSERT_EQ(callback_data[0][i]->m_NumStateChanges, callback_data[1][i]->m_NumStateChanges);
+
+            uint32_t emitter_count = dmParticle::GetInstanceEmitterCount(contexts[0], instances[0][i]);
+            for (uint32_t e = 0; e < emitter_count; ++e)
+            {
+                dmParticle::Emitter* e0 = GetEmitter(contexts[0], instances[0][i], e);
+                dmParticle::Emitter* e1 = GetEmitter(contexts[1], instances[1][i], e);
+                ASSERT_EQ(e0->m_State, e1->m_State);
+                ASSERT_EQ(e0->m_Seed, e1->m_Seed);
+                ASSERT_EQ(e0->m_Particles.Size(), e1->m_Particles.Size());
+                for (uint32_t p = 0; p < e0->m_Particles.Size(); ++p)
+                {
+                    dmParticle::Particle p0 = e0->m_Particles.Get(p);
+                    dmParticle::Particle p1 = e1->m_Particles.Get(p);
+                    ASSERT_EQ(0, memcmp(&p0, &p1, sizeof(dmParticle::Particle)));
+                }
+            }
+        }
+    }
+
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            dmParticle::DestroyInstance(contexts[c], instances[c][i]);
+        }
+        dmParticle::DestroyContext(contexts[c]);
+    }
+    for (uint32_t i = 0; i < prototype_count; ++i)
+    {
+        dmParticle::Particle_DeletePrototype(prototypes[i]);
+    }
+    dmJobThread::Destroy(job_thread);
+}
+
+/**
+ * Verify the particle sort against std::sort, see test_particle_perf.cpp for the timings
+ */
+TEST_F(ParticleTest, SortParticles)
+{
+    const uint32_t counts[] = {100, 1000, 10000, 60000};
+    const uint32_t iterations = 2;
+
+    dmParticle::Emitter emitter;
+    memset(&emitter, 0, sizeof(emitter));
+    emitter.m_Particles.SetCapacity(counts[DM_ARRAY_SIZE(counts) - 1]);
+    uint64_t* pairs = new uint64_t[emitter.m_Particles.Capacity()];
+    uint32_t* expected = new uint32_t[emitter.m_Particles.Capacity()];
+
+    for (uint32_t o = 0; o < SORT_ORDER_COUNT; ++o)
+    {
+        for (uint32_t c = 0; c < DM_ARRAY_SIZE(counts); ++c)
+        {
+            uint32_t count = counts[c];
+            for (uint32_t it = 0; it < iterations; ++it)
+            {
+                uint32_t seed = it;
+                FillSortKeys(&emitter, (SortOrder)o, count, &seed);
+                StdSortParticles(&emitter, pairs);
+                memcpy(expected, emitter.m_Particles.m_SortKeys, count * sizeof(uint32_t));
+
+                seed = it;
+                FillSortKeys(&emitter, (SortOrder)o, count, &seed);
+                dmParticle::SortParticles(&emitter);
+
+                const float* x = emitter.m_Particles.GetStream(dmParticle::PARTICLE_STREAM_POSITION_X);
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    ASSERT_EQ(expected[i], emitter.m_Particles.m_SortKeys[i]);
+                    ASSERT_EQ((float)expected[i], x[i]);
+                }
+            }
+        }
+    }
+
+    delete [] expected;
+    delete [] pairs;
+    emitter.m_Particles.SetCapacity(0);
+}
+
+/**
+ * Fills the emitters of the benchmark prototype in a single update, see test_particle_perf.cpp for the benchmark
+ */
+TEST_F(ParticleTest, BenchmarkPrototype)
+{
+    const uint32_t instance_count = 16;
+    const uint32_t particles_per_instance = 1000;
+    float dt = 1.0f / 60.0f;
+
+    dmParticle::HParticleContext context = dmParticle::CreateContext(instance_count, instance_count * particles_per_instance);
+    ASSERT_TRUE(LoadPrototype("benchmark.particlefxc", &m_Prototype));
+
+    dmParticle::HInstance instances[instance_count];
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        instances[i] = dmParticle::CreateInstance(context, m_Prototype, 0x0);
+        dmParticle::SetPosition(context, instances[i], Point3((float)(i % 32), (float)(i / 32), 0.0f));
+        dmParticle::StartInstance(context, instances[i]);
+    }
+
+    dmParticle::Update(context, dt, 0x0);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        ASSERT_EQ(particles_per_instance, ParticleCount(GetEmitter(context, instances[i], 0)));
+    }
+
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(particles_per_instance, sizeof(TestVertex));
+    uint8_t* vertex_buffer = new uint8_t[vertex_buffer_size];
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        uint32_t out_vertex_buffer_size = 0;
+        dmParticle::GenerateVertexData(context, dt, instances[i], 0, m_AttributeInfos, Vector4(1,1,1,1), (void*)vertex_buffer, vertex_buffer_size, &out_vertex_buffer_size);
+        ASSERT_EQ(vertex_buffer_size, out_vertex_buffer_size);
+    }
+    delete [] vertex_buffer;
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmParticle::DestroyInstance(context, instances[i]);
+    }
+    dmParticle::DestroyContext(context);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -0,0 +1,205 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_PARTICLE_TEST_PARTICLE_H
+#define DM_PARTICLE_TEST_PARTICLE_H
+
+#include <stdio.h>
+#include <algorithm>
+
+#include <jc_test/jc_test.h>
+
+#include <dlib/hash.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/testutil.h>
+
+#include <graphics/graphics_ddf.h>
+
+#include "../particle.h"
+#include "../particle_private.h"
+
+struct TestVertex
+{
+    // Offset 0
+    float m_X, m_Y, m_Z;
+    // Offset 12
+    float m_Red, m_Green, m_Blue, m_Alpha;
+    // Offset 28
+    float m_U, m_V;
+    // Offset 36
+    float m_PageIndex;
+    // Offset 40
+};
+
+static inline void FillAttribute(dmGraphics::VertexAttributeInfo& info, dmhash_t name_hash, dmGraphics::VertexAttribute::SemanticType semantic_type, dmGraphics::VertexAttribute::VectorType source_vector_type)
+{
+    info.m_NameHash        = name_hash;
+    info.m_SemanticType    = semantic_type;
+    info.m_CoordinateSpace = dmGraphics::COORDINATE_SPACE_WORLD;
+    info.m_DataType        = dmGraphics::VertexAttribute::TYPE_FLOAT;
+    info.m_VectorType      = source_vector_type;
+    info.m_ValuePtr        = 0;
+    info.m_ValueVectorType = source_vector_type;
+}
+
+class ParticleTest : public jc_test_base_class
+{
+protected:
+    virtual void SetUp()
+    {
+        m_Context = dmParticle::CreateContext(64, 1024);
+        assert(m_Context != 0);
+        m_VertexBufferSize = dmParticle::GetVertexBufferSize(1024, sizeof(TestVertex));
+        m_VertexBuffer = new uint8_t[m_VertexBufferSize];
+        m_Prototype = 0x0;
+
+        FillAttribute(m_AttributeInfos.m_Infos[0], dmHashString64("position"),   dmGraphics::VertexAttribute::SEMANTIC_TYPE_POSITION,   dmGraphics::VertexAttribute::VECTOR_TYPE_VEC3);
+        FillAttribute(m_AttributeInfos.m_Infos[1], dmHashString64("color"),      dmGraphics::VertexAttribute::SEMANTIC_TYPE_COLOR,      dmGraphics::VertexAttribute::VECTOR_TYPE_VEC4);
+        FillAttribute(m_AttributeInfos.m_Infos[2], dmHashString64("texcoord0"),  dmGraphics::VertexAttribute::SEMANTIC_TYPE_TEXCOORD,   dmGraphics::VertexAttribute::VECTOR_TYPE_VEC2);
+        FillAttribute(m_AttributeInfos.m_Infos[3], dmHashString64("page_index"), dmGraphics::VertexAttribute::SEMANTIC_TYPE_PAGE_INDEX, dmGraphics::VertexAttribute::VECTOR_TYPE_SCALAR);
+
+        m_AttributeInfos.m_NumInfos     = 4;
+        m_AttributeInfos.m_VertexStride = sizeof(TestVertex);
+    }
+
+    virtual void TearDown()
+    {
+        if (m_Prototype != 0x0)
+        {
+            dmParticle::Particle_DeletePrototype(m_Prototype);
+        }
+        dmParticle::DestroyContext(m_Context);
+        delete [] m_VertexBuffer;
+    }
+
+    void VerifyVertexTexCoords(TestVertex* vertex_buffer, float* tex_coords, uint32_t tile, bool rotated_on_atlas);
+    void VerifyVertexDims(TestVertex* vertex_buffer, uint32_t particle_count, float size, uint32_t tile_width, uint32_t tile_height);
+
+    dmParticle::HParticleContext m_Context;
+    dmParticle::HPrototype m_Prototype;
+    dmGraphics::VertexAttributeInfos m_AttributeInfos;
+
+    uint8_t* m_VertexBuffer;
+    uint32_t m_VertexBufferSize;
+
+    dmParticle::EmitterStateChanged m_CallbackFunc;
+    dmParticle::EmitterStateChangedData m_CallbackData;
+};
+
+static inline dmParticle::Emitter* GetEmitter(dmParticle::HParticleContext context, dmParticle::HInstance instance, uint32_t index)
+{
+    return &context->m_Instances[instance & 0xffff]->m_Emitters[index];
+}
+
+static inline uint32_t ParticleCount(dmParticle::Emitter* emitter)
+{
+    return emitter->m_Particles.Size();
+}
+
+static inline bool LoadPrototype(const char* filename, dmParticle::HPrototype* prototype)
+{
+    char path[128];
+    dmTestUtil::MakeHostPathf(path, sizeof(path), "build/src/test/%s", filename);
+
+    const uint32_t MAX_FILE_SIZE = 4 * 1024;
+    unsigned char buffer[MAX_FILE_SIZE];
+    uint32_t file_size = 0;
+
+    FILE* f = fopen(path, "rb");
+    if (f)
+    {
+        file_size = fread(buffer, 1, MAX_FILE_SIZE, f);
+        fclose(f);
+        *prototype = dmParticle::NewPrototype(buffer, file_size);
+        return *prototype != 0x0;
+    }
+    else
+    {
+        dmLogWarning("Particle FX could not be loaded: %s.", path);
+        return false;
+    }
+}
+
+enum SortOrder
+{
+    SORT_ORDER_SORTED,
+    SORT_ORDER_NEARLY_SORTED,
+    SORT_ORDER_SPAWNED,
+    SORT_ORDER_RANDOM,
+    SORT_ORDER_COUNT,
+};
+
+// Fills the sort keys like GenerateKeys, and stores the key in the position stream to track the particles
+static inline void FillSortKeys(dmParticle::Emitter* emitter, SortOrder order, uint32_t count, uint32_t* seed)
+{
+    dmParticle::ParticleBuffer& particles = emitter->m_Particles;
+    particles.SetSize(count);
+    float* x = particles.GetStream(dmParticle::PARTICLE_STREAM_POSITION_X);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t life_time = 0;
+        switch (order)
+        {
+        case SORT_ORDER_SORTED:
+            life_time = (i * 0xffff) / count;
+            break;
+        case SORT_ORDER_NEARLY_SORTED:
+            // Particles with spread life times drift a little relative to each other
+            life_time = dmMath::Min(0xffffu, (i * 0xffff) / count + (dmMath::Rand(seed) % 8));
+            break;
+        case SORT_ORDER_SPAWNED:
+            // The newest particles are spawned last, but are the youngest
+            life_time = i < count - count / 100 ? 100 + ((i * 0xff00) / count) : (dmMath::Rand(seed) % 100);
+            break;
+        case SORT_ORDER_RANDOM:
+            life_time = dmMath::Rand(seed) & 0xffff;
+            break;
+        default:
+            break;
+        }
+        particles.m_SortKeys[i] = (life_time << 16) | (i & 0xffff);
+        x[i] = (float)particles.m_SortKeys[i];
+    }
+}
+
+// The sort used before the radix sort
+static inline void StdSortParticles(dmParticle::Emitter* emitter, uint64_t* pairs)
+{
+    dmParticle::ParticleBuffer& particles = emitter->m_Particles;
+    uint32_t n = particles.Size();
+    uint32_t* keys = particles.m_SortKeys;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        pairs[i] = ((uint64_t)keys[i] << 32) | i;
+    }
+    std::sort(pairs, pairs + n);
+    for (uint32_t s = 0; s < dmParticle::PARTICLE_STREAM_COUNT; ++s)
+    {
+        const float* src = particles.m_Streams[s];
+        float* dst = particles.m_Scratch;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            dst[i] = src[(uint32_t)pairs[i]];
+        }
+        particles.m_Scratch = particles.m_Streams[s];
+        particles.m_Streams[s] = dst;
+    }
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        keys[i] = (uint32_t)(pairs[i] >> 32);
+    }
+}
+
+#endif // DM_PARTICLE_TEST_PARTICLE_H
@@ -0,0 +1,156 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <dlib/job_thread.h>
+#include <dlib/time.h>
+
+#include "test_particle.h"
+
+using namespace dmVMath;
+
+/**
+ * Simulates 1M particles across 1k emitters and reports the cost per particle.
+ */
+TEST_F(ParticleTest, Benchmark)
+{
+    const uint32_t instance_count = 1000;
+    const uint32_t particles_per_instance = 1000;
+    const uint32_t frame_count = 20;
+    float dt = 1.0f / 60.0f;
+
+    dmParticle::HParticleContext context = dmParticle::CreateContext(instance_count, instance_count * particles_per_instance);
+    ASSERT_TRUE(LoadPrototype("benchmark.particlefxc", &m_Prototype));
+
+    dmParticle::HInstance* instances = new dmParticle::HInstance[instance_count];
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        instances[i] = dmParticle::CreateInstance(context, m_Prototype, 0x0);
+        dmParticle::SetPosition(context, instances[i], Point3((float)(i % 32), (float)(i / 32), 0.0f));
+        dmParticle::StartInstance(context, instances[i]);
+    }
+
+    // Fill all emitters
+    dmParticle::Update(context, dt, 0x0);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        ASSERT_EQ(particles_per_instance, ParticleCount(GetEmitter(context, instances[i], 0)));
+    }
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        dmParticle::Update(context, dt, 0x0);
+    }
+    uint64_t update_time = dmTime::GetMonotonicTime() - start;
+
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread1";
+    job_thread_create_params.m_ThreadNames[1] = "DefoldTestJobThread2";
+    job_thread_create_params.m_ThreadNames[2] = "DefoldTestJobThread3";
+    job_thread_create_params.m_ThreadNames[3] = "DefoldTestJobThread4";
+    job_thread_create_params.m_ThreadCount    = 4;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_params);
+    dmParticle::SetJobThreadContext(context, job_thread);
+
+    start = dmTime::GetMonotonicTime();
+    for (uint32_t f = 0; f < frame_count; ++f)
+    {
+        dmParticle::Update(context, dt, 0x0);
+    }
+    uint64_t parallel_update_time = dmTime::GetMonotonicTime() - start;
+
+    dmParticle::SetJobThreadContext(context, 0x0);
+    dmJobThread::Destroy(job_thread);
+
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(particles_per_instance, sizeof(TestVertex));
+    uint8_t* vertex_buffer = new uint8_t[vertex_buffer_size];
+    start = dmTime::GetMonotonicTime();
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        uint32_t out_vertex_buffer_size = 0;
+        dmParticle::GenerateVertexData(context, dt, instances[i], 0, m_AttributeInfos, Vector4(1,1,1,1), (void*)vertex_buffer, vertex_buffer_size, &out_vertex_buffer_size);
+        ASSERT_EQ(vertex_buffer_size, out_vertex_buffer_size);
+    }
+    uint64_t vertex_time = dmTime::GetMonotonicTime() - start;
+    delete [] vertex_buffer;
+
+    float particle_count = (float)(instance_count * particles_per_instance);
+    printf("Simulate: %.2f ns/particle\n", (update_time * 1000.0f) / (particle_count * frame_count));
+    printf("Simulate (%d job threads): %.2f ns/particle\n", job_thread_create_params.m_ThreadCount, (parallel_update_time * 1000.0f) / (particle_count * frame_count));
+    printf("Vertices: %.2f ns/particle\n", (vertex_time * 1000.0f) / particle_count);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmParticle::DestroyInstance(context, instances[i]);
+    }
+    delete [] instances;
+    dmParticle::DestroyContext(context);
+}
+
+/**
+ * Compare the time of the particle sort against std::sort
+ */
+TEST_F(ParticleTest, SortParticles)
+{
+    const uint32_t counts[] = {100, 1000, 10000, 60000};
+    const char* order_names[] = {"sorted", "nearly sorted", "spawned", "random"};
+    const uint32_t iterations = 10;
+
+    dmParticle::Emitter emitter;
+    memset(&emitter, 0, sizeof(emitter));
+    emitter.m_Particles.SetCapacity(counts[DM_ARRAY_SIZE(counts) - 1]);
+    uint64_t* pairs = new uint64_t[emitter.m_Particles.Capacity()];
+
+    for (uint32_t o = 0; o < SORT_ORDER_COUNT; ++o)
+    {
+        for (uint32_t c = 0; c < DM_ARRAY_SIZE(counts); ++c)
+        {
+            uint32_t count = counts[c];
+            uint64_t std_sort_time = 0;
+            uint64_t sort_time = 0;
+            for (uint32_t it = 0; it < iterations; ++it)
+            {
+                uint32_t seed = it;
+                FillSortKeys(&emitter, (SortOrder)o, count, &seed);
+                uint64_t start = dmTime::GetMonotonicTime();
+                StdSortParticles(&emitter, pairs);
+                std_sort_time += dmTime::GetMonotonicTime() - start;
+
+                seed = it;
+                FillSortKeys(&emitter, (SortOrder)o, count, &seed);
+                start = dmTime::GetMonotonicTime();
+                dmParticle::SortParticles(&emitter);
+                sort_time += dmTime::GetMonotonicTime() - start;
+            }
+            printf("Sort %5u particles, %-13s: std::sort %8.2f us, SortParticles %8.2f us\n", count, order_names[o], std_sort_time / (float)iterations, sort_time / (float)iterations);
+        }
+    }
+
+    delete [] pairs;
+    emitter.m_Particles.SetCapacity(0);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+
+    int ret = jc_test_run_all();
+    return ret;
+}
@@ -318,6 +318,11 @@ namespace dmRender
 
     /*#
      * Visibility dispatch function callback.
+     * The callback sets the m_Visibility of each entry in the array.
+     * By default, the callback is called on the main thread. If the dispatch was registered with
+     * RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY, the callback may be called concurrently from several
+     * threads, each call with a disjoint part of the entries. The callback must then only write to the given entries,
+     * and only read other data (e.g. the user data) that isn't modified during the rendering.
      * @struct
      * @name RenderListVisibilityParams
      * @member m_UserData [type: void*] the callback user data (registered with RenderListMakeDispatch())
@@ -361,6 +366,17 @@ namespace dmRender
         uint32_t* m_End;
     };
 
+    /*#
+     * Render dispatch flags
+     * @enum
+     * @name RenderListDispatchFlags
+     * @member RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY The visibility callback is thread safe, see RenderListVisibilityParams
+     */
+    enum RenderListDispatchFlags
+    {
+        RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY = 1,
+    };
+
     /*#
      * Render dispatch function handle.
      * @typedef
@@ -387,6 +403,18 @@ namespace dmRender
      */
     HRenderListDispatch RenderListMakeDispatch(HRenderContext context, RenderListDispatchFn dispatch_fn, RenderListVisibilityFn visibility_fn, void* user_data);
 
+    /*#
+     * Register a render dispatch function
+     * @name RenderListMakeDispatch
+     * @param context [type: dmRender::HRenderContext] the context
+     * @param dispatch_fn [type: dmRender::RenderListDispatchFn] the render batch callback function
+     * @param visibility_fn [type: dmRender::RenderListVisibilityFn] the render list visibility callback function. May be 0
+     * @param user_data [type: void*] userdata to the callback
+     * @param flags [type: uint32_t] a combination of dmRender::RenderListDispatchFlags
+     * @return dispatch [type: dmRender::HRenderListDispatch] the render dispatch function handle
+     */
+    HRenderListDispatch RenderListMakeDispatch(HRenderContext context, RenderListDispatchFn dispatch_fn, RenderListVisibilityFn visibility_fn, void* user_data, uint32_t flags);
+
     // Deprecated, left for backwards compatibility until extensions have been updated
     HRenderListDispatch RenderListMakeDispatch(HRenderContext context, RenderListDispatchFn fn, void* user_data);
 
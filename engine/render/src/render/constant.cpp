@@ -351,6 +351,7 @@ void IterateNamedConstants(HNamedConstantBuffer buffer, void (*callback)(dmhash_
 
 struct ApplyConstantContext
 {
+    dmRender::HRenderContext m_RenderContext;
     dmGraphics::HContext m_GraphicsContext;
     HNamedConstantBuffer m_ConstantBuffer;
 
@@ -360,16 +361,18 @@ struct ApplyConstantContext
         HComputeProgram m_ComputeProgram;
     };
 
-    ApplyConstantContext(dmGraphics::HContext graphics_context, HMaterial material, HNamedConstantBuffer constant_buffer)
+    ApplyConstantContext(dmRender::HRenderContext render_context, HMaterial material, HNamedConstantBuffer constant_buffer)
     {
-        m_GraphicsContext = graphics_context;
+        m_RenderContext   = render_context;
+        m_GraphicsContext = dmRender::GetGraphicsContext(render_context);
         m_Material        = material;
         m_ConstantBuffer  = constant_buffer;
     }
 
-    ApplyConstantContext(dmGraphics::HContext graphics_context, HComputeProgram program, HNamedConstantBuffer constant_buffer)
+    ApplyConstantContext(dmRender::HRenderContext render_context, HComputeProgram program, HNamedConstantBuffer constant_buffer)
     {
-        m_GraphicsContext = graphics_context;
+        m_RenderContext   = render_context;
+        m_GraphicsContext = dmRender::GetGraphicsContext(render_context);
         m_ComputeProgram  = program;
         m_ConstantBuffer  = constant_buffer;
     }
@@ -384,19 +387,18 @@ static inline void ApplyConstant(ApplyConstantContext* context, const uint64_t*
 
         if (constant->m_Type == dmRenderDDF::MaterialDesc::CONSTANT_TYPE_USER_MATRIX4)
         {
-            dmGraphics::SetConstantM4(context->m_GraphicsContext, values, constant->m_NumValues / 4, *location);
+            SetProgramConstantM4(context->m_RenderContext, values, constant->m_NumValues / 4, *location);
         }
         else
         {
-            dmGraphics::SetConstantV4(context->m_GraphicsContext, values, constant->m_NumValues, *location);
+            SetProgramConstantV4(context->m_RenderContext, values, constant->m_NumValues, *location);
         }
     }
 }
 
 void ApplyNamedConstantBuffer(dmRender::HRenderContext render_context, HMaterial material, HNamedConstantBuffer buffer)
 {
-    dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
-    ApplyConstantContext context(graphics_context, material, buffer);
+    ApplyConstantContext context(render_context, material, buffer);
     buffer->m_Constants.Iterate(ApplyConstant, &context);
 }
 
@@ -420,8 +422,7 @@ static inline void ApplyConstantCompute(ApplyConstantContext* context, const uin
 
 void ApplyNamedConstantBuffer(dmRender::HRenderContext render_context, HComputeProgram program, HNamedConstantBuffer buffer)
 {
-    dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
-    ApplyConstantContext context(graphics_context, program, buffer);
+    ApplyConstantContext context(render_context, program, buffer);
     buffer->m_Constants.Iterate(ApplyConstantCompute, &context);
 }
 
@@ -41,6 +41,7 @@
 DM_PROPERTY_EXTERN(rmtp_Render);
 DM_PROPERTY_U32(rmtp_FontCharacterCount, 0, FrameReset, "# glyphs", &rmtp_Render);
 DM_PROPERTY_U32(rmtp_FontVertexSize, 0, FrameReset, "size of vertices in bytes", &rmtp_Render);
+DM_PROPERTY_U32(rmtp_FontLayoutCount, 0, FrameReset, "# texts laid out", &rmtp_Render);
 
 namespace dmRender
 {
@@ -111,6 +112,33 @@ namespace dmRender
         int16_t              m_Y;
     };
 
+    struct TextLayoutGlyph
+    {
+        dmRender::FontGlyph* m_Glyph;
+        float                m_X; // Offset from the start of the line
+    };
+
+    struct TextLayoutLine
+    {
+        float    m_Width;
+        uint32_t m_GlyphStart;
+        uint32_t m_GlyphCount;
+    };
+
+    // The line breaks and glyph positions of a text. Kept in the text context over frames,
+    // so that texts that don't change only need to be laid out once (see GetTextLayout)
+    struct TextLayout
+    {
+        dmArray<TextLayoutGlyph> m_Glyphs;
+        dmArray<TextLayoutLine>  m_Lines;
+        dmhash_t                 m_Key;
+        float                    m_Width;
+        uint32_t                 m_Frame; // The last frame the layout was used
+    };
+
+    // Layouts older than this many frames are removed when the layout cache is full
+    static const uint32_t TEXT_LAYOUT_MAX_AGE = 1;
+
     struct FontMap
     {
         FontMap()
@@ -118,6 +146,7 @@ namespace dmRender
         , m_Texture(0)
         , m_Material(0)
         , m_NameHash(0)
+        , m_LayoutVersion(0)
         , m_GetGlyph(0)
         , m_GetGlyphData(0)
         , m_ShadowX(0.0f)
@@ -161,6 +190,7 @@ namespace dmRender
         dmGraphics::HTexture    m_Texture;
         HMaterial               m_Material;
         dmhash_t                m_NameHash;
+        uint32_t                m_LayoutVersion; // Unique for each font setup, part of the text layout cache keys
 
         FGetGlyph               m_GetGlyph;
         FGetGlyphData           m_GetGlyphData;
@@ -205,6 +235,8 @@ namespace dmRender
 
     static float GetLineTextMetrics(HFontMap font_map, float tracking, const char* text, int n, bool measure_trailing_space);
 
+    static uint32_t g_FontMapLayoutVersion = 0;
+
     static void InitFontmap(FontMapParams& params, dmGraphics::TextureParams& tex_params, uint8_t init_val)
     {
         uint8_t bpp = params.m_GlyphChannels;
@@ -291,6 +323,8 @@ namespace dmRender
         assert(params.m_GetGlyphData);
 
         font_map->m_NameHash = params.m_NameHash;
+        // The glyphs and metrics may have changed, so any cached text layouts for the font map must not be used again
+        font_map->m_LayoutVersion = ++g_FontMapLayoutVersion;
         font_map->m_GetGlyph = params.m_GetGlyph;
         font_map->m_GetGlyphData = params.m_GetGlyphData;
         font_map->m_ShadowX = params.m_ShadowX;
@@ -399,6 +433,11 @@ namespace dmRender
         delete font_map;
     }
 
+    void InvalidateFontMapLayouts(HFontMap font_map)
+    {
+        font_map->m_LayoutVersion = ++g_FontMapLayoutVersion;
+    }
+
     void SetFontMapUserData(HFontMap font_map, void* user_data)
     {
         font_map->m_UserData = user_data;
@@ -469,6 +508,10 @@ namespace dmRender
         // NOTE: 8 is "arbitrary" heuristic
         text_context.m_TextEntries.SetCapacity(max_characters / 8);
 
+        uint32_t layout_capacity = dmMath::Max(16U, text_context.m_TextEntries.Capacity());
+        text_context.m_LayoutCache.SetCapacity(layout_capacity * 2 / 3, layout_capacity);
+        text_context.m_Layouts.SetCapacity(layout_capacity);
+
         for (uint32_t i = 0; i < text_context.m_RenderObjects.Capacity(); ++i)
         {
             RenderObject ro;
@@ -490,6 +533,17 @@ namespace dmRender
         {
             dmRender::DeleteNamedConstantBuffer(text_context.m_ConstantBuffers[i]);
         }
+        for (uint32_t i = 0; i < text_context.m_Layouts.Size(); ++i)
+        {
+            delete text_context.m_Layouts[i];
+        }
+        for (uint32_t i = 0; i < text_context.m_FreeLayouts.Size(); ++i)
+        {
+            delete text_context.m_FreeLayouts[i];
+        }
+        text_context.m_LayoutCache.Clear();
+        text_context.m_Layouts.SetSize(0);
+        text_context.m_FreeLayouts.SetSize(0);
         dmMemory::AlignedFree(text_context.m_ClientBuffer);
         dmGraphics::DeleteVertexBuffer(text_context.m_VertexBuffer);
         dmGraphics::DeleteVertexDeclaration(text_context.m_VertexDecl);
@@ -528,6 +582,159 @@ namespace dmRender
         }
     };
 
+    static void PruneTextLayouts(TextContext& text_context)
+    {
+        uint32_t i = 0;
+        while (i < text_context.m_Layouts.Size())
+        {
+            TextLayout* layout = text_context.m_Layouts[i];
+            if (layout->m_Frame + TEXT_LAYOUT_MAX_AGE < text_context.m_Frame)
+            {
+                text_context.m_LayoutCache.Erase(layout->m_Key);
+                text_context.m_Layouts.EraseSwap(i);
+                if (text_context.m_FreeLayouts.Full())
+                {
+                    text_context.m_FreeLayouts.OffsetCapacity(64);
+                }
+                text_context.m_FreeLayouts.Push(layout);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    static TextLayout* AcquireTextLayout(TextContext& text_context, dmhash_t key)
+    {
+        if (text_context.m_LayoutCache.Full())
+        {
+            PruneTextLayouts(text_context);
+
+            // Grow if most of the layouts are still in use
+            if (text_context.m_LayoutCache.Size() > text_context.m_LayoutCache.Capacity() / 2)
+            {
+                uint32_t capacity = text_context.m_LayoutCache.Capacity() * 2;
+                text_context.m_LayoutCache.SetCapacity(capacity * 2 / 3, capacity);
+                text_context.m_Layouts.SetCapacity(capacity);
+            }
+        }
+
+        TextLayout* layout;
+        if (text_context.m_FreeLayouts.Empty())
+        {
+            layout = new TextLayout;
+        }
+        else
+        {
+            layout = text_context.m_FreeLayouts.Back();
+            text_context.m_FreeLayouts.Pop();
+        }
+
+        layout->m_Key = key;
+        layout->m_Glyphs.SetSize(0);
+        layout->m_Lines.SetSize(0);
+        text_context.m_LayoutCache.Put(key, layout);
+        text_context.m_Layouts.Push(layout);
+        return layout;
+    }
+
+    // Gets the layout of a text from the cache, or lays it out if it isn't there
+    static TextLayout* GetTextLayout(TextContext& text_context, HFontMap font_map, const char* text, uint32_t text_len, float width, bool line_break, float tracking)
+    {
+        if (!line_break) {
+            width = FLT_MAX;
+        }
+
+        HashState64 key_state;
+        dmHashInit64(&key_state, false);
+        dmHashUpdateBuffer64(&key_state, &font_map, sizeof(font_map));
+        dmHashUpdateBuffer64(&key_state, &font_map->m_LayoutVersion, sizeof(font_map->m_LayoutVersion));
+        dmHashUpdateBuffer64(&key_state, &width, sizeof(width));
+        dmHashUpdateBuffer64(&key_state, &tracking, sizeof(tracking));
+        dmHashUpdateBuffer64(&key_state, &line_break, sizeof(line_break));
+        dmHashUpdateBuffer64(&key_state, text, text_len);
+        dmhash_t key = dmHashFinal64(&key_state);
+
+        TextLayout** cached = text_context.m_LayoutCache.Get(key);
+        if (cached)
+        {
+            (*cached)->m_Frame = text_context.m_Frame;
+            return *cached;
+        }
+
+        DM_PROPERTY_ADD_U32(rmtp_FontLayoutCount, 1);
+
+        TextLayout* layout = AcquireTextLayout(text_context, key);
+        layout->m_Frame = text_context.m_Frame;
+
+        float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
+        tracking = line_height * tracking;
+
+        const uint32_t max_lines = 128;
+        TextLine lines[max_lines];
+
+        // Trailing space characters should be ignored when measuring and
+        // rendering multiline text.
+        // For single line text we still want to include spaces when the text
+        // layout is calculated (https://github.com/defold/defold/issues/5911)
+        bool measure_trailing_space = !line_break;
+
+        LayoutMetrics lm(font_map, tracking);
+        uint32_t line_count = Layout(text, width, lines, max_lines, &layout->m_Width, lm, measure_trailing_space);
+
+        // The byte count is an upper bound for the number of characters
+        if (layout->m_Glyphs.Capacity() < text_len)
+        {
+            layout->m_Glyphs.SetCapacity(text_len);
+        }
+        if (layout->m_Lines.Capacity() < line_count)
+        {
+            layout->m_Lines.SetCapacity(line_count);
+        }
+
+        for (uint32_t i = 0; i < line_count; ++i)
+        {
+            const TextLine& l = lines[i];
+            TextLayoutLine line;
+            line.m_Width      = l.m_Width;
+            line.m_GlyphStart = layout->m_Glyphs.Size();
+
+            const char* cursor = &text[l.m_Index];
+            float x = 0.0f;
+            for (int j = 0; j < l.m_Count; ++j)
+            {
+                uint32_t c = dmUtf8::NextChar(&cursor);
+                FontGlyph* glyph = GetGlyph(font_map, c);
+                if (!glyph) {
+                    continue;
+                }
+
+                TextLayoutGlyph layout_glyph;
+                layout_glyph.m_Glyph = glyph;
+                layout_glyph.m_X     = x;
+                layout->m_Glyphs.Push(layout_glyph);
+                x += glyph->m_Advance + tracking;
+            }
+
+            line.m_GlyphCount = layout->m_Glyphs.Size() - line.m_GlyphStart;
+            layout->m_Lines.Push(line);
+        }
+
+        return layout;
+    }
+
+    static void GetTextLayoutMetrics(HFontMap font_map, const TextLayout* layout, float leading, TextMetrics* metrics)
+    {
+        float line_height   = font_map->m_MaxAscent + font_map->m_MaxDescent;
+        uint32_t num_lines  = layout->m_Lines.Size();
+        metrics->m_MaxAscent  = font_map->m_MaxAscent;
+        metrics->m_MaxDescent = font_map->m_MaxDescent;
+        metrics->m_Width      = layout->m_Width;
+        metrics->m_Height     = num_lines * (line_height * leading) - line_height * (leading - 1.0f);
+        metrics->m_LineCount  = num_lines;
+    }
+
     static dmhash_t g_TextureSizeRecipHash = dmHashString64("texture_size_recip");
 
     static dmVMath::Point3 CalcCenterPoint(HFontMap font_map, const TextEntry& te, const TextMetrics& metrics) {
@@ -595,6 +802,7 @@ namespace dmRender
         te.m_StringOffset = offset;
         te.m_FontMap = font_map;
         te.m_Material = material;
+        te.m_Layout = GetTextLayout(*text_context, font_map, params.m_Text, text_len, params.m_Width, params.m_LineBreak, params.m_Tracking);
         te.m_BatchKey = batch_key;
         te.m_Next = -1;
         te.m_Tail = -1;
@@ -616,7 +824,7 @@ namespace dmRender
         te.m_DestinationBlendFactor = params.m_DestinationBlendFactor;
 
         TextMetrics metrics;
-        GetTextMetrics(font_map, params.m_Text, params.m_Width, params.m_LineBreak, params.m_Leading, params.m_Tracking, &metrics);
+        GetTextLayoutMetrics(font_map, te.m_Layout, params.m_Leading, &metrics);
 
         // find center and radius for frustum culling
         dmVMath::Point3 centerpoint_local = CalcCenterPoint(font_map, te, metrics);
@@ -812,28 +1020,14 @@ namespace dmRender
         UpdateGlyphTexture(font_map, g, cache_glyph->m_X, cache_glyph->m_Y, g_offset_y);
     }
 
-    static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
+    static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
     {
-        float width = te.m_Width;
-        if (!te.m_LineBreak) {
-            width = FLT_MAX;
-        }
         float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
         float leading = line_height * te.m_Leading;
-        float tracking = line_height * te.m_Tracking;
-
-        const uint32_t max_lines = 128;
-        TextLine lines[max_lines];
 
-        // Trailing space characters should be ignored when measuring and
-        // rendering multiline text.
-        // For single line text we still want to include spaces when the text
-        // layout is calculated (https://github.com/defold/defold/issues/5911)
-        bool measure_trailing_space = !te.m_LineBreak;
-
-        LayoutMetrics lm(font_map, tracking);
-        float layout_width;
-        int line_count = Layout(text, width, lines, max_lines, &layout_width, lm, measure_trailing_space);
+        const TextLayout* layout = te.m_Layout;
+        const TextLayoutGlyph* layout_glyphs = layout->m_Glyphs.Begin();
+        int line_count = (int) layout->m_Lines.Size();
         float x_offset = OffsetX(te.m_Align, te.m_Width);
         if (font_map->m_IsMonospaced)
         {
@@ -884,21 +1078,15 @@ namespace dmRender
             // Calculate number of valid glyphs
             for (int line = 0; line < line_count; ++line)
             {
-                TextLine& l = lines[line];
-                const char* cursor = &text[l.m_Index];
+                const TextLayoutLine& l = layout->m_Lines[line];
                 bool inner_break = false;
 
-                for (int j = 0; j < l.m_Count; ++j)
+                for (uint32_t j = 0; j < l.m_GlyphCount; ++j)
                 {
-                    uint32_t c = dmUtf8::NextChar(&cursor);
-                    dmRender::FontGlyph* g = GetGlyph(font_map, c);
-                    if (!g)
-                    {
-                        continue;
-                    }
+                    dmRender::FontGlyph* g = layout_glyphs[l.m_GlyphStart + j].m_Glyph;
 
-                    // If we get here, then it may be that c != glyph->m_Character
-                    c = g->m_Character;
+                    // The glyph may be the fallback glyph, i.e. not the character in the text
+                    uint32_t c = g->m_Character;
 
                     if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
                     {
@@ -936,22 +1124,17 @@ namespace dmRender
         }
 
         for (int line = 0; line < line_count; ++line) {
-            TextLine& l = lines[line];
-            float x = x_offset - OffsetX(te.m_Align, l.m_Width);
+            const TextLayoutLine& l = layout->m_Lines[line];
+            float line_x = x_offset - OffsetX(te.m_Align, l.m_Width);
             float y = y_offset - line * leading;
-            const char* cursor = &text[l.m_Index];
-            int n = l.m_Count;
-            for (int j = 0; j < n; ++j)
+            for (uint32_t j = 0; j < l.m_GlyphCount; ++j)
             {
-                uint32_t c = dmUtf8::NextChar(&cursor);
+                const TextLayoutGlyph& layout_glyph = layout_glyphs[l.m_GlyphStart + j];
+                FontGlyph* glyph = layout_glyph.m_Glyph;
+                float x = line_x + layout_glyph.m_X;
 
-                FontGlyph* glyph = GetGlyph(font_map, c);
-                if (!glyph) {
-                    continue;
-                }
-
-                // If we get here, then it may be that c != glyph->m_Character
-                c = glyph->m_Character;
+                // The glyph may be the fallback glyph, i.e. not the character in the text
+                uint32_t c = glyph->m_Character;
 
                 // Look ahead and see if we can produce vertices for the next glyph or not
                 if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
@@ -1124,7 +1307,6 @@ namespace dmRender
                         vertexindex += vertices_per_quad;
                     }
                 }
-                x += glyph->m_Advance + tracking;
             }
         }
 
@@ -1188,9 +1370,8 @@ namespace dmRender
         for (uint32_t *i = begin;i != end; ++i)
         {
             const TextEntry& te = *(TextEntry*) buf[*i].m_UserData;
-            const char* text = &text_context.m_TextBuffer[te.m_StringOffset];
 
-            int num_indices = CreateFontVertexDataInternal(text_context, font_map, text, te, im_recip, ih_recip, &vertices[text_context.m_VertexIndex], text_context.m_MaxVertexCount - text_context.m_VertexIndex);
+            int num_indices = CreateFontVertexDataInternal(text_context, font_map, te, im_recip, ih_recip, &vertices[text_context.m_VertexIndex], text_context.m_MaxVertexCount - text_context.m_VertexIndex);
             text_context.m_VertexIndex += num_indices;
         }
 
@@ -1272,7 +1453,7 @@ namespace dmRender
 
             if (count > 0) {
                 dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, count);
-                dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(render_context, &FontRenderListDispatch, &RenderListFrustumCulling, render_context);
+                dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(render_context, &FontRenderListDispatch, &RenderListFrustumCulling, render_context, dmRender::RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY);
                 dmRender::RenderListEntry* write_ptr = render_list;
 
                 for( uint32_t i = 0; i < count; ++i )
@@ -132,6 +132,13 @@ namespace dmRender
      */
     void SetFontMap(HFontMap font_map, dmGraphics::HContext graphics_context, FontMapParams& params);
 
+    /**
+     * Stop using the cached text layouts of the font map. Must be called when glyphs are added
+     * to or removed from the font, since the cached layouts point to the glyphs.
+     * @param font_map Font map handle
+     */
+    void InvalidateFontMapLayouts(HFontMap font_map);
+
     /**
      * Get texture from a font map
      * @param font_map Font map handle
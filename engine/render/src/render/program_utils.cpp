@@ -14,6 +14,7 @@
 
 #include <dlib/log.h>
 #include <dlib/dstrings.h>
+#include <dlib/hash.h>
 
 #include "render.h"
 #include "render_private.h"
@@ -228,6 +229,53 @@ namespace dmRender
         }
     }
 
+    // Returns true if the values need to be set
+    static bool UpdateConstantCache(dmRender::HRenderContext render_context, const dmVMath::Vector4* values, uint32_t value_count, dmGraphics::HUniformLocation location)
+    {
+        RenderStateCache& cache = render_context->m_StateCache;
+        if (!cache.m_Active)
+        {
+            return true;
+        }
+
+        dmhash_t values_hash = dmHashBuffer64(values, sizeof(dmVMath::Vector4) * value_count);
+        dmhash_t* cached_hash = cache.m_Constants.Get((uint64_t) location);
+        if (cached_hash)
+        {
+            if (*cached_hash == values_hash)
+            {
+                cache.m_ElidedCount++;
+                return false;
+            }
+            *cached_hash = values_hash;
+            return true;
+        }
+
+        if (cache.m_Constants.Full())
+        {
+            uint32_t new_capacity = 2 * cache.m_Constants.Capacity();
+            cache.m_Constants.SetCapacity(new_capacity / 2, new_capacity);
+        }
+        cache.m_Constants.Put((uint64_t) location, values_hash);
+        return true;
+    }
+
+    void SetProgramConstantV4(dmRender::HRenderContext render_context, const dmVMath::Vector4* values, uint32_t count, dmGraphics::HUniformLocation location)
+    {
+        if (UpdateConstantCache(render_context, values, count, location))
+        {
+            dmGraphics::SetConstantV4(render_context->m_GraphicsContext, values, count, location);
+        }
+    }
+
+    void SetProgramConstantM4(dmRender::HRenderContext render_context, const dmVMath::Vector4* values, uint32_t count, dmGraphics::HUniformLocation location)
+    {
+        if (UpdateConstantCache(render_context, values, count * 4, location))
+        {
+            dmGraphics::SetConstantM4(render_context->m_GraphicsContext, values, count, location);
+        }
+    }
+
     void SetProgramConstantValues(dmGraphics::HContext graphics_context, dmGraphics::HProgram program, uint32_t total_constants_count, dmHashTable64<dmGraphics::HUniformLocation>& name_hash_to_location, dmArray<RenderConstant>& constants, dmArray<Sampler>& samplers)
     {
         dmGraphics::Type type;
@@ -356,14 +404,14 @@ namespace dmRender
             {
                 uint32_t num_values;
                 dmVMath::Vector4* values = GetConstantValues(constant, &num_values);
-                dmGraphics::SetConstantV4(graphics_context, values, num_values, location);
+                SetProgramConstantV4(render_context, values, num_values, location);
                 break;
             }
             case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_USER_MATRIX4:
             {
                 uint32_t num_values;
                 dmVMath::Vector4* values = GetConstantValues(constant, &num_values);
-                dmGraphics::SetConstantM4(graphics_context, values, num_values / 4, location);
+                SetProgramConstantM4(render_context, values, num_values / 4, location);
                 break;
             }
             case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEWPROJ:
@@ -374,27 +422,27 @@ namespace dmRender
                     ndc_matrix.setElem(2, 2, 0.5f );
                     ndc_matrix.setElem(3, 2, 0.5f );
                     const Matrix4 view_projection = ndc_matrix * render_context->m_ViewProj;
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&view_projection, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&view_projection, 1, location);
                 }
                 else
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_ViewProj, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&render_context->m_ViewProj, 1, location);
                 }
                 break;
             }
             case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
             {
-                dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_matrix, 1, location);
+                SetProgramConstantM4(render_context, (Vector4*)&world_matrix, 1, location);
                 break;
             }
             case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
             {
-                dmGraphics::SetConstantM4(graphics_context, (Vector4*)&texture_matrix, 1, location);
+                SetProgramConstantM4(render_context, (Vector4*)&texture_matrix, 1, location);
                 break;
             }
             case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEW:
             {
-                dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_View, 1, location);
+                SetProgramConstantM4(render_context, (Vector4*)&render_context->m_View, 1, location);
                 break;
             }
             case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_PROJECTION:
@@ -407,11 +455,11 @@ namespace dmRender
                     ndc_matrix.setElem(2, 2, 0.5f );
                     ndc_matrix.setElem(3, 2, 0.5f );
                     const Matrix4 proj = ndc_matrix * render_context->m_Projection;
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&proj, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&proj, 1, location);
                 }
                 else
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_Projection, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&render_context->m_Projection, 1, location);
                 }
                 break;
             }
@@ -424,7 +472,7 @@ namespace dmRender
                     // It is always affine however
                     normalT = affineInverse(normalT);
                     normalT = transpose(normalT);
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&normalT, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&normalT, 1, location);
                 }
                 break;
             }
@@ -432,7 +480,7 @@ namespace dmRender
             {
                 {
                     Matrix4 world_view = render_context->m_View * world_matrix;
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&world_view, 1, location);
                 }
                 break;
             }
@@ -444,12 +492,12 @@ namespace dmRender
                     ndc_matrix.setElem(2, 2, 0.5f );
                     ndc_matrix.setElem(3, 2, 0.5f );
                     const Matrix4 world_view_projection = ndc_matrix * render_context->m_ViewProj * world_matrix;
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&world_view_projection, 1, location);
                 }
                 else
                 {
                     const Matrix4 world_view_projection = render_context->m_ViewProj * world_matrix;
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, 1, location);
+                    SetProgramConstantM4(render_context, (Vector4*)&world_view_projection, 1, location);
                 }
                 break;
             }
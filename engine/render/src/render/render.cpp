@@ -20,6 +20,7 @@
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/profile.h>
+#include <dlib/radix_sort.h>
 #include <dlib/math.h>
 #include <dmsdk/dlib/vmath.h>
 #include <dmsdk/dlib/intersection.h>
@@ -32,6 +33,7 @@
 #include "font_renderer.h"
 
 DM_PROPERTY_GROUP(rmtp_Render, "Renderer");
+DM_PROPERTY_U32(rmtp_RenderStateElided, 0, FrameReset, "# redundant graphics calls skipped", &rmtp_Render);
 
 namespace dmRender
 {
@@ -76,6 +78,7 @@ namespace dmRender
     RenderContextParams::RenderContextParams()
     : m_ScriptContext(0x0)
     , m_SystemFontMap(0)
+    , m_JobThread(0)
     , m_VertexShaderDesc(0x0)
     , m_FragmentShaderDesc(0x0)
     , m_MaxRenderTypes(0)
@@ -105,6 +108,7 @@ namespace dmRender
         context->m_RenderObjects.SetSize(0);
 
         context->m_GraphicsContext = graphics_context;
+        context->m_JobThread = params.m_JobThread;
 
         context->m_SystemFontMap = params.m_SystemFontMap;
 
@@ -147,6 +151,21 @@ namespace dmRender
 
         context->m_RenderListDispatch.SetCapacity(255);
 
+        context->m_FrustumHash = 0xFFFFFFFF;
+        context->m_RenderListHash = 0;
+        for (uint32_t i = 0; i < MAX_RENDER_LIST_SORT_CACHE_ENTRIES; ++i)
+        {
+            context->m_RenderListSortCache[i].m_Key = 0;
+            context->m_RenderListSortCache[i].m_LastUsed = 0;
+        }
+        context->m_RenderListSortCacheCounter = 0;
+        context->m_RenderListSortCacheHits = 0;
+
+        context->m_StateCache.m_Constants.SetCapacity(32, 64);
+        context->m_StateCache.m_Program     = 0;
+        context->m_StateCache.m_ElidedCount = 0;
+        context->m_StateCache.m_Active      = 0;
+
         SetupContextEventCallback(context, &OnContextEvent);
 
         dmMessage::Result r = dmMessage::NewSocket(RENDER_SOCKET_NAME, &context->m_Socket);
@@ -188,7 +207,7 @@ namespace dmRender
         render_context->m_FrustumHash = 0xFFFFFFFF; // trigger a first recalculation each frame
     }
 
-    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn dispatch_fn, RenderListVisibilityFn visibility_fn, void* user_data)
+    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn dispatch_fn, RenderListVisibilityFn visibility_fn, void* user_data, uint32_t flags)
     {
         if (render_context->m_RenderListDispatch.Size() == render_context->m_RenderListDispatch.Capacity())
         {
@@ -201,14 +220,20 @@ namespace dmRender
         d.m_DispatchFn = dispatch_fn;
         d.m_VisibilityFn = visibility_fn;
         d.m_UserData = user_data;
+        d.m_Flags = flags;
         render_context->m_RenderListDispatch.Push(d);
 
         return render_context->m_RenderListDispatch.Size() - 1;
     }
 
+    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn dispatch_fn, RenderListVisibilityFn visibility_fn, void* user_data)
+    {
+        return RenderListMakeDispatch(render_context, dispatch_fn, visibility_fn, user_data, 0);
+    }
+
     HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn dispatch_fn, void* user_data)
     {
-        return RenderListMakeDispatch(render_context, dispatch_fn, 0, user_data);
+        return RenderListMakeDispatch(render_context, dispatch_fn, 0, user_data, 0);
     }
 
     // Allocate a buffer (from the array) with room for 'entries' entries.
@@ -266,17 +291,6 @@ namespace dmRender
         render_context->m_RenderListRanges.SetSize(0);
     }
 
-    struct RenderListSorter
-    {
-        bool operator()(uint32_t a, uint32_t b) const
-        {
-            const RenderListSortValue& u = values[a];
-            const RenderListSortValue& v = values[b];
-            return u.m_SortKey < v.m_SortKey;
-        }
-        RenderListSortValue* values;
-    };
-
     void RenderListEnd(HRenderContext render_context)
     {
         // Unflushed leftovers are assumed to be the debug rendering
@@ -294,6 +308,11 @@ namespace dmRender
         return render_context->m_GraphicsContext;
     }
 
+    dmJobThread::HContext GetJobThreadContext(HRenderContext render_context)
+    {
+        return render_context->m_JobThread;
+    }
+
     const Matrix4& GetViewProjectionMatrix(HRenderContext render_context)
     {
         return render_context->m_ViewProj;
@@ -502,6 +521,58 @@ namespace dmRender
         return false;
     }
 
+    // Number of entries per job when calculating the z values of a range
+    static const uint32_t SORT_ZW_CHUNK_SIZE = 4096;
+
+    struct SortZWContext
+    {
+        const uint32_t*         m_Indices;
+        RenderListEntry*        m_Entries;
+        RenderListSortValue*    m_SortValues;
+        const Matrix4*          m_ViewProj;
+        SortZWResult*           m_Results;  // One per chunk of SORT_ZW_CHUNK_SIZE indices
+    };
+
+    // Writes the z/w of the entries in [start, end) of the indices. Called with ranges of at most SORT_ZW_CHUNK_SIZE, on any thread.
+    static void MakeSortValuesZW(void* _context, void* data, uint32_t start, uint32_t end)
+    {
+        SortZWContext* context = (SortZWContext*)_context;
+        const uint32_t* indices = context->m_Indices;
+        RenderListEntry* entries = context->m_Entries;
+        RenderListSortValue* sort_values = context->m_SortValues;
+        const Matrix4& transform = *context->m_ViewProj;
+
+        float minZW = FLT_MAX;
+        float maxZW = -FLT_MAX;
+        uint32_t num_visibility_skipped = 0;
+        for (uint32_t i = start; i < end; ++i)
+        {
+            uint32_t idx = indices[i];
+            RenderListEntry* entry = &entries[idx];
+            if (entry->m_Visibility == dmRender::VISIBILITY_NONE)
+            {
+                num_visibility_skipped++;
+                continue;
+            }
+
+            if (entry->m_MajorOrder != RENDER_ORDER_WORLD)
+            {
+                continue; // Could perhaps break here, if we also sorted on the major order (cost more when I tested it /MAWE)
+            }
+
+            const Vector4 res = transform * entry->m_WorldPosition;
+            const float zw = res.getZ() / res.getW();
+            sort_values[idx].m_ZW = zw;
+            if (zw < minZW) minZW = zw;
+            if (zw > maxZW) maxZW = zw;
+        }
+
+        SortZWResult& result = context->m_Results[start / SORT_ZW_CHUNK_SIZE];
+        result.m_MinZW = dmMath::Min(result.m_MinZW, minZW);
+        result.m_MaxZW = dmMath::Max(result.m_MaxZW, maxZW);
+        result.m_NumVisibilitySkipped += num_visibility_skipped;
+    }
+
     // Compute new sort values for everything that matches tag_mask
     static void MakeSortBuffer(HRenderContext context, uint32_t tag_count, dmhash_t* tags)
     {
@@ -539,27 +610,32 @@ namespace dmRender
             }
 
             // Write z values...
-            int num_visibility_skipped = 0;
-            for (uint32_t i = range.m_Start; i < range.m_Start+range.m_Count; ++i)
+            uint32_t num_chunks = (range.m_Count + SORT_ZW_CHUNK_SIZE - 1) / SORT_ZW_CHUNK_SIZE;
+            if (context->m_RenderListSortZWResults.Capacity() < num_chunks)
+                context->m_RenderListSortZWResults.SetCapacity(num_chunks);
+            context->m_RenderListSortZWResults.SetSize(num_chunks);
+            SortZWResult* results = context->m_RenderListSortZWResults.Begin();
+            for (uint32_t c = 0; c < num_chunks; ++c)
             {
-                uint32_t idx = context->m_RenderListSortIndices[i];
-                RenderListEntry* entry = &entries[idx];
-                if (entry->m_Visibility == dmRender::VISIBILITY_NONE)
-                {
-                    num_visibility_skipped++;
-                    continue;
-                }
+                results[c].m_MinZW = FLT_MAX;
+                results[c].m_MaxZW = -FLT_MAX;
+                results[c].m_NumVisibilitySkipped = 0;
+            }
 
-                if (entry->m_MajorOrder != RENDER_ORDER_WORLD)
-                {
-                    continue; // Could perhaps break here, if we also sorted on the major order (cost more when I tested it /MAWE)
-                }
+            SortZWContext zw_context;
+            zw_context.m_Indices = context->m_RenderListSortIndices.Begin() + range.m_Start;
+            zw_context.m_Entries = entries;
+            zw_context.m_SortValues = sort_values;
+            zw_context.m_ViewProj = &transform;
+            zw_context.m_Results = results;
+            dmJobThread::ParallelFor(context->m_JobThread, MakeSortValuesZW, &zw_context, 0, range.m_Count, SORT_ZW_CHUNK_SIZE);
 
-                const Vector4 res = transform * entry->m_WorldPosition;
-                const float zw = res.getZ() / res.getW();
-                sort_values[idx].m_ZW = zw;
-                if (zw < minZW) minZW = zw;
-                if (zw > maxZW) maxZW = zw;
+            uint32_t num_visibility_skipped = 0;
+            for (uint32_t c = 0; c < num_chunks; ++c)
+            {
+                minZW = dmMath::Min(minZW, results[c].m_MinZW);
+                maxZW = dmMath::Max(maxZW, results[c].m_MaxZW);
+                num_visibility_skipped += results[c].m_NumVisibilitySkipped;
             }
 
             if (num_visibility_skipped == range.m_Count)
@@ -643,6 +719,45 @@ namespace dmRender
         FindRenderListRanges(first, high - first, size - (high - rangefirst), entries, comp, ctx, callback);
     }
 
+    // Stable sort of the indices on the keys in context->m_RenderListSortKeys, which must have been filled in for all the indices
+    static void RadixSortIndices(HRenderContext context, uint32_t* indices, uint32_t count)
+    {
+        if (context->m_RenderListSortKeysScratch.Capacity() < count)
+        {
+            context->m_RenderListSortKeysScratch.SetCapacity(count);
+            context->m_RenderListSortIndicesScratch.SetCapacity(count);
+        }
+        context->m_RenderListSortKeysScratch.SetSize(count);
+        context->m_RenderListSortIndicesScratch.SetSize(count);
+
+        dmRadixSort::Sort64(context->m_RenderListSortKeys.Begin(), indices,
+                            context->m_RenderListSortKeysScratch.Begin(), context->m_RenderListSortIndicesScratch.Begin(), count);
+    }
+
+    // Same as RadixSortIndices(), but for the 32 bit keys in the first half of context->m_RenderListSortKeys.
+    // The second half is used as the key scratch buffer.
+    static void RadixSortIndices32(HRenderContext context, uint32_t* indices, uint32_t count)
+    {
+        if (context->m_RenderListSortIndicesScratch.Capacity() < count)
+        {
+            context->m_RenderListSortIndicesScratch.SetCapacity(count);
+        }
+        context->m_RenderListSortIndicesScratch.SetSize(count);
+
+        uint32_t* keys = (uint32_t*) context->m_RenderListSortKeys.Begin();
+        dmRadixSort::Sort32(keys, indices, keys + count, context->m_RenderListSortIndicesScratch.Begin(), count);
+    }
+
+    static uint64_t* GetSortKeys(HRenderContext context, uint32_t count)
+    {
+        if (context->m_RenderListSortKeys.Capacity() < count)
+        {
+            context->m_RenderListSortKeys.SetCapacity(count);
+        }
+        context->m_RenderListSortKeys.SetSize(count);
+        return context->m_RenderListSortKeys.Begin();
+    }
+
     static void SortRenderList(HRenderContext context)
     {
         DM_PROFILE("SortRenderList");
@@ -652,9 +767,15 @@ namespace dmRender
 
         // First sort on the tag masks
         {
-            RenderListEntrySorter sort;
-            sort.m_Base = context->m_RenderList.Begin();
-            std::stable_sort(context->m_RenderListSortIndices.Begin(), context->m_RenderListSortIndices.End(), sort);
+            RenderListEntry* entries = context->m_RenderList.Begin();
+            uint32_t* indices = context->m_RenderListSortIndices.Begin();
+            uint32_t count = context->m_RenderListSortIndices.Size();
+            uint32_t* keys = (uint32_t*) GetSortKeys(context, count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                keys[i] = entries[indices[i]].m_TagListKey;
+            }
+            RadixSortIndices32(context, indices, count);
         }
         // Now find the ranges of tag masks
         {
@@ -672,6 +793,106 @@ namespace dmRender
         return a->m_Dispatch == b->m_Dispatch;
     }
 
+    // The fields of a render list entry that the sort order depends on, packed without any padding
+    struct RenderListEntrySortFields
+    {
+        float    m_X, m_Y, m_Z;
+        uint32_t m_Order;
+        uint32_t m_BatchKey;
+        uint32_t m_TagListKey;
+        uint32_t m_Bits; // m_MinorOrder, m_MajorOrder, m_Dispatch and m_Visibility
+    };
+
+    static dmhash_t HashRenderListSortFields(const RenderListEntry* entries, uint32_t count)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+
+        RenderListEntrySortFields fields[64];
+        for (uint32_t start = 0; start < count; start += DM_ARRAY_SIZE(fields))
+        {
+            uint32_t n = dmMath::Min(count - start, (uint32_t) DM_ARRAY_SIZE(fields));
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const RenderListEntry& entry = entries[start + i];
+                RenderListEntrySortFields& f = fields[i];
+                f.m_X          = entry.m_WorldPosition.getX();
+                f.m_Y          = entry.m_WorldPosition.getY();
+                f.m_Z          = entry.m_WorldPosition.getZ();
+                f.m_Order      = entry.m_Order;
+                f.m_BatchKey   = entry.m_BatchKey;
+                f.m_TagListKey = entry.m_TagListKey;
+                f.m_Bits       = entry.m_MinorOrder | (entry.m_MajorOrder << 4) | (entry.m_Dispatch << 6) | (entry.m_Visibility << 14);
+            }
+            dmHashUpdateBuffer64(&state, fields, n * sizeof(RenderListEntrySortFields));
+        }
+        return dmHashFinal64(&state);
+    }
+
+    static void HashMatrix4(HashState64* state, const dmVMath::Matrix4& m)
+    {
+        float values[16];
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                values[c * 4 + r] = m.getElem(c, r);
+            }
+        }
+        dmHashUpdateBuffer64(state, values, sizeof(values));
+    }
+
+    static dmhash_t MakeSortCacheKey(HRenderContext context, HPredicate predicate, dmhash_t frustum_hash)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, &context->m_RenderListHash, sizeof(context->m_RenderListHash));
+        dmHashUpdateBuffer64(&state, &frustum_hash, sizeof(frustum_hash));
+        HashMatrix4(&state, context->m_ViewProj);
+        if (predicate)
+        {
+            // The tags are sorted when the predicate is created
+            dmHashUpdateBuffer64(&state, predicate->m_Tags, sizeof(dmhash_t) * predicate->m_TagCount);
+        }
+        return dmHashFinal64(&state);
+    }
+
+    // Returns the cache entry for the key, or 0 if not found
+    static RenderListSortCacheEntry* FindSortCacheEntry(HRenderContext context, dmhash_t key)
+    {
+        for (uint32_t i = 0; i < MAX_RENDER_LIST_SORT_CACHE_ENTRIES; ++i)
+        {
+            RenderListSortCacheEntry* entry = &context->m_RenderListSortCache[i];
+            if (entry->m_Key == key)
+            {
+                entry->m_LastUsed = context->m_RenderListSortCacheCounter;
+                return entry;
+            }
+        }
+        return 0;
+    }
+
+    // Stores the current sort buffer in the least recently used cache entry
+    static void StoreSortCacheEntry(HRenderContext context, dmhash_t key)
+    {
+        RenderListSortCacheEntry* entry = &context->m_RenderListSortCache[0];
+        for (uint32_t i = 1; i < MAX_RENDER_LIST_SORT_CACHE_ENTRIES; ++i)
+        {
+            RenderListSortCacheEntry* e = &context->m_RenderListSortCache[i];
+            if (e->m_LastUsed < entry->m_LastUsed)
+                entry = e;
+        }
+
+        const dmArray<uint32_t>& sort_buffer = context->m_RenderListSortBuffer;
+        if (entry->m_SortBuffer.Capacity() < sort_buffer.Size())
+            entry->m_SortBuffer.SetCapacity(sort_buffer.Size());
+        entry->m_SortBuffer.SetSize(sort_buffer.Size());
+        if (!sort_buffer.Empty())
+            memcpy(entry->m_SortBuffer.Begin(), sort_buffer.Begin(), sizeof(uint32_t) * sort_buffer.Size());
+        entry->m_Key = key;
+        entry->m_LastUsed = context->m_RenderListSortCacheCounter;
+    }
+
     static void SetVisibility(uint32_t count, RenderListEntry* entries, Visibility visibility)
     {
         for (uint32_t i = 0; i < count; ++i)
@@ -680,6 +901,35 @@ namespace dmRender
         }
     }
 
+    // Number of entries per call to a thread safe visibility function
+    static const uint32_t CULLING_CHUNK_SIZE = 1024;
+
+    struct FrustumCullingContext
+    {
+        HRenderContext                  m_RenderContext;
+        const dmIntersection::Frustum*  m_Frustum;
+    };
+
+    static void FrustumCullingChunks(void* _context, void* data, uint32_t start, uint32_t end)
+    {
+        FrustumCullingContext* context = (FrustumCullingContext*)_context;
+        const RenderListCullingChunk* chunks = (const RenderListCullingChunk*)data;
+        RenderListEntry* entries = context->m_RenderContext->m_RenderList.Begin();
+
+        for (uint32_t i = start; i < end; ++i)
+        {
+            const RenderListCullingChunk& chunk = chunks[i];
+            const RenderListDispatch* d = &context->m_RenderContext->m_RenderListDispatch[chunk.m_Dispatch];
+
+            RenderListVisibilityParams params;
+            params.m_Frustum = context->m_Frustum;
+            params.m_UserData = d->m_UserData;
+            params.m_Entries = entries + chunk.m_Start;
+            params.m_NumEntries = chunk.m_Count;
+            d->m_VisibilityFn(params);
+        }
+    }
+
     static void FrustumCulling(HRenderContext context, const dmIntersection::Frustum& frustum)
     {
         DM_PROFILE("FrustumCulling");
@@ -688,7 +938,11 @@ namespace dmRender
         if (num_entries == 0)
             return;
 
-        BatchIterator<RenderListEntry*> iter(num_entries, context->m_RenderList.Begin(), RenderListEntryEqFn);
+        RenderListEntry* entries = context->m_RenderList.Begin();
+        dmArray<RenderListCullingChunk>& chunks = context->m_RenderListCullingChunks;
+        chunks.SetSize(0);
+
+        BatchIterator<RenderListEntry*> iter(num_entries, entries, RenderListEntryEqFn);
         while(iter.Next())
         {
             RenderListEntry* batch_start = iter.Begin();
@@ -698,6 +952,22 @@ namespace dmRender
             {
                 SetVisibility(iter.Length(), iter.Begin(), dmRender::VISIBILITY_FULL);
             }
+            else if (context->m_JobThread && (d->m_Flags & RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY))
+            {
+                // Defer, so that all thread safe batches are culled in one go
+                uint32_t batch_offset = batch_start - entries;
+                uint32_t batch_length = iter.Length();
+                for (uint32_t start = 0; start < batch_length; start += CULLING_CHUNK_SIZE)
+                {
+                    if (chunks.Full())
+                        chunks.OffsetCapacity(dmMath::Max(64U, chunks.Capacity()));
+                    RenderListCullingChunk chunk;
+                    chunk.m_Start = batch_offset + start;
+                    chunk.m_Count = dmMath::Min(CULLING_CHUNK_SIZE, batch_length - start);
+                    chunk.m_Dispatch = batch_start->m_Dispatch;
+                    chunks.Push(chunk);
+                }
+            }
             else {
                 RenderListVisibilityParams params;
                 params.m_Frustum = &frustum;
@@ -707,6 +977,14 @@ namespace dmRender
                 d->m_VisibilityFn(params);
             }
         }
+
+        if (!chunks.Empty())
+        {
+            FrustumCullingContext culling_context;
+            culling_context.m_RenderContext = context;
+            culling_context.m_Frustum = &frustum;
+            dmJobThread::ParallelFor(context->m_JobThread, FrustumCullingChunks, &culling_context, chunks.Begin(), chunks.Size(), 1);
+        }
     }
 
     void SetTextureBindingByHash(dmRender::HRenderContext render_context, dmhash_t sampler_hash, dmGraphics::HTexture texture)
@@ -866,12 +1144,6 @@ namespace dmRender
             }
         }
 
-        // Cleared once per frame
-        if (context->m_RenderListRanges.Empty())
-        {
-            SortRenderList(context);
-        }
-
         dmhash_t frustum_hash = frustum_matrix ? dmHashBuffer64((const void*) frustum_matrix, 16*sizeof(float)) : 0;
 
         if (context->m_FrustumHash != frustum_hash)
@@ -890,20 +1162,58 @@ namespace dmRender
                 // Reset the visibility
                 SetVisibility(context->m_RenderList.Size(), context->m_RenderList.Begin(), dmRender::VISIBILITY_FULL);
             }
+
+            // The sort order only depends on the entries (and their visibility), which only change when
+            // the entries are submitted or culled, so this is where we detect if the render list has changed
+            DM_PROFILE("DrawRenderList_HASH");
+            context->m_RenderListHash = HashRenderListSortFields(context->m_RenderList.Begin(), context->m_RenderList.Size());
         }
 
-        MakeSortBuffer(context, predicate?predicate->m_TagCount:0, predicate?predicate->m_Tags:0);
+        // Reuse the sort order from a previous draw call (this or an earlier frame) with the same render list,
+        // predicate, view projection and frustum
+        context->m_RenderListSortCacheCounter++;
+        dmhash_t sort_cache_key = MakeSortCacheKey(context, predicate, frustum_hash);
+        RenderListSortCacheEntry* sort_cache_entry = FindSortCacheEntry(context, sort_cache_key);
+        if (sort_cache_entry)
+        {
+            context->m_RenderListSortCacheHits++;
+            const dmArray<uint32_t>& cached = sort_cache_entry->m_SortBuffer;
+            if (context->m_RenderListSortBuffer.Capacity() < cached.Size())
+                context->m_RenderListSortBuffer.SetCapacity(cached.Size());
+            context->m_RenderListSortBuffer.SetSize(cached.Size());
+            if (!cached.Empty())
+                memcpy(context->m_RenderListSortBuffer.Begin(), cached.Begin(), sizeof(uint32_t) * cached.Size());
+        }
+        else
+        {
+            // Cleared once per frame
+            if (context->m_RenderListRanges.Empty())
+            {
+                SortRenderList(context);
+            }
 
-        if (context->m_RenderListSortBuffer.Empty())
-            return RESULT_OK;
+            MakeSortBuffer(context, predicate?predicate->m_TagCount:0, predicate?predicate->m_Tags:0);
 
-        {
-            DM_PROFILE("DrawRenderList_SORT");
-            RenderListSorter sort;
-            sort.values = context->m_RenderListSortValues.Begin();
-            std::stable_sort(context->m_RenderListSortBuffer.Begin(), context->m_RenderListSortBuffer.End(), sort);
+            if (!context->m_RenderListSortBuffer.Empty())
+            {
+                DM_PROFILE("DrawRenderList_SORT");
+                const RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
+                uint32_t* indices = context->m_RenderListSortBuffer.Begin();
+                uint32_t count = context->m_RenderListSortBuffer.Size();
+                uint64_t* keys = GetSortKeys(context, count);
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    keys[i] = sort_values[indices[i]].m_SortKey;
+                }
+                RadixSortIndices(context, indices, count);
+            }
+
+            StoreSortCacheEntry(context, sort_cache_key);
         }
 
+        if (context->m_RenderListSortBuffer.Empty())
+            return RESULT_OK;
+
         // Construct render objects
         context->m_RenderObjects.SetSize(0);
 
@@ -1043,6 +1353,81 @@ namespace dmRender
         TrimTextureBindingTable(render_context);
     }
 
+    // The program binding of the sampler uniforms is per program, so all texture units need to apply their samplers again
+    static void EnableStateCacheProgram(HRenderContext render_context, dmGraphics::HProgram program)
+    {
+        RenderStateCache& cache = render_context->m_StateCache;
+        if (cache.m_Program == program)
+        {
+            cache.m_ElidedCount++;
+            return;
+        }
+
+        dmGraphics::EnableProgram(render_context->m_GraphicsContext, program);
+        cache.m_Program = program;
+        cache.m_Constants.Clear();
+
+        for (uint32_t i = 0; i < cache.m_TextureUnits.Size(); ++i)
+        {
+            cache.m_TextureUnits[i].m_SamplerDirty = 1;
+        }
+    }
+
+    static void EnableStateCacheTexture(HRenderContext render_context, uint8_t unit, uint8_t sub_handle, dmGraphics::HTexture texture, HSampler sampler)
+    {
+        RenderStateCache& cache = render_context->m_StateCache;
+        if (unit >= cache.m_TextureUnits.Size())
+        {
+            if (unit >= cache.m_TextureUnits.Capacity())
+            {
+                cache.m_TextureUnits.SetCapacity(unit + 4);
+            }
+            uint32_t first_new = cache.m_TextureUnits.Size();
+            cache.m_TextureUnits.SetSize(unit + 1);
+            memset(&cache.m_TextureUnits[first_new], 0, sizeof(RenderStateCache::TextureUnit) * (unit + 1 - first_new));
+        }
+
+        RenderStateCache::TextureUnit& bound = cache.m_TextureUnits[unit];
+        if (bound.m_Texture == texture && bound.m_SubHandle == sub_handle && bound.m_Sampler == sampler && !bound.m_SamplerDirty)
+        {
+            cache.m_ElidedCount += sampler ? 2 : 1;
+            return;
+        }
+
+        dmGraphics::EnableTexture(render_context->m_GraphicsContext, unit, sub_handle, texture);
+        ApplyProgramSampler(render_context, sampler, unit, texture);
+
+        bound.m_Texture      = texture;
+        bound.m_SubHandle    = sub_handle;
+        bound.m_Sampler      = sampler;
+        bound.m_SamplerDirty = 0;
+
+        // The sampler settings are stored in the texture, so other units using the same texture need to apply theirs again
+        for (uint32_t i = 0; i < cache.m_TextureUnits.Size(); ++i)
+        {
+            if (i != unit && cache.m_TextureUnits[i].m_Texture == texture)
+            {
+                cache.m_TextureUnits[i].m_SamplerDirty = 1;
+            }
+        }
+    }
+
+    static void DisableStateCacheTextures(HRenderContext render_context, uint8_t first_unit)
+    {
+        RenderStateCache& cache = render_context->m_StateCache;
+        for (uint32_t i = first_unit; i < cache.m_TextureUnits.Size(); ++i)
+        {
+            if (cache.m_TextureUnits[i].m_Texture)
+            {
+                dmGraphics::DisableTexture(render_context->m_GraphicsContext, i, cache.m_TextureUnits[i].m_Texture);
+            }
+        }
+        if (first_unit < cache.m_TextureUnits.Size())
+        {
+            cache.m_TextureUnits.SetSize(first_unit);
+        }
+    }
+
     // NOTE: Currently only used externally in 1 test (fontview.cpp)
     // TODO: Replace that occurrance with DrawRenderList
     Result Draw(HRenderContext render_context, HPredicate predicate, HNamedConstantBuffer constant_buffer)
@@ -1056,9 +1441,16 @@ namespace dmRender
         HMaterial material         = render_context->m_Material;
         HMaterial context_material = render_context->m_Material;
 
+        RenderStateCache& state_cache = render_context->m_StateCache;
+        uint32_t elided_count_start   = state_cache.m_ElidedCount;
+        state_cache.m_Active          = 1;
+        state_cache.m_Program         = 0;
+        state_cache.m_Constants.Clear();
+        state_cache.m_TextureUnits.SetSize(0);
+
         if(context_material)
         {
-            dmGraphics::EnableProgram(context, GetMaterialProgram(context_material));
+            EnableStateCacheProgram(render_context, GetMaterialProgram(context_material));
             GetRenderContextTextures(render_context, context_material->m_Samplers, render_context_textures);
         }
 
@@ -1084,7 +1476,7 @@ namespace dmRender
                 if(material != ro->m_Material)
                 {
                     material = ro->m_Material;
-                    dmGraphics::EnableProgram(context, GetMaterialProgram(material));
+                    EnableStateCacheProgram(render_context, GetMaterialProgram(material));
 
                     // Reset the override texture binding array. The new material may have a different
                     // resource layout than the current material.
@@ -1118,14 +1510,15 @@ namespace dmRender
                     for (int sub_handle = 0; sub_handle < num_texture_handles; ++sub_handle)
                     {
                         HSampler sampler = GetProgramSampler(material->m_Samplers, next_texture_unit);
-                        dmGraphics::EnableTexture(context, next_texture_unit, sub_handle, texture);
-                        ApplyProgramSampler(render_context, sampler, next_texture_unit, texture);
-
+                        EnableStateCacheTexture(render_context, next_texture_unit, sub_handle, texture, sampler);
                         next_texture_unit++;
                     }
                 }
             }
 
+            // Units still bound by the previous render object, but not used by this one
+            DisableStateCacheTextures(render_context, next_texture_unit);
+
             dmGraphics::HProgram material_program = GetMaterialProgram(material);
 
             for (int i = 0; i < RenderObject::MAX_VERTEX_BUFFER_COUNT; ++i)
@@ -1157,24 +1550,12 @@ namespace dmRender
                     dmGraphics::DisableVertexDeclaration(context, ro->m_VertexDeclarations[i]);
                 }
             }
-
-            next_texture_unit = 0;
-            for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
-            {
-                dmGraphics::HTexture texture = ro->m_Textures[i];
-                if (render_context_textures[i])
-                    texture = render_context_textures[i];
-                if (texture)
-                {
-                    for (int sub_handle = 0; sub_handle < dmGraphics::GetNumTextureHandles(texture); ++sub_handle)
-                    {
-                        dmGraphics::DisableTexture(context, next_texture_unit, texture);
-                        next_texture_unit++;
-                    }
-                }
-            }
         }
 
+        DisableStateCacheTextures(render_context, 0);
+        state_cache.m_Active = 0;
+        DM_PROPERTY_ADD_U32(rmtp_RenderStateElided, state_cache.m_ElidedCount - elided_count_start);
+
         ResetRenderStateIfChanged(context, ps_orig, dmGraphics::GetPipelineState(context));
 
         TrimTextureBindingTable(render_context);
@@ -21,6 +21,7 @@
 #include <dmsdk/render/render.h>
 
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <script/script.h>
 #include <script/lua_source_ddf.h>
 #include <graphics/graphics.h>
@@ -135,6 +136,7 @@ namespace dmRender
 
         dmScript::HContext              m_ScriptContext;
         HFontMap                        m_SystemFontMap;
+        dmJobThread::HContext           m_JobThread;            // Used for culling and sorting large render lists. May be 0
         void*                           m_VertexShaderDesc;
         void*                           m_FragmentShaderDesc;
         uint32_t                        m_MaxRenderTypes;
@@ -183,6 +185,9 @@ namespace dmRender
 
     dmGraphics::HContext GetGraphicsContext(HRenderContext render_context);
 
+    // Returns the job thread context used by the render context. May be 0
+    dmJobThread::HContext GetJobThreadContext(HRenderContext render_context);
+
     const dmVMath::Matrix4& GetViewProjectionMatrix(HRenderContext render_context);
     const dmVMath::Matrix4& GetViewMatrix(HRenderContext render_context);
     dmVMath::Matrix4 GetNormalMatrix(HRenderContext render_context, const dmVMath::Matrix4& world_matrix);
@@ -144,6 +144,8 @@ namespace dmRender
 
     const int MAX_TEXT_RENDER_CONSTANTS = 16;
 
+    struct TextLayout; // See font_renderer.cpp
+
     struct TextEntry
     {
         StencilTestParams   m_StencilTestParams;
@@ -151,6 +153,7 @@ namespace dmRender
         HConstant           m_RenderConstants[MAX_TEXT_RENDER_CONSTANTS];
         HFontMap            m_FontMap;
         HMaterial           m_Material;
+        TextLayout*         m_Layout;
         dmGraphics::BlendFactor m_SourceBlendFactor;
         dmGraphics::BlendFactor m_DestinationBlendFactor;
         uint64_t            m_BatchKey;
@@ -188,6 +191,10 @@ namespace dmRender
         dmArray<char>                       m_TextBuffer;
         // Map from batch id (hash of font-map etc) to index into m_TextEntries
         dmArray<TextEntry>                  m_TextEntries;
+        // Layouts of the recently drawn texts, by font map, text and layout parameters
+        dmHashTable64<TextLayout*>          m_LayoutCache;
+        dmArray<TextLayout*>                m_Layouts;      // The layouts in m_LayoutCache
+        dmArray<TextLayout*>                m_FreeLayouts;
         uint32_t                            m_TextEntriesFlushed;
         uint32_t                            m_Frame;
         uint32_t                            m_PreviousFrame;
@@ -206,6 +213,23 @@ namespace dmRender
         RenderListDispatchFn        m_DispatchFn;
         RenderListVisibilityFn      m_VisibilityFn;
         void*                       m_UserData;
+        uint32_t                    m_Flags;    // RenderListDispatchFlags
+    };
+
+    // The z/w range of a part of the render list, see MakeSortBuffer()
+    struct SortZWResult
+    {
+        float    m_MinZW;
+        float    m_MaxZW;
+        uint32_t m_NumVisibilitySkipped;
+    };
+
+    // A part of a render list, to be culled by a thread safe visibility function
+    struct RenderListCullingChunk
+    {
+        uint32_t m_Start;
+        uint32_t m_Count;
+        uint8_t  m_Dispatch;
     };
 
     struct RenderListSortValue
@@ -235,6 +259,17 @@ namespace dmRender
         uint32_t m_Skip:1;      // During the current draw call
     };
 
+    // A sorted draw call, i.e. the sort buffer produced by DrawRenderList() for a given
+    // render list, predicate, view projection and frustum
+    struct RenderListSortCacheEntry
+    {
+        dmArray<uint32_t>   m_SortBuffer;
+        dmhash_t            m_Key;      // 0 if unused
+        uint32_t            m_LastUsed; // Value of RenderContext::m_RenderListSortCacheCounter when last used
+    };
+
+    const uint32_t MAX_RENDER_LIST_SORT_CACHE_ENTRIES = 8;
+
     struct MaterialTagList
     {
         uint32_t m_Count;
@@ -247,6 +282,25 @@ namespace dmRender
         dmGraphics::HTexture m_Texture;
     };
 
+    // Tracks the state bound while Draw() draws its render objects, so that state shared by
+    // consecutive render objects isn't set again
+    struct RenderStateCache
+    {
+        struct TextureUnit
+        {
+            dmGraphics::HTexture m_Texture;
+            HSampler             m_Sampler;
+            uint8_t              m_SubHandle;
+            uint8_t              m_SamplerDirty : 1; // The texture parameters were changed through another unit
+        };
+
+        dmHashTable64<dmhash_t> m_Constants;    // Uniform location -> hash of the values last set for the current program
+        dmArray<TextureUnit>    m_TextureUnits;
+        dmGraphics::HProgram    m_Program;
+        uint32_t                m_ElidedCount;  // Number of skipped graphics calls since the context was created
+        uint32_t                m_Active : 1;
+    };
+
     struct RenderCamera
     {
         dmMessage::URL   m_URL;
@@ -280,10 +334,20 @@ namespace dmRender
         dmArray<RenderListDispatch> m_RenderListDispatch;
         dmArray<RenderListSortValue>m_RenderListSortValues;
         dmArray<uint32_t>           m_RenderListSortBuffer;
+        dmArray<uint64_t>           m_RenderListSortKeys;           // Radix sort keys, and scratch buffers for the radix sort
+        dmArray<uint64_t>           m_RenderListSortKeysScratch;
+        dmArray<uint32_t>           m_RenderListSortIndicesScratch;
         dmArray<uint32_t>           m_RenderListSortIndices;
         dmArray<RenderListRange>    m_RenderListRanges;         // Maps tagmask to a range in the (sorted) render list
+        dmArray<RenderListCullingChunk> m_RenderListCullingChunks;
+        dmArray<SortZWResult>       m_RenderListSortZWResults;
         dmArray<TextureBinding>     m_TextureBindTable;
+        RenderStateCache            m_StateCache;
         dmhash_t                    m_FrustumHash;
+        dmhash_t                    m_RenderListHash;           // Hash of the sorted fields of the render list entries (including visibility), updated after culling
+        RenderListSortCacheEntry    m_RenderListSortCache[MAX_RENDER_LIST_SORT_CACHE_ENTRIES];
+        uint32_t                    m_RenderListSortCacheCounter;
+        uint32_t                    m_RenderListSortCacheHits;  // Number of draw calls that reused a cached sort order
 
         dmHashTable32<MaterialTagList>  m_MaterialTagLists;
 
@@ -295,6 +359,7 @@ namespace dmRender
         Matrix4                     m_Projection;
         Matrix4                     m_ViewProj;
         dmGraphics::HContext        m_GraphicsContext;
+        dmJobThread::HContext       m_JobThread;
         HMaterial                   m_Material;
         HComputeProgram             m_ComputeProgram;
         dmMessage::HSocket          m_Socket;
@@ -332,6 +397,10 @@ namespace dmRender
     HSampler GetProgramSampler(const dmArray<Sampler>& samplers, uint32_t unit);
     void     ApplyProgramSampler(dmRender::HRenderContext render_context, HSampler sampler, uint8_t unit, dmGraphics::HTexture texture);
 
+    // Sets the constant values, unless they are already set for the current program (only tracked while Draw() is drawing)
+    void     SetProgramConstantV4(dmRender::HRenderContext render_context, const dmVMath::Vector4* values, uint32_t count, dmGraphics::HUniformLocation location);
+    void     SetProgramConstantM4(dmRender::HRenderContext render_context, const dmVMath::Vector4* values, uint32_t count, dmGraphics::HUniformLocation location);
+
     void FillElementIds(char* buffer, uint32_t buffer_size, dmhash_t element_ids[4]);
 
     // Return true if the predicate tags all exist in the material tag list
@@ -355,17 +424,6 @@ namespace dmRender
     RenderCamera* CheckRenderCamera(lua_State* L, int index, HRenderContext render_context);
 
     // Exposed here for unit testing
-    struct RenderListEntrySorter
-    {
-        bool operator()(int a, int b) const
-        {
-            const RenderListEntry& ea = m_Base[a];
-            const RenderListEntry& eb = m_Base[b];
-            return ea.m_TagListKey < eb.m_TagListKey;
-        }
-        RenderListEntry* m_Base;
-    };
-
     struct FindRangeComparator
     {
         RenderListEntry* m_Entries;
@@ -20,9 +20,9 @@
 #include <testmain/testmain.h>
 #include <dlib/hash.h>
 #include <dlib/math.h>
+#include <dlib/radix_sort.h>
 
 #include <script/script.h>
-#include <algorithm> // std::stable_sort
 
 #include "test_render.h"
 
@@ -48,7 +48,8 @@ using namespace dmVMath;
 static dmRender::FontGlyph* GetGlyph(uint32_t utf8, void* user_ctx)
 {
     dmRender::FontGlyph* glyphs = (dmRender::FontGlyph*)user_ctx;
-    return &glyphs[utf8];
+    // Glyphs with another character are treated as removed from the font
+    return glyphs[utf8].m_Character == utf8 ? &glyphs[utf8] : 0;
 }
 
 static void* GetGlyphData(uint32_t codepoint, void* user_ctx, uint32_t* out_size, uint32_t* out_compression, uint32_t* out_width, uint32_t* out_height)
@@ -981,6 +982,116 @@ TEST_F(dmRenderTest, TestDefaultSamplerFilters)
     dmGraphics::DeleteVertexDeclaration(vx_decl);
 }
 
+TEST_F(dmRenderTest, TestRenderStateCache)
+{
+    const char* shader_src = "uniform vec4 tint;\n"
+                             "uniform lowp sampler2D texture_sampler;\n";
+
+    dmGraphics::ShaderDesc::ResourceBinding uniforms[2] = {};
+    FillResourceBinding(&uniforms[0], "tint", dmGraphics::ShaderDesc::SHADER_TYPE_VEC4);
+    FillResourceBinding(&uniforms[1], "texture_sampler", dmGraphics::ShaderDesc::SHADER_TYPE_SAMPLER2D);
+
+    dmGraphics::ShaderDesc::Shader shader = MakeDDFShader(dmGraphics::ShaderDesc::LANGUAGE_GLSL_SM140, shader_src, strlen(shader_src));
+    dmGraphics::ShaderDesc vs_desc        = MakeDDFShaderDesc(&shader, dmGraphics::ShaderDesc::SHADER_TYPE_VERTEX, 0, 0, uniforms, 2);
+    dmGraphics::ShaderDesc fs_desc        = MakeDDFShaderDesc(&shader, dmGraphics::ShaderDesc::SHADER_TYPE_FRAGMENT, 0, 0, uniforms, 2);
+    dmGraphics::HVertexProgram vp         = dmGraphics::NewVertexProgram(m_GraphicsContext, &vs_desc, 0, 0);
+    dmGraphics::HFragmentProgram fp       = dmGraphics::NewFragmentProgram(m_GraphicsContext, &fs_desc, 0, 0);
+    dmRender::HMaterial material          = dmRender::NewMaterial(m_Context, vp, fp);
+
+    ASSERT_TRUE(dmRender::SetMaterialSampler(material,
+        dmHashString64("texture_sampler"), 0,
+        dmGraphics::TEXTURE_WRAP_REPEAT,
+        dmGraphics::TEXTURE_WRAP_REPEAT,
+        dmGraphics::TEXTURE_FILTER_NEAREST,
+        dmGraphics::TEXTURE_FILTER_NEAREST,
+        1.0f));
+
+    dmGraphics::TextureCreationParams creation_params;
+    creation_params.m_Width          = 2;
+    creation_params.m_Height         = 2;
+    creation_params.m_OriginalWidth  = 2;
+    creation_params.m_OriginalHeight = 2;
+    dmGraphics::HTexture texture     = dmGraphics::NewTexture(m_GraphicsContext, creation_params);
+
+    uint8_t tex_data[2 * 2];
+    dmGraphics::TextureParams params;
+    params.m_DataSize  = sizeof(tex_data);
+    params.m_Data      = tex_data;
+    params.m_Width     = creation_params.m_Width;
+    params.m_Height    = creation_params.m_Height;
+    params.m_Format    = dmGraphics::TEXTURE_FORMAT_LUMINANCE;
+    dmGraphics::SetTexture(texture, params);
+
+    dmGraphics::HVertexDeclaration vx_decl = dmGraphics::NewVertexDeclaration(m_GraphicsContext, 0, 0);
+    dmGraphics::HVertexBuffer vx_buffer    = dmGraphics::NewVertexBuffer(m_GraphicsContext, 0, 0, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+
+    dmRender::RenderObject ros[2];
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(ros); ++i)
+    {
+        ros[i].Init();
+        ros[i].m_Material          = material;
+        ros[i].m_VertexCount       = 1;
+        ros[i].m_VertexDeclaration = vx_decl;
+        ros[i].m_VertexBuffer      = vx_buffer;
+        ros[i].m_Textures[0]       = texture;
+    }
+
+    dmGraphics::NullContext* null_context = (dmGraphics::NullContext*) m_GraphicsContext;
+
+    // Both render objects share program, texture and constant values, so they are only set once
+    {
+        null_context->m_SetConstantCount   = 0;
+        null_context->m_EnableTextureCount = 0;
+        uint32_t elided_count = m_Context->m_StateCache.m_ElidedCount;
+
+        dmRender::ClearRenderObjects(m_Context);
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ros[0]));
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ros[1]));
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(m_Context, 0, 0));
+
+        ASSERT_EQ(1, null_context->m_SetConstantCount);
+        ASSERT_EQ(1, null_context->m_EnableTextureCount);
+        ASSERT_LT(elided_count, m_Context->m_StateCache.m_ElidedCount);
+        ASSERT_EQ(0, null_context->m_Textures[0]);
+    }
+
+    // A different constant value is set again
+    {
+        dmRender::HNamedConstantBuffer constants = dmRender::NewNamedConstantBuffer();
+        Vector4 tint(1.0f, 2.0f, 3.0f, 4.0f);
+        dmRender::SetNamedConstant(constants, dmHashString64("tint"), &tint, 1);
+        ros[1].m_ConstantBuffer = constants;
+
+        null_context->m_SetConstantCount   = 0;
+        null_context->m_EnableTextureCount = 0;
+
+        dmRender::ClearRenderObjects(m_Context);
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ros[0]));
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ros[1]));
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(m_Context, 0, 0));
+
+        // The material default for ros[1] is elided, but the override from the constant buffer is not
+        ASSERT_EQ(2, null_context->m_SetConstantCount);
+        ASSERT_EQ(1, null_context->m_EnableTextureCount);
+
+        dmGraphics::HUniformLocation tint_loc = dmGraphics::GetUniformLocation(dmRender::GetMaterialProgram(material), "tint");
+        ASSERT_VEC4(tint, null_context->m_ProgramRegisters[tint_loc]);
+
+        ros[1].m_ConstantBuffer = 0;
+        dmRender::DeleteNamedConstantBuffer(constants);
+    }
+
+    dmRender::ClearRenderObjects(m_Context);
+
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+    dmRender::DeleteMaterial(m_Context, material);
+
+    dmGraphics::DeleteTexture(texture);
+    dmGraphics::DeleteVertexBuffer(vx_buffer);
+    dmGraphics::DeleteVertexDeclaration(vx_decl);
+}
+
 
 static void TestDrawVisibilityDispatch(dmRender::RenderListDispatchParams const & params)
 {
@@ -1137,6 +1248,85 @@ TEST_F(dmRenderTest, TestRenderListCulling)
     }
 }
 
+static void TestCullOddVisibility(dmRender::RenderListVisibilityParams const &params)
+{
+    for (uint32_t i = 0; i < params.m_NumEntries; ++i)
+    {
+        dmRender::RenderListEntry* entry = &params.m_Entries[i];
+        entry->m_Visibility = (entry->m_UserData & 1) ? dmRender::VISIBILITY_NONE : dmRender::VISIBILITY_FULL;
+    }
+}
+
+struct TestCullParallelDispatchCtx
+{
+    uint32_t m_EntriesRendered;
+    uint32_t m_OddEntriesRendered;
+    float    m_LastZ;
+    bool     m_Sorted;
+};
+
+static void TestCullParallelDispatch(dmRender::RenderListDispatchParams const &params)
+{
+    TestCullParallelDispatchCtx* ctx = (TestCullParallelDispatchCtx*)params.m_UserData;
+    if (params.m_Operation != dmRender::RENDER_LIST_OPERATION_BATCH)
+        return;
+    for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+    {
+        const dmRender::RenderListEntry& entry = params.m_Buf[*i];
+        ctx->m_EntriesRendered++;
+        ctx->m_OddEntriesRendered += entry.m_UserData & 1;
+        // Back to front
+        ctx->m_Sorted = ctx->m_Sorted && entry.m_WorldPosition.getZ() >= ctx->m_LastZ;
+        ctx->m_LastZ = entry.m_WorldPosition.getZ();
+    }
+}
+
+TEST_F(dmRenderTest, TestRenderListCullingParallel)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "TestJobThread";
+    job_thread_create_params.m_ThreadCount    = 4;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_params);
+    m_Context->m_JobThread = job_thread;
+
+    dmRender::SetViewMatrix(m_Context, dmVMath::Matrix4::identity());
+    dmRender::SetProjectionMatrix(m_Context, dmVMath::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, -1.0f, 1.0f));
+
+    TestCullParallelDispatchCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.m_LastZ = -1.0f;
+    ctx.m_Sorted = true;
+
+    // Large enough to be split into several culling and z/w jobs
+    const uint32_t n = 20000;
+    dmRender::RenderListBegin(m_Context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestCullParallelDispatch, TestCullOddVisibility, &ctx, dmRender::RENDER_LIST_DISPATCH_FLAG_THREAD_SAFE_VISIBILITY);
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry& entry = out[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.m_WorldPosition = Point3(0, 0, ((i * 7919) % n) / (float)n);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = i;
+    }
+    dmRender::RenderListSubmit(m_Context, out, out + n);
+    dmRender::RenderListEnd(m_Context);
+
+    dmRender::FrustumOptions frustum_options;
+    frustum_options.m_Matrix = dmVMath::Matrix4::orthographic(-1.0f, 1.0f, -1.0f, 1.0f, -10.0f, 10.0f);
+    frustum_options.m_NumPlanes = dmRender::FRUSTUM_PLANES_SIDES;
+    dmRender::DrawRenderList(m_Context, 0, 0, &frustum_options);
+
+    ASSERT_EQ(n / 2, ctx.m_EntriesRendered);
+    ASSERT_EQ(0u, ctx.m_OddEntriesRendered);
+    ASSERT_TRUE(ctx.m_Sorted);
+
+    m_Context->m_JobThread = 0;
+    dmJobThread::Destroy(job_thread);
+}
+
 struct TestRenderListOrderDispatchCtx
 {
     int m_BeginCalls;
@@ -1257,6 +1447,95 @@ TEST_F(dmRenderTest, TestRenderListOrder)
     ASSERT_EQ(ctx.m_Z, orders[2]);
 }
 
+struct TestRenderListSortCacheDispatchCtx
+{
+    uint64_t m_Rendered[8];
+    uint32_t m_RenderedCount;
+};
+
+static void TestRenderListSortCacheDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    TestRenderListSortCacheDispatchCtx* ctx = (TestRenderListSortCacheDispatchCtx*)params.m_UserData;
+    if (params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH)
+    {
+        for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+        {
+            ctx->m_Rendered[ctx->m_RenderedCount++] = params.m_Buf[*i].m_UserData;
+        }
+    }
+}
+
+static void SubmitSortCacheEntries(dmRender::HRenderContext context, TestRenderListSortCacheDispatchCtx* ctx, const float* z, uint32_t n)
+{
+    dmRender::RenderListBegin(context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(context, TestRenderListSortCacheDispatch, 0, ctx);
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry& entry = out[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.m_WorldPosition = Point3(0, 0, z[i]);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_BatchKey = i; // One batch per entry
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = i;
+    }
+    dmRender::RenderListSubmit(context, out, out + n);
+    dmRender::RenderListEnd(context);
+}
+
+TEST_F(dmRenderTest, TestRenderListSortCache)
+{
+    dmRender::SetViewMatrix(m_Context, dmVMath::Matrix4::identity());
+    dmRender::SetProjectionMatrix(m_Context, dmVMath::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, -1.0f, 1.0f));
+
+    const uint32_t n = 3;
+    const float z_back_to_front[n] = { 0.1f, 0.2f, 0.3f };
+    const float z_front_to_back[n] = { 0.3f, 0.2f, 0.1f };
+
+    TestRenderListSortCacheDispatchCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    uint32_t hits = m_Context->m_RenderListSortCacheHits;
+
+    // Two draw calls in the same frame, the second one reuses the sort order of the first one
+    SubmitSortCacheEntries(m_Context, &ctx, z_back_to_front, n);
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(hits, m_Context->m_RenderListSortCacheHits);
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(hits + 1, m_Context->m_RenderListSortCacheHits);
+    ASSERT_EQ(2*n, ctx.m_RenderedCount);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(ctx.m_Rendered[i], ctx.m_Rendered[n + i]);
+    }
+    uint64_t first = ctx.m_Rendered[0];
+
+    // Same contents next frame
+    memset(&ctx, 0, sizeof(ctx));
+    SubmitSortCacheEntries(m_Context, &ctx, z_back_to_front, n);
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(hits + 2, m_Context->m_RenderListSortCacheHits);
+    ASSERT_EQ(n, ctx.m_RenderedCount);
+    ASSERT_EQ(first, ctx.m_Rendered[0]);
+
+    // Changed contents must not use the cached order
+    memset(&ctx, 0, sizeof(ctx));
+    SubmitSortCacheEntries(m_Context, &ctx, z_front_to_back, n);
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(hits + 2, m_Context->m_RenderListSortCacheHits);
+    ASSERT_EQ(n, ctx.m_RenderedCount);
+    ASSERT_EQ(first, ctx.m_Rendered[n - 1]);
+
+    // Changed view projection must not use the cached order
+    memset(&ctx, 0, sizeof(ctx));
+    dmRender::SetProjectionMatrix(m_Context, dmVMath::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, 1.0f, -1.0f));
+    SubmitSortCacheEntries(m_Context, &ctx, z_front_to_back, n);
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(hits + 2, m_Context->m_RenderListSortCacheHits);
+    ASSERT_EQ(n, ctx.m_RenderedCount);
+    ASSERT_EQ(first, ctx.m_Rendered[0]);
+}
+
 TEST_F(dmRenderTest, TestRenderListDebug)
 {
     // Test submitting debug drawing when there is no other drawing going on
@@ -1503,6 +1782,75 @@ TEST_F(dmRenderTest, TextAlignment)
     }
 }
 
+TEST_F(dmRenderTest, TextLayoutCache)
+{
+    dmRender::TextContext& text_context = m_Context->m_TextContext;
+    ASSERT_EQ(0u, text_context.m_LayoutCache.Size());
+
+    const int charwidth = 2;
+
+    dmRender::DrawTextParams params;
+    params.m_Text = "Hello World Bonanza";
+    params.m_Width = 8*charwidth;
+    params.m_LineBreak = true;
+
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(2u, text_context.m_TextEntries.Size());
+    ASSERT_EQ(1u, text_context.m_LayoutCache.Size());
+    ASSERT_EQ(text_context.m_TextEntries[0].m_Layout, text_context.m_TextEntries[1].m_Layout);
+    dmRender::TextLayout* layout = text_context.m_TextEntries[0].m_Layout;
+
+    // The leading doesn't change the layout, but the width does
+    params.m_Leading = 2.0f;
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(1u, text_context.m_LayoutCache.Size());
+    ASSERT_EQ(layout, text_context.m_TextEntries[2].m_Layout);
+
+    params.m_Width = 100*charwidth;
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(2u, text_context.m_LayoutCache.Size());
+    ASSERT_NE(layout, text_context.m_TextEntries[3].m_Layout);
+
+    // The layouts are kept between frames
+    dmRender::ClearRenderObjects(m_Context);
+    params.m_Width = 8*charwidth;
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(2u, text_context.m_LayoutCache.Size());
+    ASSERT_EQ(layout, text_context.m_TextEntries[0].m_Layout);
+
+    // Changing the font map invalidates its layouts
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 128;
+    font_map_params.m_CacheHeight = 128;
+    font_map_params.m_CacheCellWidth = 8;
+    font_map_params.m_CacheCellHeight = 8;
+    font_map_params.m_MaxAscent = 2;
+    font_map_params.m_MaxDescent = 1;
+    font_map_params.m_GetGlyph = GetGlyph;
+    font_map_params.m_GetGlyphData = GetGlyphData;
+    dmRender::SetFontMap(m_SystemFontMap, m_GraphicsContext, font_map_params);
+
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(3u, text_context.m_LayoutCache.Size());
+    ASSERT_NE(layout, text_context.m_TextEntries[1].m_Layout);
+    layout = text_context.m_TextEntries[1].m_Layout;
+
+    // Removing and adding glyphs invalidates the layouts pointing to them
+    m_Glyphs['H'].m_Character = 0;
+    dmRender::InvalidateFontMapLayouts(m_SystemFontMap);
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(4u, text_context.m_LayoutCache.Size());
+    ASSERT_NE(layout, text_context.m_TextEntries[2].m_Layout);
+    layout = text_context.m_TextEntries[2].m_Layout;
+
+    m_Glyphs['H'].m_Character = 'H';
+    dmRender::InvalidateFontMapLayouts(m_SystemFontMap);
+    dmRender::DrawText(m_Context, m_SystemFontMap, 0, 0, params);
+    ASSERT_EQ(5u, text_context.m_LayoutCache.Size());
+    ASSERT_NE(layout, text_context.m_TextEntries[3].m_Layout);
+}
+
 struct SRangeCtx
 {
     uint32_t m_NumRanges;
@@ -1528,16 +1876,18 @@ TEST_F(dmRenderTest, FindRanges)
     const uint32_t count = 32; // Large enough to avoid the initial intro sort
     dmRender::RenderListEntry entries[count];
     uint32_t indices[count];
+    uint32_t keys[count];
     for( uint32_t i = 0; i < count; ++i) {
         indices[i] = i;
         entries[i].m_Order = i;
         entries[i].m_TagListKey = i % 5;
+        keys[i] = entries[i].m_TagListKey;
     }
 
-    // Sort the entries
-    dmRender::RenderListEntrySorter sort;
-    sort.m_Base = entries;
-    std::stable_sort(indices, indices + count, sort);
+    // Sort the entries on the tag list key, like SortRenderList
+    uint32_t key_scratch[count];
+    uint32_t index_scratch[count];
+    dmRadixSort::Sort32(keys, indices, key_scratch, index_scratch, count);
 
     // Make sure it's sorted
     bool sorted = true;
@@ -0,0 +1,326 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h> // rand
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+#include <testmain/testmain.h>
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
+#include <dlib/radix_sort.h>
+#include <dlib/time.h>
+
+#include <script/script.h>
+#include <algorithm> // std::stable_sort
+
+#include "render/render.h"
+#include "render/render_private.h"
+#include "render/font_renderer.h"
+
+#include "test_render.h"
+
+// Benchmarks for sorting and drawing large render lists, and for drawing many texts.
+// Not run as part of the test suite, run build/src/test/test_render_perf manually.
+
+using namespace dmVMath;
+
+extern "C" void dmExportedSymbols();
+
+static const uint32_t ENTRY_COUNTS[] = {1000, 10000, 50000, 100000, 200000};
+static const uint32_t DRAW_CALLS = 4;    // Number of render.draw() calls per frame
+static const uint32_t ITERATIONS = 10;
+
+static const uint32_t LABEL_COUNT = 5000;
+static const float    LABEL_STATIC_RATIOS[] = {0.0f, 0.5f, 0.9f, 1.0f}; // The part of the labels with text that doesn't change between frames
+
+class dmRenderPerfTest : public jc_test_base_class
+{
+protected:
+    dmPlatform::HWindow m_Window;
+    dmRender::HRenderContext m_Context;
+    dmGraphics::HContext m_GraphicsContext;
+    dmScript::HContext m_ScriptContext;
+
+    virtual void SetUp()
+    {
+        dmGraphics::InstallAdapter();
+
+        dmPlatform::WindowParams win_params = {};
+        win_params.m_Width = 20;
+        win_params.m_Height = 10;
+
+        m_Window = dmPlatform::NewWindow();
+        dmPlatform::OpenWindow(m_Window, win_params);
+
+        dmGraphics::ContextParams graphics_context_params = {};
+        graphics_context_params.m_Window = m_Window;
+        m_GraphicsContext = dmGraphics::NewContext(graphics_context_params);
+
+        dmScript::ContextParams script_context_params = {};
+        script_context_params.m_GraphicsContext = m_GraphicsContext;
+        m_ScriptContext = dmScript::NewContext(script_context_params);
+
+        dmRender::RenderContextParams params;
+        params.m_MaxRenderTargets = 1;
+        params.m_MaxInstances = 2;
+        params.m_ScriptContext = m_ScriptContext;
+        params.m_MaxDebugVertexCount = 256;
+        params.m_MaxCharacters = 64 * 1024; // Room for the text entries of LABEL_COUNT labels
+        params.m_MaxBatches = 128;
+        m_Context = dmRender::NewRenderContext(m_GraphicsContext, params);
+    }
+
+    virtual void TearDown()
+    {
+        dmRender::DeleteRenderContext(m_Context, 0);
+        dmGraphics::DeleteContext(m_GraphicsContext);
+        dmScript::DeleteContext(m_ScriptContext);
+
+        dmPlatform::CloseWindow(m_Window);
+        dmPlatform::DeleteWindow(m_Window);
+    }
+};
+
+static float ToMs(uint64_t start, uint64_t end)
+{
+    return (end - start) / 1000.0f;
+}
+
+static void NullDispatch(dmRender::RenderListDispatchParams const& params)
+{
+}
+
+static void FillRenderList(dmRender::HRenderContext context, uint32_t count)
+{
+    dmRender::RenderListBegin(context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(context, NullDispatch, 0);
+
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(context, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmRender::RenderListEntry& entry = out[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.m_WorldPosition = Point3(rand() % 1000, rand() % 1000, (rand() % 1000) / 1000.0f);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_TagListKey = i % 2;
+        entry.m_BatchKey = rand() % 64;
+        entry.m_Dispatch = dispatch;
+    }
+    dmRender::RenderListSubmit(context, out, out + count);
+    dmRender::RenderListEnd(context);
+}
+
+struct SortValueSorter
+{
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return m_Values[a].m_SortKey < m_Values[b].m_SortKey;
+    }
+    const dmRender::RenderListSortValue* m_Values;
+};
+
+// Sort only: the previous std::stable_sort over indices, and the radix sort over the same values
+static void MeasureSort(uint32_t count, float* out_stable_sort, float* out_radix_sort)
+{
+    dmArray<dmRender::RenderListSortValue> values;
+    dmArray<uint32_t> indices;
+    dmArray<uint32_t> index_scratch;
+    dmArray<uint64_t> keys;
+    dmArray<uint64_t> key_scratch;
+    values.SetCapacity(count);
+    values.SetSize(count);
+    indices.SetCapacity(count);
+    indices.SetSize(count);
+    index_scratch.SetCapacity(count);
+    index_scratch.SetSize(count);
+    keys.SetCapacity(count);
+    keys.SetSize(count);
+    key_scratch.SetCapacity(count);
+    key_scratch.SetSize(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmRender::RenderListSortValue& v = values[i];
+        v.m_SortKey = 0;
+        v.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        v.m_Order = rand() % 0xffffff;
+        v.m_BatchKey = rand() % 64;
+    }
+
+    float stable_sort = 0.0f;
+    float radix_sort = 0.0f;
+    for (uint32_t it = 0; it < ITERATIONS; ++it)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            indices[i] = i;
+
+        SortValueSorter sorter;
+        sorter.m_Values = values.Begin();
+        uint64_t start = dmTime::GetMonotonicTime();
+        std::stable_sort(indices.Begin(), indices.End(), sorter);
+        uint64_t end = dmTime::GetMonotonicTime();
+        stable_sort += ToMs(start, end);
+
+        for (uint32_t i = 0; i < count; ++i)
+            indices[i] = i;
+
+        start = dmTime::GetMonotonicTime();
+        for (uint32_t i = 0; i < count; ++i)
+            keys[i] = values[indices[i]].m_SortKey;
+        dmRadixSort::Sort64(keys.Begin(), indices.Begin(), key_scratch.Begin(), index_scratch.Begin(), count);
+        end = dmTime::GetMonotonicTime();
+        radix_sort += ToMs(start, end);
+    }
+
+    *out_stable_sort = stable_sort / ITERATIONS;
+    *out_radix_sort = radix_sort / ITERATIONS;
+}
+
+TEST_F(dmRenderPerfTest, DrawRenderList)
+{
+    dmRender::SetViewMatrix(m_Context, Matrix4::identity());
+    dmRender::SetProjectionMatrix(m_Context, Matrix4::orthographic(0.0f, 1000.0f, 0.0f, 1000.0f, -1.0f, 1.0f));
+
+    printf("times in ms, draw times are per frame with %u draw calls\n", DRAW_CALLS);
+    printf("%10s %12s %12s %12s\n", "entries", "stable_sort", "radix sort", "draw");
+    for (uint32_t c = 0; c < DM_ARRAY_SIZE(ENTRY_COUNTS); ++c)
+    {
+        uint32_t count = ENTRY_COUNTS[c];
+
+        float stable_sort, radix_sort;
+        MeasureSort(count, &stable_sort, &radix_sort);
+
+        float draw = 0.0f;
+        for (uint32_t it = 0; it < ITERATIONS; ++it)
+        {
+            FillRenderList(m_Context, count);
+            uint64_t start = dmTime::GetMonotonicTime();
+            for (uint32_t d = 0; d < DRAW_CALLS; ++d)
+                dmRender::DrawRenderList(m_Context, 0, 0, 0);
+            uint64_t end = dmTime::GetMonotonicTime();
+            draw += ToMs(start, end);
+        }
+
+        printf("%10u %12.3f %12.3f %12.3f\n", count, stable_sort, radix_sort, draw / ITERATIONS);
+    }
+}
+
+static dmRender::FontGlyph* GetGlyph(uint32_t utf8, void* user_ctx)
+{
+    dmRender::FontGlyph* glyphs = (dmRender::FontGlyph*)user_ctx;
+    return utf8 < 128 ? &glyphs[utf8] : 0;
+}
+
+static void* GetGlyphData(uint32_t codepoint, void* user_ctx, uint32_t* out_size, uint32_t* out_compression, uint32_t* out_width, uint32_t* out_height)
+{
+    return 0;
+}
+
+TEST_F(dmRenderPerfTest, DrawText)
+{
+    dmRender::SetViewMatrix(m_Context, Matrix4::identity());
+    dmRender::SetProjectionMatrix(m_Context, Matrix4::orthographic(0.0f, 1000.0f, 0.0f, 1000.0f, -1.0f, 1.0f));
+
+    dmRender::FontGlyph glyphs[128];
+    memset(glyphs, 0, sizeof(glyphs));
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(glyphs); ++i)
+    {
+        glyphs[i].m_Character = i;
+        glyphs[i].m_Width = 8;
+        glyphs[i].m_LeftBearing = 1;
+        glyphs[i].m_Advance = 10;
+        glyphs[i].m_Ascent = 12;
+        glyphs[i].m_Descent = 4;
+    }
+
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 256;
+    font_map_params.m_CacheHeight = 256;
+    font_map_params.m_CacheCellWidth = 16;
+    font_map_params.m_CacheCellHeight = 16;
+    font_map_params.m_MaxAscent = 12;
+    font_map_params.m_MaxDescent = 4;
+    font_map_params.m_GetGlyph = GetGlyph;
+    font_map_params.m_GetGlyphData = GetGlyphData;
+    dmRender::HFontMap font_map = dmRender::NewFontMap(m_GraphicsContext, font_map_params);
+    dmRender::SetFontMapUserData(font_map, glyphs);
+
+    dmGraphics::ShaderDesc::Shader shader = MakeDDFShader(dmGraphics::ShaderDesc::LANGUAGE_GLSL_SM140, "foo", 3);
+    dmGraphics::ShaderDesc vs_desc        = MakeDDFShaderDesc(&shader, dmGraphics::ShaderDesc::SHADER_TYPE_VERTEX, 0, 0, 0, 0);
+    dmGraphics::ShaderDesc fs_desc        = MakeDDFShaderDesc(&shader, dmGraphics::ShaderDesc::SHADER_TYPE_FRAGMENT, 0, 0, 0, 0);
+    dmGraphics::HVertexProgram vp   = dmGraphics::NewVertexProgram(m_GraphicsContext, &vs_desc, 0, 0);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(m_GraphicsContext, &fs_desc, 0, 0);
+    dmRender::HMaterial material    = dmRender::NewMaterial(m_Context, vp, fp);
+
+    printf("times in ms per frame, %u labels\n", LABEL_COUNT);
+    printf("%10s %12s %12s\n", "static", "draw_text", "render");
+
+    uint32_t frame = 0;
+    for (uint32_t r = 0; r < DM_ARRAY_SIZE(LABEL_STATIC_RATIOS); ++r)
+    {
+        uint32_t static_count = (uint32_t) (LABEL_COUNT * LABEL_STATIC_RATIOS[r]);
+
+        float draw_text = 0.0f;
+        float render = 0.0f;
+        for (uint32_t it = 0; it < ITERATIONS; ++it, ++frame)
+        {
+            dmRender::ClearRenderObjects(m_Context);
+
+            uint64_t start = dmTime::GetMonotonicTime();
+            for (uint32_t i = 0; i < LABEL_COUNT; ++i)
+            {
+                char text[64];
+                if (i < static_count)
+                    dmSnPrintf(text, sizeof(text), "Label %u", i);
+                else
+                    dmSnPrintf(text, sizeof(text), "Score: %u", frame * LABEL_COUNT + i);
+
+                dmRender::DrawTextParams params;
+                params.m_Text = text;
+                params.m_WorldTransform.setTranslation(Vector3((i % 50) * 20.0f, (i / 50) * 10.0f, 0.0f));
+                params.m_Width = 100.0f;
+                params.m_LineBreak = (i % 4) == 0;
+                dmRender::DrawText(m_Context, font_map, material, 0, params);
+            }
+            uint64_t end = dmTime::GetMonotonicTime();
+            draw_text += ToMs(start, end);
+
+            start = dmTime::GetMonotonicTime();
+            dmRender::RenderListBegin(m_Context);
+            dmRender::RenderListEnd(m_Context);
+            dmRender::DrawRenderList(m_Context, 0, 0, 0);
+            end = dmTime::GetMonotonicTime();
+            render += ToMs(start, end);
+        }
+
+        printf("%9u%% %12.3f %12.3f\n", (uint32_t) (LABEL_STATIC_RATIOS[r] * 100.0f), draw_text / ITERATIONS, render / ITERATIONS);
+    }
+
+    dmRender::ClearRenderObjects(m_Context);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+    dmRender::DeleteMaterial(m_Context, material);
+    dmRender::DeleteFontMap(font_map);
+}
+
+int main(int argc, char **argv)
+{
+    dmExportedSymbols();
+    TestMainPlatformInit();
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
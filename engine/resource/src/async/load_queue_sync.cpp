@@ -26,9 +26,10 @@ namespace dmLoadQueue
 
     struct Request
     {
-        const char* m_Name;
-        const char* m_CanonicalPath;
-        PreloadInfo m_PreloadInfo;
+        const char*                      m_Name;
+        const char*                      m_CanonicalPath;
+        PreloadInfo                      m_PreloadInfo;
+        dmResource::BorrowedResourceData m_Borrowed;
     };
 
     struct Queue
@@ -63,6 +64,7 @@ namespace dmLoadQueue
         queue->m_ActiveRequest->m_Name          = name;
         queue->m_ActiveRequest->m_CanonicalPath = canonical_path;
         queue->m_ActiveRequest->m_PreloadInfo   = *info;
+        queue->m_ActiveRequest->m_Borrowed.m_Archive = 0;
         return queue->m_ActiveRequest;
     }
 
@@ -73,7 +75,16 @@ namespace dmLoadQueue
             return RESULT_INVALID_PARAM;
         }
 
-        load_result->m_LoadResult    = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size);
+        if (dmResource::RESULT_OK == dmResource::BorrowResourceData(queue->m_Factory, request->m_CanonicalPath, &request->m_Borrowed))
+        {
+            *buf                      = (void*)request->m_Borrowed.m_Data;
+            *size                     = request->m_Borrowed.m_Size;
+            load_result->m_LoadResult = dmResource::RESULT_OK;
+        }
+        else
+        {
+            load_result->m_LoadResult = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size);
+        }
         load_result->m_PreloadResult = dmResource::RESULT_PENDING;
         load_result->m_PreloadData   = 0;
 
@@ -93,6 +104,10 @@ namespace dmLoadQueue
 
     void FreeLoad(HQueue queue, HRequest request)
     {
+        if (request->m_Borrowed.m_Archive)
+        {
+            dmResource::ReleaseResourceData(queue->m_Factory, &request->m_Borrowed);
+        }
         queue->m_ActiveRequest   = 0;
         request->m_Name          = 0x0;
         request->m_CanonicalPath = 0x0;
@@ -16,8 +16,11 @@
 #include "resource_private.h"
 #include "load_queue.h"
 
+#include <string.h>
+
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/array.h>
 #include <dlib/thread.h>
 #include <dlib/mutex.h>
@@ -26,7 +29,9 @@
 
 namespace dmLoadQueue
 {
-    // Implementation of dmLoadQueue with a thread that loads items in the order they are supplied,
+    // Implementation of dmLoadQueue with one thread that reads the items in the order they are supplied,
+    // and a number of worker threads that decode (decrypt/decompress) the read data and run the preload functions.
+    // The results are published in the same order as the requests were made.
 
     // Default to small buffers since a lot of what is loaded are just small objects anyway.
     // That way we can have more in flight, but throttle when max pending data grows too large anyway
@@ -36,14 +41,30 @@ namespace dmLoadQueue
     // This sets the bandwidth of the loader.
     const uint64_t MAX_PENDING_DATA = 4 * 1024 * 1024;
     const uint32_t QUEUE_SLOTS      = 16;
+    const uint32_t MAX_WORKERS      = 8;
+
+    enum RequestState
+    {
+        REQUEST_STATE_QUEUED,   // Waiting to be read
+        REQUEST_STATE_READ,     // Raw data read, waiting for a worker
+        REQUEST_STATE_DECODING, // Owned by a worker
+        REQUEST_STATE_DONE,     // Finished, result waiting to be published
+    };
 
     struct Request
     {
-        const char*                m_Name;
-        const char*                m_CanonicalPath;
-        dmResource::LoadBufferType m_Buffer;
-        PreloadInfo                m_PreloadInfo;
-        LoadResult                 m_Result;
+        const char*                      m_Name;
+        const char*                      m_CanonicalPath;
+        dmResource::LoadBufferType       m_Buffer;
+        dmResource::LoadBufferType       m_RawBuffer;
+        dmResource::BorrowedResourceData m_Borrowed;      // Used instead of the buffers if the archive data could be used directly
+        PreloadInfo                      m_PreloadInfo;
+        LoadResult                       m_Result;
+        LoadResult                       m_PendingResult; // Copied to m_Result when published
+        uint64_t                         m_BytesWaiting;  // Buffer capacity added to Queue::m_BytesWaiting
+        uint32_t                         m_ResourceSize;
+        uint32_t                         m_Flags;
+        RequestState                     m_State;
     };
 
     struct Queue
@@ -51,21 +72,27 @@ namespace dmLoadQueue
         Request                                 m_Request[QUEUE_SLOTS];
         dmResource::HFactory                    m_Factory;
         dmMutex::HMutex                         m_Mutex;
-        dmConditionVariable::HConditionVariable m_WakeupCond;
+        dmConditionVariable::HConditionVariable m_WakeupCond;       // Wakes up the read thread
+        dmConditionVariable::HConditionVariable m_WorkerWakeupCond; // Wakes up the workers
         dmThread::Thread                        m_Thread;
+        dmThread::Thread                        m_Workers[MAX_WORKERS];
+        uint32_t                                m_WorkerCount;
         uint32_t                                m_Front;
         uint32_t                                m_Back;
         uint32_t                                m_Loaded;
+        uint32_t                                m_Read;
+        uint32_t                                m_ReadPending; // Number of requests in REQUEST_STATE_READ
         uint64_t                                m_BytesWaiting;
         bool                                    m_Shutdown;
 
         // Circular queue with indexing as follow (exclusive end)
         //
-        //          m_Back           m_Loaded   m_Front
-        // [N/A]   [loaded] [loaded] [to-load]  [N/A]
+        //          m_Back           m_Loaded               m_Read     m_Front
+        // [N/A]   [loaded] [loaded] [read/decoding/done]   [to-load]  [N/A]
         //
     };
 
+    // Assumes the queue mutex is held
     static Request* GetNextRequest(Queue* queue)
     {
         // Since we can be loading many things at once, track the total Capacity() for buffers
@@ -77,19 +104,71 @@ namespace dmLoadQueue
             return 0x0;
         }
 
-        if (queue->m_Loaded == queue->m_Front)
+        if (queue->m_Read == queue->m_Front)
         {
             return 0x0;
         }
 
-        return &queue->m_Request[queue->m_Loaded % QUEUE_SLOTS];
+        return &queue->m_Request[queue->m_Read % QUEUE_SLOTS];
+    }
+
+    // Assumes the queue mutex is held
+    static Request* GetNextReadRequest(Queue* queue)
+    {
+        if (queue->m_ReadPending == 0)
+        {
+            return 0x0;
+        }
+
+        for (uint32_t i = queue->m_Loaded; i != queue->m_Read; ++i)
+        {
+            Request* r = &queue->m_Request[i % QUEUE_SLOTS];
+            if (r->m_State == REQUEST_STATE_READ)
+            {
+                return r;
+            }
+        }
+        return 0x0;
+    }
+
+    // Assumes the queue mutex is held
+    static void AddBytesWaiting(Queue* queue, Request* request)
+    {
+        uint64_t bytes = request->m_Buffer.Capacity() + request->m_RawBuffer.Capacity();
+        queue->m_BytesWaiting    += bytes - request->m_BytesWaiting;
+        request->m_BytesWaiting   = bytes;
+    }
+
+    // Publishes the results of finished requests, in order
+    // Assumes the queue mutex is held
+    static void PublishResults(Queue* queue)
+    {
+        while (queue->m_Loaded != queue->m_Read)
+        {
+            Request* r = &queue->m_Request[queue->m_Loaded % QUEUE_SLOTS];
+            if (r->m_State != REQUEST_STATE_DONE)
+            {
+                break;
+            }
+            r->m_Result = r->m_PendingResult;
+            queue->m_Loaded++;
+        }
+    }
+
+    static void ResetBufferCapacity(dmResource::LoadBufferType* buffer)
+    {
+        assert(buffer->Size() == 0);
+        if (buffer->Capacity() != DEFAULT_CAPACITY)
+        {
+            buffer->SetCapacity(DEFAULT_CAPACITY);
+        }
     }
 
     static void LoadThread(void* arg)
     {
         Queue* queue     = (Queue*)arg;
         Request* current = 0;
-        LoadResult result;
+        dmResource::Result result;
         while (true)
         {
             {
@@ -97,10 +176,23 @@ namespace dmLoadQueue
                 if (current != 0)
                 {
                     // Just finished one (from previous iteration)
-                    queue->m_BytesWaiting += current->m_Buffer.Capacity();
-                    queue->m_Loaded++;
-                    current->m_Result = result;
-                    current           = 0;
+                    AddBytesWaiting(queue, current);
+                    queue->m_Read++;
+                    if (result == dmResource::RESULT_OK)
+                    {
+                        current->m_State = REQUEST_STATE_READ;
+                        queue->m_ReadPending++;
+                        dmConditionVariable::Signal(queue->m_WorkerWakeupCond);
+                    }
+                    else
+                    {
+                        current->m_PendingResult.m_LoadResult    = result;
+                        current->m_PendingResult.m_PreloadResult = dmResource::RESULT_PENDING;
+                        current->m_PendingResult.m_PreloadData   = 0;
+                        current->m_State = REQUEST_STATE_DONE;
+                        PublishResults(queue);
+                    }
+                    current = 0;
                 }
                 if (queue->m_Shutdown)
                 {
@@ -111,16 +203,21 @@ namespace dmLoadQueue
                 if (current == 0x0)
                 {
                     // Nothing to do, reset any buffers of inactive requests that are not at default capacity
+                    // Requests that are being decoded, or waiting to be picked up, have their buffers accounted for
                     for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
                     {
                         Request* r = &queue->m_Request[i];
-                        if (r->m_Buffer.Size() == 0)
+                        if (r->m_BytesWaiting == 0)
                         {
+                            // Just free the memory here, no need to allocate while holding the mutex
                             if (r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
                             {
-                                // Just free the memory here, no need to allocate while holding the mutex
                                 r->m_Buffer.SetCapacity(0);
                             }
+                            if (r->m_RawBuffer.Capacity() > DEFAULT_CAPACITY)
+                            {
+                                r->m_RawBuffer.SetCapacity(0);
+                            }
                         }
                     }
                     dmConditionVariable::Wait(queue->m_WakeupCond, queue->m_Mutex);
@@ -130,54 +227,131 @@ namespace dmLoadQueue
 
             if (current)
             {
-                // We use the temporary result object here to fill in the data so it can be written with the mutex held.
-                uint32_t size = 0;
+                // Only the read is done here, since it is serialized on the factory load mutex anyway.
+                // The decoding and the preload function runs on the workers.
+                ResetBufferCapacity(&current->m_Buffer);
+                ResetBufferCapacity(&current->m_RawBuffer);
 
-                assert(current->m_Buffer.Size() == 0);
-                if (current->m_Buffer.Capacity() != DEFAULT_CAPACITY)
+                result = dmResource::BorrowResourceData(queue->m_Factory, current->m_CanonicalPath, &current->m_Borrowed);
+                if (result == dmResource::RESULT_OK)
+                {
+                    current->m_ResourceSize = current->m_Borrowed.m_Size;
+                    current->m_Flags        = 0;
+                }
+                else
                 {
-                    current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
+                    result = dmResource::LoadRawResourceFromBuffer(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &current->m_ResourceSize, &current->m_Flags, &current->m_RawBuffer);
                 }
+            }
+        }
+    }
+
+    static const void* GetData(Request* request)
+    {
+        return request->m_Borrowed.m_Archive ? request->m_Borrowed.m_Data : request->m_Buffer.Begin();
+    }
+
+    static uint32_t GetDataSize(Request* request)
+    {
+        return request->m_Borrowed.m_Archive ? request->m_Borrowed.m_Size : request->m_Buffer.Size();
+    }
 
-                result.m_LoadResult = dmResource::LoadResourceFromBuffer(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
-                result.m_PreloadResult = dmResource::RESULT_PENDING;
-                result.m_PreloadData   = 0;
+    static void DecodeAndPreload(Queue* queue, Request* current, LoadResult* result)
+    {
+        if (current->m_Borrowed.m_Archive)
+        {
+            // Stored uncompressed and unencrypted, nothing to decode
+            result->m_LoadResult = dmResource::RESULT_OK;
+        }
+        else
+        {
+            result->m_LoadResult = dmResource::DecodeResource(current->m_Flags, current->m_ResourceSize, &current->m_RawBuffer, &current->m_Buffer);
+        }
+        result->m_PreloadResult = dmResource::RESULT_PENDING;
+        result->m_PreloadData   = 0;
+
+        if (result->m_LoadResult == dmResource::RESULT_OK)
+        {
+            assert(GetDataSize(current) == current->m_ResourceSize);
+            if (current->m_PreloadInfo.m_CompleteFunction)
+            {
+                ResourcePreloadParams params;
+                params.m_Factory        = queue->m_Factory;
+                params.m_Context        = current->m_PreloadInfo.m_Context;
+                params.m_Buffer         = GetData(current);
+                params.m_BufferSize     = GetDataSize(current);
+                params.m_HintInfo       = &current->m_PreloadInfo.m_HintInfo;
+                params.m_PreloadData    = &result->m_PreloadData;
+                result->m_PreloadResult = (dmResource::Result)current->m_PreloadInfo.m_CompleteFunction(&params);
+            }
+            else
+            {
+                result->m_PreloadResult = dmResource::RESULT_OK;
+            }
+        }
+    }
 
-                if (result.m_LoadResult == dmResource::RESULT_OK)
+    static void WorkerThread(void* arg)
+    {
+        Queue* queue     = (Queue*)arg;
+        Request* current = 0;
+        LoadResult result;
+        while (true)
+        {
+            {
+                dmMutex::ScopedLock lk(queue->m_Mutex);
+                if (current != 0)
                 {
-                    assert(current->m_Buffer.Size() == size);
-                    if (current->m_PreloadInfo.m_CompleteFunction)
-                    {
-                        ResourcePreloadParams params;
-                        params.m_Factory       = queue->m_Factory;
-                        params.m_Context       = current->m_PreloadInfo.m_Context;
-                        params.m_Buffer        = current->m_Buffer.Begin();
-                        params.m_BufferSize    = current->m_Buffer.Size();
-                        params.m_HintInfo      = &current->m_PreloadInfo.m_HintInfo;
-                        params.m_PreloadData   = &result.m_PreloadData;
-                        result.m_PreloadResult = (dmResource::Result)current->m_PreloadInfo.m_CompleteFunction(&params);
-                    }
-                    else
-                    {
-                        result.m_PreloadResult = dmResource::RESULT_OK;
-                    }
+                    AddBytesWaiting(queue, current);
+                    current->m_PendingResult = result;
+                    current->m_State         = REQUEST_STATE_DONE;
+                    current                  = 0;
+                    PublishResults(queue);
+                }
+
+                while (!queue->m_Shutdown && (current = GetNextReadRequest(queue)) == 0x0)
+                {
+                    dmConditionVariable::Wait(queue->m_WorkerWakeupCond, queue->m_Mutex);
+                }
+                if (queue->m_Shutdown)
+                {
+                    return;
                 }
+
+                current->m_State = REQUEST_STATE_DECODING;
+                queue->m_ReadPending--;
             }
+
+            DecodeAndPreload(queue, current, &result);
         }
     }
 
     HQueue CreateQueue(dmResource::HFactory factory)
     {
-        Queue* q          = new Queue();
-        q->m_Factory      = factory;
-        q->m_Front        = 0;
-        q->m_Back         = 0;
-        q->m_Loaded       = 0;
-        q->m_Shutdown     = false;
-        q->m_BytesWaiting = 0;
-        q->m_Mutex        = dmMutex::New();
-        q->m_WakeupCond   = dmConditionVariable::New();
-        q->m_Thread       = dmThread::New(&LoadThread, 128 * 1024, q, "AsyncLoad");
+        Queue* q              = new Queue();
+        q->m_Factory          = factory;
+        q->m_Front            = 0;
+        q->m_Back             = 0;
+        q->m_Loaded           = 0;
+        q->m_Read             = 0;
+        q->m_ReadPending      = 0;
+        q->m_Shutdown         = false;
+        q->m_BytesWaiting     = 0;
+        q->m_Mutex            = dmMutex::New();
+        q->m_WakeupCond       = dmConditionVariable::New();
+        q->m_WorkerWakeupCond = dmConditionVariable::New();
+        for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
+        {
+            q->m_Request[i].m_BytesWaiting = 0;
+            memset(&q->m_Request[i].m_Borrowed, 0, sizeof(q->m_Request[i].m_Borrowed));
+        }
+
+        q->m_Thread      = dmThread::New(&LoadThread, 128 * 1024, q, "AsyncLoad");
+        q->m_WorkerCount = dmMath::Min(dmResource::GetLoadThreadCount(factory), MAX_WORKERS);
+        for (uint32_t i = 0; i < q->m_WorkerCount; ++i)
+        {
+            q->m_Workers[i] = dmThread::New(&WorkerThread, 128 * 1024, q, "AsyncLoadWorker");
+        }
 
         return q;
     }
@@ -187,10 +361,24 @@ namespace dmLoadQueue
         {
             dmMutex::ScopedLock lk(queue->m_Mutex);
             queue->m_Shutdown = true;
-            // Wake up the worker so it can exit and allow us to join
+            // Wake up the threads so they can exit and allow us to join
             dmConditionVariable::Signal(queue->m_WakeupCond);
+            dmConditionVariable::Broadcast(queue->m_WorkerWakeupCond);
         }
         dmThread::Join(queue->m_Thread);
+        for (uint32_t i = 0; i < queue->m_WorkerCount; ++i)
+        {
+            dmThread::Join(queue->m_Workers[i]);
+        }
+        for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
+        {
+            // Requests that were never freed
+            if (queue->m_Request[i].m_Borrowed.m_Archive)
+            {
+                dmResource::ReleaseResourceData(queue->m_Factory, &queue->m_Request[i].m_Borrowed);
+            }
+        }
+        dmConditionVariable::Delete(queue->m_WorkerWakeupCond);
         dmConditionVariable::Delete(queue->m_WakeupCond);
         dmMutex::Delete(queue->m_Mutex);
         delete queue;
@@ -209,15 +397,16 @@ namespace dmLoadQueue
         if ((queue->m_Front - queue->m_Back) == QUEUE_SLOTS)
             return 0;
 
-        if (queue->m_Loaded == queue->m_Front)
+        if (queue->m_Read == queue->m_Front)
         {
-            // The worker is sleeping waiting for request, wake it up
+            // The reader is sleeping waiting for request, wake it up
             dmConditionVariable::Signal(queue->m_WakeupCond);
         }
 
         Request* req         = &queue->m_Request[(queue->m_Front++) % QUEUE_SLOTS];
         req->m_Name          = name;
         req->m_CanonicalPath = canonical_path;
+        req->m_State         = REQUEST_STATE_QUEUED;
 
         req->m_PreloadInfo         = *info;
         req->m_Result.m_LoadResult = dmResource::RESULT_PENDING;
@@ -231,8 +420,8 @@ namespace dmLoadQueue
         if (request->m_Result.m_LoadResult == dmResource::RESULT_PENDING)
             return RESULT_PENDING;
 
-        *buf         = request->m_Buffer.Begin();
-        *size        = request->m_Buffer.Size();
+        *buf         = (void*)GetData(request);
+        *size        = GetDataSize(request);
         *load_result = request->m_Result;
 
         return RESULT_OK;
@@ -242,15 +431,21 @@ namespace dmLoadQueue
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
-        uint32_t old_bytes_waiting = queue->m_BytesWaiting;
+        uint64_t old_bytes_waiting = queue->m_BytesWaiting;
 
-        // Make sure we don't copy any data if we reallocate the buffer
+        // Make sure we don't copy any data if we reallocate the buffers
         request->m_Buffer.SetSize(0);
+        request->m_RawBuffer.SetSize(0);
+        if (request->m_Borrowed.m_Archive)
+        {
+            dmResource::ReleaseResourceData(queue->m_Factory, &request->m_Borrowed);
+        }
 
         uint32_t buffer_capacity = request->m_Buffer.Capacity();
-        queue->m_BytesWaiting -= buffer_capacity;
+        queue->m_BytesWaiting  -= request->m_BytesWaiting;
+        request->m_BytesWaiting = 0;
         // If we either have blocked further processing by exceeding MAX_PENDING_DATA or
-        // the buffer has a non-default capacity, we want to wake up the worker
+        // the buffer has a non-default capacity, we want to wake up the reader
         if (buffer_capacity != DEFAULT_CAPACITY || (old_bytes_waiting >= MAX_PENDING_DATA && queue->m_BytesWaiting < MAX_PENDING_DATA))
         {
             // Wake up thread, we can now fit a new request
@@ -177,6 +177,8 @@
  * @name ResourceTypeSetPreloadFn
  * @param type [type: HResourceType] The type
  * @param fn [type: FResourcePreload] Function to be called when loading of the resource starts
+ * @note The function is called from the resource loader threads, and may be called concurrently
+ *       for different resources
  */
 
 /*# set create function for type
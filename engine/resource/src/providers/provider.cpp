@@ -39,6 +39,7 @@ void ArchiveLoader::Verify()
     assert(m_Unmount != 0);
     assert(m_GetFileSize != 0);
     assert(m_ReadFile != 0);
+    assert((m_GetRawFileInfo != 0) == (m_ReadRawFile != 0));
 }
 
 void RegisterArchiveLoader(ArchiveLoader* loader)
@@ -86,6 +87,21 @@ bool CanMountUri(HArchiveLoader loader, const dmURI::Parts* uri)
 // ****************************************
 // Archives
 
+static void InitBorrowState(Archive* archive)
+{
+    dmSpinlock::Create(&archive->m_BorrowLock);
+    archive->m_BorrowCount = 0;
+    archive->m_UnmountPending = false;
+}
+
+static Result DoUnmount(Archive* archive)
+{
+    Result result = archive->m_Loader->m_Unmount(archive->m_Internal);
+    dmSpinlock::Destroy(&archive->m_BorrowLock);
+    delete archive;
+    return result;
+}
+
 static Result DoMount(ArchiveLoader* loader, const dmURI::Parts* uri, HArchive base_archive, HArchive* out_archive)
 {
     void* internal;
@@ -96,6 +112,7 @@ static Result DoMount(ArchiveLoader* loader, const dmURI::Parts* uri, HArchive b
         memcpy(&archive->m_Uri, uri, sizeof(dmURI::Parts));
         archive->m_Loader = loader;
         archive->m_Internal = internal;
+        InitBorrowState(archive);
         *out_archive = archive;
     }
     return result;
@@ -114,15 +131,23 @@ Result CreateMount(ArchiveLoader* loader, void* internal, HArchive* out_archive)
     memset(archive, 0, sizeof(Archive));
     archive->m_Loader = loader;
     archive->m_Internal = internal;
+    InitBorrowState(archive);
     *out_archive = archive;
     return RESULT_OK;
 }
 
 Result Unmount(HArchive archive)
 {
-    Result result = archive->m_Loader->m_Unmount(archive->m_Internal);
-    delete archive;
-    return result;
+    {
+        DM_SPINLOCK_SCOPED_LOCK(archive->m_BorrowLock);
+        if (archive->m_BorrowCount > 0)
+        {
+            // The last ReleaseFile() does the unmount
+            archive->m_UnmountPending = true;
+            return RESULT_OK;
+        }
+    }
+    return DoUnmount(archive);
 }
 
 Result GetFileSize(HArchive archive, dmhash_t path_hash, const char* path, uint32_t* file_size)
@@ -135,6 +160,64 @@ Result ReadFile(HArchive archive, dmhash_t path_hash, const char* path, uint8_t*
     return archive->m_Loader->m_ReadFile(archive->m_Internal, path_hash, path, buffer, buffer_len);
 }
 
+Result GetRawFileInfo(HArchive archive, dmhash_t path_hash, const char* path, RawFileInfo* info)
+{
+    if (archive->m_Loader->m_GetRawFileInfo)
+        return archive->m_Loader->m_GetRawFileInfo(archive->m_Internal, path_hash, path, info);
+
+    uint32_t file_size;
+    Result result = archive->m_Loader->m_GetFileSize(archive->m_Internal, path_hash, path, &file_size);
+    if (result == RESULT_OK)
+    {
+        info->m_FileSize = file_size;
+        info->m_RawSize  = file_size;
+        info->m_Flags    = 0;
+    }
+    return result;
+}
+
+Result ReadRawFile(HArchive archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len)
+{
+    if (archive->m_Loader->m_ReadRawFile)
+        return archive->m_Loader->m_ReadRawFile(archive->m_Internal, path_hash, path, buffer, buffer_len);
+    return archive->m_Loader->m_ReadFile(archive->m_Internal, path_hash, path, buffer, buffer_len);
+}
+
+Result BorrowFile(HArchive archive, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* file_size)
+{
+    if (!archive->m_Loader->m_BorrowFile)
+        return RESULT_NOT_SUPPORTED;
+
+    {
+        DM_SPINLOCK_SCOPED_LOCK(archive->m_BorrowLock);
+        if (archive->m_UnmountPending)
+            return RESULT_NOT_SUPPORTED;
+        archive->m_BorrowCount++;
+    }
+
+    Result result = archive->m_Loader->m_BorrowFile(archive->m_Internal, path_hash, path, data, file_size);
+    if (result != RESULT_OK)
+    {
+        ReleaseFile(archive);
+    }
+    return result;
+}
+
+void ReleaseFile(HArchive archive)
+{
+    bool unmount;
+    {
+        DM_SPINLOCK_SCOPED_LOCK(archive->m_BorrowLock);
+        assert(archive->m_BorrowCount > 0);
+        archive->m_BorrowCount--;
+        unmount = archive->m_BorrowCount == 0 && archive->m_UnmountPending;
+    }
+    if (unmount)
+    {
+        DoUnmount(archive);
+    }
+}
+
 Result GetManifest(HArchive archive, dmResource::HManifest* out_manifest)
 {
     if (archive->m_Loader->m_GetManifest)
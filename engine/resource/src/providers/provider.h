@@ -37,6 +37,14 @@ namespace dmResourceProvider
         RESULT_ERROR_UNKNOWN        = -1000,
     };
 
+    // The file data as it is stored in the archive
+    struct RawFileInfo
+    {
+        uint32_t m_FileSize;    // The size of the file once decoded
+        uint32_t m_RawSize;     // The size of the stored data
+        uint32_t m_Flags;       // dmResourceArchive::EntryFlag bits. 0 means the stored data is the file
+    };
+
     struct ArchiveLoader;
     typedef struct Archive*         HArchive;
     typedef void*                   HArchiveInternal;
@@ -51,6 +59,11 @@ namespace dmResourceProvider
     typedef Result (*FGetFileSize)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint32_t* file_size);
     typedef Result (*FReadFile)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len);
     typedef Result (*FWriteFile)(HArchiveInternal archive, dmhash_t path_hash, const char* path, const uint8_t* buffer, uint32_t buffer_len);
+    // Optional. For archives that store files encrypted and/or compressed, so that they can be decoded outside of the resource locks
+    typedef Result (*FGetRawFileInfo)(HArchiveInternal archive, dmhash_t path_hash, const char* path, RawFileInfo* info);
+    typedef Result (*FReadRawFile)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len);
+    // Optional. For archives that can give direct access to (e.g. memory mapped) file data. Returns RESULT_NOT_SUPPORTED if not possible for the file
+    typedef Result (*FBorrowFile)(HArchiveInternal archive, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* file_size);
     typedef Result (*FGetManifest)(HArchiveInternal, dmResource::HManifest*); // In order for other providers to get the base manifest
     typedef Result (*FSetManifest)(HArchiveInternal, dmResource::HManifest);  // In order to set a downloaded manifest to a provider
 
@@ -73,6 +86,15 @@ namespace dmResourceProvider
     Result ReadFile(HArchive archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len);
     Result WriteFile(HArchive archive, dmhash_t path_hash, const char* path, const uint8_t* buffer, uint32_t buffer_len);
 
+    // Read the file as it is stored, without decoding it. For loaders that don't support it, the file is read with ReadFile()
+    Result GetRawFileInfo(HArchive archive, dmhash_t path_hash, const char* path, RawFileInfo* info);
+    Result ReadRawFile(HArchive archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len);
+
+    // Get a pointer to the file data in the archive, without copying it. Returns RESULT_NOT_SUPPORTED if not possible.
+    // The data must be returned with ReleaseFile(). The archive isn't unmounted until all borrowed data is returned.
+    Result BorrowFile(HArchive archive, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* file_size);
+    void   ReleaseFile(HArchive archive);
+
 
     // Plugin API
 
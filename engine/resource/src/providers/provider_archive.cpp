@@ -234,6 +234,53 @@ namespace dmResourceProviderArchive
         return dmResourceProvider::RESULT_NOT_FOUND;
     }
 
+    static dmResourceProvider::Result GetRawFileInfo(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, dmResourceProvider::RawFileInfo* info)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            const uint32_t flags = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_Flags);
+            info->m_FileSize = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceSize);
+            info->m_RawSize  = dmResourceArchive::GetEntryRawSize(entry->m_ArchiveInfo);
+            info->m_Flags    = flags & (dmResourceArchive::ENTRY_FLAG_ENCRYPTED | dmResourceArchive::ENTRY_FLAG_COMPRESSED);
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
+    static dmResourceProvider::Result ReadRawFile(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            if (buffer_len < dmResourceArchive::GetEntryRawSize(entry->m_ArchiveInfo))
+                return dmResourceProvider::RESULT_INVAL_ERROR;
+            if (dmResourceArchive::RESULT_OK != dmResourceArchive::ReadEntryRaw(archive->m_ArchiveIndex, entry->m_ArchiveInfo, buffer))
+                return dmResourceProvider::RESULT_IO_ERROR;
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
+    static dmResourceProvider::Result BorrowFile(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* file_size)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            if (dmResourceArchive::RESULT_OK != dmResourceArchive::GetEntryDataPtr(archive->m_ArchiveIndex, entry->m_ArchiveInfo, data))
+                return dmResourceProvider::RESULT_NOT_SUPPORTED;
+            *file_size = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceSize);
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
     static dmResourceProvider::Result GetManifest(dmResourceProvider::HArchiveInternal internal, dmResource::HManifest* out_manifest)
     {
         GameArchiveFile* archive = (GameArchiveFile*)internal;
@@ -247,12 +294,15 @@ namespace dmResourceProviderArchive
 
     static void SetupArchiveLoader(dmResourceProvider::ArchiveLoader* loader)
     {
-        loader->m_CanMount      = MatchesUri;
-        loader->m_Mount         = Mount;
-        loader->m_Unmount       = Unmount;
-        loader->m_GetManifest   = GetManifest;
-        loader->m_GetFileSize   = GetFileSize;
-        loader->m_ReadFile      = ReadFile;
+        loader->m_CanMount       = MatchesUri;
+        loader->m_Mount          = Mount;
+        loader->m_Unmount        = Unmount;
+        loader->m_GetManifest    = GetManifest;
+        loader->m_GetFileSize    = GetFileSize;
+        loader->m_ReadFile       = ReadFile;
+        loader->m_GetRawFileInfo = GetRawFileInfo;
+        loader->m_ReadRawFile    = ReadRawFile;
+        loader->m_BorrowFile     = BorrowFile;
     }
 
     DM_DECLARE_ARCHIVE_LOADER(ResourceProviderArchive, "archive", SetupArchiveLoader);
@@ -16,6 +16,7 @@
 #define DM_RESOURCE_PROVIDER_PRIVATE_H
 
 #include "provider.h"
+#include <dlib/spinlock.h>
 #include <dlib/uri.h>
 
 namespace dmResourceProvider
@@ -25,6 +26,9 @@ namespace dmResourceProvider
         const ArchiveLoader*    m_Loader;
         void*                   m_Internal; // Each provider may have its own type to handle the code efficiently
         dmURI::Parts            m_Uri;
+        dmSpinlock::Spinlock    m_BorrowLock;
+        uint32_t                m_BorrowCount;      // Number of files borrowed with BorrowFile()
+        bool                    m_UnmountPending;   // Unmount() was called while files were borrowed
     };
 
     struct ArchiveLoader
@@ -39,6 +43,9 @@ namespace dmResourceProvider
         FGetFileSize            m_GetFileSize;
         FReadFile               m_ReadFile;
         FWriteFile              m_WriteFile;        // For writeable archives
+        FGetRawFileInfo         m_GetRawFileInfo;   // For archives with encrypted/compressed files
+        FReadRawFile            m_ReadRawFile;
+        FBorrowFile             m_BorrowFile;       // For archives with memory mapped files
 
         void Verify();
 
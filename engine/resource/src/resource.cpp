@@ -92,6 +92,9 @@ struct ResourceFactory
     // m_BuiltinsManifest, m_Manifest
     dmMutex::HMutex                              m_LoadMutex;
 
+    // Number of threads decoding and preloading resources in the async load queue
+    uint32_t                                     m_LoadThreadCount;
+
     // dmResource::Get recursion depth
     uint32_t                                     m_RecursionDepth;
     // List of resources currently in dmResource::Get call-stack
@@ -160,6 +163,7 @@ void SetDefaultNewFactoryParams(struct NewFactoryParams* params)
     memset(params, 0, sizeof(NewFactoryParams));
     params->m_MaxResources = 1024;
     params->m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+    params->m_LoadThreadCount = 2;
 
     params->m_ArchiveManifest.m_Data = 0;
     params->m_ArchiveManifest.m_Size = 0;
@@ -355,6 +359,7 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
     }
 
     factory->m_LoadMutex = dmMutex::New();
+    factory->m_LoadThreadCount = dmMath::Max(1u, params->m_LoadThreadCount);
     return factory;
 }
 
@@ -646,6 +651,95 @@ Result LoadResourceFromBuffer(HFactory factory, const char* path, const char* or
     return LoadResourceFromBufferLocked(factory, path, original_name, resource_size, buffer);
 }
 
+// Takes the lock.
+Result LoadRawResourceFromBuffer(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, uint32_t* flags, LoadBufferType* raw_buffer)
+{
+    DM_PROFILE(__FUNCTION__);
+    dmMutex::ScopedLock lk(factory->m_LoadMutex);
+
+    char normalized_path[RESOURCE_PATH_MAX];
+    GetCanonicalPath(path, normalized_path); // normalize the path
+
+    dmResourceProvider::RawFileInfo info;
+    Result r = dmResourceMounts::ReadRawResource(factory->m_Mounts, dmHashString64(normalized_path), normalized_path, raw_buffer, &info);
+    if (r != RESULT_OK)
+    {
+        raw_buffer->SetSize(0);
+        return r;
+    }
+
+    *resource_size = info.m_FileSize;
+    *flags = info.m_Flags;
+    return RESULT_OK;
+}
+
+// Assumes m_LoadMutex is already held
+static Result BorrowResourceDataLocked(HFactory factory, const char* canonical_path, BorrowedResourceData* data)
+{
+    const uint8_t* ptr;
+    uint32_t size;
+    dmResourceProvider::HArchive archive;
+    Result r = dmResourceMounts::BorrowResource(factory->m_Mounts, dmHashString64(canonical_path), canonical_path, &ptr, &size, &archive);
+    if (r != RESULT_OK)
+        return r;
+
+    data->m_Data    = ptr;
+    data->m_Size    = size;
+    data->m_Archive = archive;
+    return RESULT_OK;
+}
+
+// Takes the lock.
+Result BorrowResourceData(HFactory factory, const char* path, BorrowedResourceData* data)
+{
+    DM_PROFILE(__FUNCTION__);
+    dmMutex::ScopedLock lk(factory->m_LoadMutex);
+
+    char normalized_path[RESOURCE_PATH_MAX];
+    GetCanonicalPath(path, normalized_path); // normalize the path
+    return BorrowResourceDataLocked(factory, normalized_path, data);
+}
+
+void ReleaseResourceData(HFactory factory, BorrowedResourceData* data)
+{
+    (void)factory;
+    if (data->m_Archive)
+    {
+        dmResourceProvider::ReleaseFile(data->m_Archive);
+    }
+    data->m_Data    = 0;
+    data->m_Size    = 0;
+    data->m_Archive = 0;
+}
+
+Result DecodeResource(uint32_t flags, uint32_t resource_size, LoadBufferType* raw_buffer, LoadBufferType* buffer)
+{
+    DM_PROFILE(__FUNCTION__);
+
+    if (flags & dmResourceArchive::ENTRY_FLAG_COMPRESSED)
+    {
+        if (buffer->Capacity() < resource_size) {
+            buffer->SetCapacity(resource_size);
+        }
+        buffer->SetSize(resource_size);
+    }
+
+    dmResourceArchive::Result r = dmResourceArchive::DecodeEntryData(flags, (uint8_t*)raw_buffer->Begin(), raw_buffer->Size(), buffer->Begin(), resource_size);
+    if (!(flags & dmResourceArchive::ENTRY_FLAG_COMPRESSED))
+    {
+        // Decrypted in place, so the raw data is the resource data
+        buffer->Swap(*raw_buffer);
+    }
+    raw_buffer->SetSize(0);
+
+    if (r != dmResourceArchive::RESULT_OK)
+    {
+        buffer->SetSize(0);
+        return RESULT_IO_ERROR;
+    }
+    return RESULT_OK;
+}
+
 // Assumes m_LoadMutex is already held
 Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
 {
@@ -832,6 +926,15 @@ static Result CreateAndLoadResource(HFactory factory, const char* name, void** r
         return RESULT_OK;
     }
 
+    // Use the archive data directly if possible
+    BorrowedResourceData borrowed;
+    if (RESULT_OK == BorrowResourceDataLocked(factory, canonical_path, &borrowed))
+    {
+        Result result = DoCreateResource(factory, resource_type, name, canonical_path, canonical_path_hash, (void*)borrowed.m_Data, borrowed.m_Size, resource);
+        ReleaseResourceData(factory, &borrowed);
+        return result;
+    }
+
     void* buffer         = 0;
     uint32_t buffer_size = 0;
     Result result = LoadResource(factory, canonical_path, name, &buffer, &buffer_size);
@@ -1466,6 +1569,11 @@ dmMutex::HMutex GetLoadMutex(const dmResource::HFactory factory)
     return factory->m_LoadMutex;
 }
 
+uint32_t GetLoadThreadCount(const dmResource::HFactory factory)
+{
+    return factory->m_LoadThreadCount;
+}
+
 dmResourceMounts::HContext GetMountsContext(const dmResource::HFactory factory)
 {
     return factory->m_Mounts;
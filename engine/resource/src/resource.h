@@ -137,7 +137,10 @@ namespace dmResource
         EmbeddedResource m_ArchiveData;
         EmbeddedResource m_ArchiveManifest;
 
-        uint32_t m_Reserved[5];
+        /// Number of threads decoding and preloading resources loaded asynchronously. Default is 2
+        uint32_t m_LoadThreadCount;
+
+        uint32_t m_Reserved[4];
 
         NewFactoryParams()
         {
@@ -331,6 +334,13 @@ namespace dmResource
     */
     dmMutex::HMutex GetLoadMutex(const dmResource::HFactory factory);
 
+    /**
+     * Returns the number of threads used to decode and preload resources loaded asynchronously
+     * @param factory Factory handle
+     * @return Number of threads
+    */
+    uint32_t GetLoadThreadCount(const dmResource::HFactory factory);
+
 
     /**
      * @name
@@ -412,6 +422,25 @@ namespace dmResource
     Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
     // load with own buffer
     Result LoadResourceFromBuffer(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer);
+    // load the resource as it is stored (i.e. possibly encrypted and/or compressed) into raw_buffer.
+    // flags are dmResourceArchive::EntryFlag bits, and are passed to DecodeResource() to get the actual resource data
+    Result LoadRawResourceFromBuffer(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, uint32_t* flags, LoadBufferType* raw_buffer);
+    // decode a resource loaded with LoadRawResourceFromBuffer() into buffer. Does not take the lock.
+    // raw_buffer is decoded in place, and the buffers are swapped if no decompression is needed
+    Result DecodeResource(uint32_t flags, uint32_t resource_size, LoadBufferType* raw_buffer, LoadBufferType* buffer);
+
+    struct BorrowedResourceData
+    {
+        const void*                  m_Data;
+        uint32_t                     m_Size;
+        dmResourceProvider::HArchive m_Archive;
+    };
+
+    // get a pointer to the resource data in a (memory mapped) archive, without copying it. Takes the lock.
+    // returns RESULT_NOT_SUPPORTED if the resource needs to be loaded with one of the functions above instead
+    Result BorrowResourceData(HFactory factory, const char* path, BorrowedResourceData* data);
+    // return data borrowed with BorrowResourceData(). Does not take the lock.
+    void ReleaseResourceData(HFactory factory, BorrowedResourceData* data);
 }
 
 #endif // DM_RESOURCE_H
@@ -587,30 +587,74 @@ namespace dmResourceArchive
 
         // At this point the source_data is the file "stored on disc"
         // and will be treated as the input
+        Result result = DecodeEntryData(flags, source_data, source_data_size, buffer, size);
+        delete[] temp_data;
+        return result;
+    }
+
+    uint32_t GetEntryRawSize(const EntryData* entry)
+    {
+        const uint32_t flags = dmEndian::ToNetwork(entry->m_Flags);
+        if (flags & dmResourceArchive::ENTRY_FLAG_COMPRESSED)
+            return dmEndian::ToNetwork(entry->m_ResourceCompressedSize);
+        return dmEndian::ToNetwork(entry->m_ResourceSize);
+    }
+
+    Result ReadEntryRaw(HArchiveIndexContainer archive, const EntryData* entry, void* buffer)
+    {
+        const uint32_t resource_offset  = dmEndian::ToNetwork(entry->m_ResourceDataOffset);
+        const uint32_t raw_size         = GetEntryRawSize(entry);
 
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        if (afi->m_IsMemMapped)
+        {
+            memcpy(buffer, (const uint8_t*)afi->m_ResourceData + resource_offset, raw_size);
+            return dmResourceArchive::RESULT_OK;
+        }
+
+        FILE* resource_file = afi->m_FileResourceData;
+        fseek(resource_file, resource_offset, SEEK_SET);
+        if (fread(buffer, 1, raw_size, resource_file) != raw_size)
+        {
+            return dmResourceArchive::RESULT_IO_ERROR;
+        }
+        return dmResourceArchive::RESULT_OK;
+    }
+
+    Result GetEntryDataPtr(HArchiveIndexContainer archive, const EntryData* entry, const uint8_t** data)
+    {
+        const uint32_t flags = dmEndian::ToNetwork(entry->m_Flags);
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        if (!afi->m_IsMemMapped || (flags & (dmResourceArchive::ENTRY_FLAG_ENCRYPTED | dmResourceArchive::ENTRY_FLAG_COMPRESSED)))
+        {
+            return dmResourceArchive::RESULT_NOT_FOUND;
+        }
+
+        *data = afi->m_ResourceData + dmEndian::ToNetwork(entry->m_ResourceDataOffset);
+        return dmResourceArchive::RESULT_OK;
+    }
+
+    Result DecodeEntryData(uint32_t flags, uint8_t* source_data, uint32_t source_data_size, void* buffer, uint32_t size)
+    {
         // Encryption is done in-place
-        if(encrypted)
+        if (flags & dmResourceArchive::ENTRY_FLAG_ENCRYPTED)
         {
-            dmResource::Result r = dmResource::DecryptBuffer((uint8_t*)source_data, source_data_size);
+            dmResource::Result r = dmResource::DecryptBuffer(source_data, source_data_size);
             if (dmResource::RESULT_OK != r)
             {
-                delete[] temp_data;
                 return dmResourceArchive::RESULT_UNKNOWN;
             }
         }
 
-        if (compressed)
+        if (flags & dmResourceArchive::ENTRY_FLAG_COMPRESSED)
         {
             int decompressed_size;
             dmLZ4::Result r = dmLZ4::DecompressBuffer(source_data, source_data_size, buffer, size, &decompressed_size);
             if (dmLZ4::RESULT_OK != r)
             {
-                delete[] temp_data;
                 return dmResourceArchive::RESULT_OUTBUFFER_TOO_SMALL;
             }
         }
-
-        delete[] temp_data;
         return dmResourceArchive::RESULT_OK;
     }
 
@@ -212,6 +212,46 @@ namespace dmResourceArchive
      */
     Result ReadEntry(HArchiveIndexContainer archive, const EntryData* entry, void* buffer);
 
+    /**
+     * Get the size of the resource data as it is stored in the archive
+     * @param entry_data entry data
+     * @return the compressed size if the entry is compressed, otherwise the resource size
+     */
+    uint32_t GetEntryRawSize(const EntryData* entry);
+
+    /**
+     * Read resource from the given archive without decrypting or decompressing it.
+     * Use DecodeEntryData() with the entry flags to get the resource data.
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param buffer buffer to load to. Must have room for GetEntryRawSize() bytes
+     * @return RESULT_OK on success
+     */
+    Result ReadEntryRaw(HArchiveIndexContainer archive, const EntryData* entry, void* buffer);
+
+    /**
+     * Decrypt and decompress resource data. The decryption is done in place.
+     * Does not access the archive, so it can be called from any thread.
+     * @param flags the entry flags (ENTRY_FLAG_ENCRYPTED, ENTRY_FLAG_COMPRESSED)
+     * @param source_data the data as stored in the archive
+     * @param source_data_size size of source_data
+     * @param buffer buffer to decompress to. Unused if the entry isn't compressed
+     * @param size resource size
+     * @return RESULT_OK on success
+     */
+    Result DecodeEntryData(uint32_t flags, uint8_t* source_data, uint32_t source_data_size, void* buffer, uint32_t size);
+
+    /**
+     * Get a pointer to the resource data in the archive, without copying it.
+     * Only possible if the archive data is in memory (e.g. memory mapped), and the entry is
+     * stored uncompressed and unencrypted.
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param data pointer to the resource data, valid as long as the archive is loaded
+     * @return RESULT_OK on success, RESULT_NOT_FOUND if the data can't be accessed directly
+     */
+    Result GetEntryDataPtr(HArchiveIndexContainer archive, const EntryData* entry, const uint8_t** data);
+
     /**
      * Delete archive index. Only required for archives created with LoadArchive function
      * @param archive archive index handle
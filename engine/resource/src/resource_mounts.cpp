@@ -494,6 +494,72 @@ dmResource::Result ReadResource(HContext ctx, const char* path, dmhash_t path_ha
     return dmResource::RESULT_RESOURCE_NOT_FOUND;
 }
 
+dmResource::Result ReadRawResource(HContext ctx, dmhash_t path_hash, const char* path, dmArray<char>* buffer, dmResourceProvider::RawFileInfo* info)
+{
+    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+
+    uint32_t size = ctx->m_Mounts.Size();
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ArchiveMount& mount = ctx->m_Mounts[i];
+        dmResourceProvider::Result result = dmResourceProvider::GetRawFileInfo(mount.m_Archive, path_hash, path, info);
+        if (dmResourceProvider::RESULT_OK == result)
+        {
+            if (buffer->Capacity() < info->m_RawSize)
+                buffer->SetCapacity(info->m_RawSize);
+            buffer->SetSize(info->m_RawSize);
+
+            result = dmResourceProvider::ReadRawFile(mount.m_Archive, path_hash, path, (uint8_t*)buffer->Begin(), info->m_RawSize);
+            DM_RESOURCE_DBG_LOG(3, "ReadRawResource: %s (%u bytes, flags %u) - result %d\n", path, info->m_RawSize, info->m_Flags, result);
+            DebugPrintMount(3, mount);
+            return ProviderResultToResult(result);
+        }
+    }
+
+    if (!ctx->m_CustomFiles.Empty())
+    {
+        uint32_t resource_size;
+        dmResource::Result result = GetCustomResourceSize(ctx, path_hash, path, &resource_size);
+        if (dmResource::RESULT_OK == result)
+        {
+            if (buffer->Capacity() < resource_size)
+                buffer->SetCapacity(resource_size);
+            buffer->SetSize(resource_size);
+
+            info->m_FileSize = resource_size;
+            info->m_RawSize  = resource_size;
+            info->m_Flags    = 0;
+            return ReadCustomResource(ctx, path_hash, (uint8_t*)buffer->Begin(), resource_size);
+        }
+    }
+
+    return dmResource::RESULT_RESOURCE_NOT_FOUND;
+}
+
+dmResource::Result BorrowResource(HContext ctx, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* resource_size, dmResourceProvider::HArchive* archive)
+{
+    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+
+    uint32_t size = ctx->m_Mounts.Size();
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ArchiveMount& mount = ctx->m_Mounts[i];
+        dmResourceProvider::Result result = dmResourceProvider::GetFileSize(mount.m_Archive, path_hash, path, resource_size);
+        if (dmResourceProvider::RESULT_OK == result)
+        {
+            // Only the mount that would be read from may be borrowed from
+            result = dmResourceProvider::BorrowFile(mount.m_Archive, path_hash, path, data, resource_size);
+            DM_RESOURCE_DBG_LOG(3, "BorrowResource: %s (%u bytes) - result %d\n", path, *resource_size, result);
+            if (dmResourceProvider::RESULT_OK != result)
+                return dmResource::RESULT_NOT_SUPPORTED;
+            *archive = mount.m_Archive;
+            return dmResource::RESULT_OK;
+        }
+    }
+
+    return dmResource::RESULT_NOT_SUPPORTED;
+}
+
 // ****************************************
 // Custom files
 
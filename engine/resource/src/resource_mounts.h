@@ -23,6 +23,7 @@
 namespace dmResourceProvider
 {
     typedef struct Archive*         HArchive;
+    struct RawFileInfo;
 }
 
 namespace dmResourceMounts
@@ -52,6 +53,14 @@ namespace dmResourceMounts
     dmResource::Result ReadResource(HContext ctx, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_size);
     dmResource::Result ReadResource(HContext ctx, dmhash_t path_hash, const char* path, dmArray<char>* buffer);
 
+    // Reads the resource as it is stored in the archive, see dmResourceProvider::ReadRawFile()
+    dmResource::Result ReadRawResource(HContext ctx, dmhash_t path_hash, const char* path, dmArray<char>* buffer, dmResourceProvider::RawFileInfo* info);
+
+    // Gets a pointer to the resource data in the archive without copying it, see dmResourceProvider::BorrowFile()
+    // Returns RESULT_NOT_SUPPORTED if the caller should read the resource instead.
+    // The data must be returned with dmResourceProvider::ReleaseFile(*archive)
+    dmResource::Result BorrowResource(HContext ctx, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* resource_size, dmResourceProvider::HArchive* archive);
+
     struct SGetMountResult
     {
         const char*                  m_Name;
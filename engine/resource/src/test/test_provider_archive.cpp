@@ -25,6 +25,7 @@
 #include "../providers/provider.h"
 #include "../providers/provider_private.h"
 #include "../providers/provider_archive.h"
+#include "../resource_archive.h"
 
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
@@ -299,6 +300,95 @@ TEST_P(ArchiveProviderArchiveInMemory, ReadFile)
         dmMemory::AlignedFree((void*)expected_file);
     }
 }
+
+// * Test that the raw data decodes to the same data as ReadFile() returns
+TEST_P(ArchiveProviderArchiveInMemory, ReadRawFile)
+{
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(FILE_PATHS); ++i)
+    {
+        const char* path = FILE_PATHS[i];
+        dmhash_t path_hash = dmHashString64(path);
+
+        dmResourceProvider::Result result;
+        uint32_t file_size;
+        result = dmResourceProvider::GetFileSize(m_Archive, path_hash, path, &file_size);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+        uint8_t* expected_file = new uint8_t[file_size];
+        result = dmResourceProvider::ReadFile(m_Archive, path_hash, path, expected_file, file_size);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+        dmResourceProvider::RawFileInfo info;
+        result = dmResourceProvider::GetRawFileInfo(m_Archive, path_hash, path, &info);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+        ASSERT_EQ(file_size, info.m_FileSize);
+
+        uint8_t* raw = new uint8_t[info.m_RawSize];
+        result = dmResourceProvider::ReadRawFile(m_Archive, path_hash, path, raw, info.m_RawSize);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+        uint8_t* buffer = new uint8_t[file_size];
+        dmResourceArchive::Result ar = dmResourceArchive::DecodeEntryData(info.m_Flags, raw, info.m_RawSize, buffer, file_size);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, ar);
+
+        if (info.m_Flags & dmResourceArchive::ENTRY_FLAG_COMPRESSED)
+        {
+            ASSERT_ARRAY_EQ_LEN(expected_file, buffer, file_size);
+        }
+        else
+        {
+            // Decoded in place
+            ASSERT_EQ(file_size, info.m_RawSize);
+            ASSERT_ARRAY_EQ_LEN(expected_file, raw, file_size);
+        }
+
+        delete[] buffer;
+        delete[] raw;
+        delete[] expected_file;
+    }
+}
+
+// * Test that uncompressed files can be borrowed directly from the archive data, and that the data is the same as ReadFile() returns
+TEST_P(ArchiveProviderArchiveInMemory, BorrowFile)
+{
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(FILE_PATHS); ++i)
+    {
+        const char* path = FILE_PATHS[i];
+        dmhash_t path_hash = dmHashString64(path);
+
+        dmResourceProvider::Result result;
+        dmResourceProvider::RawFileInfo info;
+        result = dmResourceProvider::GetRawFileInfo(m_Archive, path_hash, path, &info);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+        uint8_t* expected_file = new uint8_t[info.m_FileSize];
+        result = dmResourceProvider::ReadFile(m_Archive, path_hash, path, expected_file, info.m_FileSize);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+        const uint8_t* data = 0;
+        uint32_t file_size = 0;
+        result = dmResourceProvider::BorrowFile(m_Archive, path_hash, path, &data, &file_size);
+        if (info.m_Flags & (dmResourceArchive::ENTRY_FLAG_COMPRESSED | dmResourceArchive::ENTRY_FLAG_ENCRYPTED))
+        {
+            ASSERT_EQ(dmResourceProvider::RESULT_NOT_SUPPORTED, result);
+        }
+        else
+        {
+            ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+            ASSERT_EQ(info.m_FileSize, file_size);
+            ASSERT_ARRAY_EQ_LEN(expected_file, data, file_size);
+            dmResourceProvider::ReleaseFile(m_Archive);
+        }
+
+        delete[] expected_file;
+    }
+
+    const char* path = "src/test/files/not_exist";
+    const uint8_t* data;
+    uint32_t file_size;
+    ASSERT_EQ(dmResourceProvider::RESULT_NOT_FOUND, dmResourceProvider::BorrowFile(m_Archive, dmHashString64(path), path, &data, &file_size));
+}
+
 InMemoryParams params_in_memory_archives[] = {
     {RESOURCES_DMANIFEST, RESOURCES_DMANIFEST_SIZE, RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, RESOURCES_ARCD_SIZE},
     {RESOURCES_COMPRESSED_DMANIFEST, RESOURCES_COMPRESSED_DMANIFEST_SIZE, RESOURCES_COMPRESSED_ARCI, RESOURCES_COMPRESSED_ARCI_SIZE, RESOURCES_COMPRESSED_ARCD, RESOURCES_COMPRESSED_ARCD_SIZE},
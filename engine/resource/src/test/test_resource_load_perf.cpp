@@ -0,0 +1,277 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h> // rand
+#include <string.h>
+
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
+#include <dlib/hash.h>
+#include <dlib/hashtable.h>
+#include <dlib/log.h>
+#include <dlib/lz4.h>
+#include <dlib/math.h>
+#include <dlib/time.h>
+
+#include "../resource.h"
+#include "../resource_archive.h"
+#include "../resource_mounts.h"
+#include "../providers/provider.h"
+#include "../providers/provider_private.h"
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+// Benchmarks for loading many resources asynchronously with the preloader.
+// The resources are served from a synthetic in memory archive with LZ4 compressed entries.
+// Not run as part of the test suite, run build/src/test/test_resource_load_perf manually.
+
+static const uint32_t SMALL_ENTRY_COUNT  = 4000;
+static const uint32_t SMALL_ENTRY_SIZE   = 2 * 1024;
+static const uint32_t LARGE_ENTRY_COUNT  = 64;
+static const uint32_t LARGE_ENTRY_SIZE   = 1024 * 1024;
+static const uint32_t PRELOADER_BATCH    = 512; // Keep well below the max number of preloader requests
+static const uint32_t THREAD_COUNTS[]    = {1, 2, 4, 8};
+
+struct SyntheticEntry
+{
+    dmArray<uint8_t> m_Data; // Compressed
+    uint32_t         m_Size;
+};
+
+struct SyntheticArchive
+{
+    dmHashTable64<SyntheticEntry*> m_Entries;
+    dmArray<SyntheticEntry*>       m_EntryList;
+};
+
+static dmResourceProvider::Result SyntheticUnmount(dmResourceProvider::HArchiveInternal internal)
+{
+    return dmResourceProvider::RESULT_OK;
+}
+
+static dmResourceProvider::Result SyntheticGetFileSize(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, uint32_t* file_size)
+{
+    SyntheticArchive* archive = (SyntheticArchive*)internal;
+    SyntheticEntry** entry = archive->m_Entries.Get(path_hash);
+    if (!entry)
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    *file_size = (*entry)->m_Size;
+    return dmResourceProvider::RESULT_OK;
+}
+
+static dmResourceProvider::Result SyntheticReadFile(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len)
+{
+    SyntheticArchive* archive = (SyntheticArchive*)internal;
+    SyntheticEntry** entry = archive->m_Entries.Get(path_hash);
+    if (!entry)
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    int decompressed_size;
+    if (dmLZ4::RESULT_OK != dmLZ4::DecompressBuffer((*entry)->m_Data.Begin(), (*entry)->m_Data.Size(), buffer, buffer_len, &decompressed_size))
+        return dmResourceProvider::RESULT_IO_ERROR;
+    return dmResourceProvider::RESULT_OK;
+}
+
+static dmResourceProvider::Result SyntheticGetRawFileInfo(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, dmResourceProvider::RawFileInfo* info)
+{
+    SyntheticArchive* archive = (SyntheticArchive*)internal;
+    SyntheticEntry** entry = archive->m_Entries.Get(path_hash);
+    if (!entry)
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    info->m_FileSize = (*entry)->m_Size;
+    info->m_RawSize  = (*entry)->m_Data.Size();
+    info->m_Flags    = dmResourceArchive::ENTRY_FLAG_COMPRESSED;
+    return dmResourceProvider::RESULT_OK;
+}
+
+static dmResourceProvider::Result SyntheticReadRawFile(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len)
+{
+    SyntheticArchive* archive = (SyntheticArchive*)internal;
+    SyntheticEntry** entry = archive->m_Entries.Get(path_hash);
+    if (!entry)
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    memcpy(buffer, (*entry)->m_Data.Begin(), (*entry)->m_Data.Size());
+    return dmResourceProvider::RESULT_OK;
+}
+
+static void AddEntry(SyntheticArchive* archive, const char* path, uint32_t size)
+{
+    // Somewhat compressible data
+    dmArray<uint8_t> data;
+    data.SetCapacity(size);
+    data.SetSize(size);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        data[i] = (i & 0x40) ? (uint8_t)(rand() & 0xff) : (uint8_t)(i & 0x7);
+    }
+
+    int max_compressed_size;
+    dmLZ4::MaxCompressedSize(size, &max_compressed_size);
+
+    SyntheticEntry* entry = new SyntheticEntry;
+    entry->m_Size = size;
+    entry->m_Data.SetCapacity(max_compressed_size);
+    entry->m_Data.SetSize(max_compressed_size);
+    int compressed_size;
+    dmLZ4::CompressBuffer(data.Begin(), size, entry->m_Data.Begin(), &compressed_size);
+    entry->m_Data.SetSize(compressed_size);
+
+    archive->m_Entries.Put(dmHashString64(path), entry);
+    archive->m_EntryList.Push(entry);
+}
+
+struct SyntheticResource
+{
+    uint64_t m_Hash;
+};
+
+static dmResource::Result SyntheticPreload(const dmResource::ResourcePreloadParams* params)
+{
+    // Some work per byte, in lieu of parsing the data
+    SyntheticResource* resource = new SyntheticResource;
+    resource->m_Hash = dmHashBuffer64(params->m_Buffer, params->m_BufferSize);
+    *params->m_PreloadData = resource;
+    return dmResource::RESULT_OK;
+}
+
+static dmResource::Result SyntheticCreate(const dmResource::ResourceCreateParams* params)
+{
+    ResourceDescriptorSetResource(params->m_Resource, params->m_PreloadData);
+    return dmResource::RESULT_OK;
+}
+
+static dmResource::Result SyntheticDestroy(const dmResource::ResourceDestroyParams* params)
+{
+    delete (SyntheticResource*)ResourceDescriptorGetResource(params->m_Resource);
+    return dmResource::RESULT_OK;
+}
+
+class LoadPerfTest : public jc_test_base_class
+{
+protected:
+    virtual void SetUp()
+    {
+        memset(&m_Loader, 0, sizeof(m_Loader));
+        m_Loader.m_NameHash       = dmHashString64("synthetic");
+        m_Loader.m_Unmount        = SyntheticUnmount;
+        m_Loader.m_GetFileSize    = SyntheticGetFileSize;
+        m_Loader.m_ReadFile       = SyntheticReadFile;
+        m_Loader.m_GetRawFileInfo = SyntheticGetRawFileInfo;
+        m_Loader.m_ReadRawFile    = SyntheticReadRawFile;
+
+        uint32_t count = SMALL_ENTRY_COUNT + LARGE_ENTRY_COUNT;
+        m_Archive.m_Entries.SetCapacity(count / 2, count);
+        m_Archive.m_EntryList.SetCapacity(count);
+        m_Paths.SetCapacity(count);
+
+        char path[64];
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            bool large = (i % (count / LARGE_ENTRY_COUNT)) == 0 && i / (count / LARGE_ENTRY_COUNT) < LARGE_ENTRY_COUNT;
+            dmSnPrintf(path, sizeof(path), "/entry%u.synthc", i);
+            AddEntry(&m_Archive, path, large ? LARGE_ENTRY_SIZE : SMALL_ENTRY_SIZE + (rand() % SMALL_ENTRY_SIZE));
+            m_Paths.Push(strdup(path));
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for (uint32_t i = 0; i < m_Archive.m_EntryList.Size(); ++i)
+            delete m_Archive.m_EntryList[i];
+        for (uint32_t i = 0; i < m_Paths.Size(); ++i)
+            free((void*)m_Paths[i]);
+    }
+
+public:
+    dmResourceProvider::ArchiveLoader m_Loader;
+    SyntheticArchive                  m_Archive;
+    dmArray<const char*>              m_Paths;
+};
+
+static float ToMs(uint64_t start, uint64_t end)
+{
+    return (end - start) / 1000.0f;
+}
+
+// Loads all the entries of the archive with preloaders, and returns the time in ms
+static float MeasureLoad(LoadPerfTest* test, uint32_t thread_count)
+{
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = test->m_Paths.Size() + 1;
+    params.m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+    params.m_LoadThreadCount = thread_count;
+    dmResource::HFactory factory = dmResource::NewFactory(&params, ".");
+    if (!factory)
+        return -1.0f;
+
+    dmResource::RegisterType(factory, "synthc", 0, SyntheticPreload, SyntheticCreate, 0, SyntheticDestroy, 0);
+
+    dmResourceProvider::HArchive archive;
+    dmResourceProvider::CreateMount(&test->m_Loader, &test->m_Archive, &archive);
+    dmResourceMounts::AddMount(dmResource::GetMountsContext(factory), "synthetic", archive, 100, false);
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    for (uint32_t offset = 0; offset < test->m_Paths.Size(); offset += PRELOADER_BATCH)
+    {
+        uint32_t count = dmMath::Min(PRELOADER_BATCH, test->m_Paths.Size() - offset);
+        dmArray<const char*> names(test->m_Paths.Begin() + offset, count, count);
+        dmResource::HPreloader preloader = dmResource::NewPreloader(factory, names);
+
+        dmResource::Result r;
+        do
+        {
+            r = dmResource::UpdatePreloader(preloader, 0, 0, 10 * 1000);
+        } while (r == dmResource::RESULT_PENDING);
+        EXPECT_EQ(dmResource::RESULT_OK, r);
+
+        dmResource::DeletePreloader(preloader);
+    }
+    uint64_t end = dmTime::GetMonotonicTime();
+
+    dmResource::DeleteFactory(factory);
+    return ToMs(start, end);
+}
+
+TEST_F(LoadPerfTest, LoadSyntheticArchive)
+{
+    uint64_t total_size = 0;
+    uint64_t total_compressed_size = 0;
+    for (uint32_t i = 0; i < m_Archive.m_EntryList.Size(); ++i)
+    {
+        total_size += m_Archive.m_EntryList[i]->m_Size;
+        total_compressed_size += m_Archive.m_EntryList[i]->m_Data.Size();
+    }
+    printf("%u entries, %.1f MB, %.1f MB compressed\n", m_Archive.m_EntryList.Size(), total_size / (1024.0f * 1024.0f), total_compressed_size / (1024.0f * 1024.0f));
+
+    printf("%10s %12s\n", "threads", "load");
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(THREAD_COUNTS); ++i)
+    {
+        float load = MeasureLoad(this, THREAD_COUNTS[i]);
+        printf("%10u %12.3f\n", THREAD_COUNTS[i], load);
+    }
+}
+
+extern "C" void dmExportedSymbols();
+
+int main(int argc, char **argv)
+{
+    dmExportedSymbols();
+    dmLog::LogParams logparams;
+    dmLog::LogInitialize(&logparams);
+
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}